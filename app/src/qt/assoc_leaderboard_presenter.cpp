@@ -58,7 +58,7 @@ void AssocLeaderboardPresenter::slotShowNote(const QItemSelection& selected, con
         // IMPROVE make my role constant
         Note* note = item->data(Qt::UserRole + 1).value<Note*>();
 
-        note->incReads();
+        orloj->getMind()->noteRead(note);
         note->makeDirty();
 
         orloj->showFacetNoteView(note);
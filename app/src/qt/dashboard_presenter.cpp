@@ -57,7 +57,8 @@ DashboardPresenter::~DashboardPresenter()
 
 void DashboardPresenter::refresh(
         const vector<Outline*>& os,
-        const vector<Note*>& ns,
+        const vector<Note*>& recentNs,
+        unsigned notesCount,
         const map<const Tag*,int>& ts,
         int bytes,
         MindStatistics* stats)
@@ -97,7 +98,7 @@ void DashboardPresenter::refresh(
             "<b>Statistics</b>:"
             "<ul>"
             "<li><b>" + stringFormatIntAsUs(os.size()) + "</b> notebooks, "
-            "<b>" + stringFormatIntAsUs(ns.size()) + "</b> notes, "
+            "<b>" + stringFormatIntAsUs(notesCount) + "</b> notes, "
             "<b>" + stringFormatIntAsUs(ts.size()) + "</b> tags and "
             "<b>" + stringFormatIntAsUs(bytes) + "</b> bytes.</li>"
             "<li>Most used notebook: <b>" + QString::fromStdString(stats->mostReadOutline?stats->mostReadOutline->getName():"") + "</b>.</li>"
@@ -125,7 +126,7 @@ void DashboardPresenter::refresh(
     doFirstDashboardletPresenter->refresh(doFirstOs, true, true);
 
     outlinesDashboardletPresenter->refresh(os);
-    recentDashboardletPresenter->refresh(ns);
+    recentDashboardletPresenter->refresh(recentNs);
     // IMPROVE: consider showing recent O: navigatorDashboardletPresenter->showInitialView(ns[0]->getOutline());
     navigatorDashboardletPresenter->showInitialView();
     tagsDashboardletPresenter->refresh(ts);
@@ -63,10 +63,12 @@ public:
     ~DashboardPresenter();
 
     DashboardView* getView() { return view; }
+    NavigatorPresenter* getNavigatorDashboardlet() const { return navigatorDashboardletPresenter; }
 
     void refresh(
             const std::vector<Outline*>& os,
-            const std::vector<Note*>& ns,
+            const std::vector<Note*>& recentNs,
+            unsigned notesCount,
             const std::map<const Tag*,int>& ts,
             int bytes,
             MindStatistics* stats
@@ -18,19 +18,25 @@
 */
 #include "find_outline_by_name_dialog.h"
 
-#include "../gear/qutils.h"
-
 namespace m8r {
 
 using namespace std;
 
+constexpr size_t FindOutlineByNameDialog::FOUND_LIMIT;
+
 FindOutlineByNameDialog::FindOutlineByNameDialog(QWidget *parent)
-    : QDialog(parent)
+    : QDialog(parent),
+      listViewModel{&names},
+      choice{nullptr},
+      finder{new FuzzyFinder{}},
+      searchGeneration{0},
+      found{}
 {
     // widgets
     listView = new QListView(this);
-    // list view model must be set - use of this type of mode enable the use of string lists controlling its content
+    // virtual model: only visible rows are converted to strings
     listView->setModel(&listViewModel);
+    listView->setUniformItemSizes(true);
     // disable editation of the list item on doble click
     listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
 
@@ -87,6 +93,9 @@ FindOutlineByNameDialog::FindOutlineByNameDialog(QWidget *parent)
 
 FindOutlineByNameDialog::~FindOutlineByNameDialog()
 {
+    // stop finder's thread first as it calls back this dialog
+    delete finder;
+
     delete label;
     delete lineEdit;
     delete listView;
@@ -112,23 +121,25 @@ void FindOutlineByNameDialog::show(
     }
 
     things.clear();
-    listViewStrings.clear();
+    names.clear();
     bool useCustomNames = customizedNames!=nullptr && customizedNames->size()>0;
     if(ts.size()) {
+        things.reserve(ts.size());
+        names.reserve(ts.size());
         for(size_t i=0; i<ts.size(); i++) {
             things.push_back(ts[i]);
             if(useCustomNames) {
-                listViewStrings << QString::fromStdString(customizedNames->at(i));
+                names.push_back(customizedNames->at(i));
             } else {
-                if(ts.at(i)->getName().size()) {
-                    listViewStrings << QString::fromStdString(ts[i]->getName());
-                } else {
-                    listViewStrings << "";
-                }
+                names.push_back(ts[i]->getName());
             }
         }
-        ((QStringListModel*)listView->model())->setStringList(listViewStrings);
     }
+    // candidates are encoded once per dialog show ~ not on every key stroke
+    finder->setCandidates(names);
+    searchGeneration = 0;
+    shownQuery.clear();
+    listViewModel.showAll();
 
     findButton->setEnabled(things.size());
 
@@ -144,55 +155,68 @@ void FindOutlineByNameDialog::show(
 
 void FindOutlineByNameDialog::enableFindButton(const QString& text)
 {
-    listViewStrings.clear();
     if(!text.isEmpty()) {
-        if(keywordsCheckBox->isEnabled() && keywordsCheckBox->isChecked()) {
-            int visible = 0;
-            int row = 0;
-            for(Thing* e:things) {
-                QString s = QString::fromStdString(e->getName());
-                if(stringMatchByKeywords(text, s, caseCheckBox->isChecked())) {
-                    listView->setRowHidden(row, false);
-                    visible++;
-                } else {
-                    listView->setRowHidden(row, true);
-                }
-                row++;
-            }
-            findButton->setEnabled(visible);
-        } else {
-            Qt::CaseSensitivity c = caseCheckBox->isChecked()?Qt::CaseInsensitive:Qt::CaseSensitive;
-            // IMPROVE find a list view method giving # of visible rows
-            int visible = 0;
-            int row = 0;
-            for(Thing* e:things) {
-                QString s = QString::fromStdString(e->getName());
-                if(s.startsWith(text,c)) {
-                    listView->setRowHidden(row, false);
-                    visible++;
-                } else {
-                    listView->setRowHidden(row, true);
+        // search off GUI thread - the result is delivered by handleFound()
+        searchGeneration = finder->findAsync(
+            text.toStdString(),
+            caseCheckBox->isChecked(),
+            isKeywordsMatch(),
+            FOUND_LIMIT,
+            [this](FuzzyFinderResult& result) {
+                {
+                    lock_guard<mutex> foundLock{foundMutex};
+                    found = std::move(result);
                 }
-                row++;
-            }
-            findButton->setEnabled(visible);
-        }
+                QMetaObject::invokeMethod(this, "handleFound", Qt::QueuedConnection);
+            });
     } else {
-        for(size_t row = 0; row<things.size(); row++) {
-            listView->setRowHidden(row, false);
-        }
+        searchGeneration = 0;
+        shownQuery.clear();
+        listViewModel.showAll();
         findButton->setEnabled(things.size());
     }
 }
 
+void FindOutlineByNameDialog::handleFound()
+{
+    FuzzyFinderResult result{};
+    {
+        lock_guard<mutex> foundLock{foundMutex};
+        if(found.generation != searchGeneration || !searchGeneration) {
+            // superseded by newer query
+            return;
+        }
+        result = std::move(found);
+        found.generation = 0;
+    }
+    showFound(result);
+}
+
+void FindOutlineByNameDialog::showFound(FuzzyFinderResult& result)
+{
+    shownQuery = result.query;
+    listViewModel.show(result.matches);
+    if(listViewModel.rowCount()) {
+        listView->scrollToTop();
+    }
+    findButton->setEnabled(listViewModel.rowCount());
+}
+
 void FindOutlineByNameDialog::handleReturn()
 {
+    // Enter might be faster than finder's thread
+    string query{lineEdit->text().toStdString()};
+    if(query != shownQuery) {
+        FuzzyFinderResult result{};
+        if(finder->find(query, caseCheckBox->isChecked(), isKeywordsMatch(), FOUND_LIMIT, result)) {
+            searchGeneration = result.generation;
+            showFound(result);
+        }
+    }
+
     if(findButton->isEnabled()) {
-        for(size_t row = 0; row<things.size(); row++) {
-            if(!listView->isRowHidden(row)) {
-                choice = things[row];
-                break;
-            }
+        if(listViewModel.rowCount()) {
+            choice = things[listViewModel.toIndex(0)];
         }
 
         QDialog::close();
@@ -203,7 +227,7 @@ void FindOutlineByNameDialog::handleReturn()
 void FindOutlineByNameDialog::handleChoice()
 {
     if(listView->currentIndex().isValid()) {
-        choice = things[listView->currentIndex().row()];
+        choice = things[listViewModel.toIndex(listView->currentIndex().row())];
 
         QDialog::close();
         emit searchFinished();
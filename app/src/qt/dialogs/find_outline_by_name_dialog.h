@@ -19,10 +19,12 @@
 #ifndef M8RUI_FIND_OUTLINE_BY_NAME_DIALOG_H
 #define M8RUI_FIND_OUTLINE_BY_NAME_DIALOG_H
 
+#include <mutex>
 #include <vector>
 
 #include <QtWidgets>
 
+#include "../../lib/src/gear/fuzzy_finder.h"
 #include "../../lib/src/mind/ontology/thing_class_rel_triple.h"
 
 namespace m8r {
@@ -41,12 +43,9 @@ class FindOutlineByNameDialog : public QDialog
         {}
         void keyPressEvent(QKeyEvent* event) override {
             if(event->key() == Qt::Key_Down) {
-                // find the first visible row
-                for(int row = 0; row<target->model()->rowCount(); row++) {
-                    if(!target->isRowHidden(row)) {
-                        target->setCurrentIndex(target->model()->index(row,0));
-                        break;
-                    }
+                // select the best match
+                if(target->model()->rowCount()) {
+                    target->setCurrentIndex(target->model()->index(0,0));
                 }
                 target->setFocus();
             }
@@ -54,17 +53,72 @@ class FindOutlineByNameDialog : public QDialog
         }
     };
 
+    /**
+     * @brief Virtual list of found names - rows are mapped to names lazily.
+     */
+    class FoundNamesModel : public QAbstractListModel
+    {
+    private:
+        const std::vector<std::string>* names;
+        // all names in the original order, or top matches
+        bool all;
+        std::vector<size_t> rows;
+    public:
+        explicit FoundNamesModel(const std::vector<std::string>* names)
+            : names(names), all(true), rows{}
+        {}
+        int rowCount(const QModelIndex& parent=QModelIndex()) const override {
+            if(parent.isValid()) {
+                return 0;
+            }
+            return static_cast<int>(all ? names->size() : rows.size());
+        }
+        QVariant data(const QModelIndex& index, int role=Qt::DisplayRole) const override {
+            if(role == Qt::DisplayRole && index.isValid() && index.row() < rowCount()) {
+                return QString::fromStdString((*names)[toIndex(index.row())]);
+            }
+            return QVariant{};
+        }
+        size_t toIndex(int row) const { return all ? static_cast<size_t>(row) : rows[row]; }
+        void showAll() {
+            beginResetModel();
+            all = true;
+            rows.clear();
+            endResetModel();
+        }
+        void show(const std::vector<FuzzyMatch>& matches) {
+            beginResetModel();
+            all = false;
+            rows.clear();
+            for(const FuzzyMatch& m:matches) {
+                rows.push_back(m.index);
+            }
+            endResetModel();
+        }
+    };
+
+public:
+    // top N matches are shown ~ the rest is narrowed by typing
+    static constexpr size_t FOUND_LIMIT = 1000;
+
 private:
     MyLineEdit* lineEdit;
     QListView* listView;
-    QStringList listViewStrings;
-    QStringListModel listViewModel;
+    FoundNamesModel listViewModel;
     QCheckBox* caseCheckBox;
     QCheckBox* keywordsCheckBox;
     QPushButton* closeButton;
 
     Thing* choice;
     std::vector<Thing*> things;
+    std::vector<std::string> names;
+
+    // names are searched on finder's thread, results are passed to GUI thread
+    FuzzyFinder* finder;
+    std::uint64_t searchGeneration;
+    std::mutex foundMutex;
+    FuzzyFinderResult found;
+    std::string shownQuery;
 
 protected:
     QLabel* label;
@@ -92,11 +146,16 @@ public:
             bool showScopeCheck=false,
             bool init=true);
 
+private:
+    bool isKeywordsMatch() const { return keywordsCheckBox->isEnabled() && keywordsCheckBox->isChecked(); }
+    void showFound(FuzzyFinderResult& result);
+
 signals:
     void searchFinished();
 
 private slots:
     void enableFindButton(const QString &text);
+    void handleFound();
     void handleChoice();
     void handleReturn();
 };
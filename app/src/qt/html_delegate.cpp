@@ -18,6 +18,25 @@
 */
 #include "html_delegate.h"
 
+static inline int textAdvance(const QFontMetrics& metrics, const QString& text)
+{
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 11, 0))
+    return metrics.horizontalAdvance(text);
+#else
+    return metrics.width(text);
+#endif
+}
+
+HtmlDelegate::HtmlDelegate(QObject* parent)
+    : QStyledItemDelegate(parent),
+      layoutCache(LAYOUT_CACHE_SIZE)
+{
+}
+
+HtmlDelegate::~HtmlDelegate()
+{
+}
+
 void HtmlDelegate::paint(
         QPainter *painter,
         const QStyleOptionViewItem& option,
@@ -33,23 +52,41 @@ void HtmlDelegate::paint(
 
     QStyle *style = optionV4.widget? optionV4.widget->style() : QApplication::style();
 
-    QTextDocument doc;
-    doc.setHtml(optionV4.text);
+    const Layout* layout = getLayout(optionV4.text, optionV4.font, -1);
 
     /// painting item without text
     optionV4.text = QString();
     style->drawControl(QStyle::CE_ItemViewItem, &optionV4, painter);
 
-    QAbstractTextDocumentLayout::PaintContext ctx;
-    // highlighting text if item is selected
-    if (optionV4.state & QStyle::State_Selected)
-        ctx.palette.setColor(QPalette::Text, optionV4.palette.color(QPalette::Active, QPalette::HighlightedText));
-
     QRect textRect = style->subElementRect(QStyle::SE_ItemViewItemText, &optionV4);
     painter->save();
     painter->translate(textRect.topLeft());
     painter->setClipRect(textRect.translated(-textRect.topLeft()));
-    doc.documentLayout()->draw(painter, ctx);
+    if(layout->document) {
+        QAbstractTextDocumentLayout::PaintContext ctx;
+        // highlighting text if item is selected
+        if (optionV4.state & QStyle::State_Selected)
+            ctx.palette.setColor(QPalette::Text, optionV4.palette.color(QPalette::Active, QPalette::HighlightedText));
+
+        layout->document->documentLayout()->draw(painter, ctx);
+    } else {
+        // highlighting text if item is selected
+        QColor textColor = optionV4.palette.color(
+            QPalette::Active,
+            optionV4.state & QStyle::State_Selected ? QPalette::HighlightedText : QPalette::Text);
+
+        QFontMetrics metrics{layout->font};
+        int x = DOCUMENT_MARGIN;
+        for(const Run& run:layout->runs) {
+            if(run.background.isValid()) {
+                painter->fillRect(x, DOCUMENT_MARGIN, run.width, metrics.height(), run.background);
+            }
+            painter->setFont(runFont(layout->font, run));
+            painter->setPen(run.color.isValid() ? run.color : textColor);
+            painter->drawText(x, DOCUMENT_MARGIN + metrics.ascent(), run.text);
+            x += run.width;
+        }
+    }
     painter->restore();
 }
 
@@ -65,8 +102,191 @@ QSize HtmlDelegate::sizeHint(
 #endif
     initStyleOption(&optionV4, index);
 
-    QTextDocument doc;
-    doc.setHtml(optionV4.text);
-    doc.setTextWidth(optionV4.rect.width());
-    return QSize(doc.idealWidth(), doc.size().height());
+    return getLayout(optionV4.text, optionV4.font, optionV4.rect.width())->size;
+}
+
+const HtmlDelegate::Layout* HtmlDelegate::getLayout(const QString& html, const QFont& font, int width) const
+{
+    LayoutKey key{html, width};
+    Layout* layout = layoutCache.object(key);
+    if(layout && layout->font == font) {
+        return layout;
+    }
+
+    layout = new Layout{};
+    layout->font = font;
+    if(parseRuns(html, layout->runs)) {
+        int runsWidth = 0;
+        for(Run& run:layout->runs) {
+            run.width = textAdvance(QFontMetrics{runFont(font, run)}, run.text);
+            runsWidth += run.width;
+        }
+        layout->size = QSize(
+            runsWidth + 2*DOCUMENT_MARGIN,
+            QFontMetrics{font}.height() + 2*DOCUMENT_MARGIN);
+    } else {
+        layout->runs.clear();
+        layout->document = new QTextDocument{};
+        layout->document->setDefaultFont(font);
+        layout->document->setHtml(html);
+        if(width >= 0) {
+            layout->document->setTextWidth(width);
+        }
+        layout->size = QSize(layout->document->idealWidth(), layout->document->size().height());
+    }
+
+    // cache takes ownership (least recently used layouts are deleted)
+    layoutCache.insert(key, layout);
+    return layout;
+}
+
+bool HtmlDelegate::parseRuns(const QString& html, QVector<Run>& runs)
+{
+    runs.clear();
+
+    // style of the innermost open element is on top
+    QVector<Run> styles{};
+    styles.append(Run{QString{}, QColor{}, QColor{}, false, false, 0});
+    QString text{};
+    // HTML collapses whitespaces and skips leading ones
+    bool lastSpace = true;
+
+    auto flush = [&]() {
+        if(!text.isEmpty()) {
+            Run run = styles.last();
+            run.text = text;
+            runs.append(run);
+            text.clear();
+        }
+    };
+
+    for(int i=0; i<html.size(); i++) {
+        const QChar c = html[i];
+        if(c == '<') {
+            int end = html.indexOf('>', i);
+            if(end < 0) {
+                return false;
+            }
+            QString tag = html.mid(i+1, end-i-1);
+            flush();
+            if(tag == "/span" || tag == "/b") {
+                if(styles.size() == 1) {
+                    return false;
+                }
+                styles.removeLast();
+            } else if(tag == "b") {
+                Run style = styles.last();
+                style.bold = true;
+                styles.append(style);
+            } else if(tag == "span" || tag.startsWith("span ")) {
+                Run style = styles.last();
+                if(!parseSpanStyle(tag, style)) {
+                    return false;
+                }
+                styles.append(style);
+            } else {
+                // tables, links, line breaks, ... are laid out by document
+                return false;
+            }
+            i = end;
+        } else if(c == '&') {
+            int end = html.indexOf(';', i);
+            if(end < 0) {
+                return false;
+            }
+            QString entity = html.mid(i+1, end-i-1);
+            if(entity == "nbsp") {
+                text += QChar(0x00A0);
+            } else if(entity == "amp") {
+                text += '&';
+            } else if(entity == "lt") {
+                text += '<';
+            } else if(entity == "gt") {
+                text += '>';
+            } else if(entity == "quot") {
+                text += '"';
+            } else if(entity == "apos") {
+                text += '\'';
+            } else if(entity.startsWith('#')) {
+                bool ok;
+                uint code = entity.mid(1).toUInt(&ok);
+                if(!ok || code > 0xFFFF) {
+                    return false;
+                }
+                text += QChar(static_cast<ushort>(code));
+            } else {
+                return false;
+            }
+            lastSpace = false;
+            i = end;
+        } else if(c == '\n' || c == '\r') {
+            return false;
+        } else if(c == ' ' || c == '\t') {
+            if(!lastSpace) {
+                text += ' ';
+                lastSpace = true;
+            }
+        } else {
+            text += c;
+            lastSpace = false;
+        }
+    }
+    flush();
+
+    return styles.size() == 1;
+}
+
+bool HtmlDelegate::parseSpanStyle(const QString& tag, Run& run)
+{
+    int s = tag.indexOf("style=");
+    if(s < 0) {
+        return true;
+    }
+    s += 6;
+    if(s >= tag.size() || (tag[s] != '\'' && tag[s] != '"')) {
+        return false;
+    }
+    int e = tag.indexOf(tag[s], s+1);
+    if(e < 0) {
+        return false;
+    }
+
+    for(const QString& declaration:tag.mid(s+1, e-s-1).split(';')) {
+        int colon = declaration.indexOf(':');
+        if(colon < 0) {
+            if(declaration.trimmed().isEmpty()) {
+                continue;
+            }
+            return false;
+        }
+        QString property = declaration.left(colon).trimmed();
+        QString value = declaration.mid(colon+1).trimmed();
+        if(property == "color") {
+            run.color = QColor(value);
+            if(!run.color.isValid()) {
+                return false;
+            }
+        } else if(property == "background-color") {
+            run.background = QColor(value);
+            if(!run.background.isValid()) {
+                return false;
+            }
+        } else if(property == "font-style") {
+            run.italic = value == "italic";
+        } else if(property == "font-weight") {
+            run.bold = value == "bold";
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+QFont HtmlDelegate::runFont(const QFont& font, const Run& run)
+{
+    QFont result{font};
+    result.setBold(run.bold);
+    result.setItalic(run.italic);
+    return result;
 }
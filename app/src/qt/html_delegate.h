@@ -21,8 +21,71 @@
 
 #include <QtWidgets>
 
+/**
+ * @brief Delegate rendering HTML of table/tree cells.
+ *
+ * Laid out cells are kept in LRU cache keyed by HTML and width, therefore
+ * neither repaint nor size hint requires HTML parsing. Simple markup used
+ * by O/N tables (text, entities and styled spans) is rendered as text runs
+ * directly by painter; other markup is laid out by QTextDocument.
+ */
 class HtmlDelegate : public QStyledItemDelegate
 {
+public:
+    static constexpr int LAYOUT_CACHE_SIZE = 4096;
+    // QTextDocument default document margin to keep runs aligned w/ documents
+    static constexpr int DOCUMENT_MARGIN = 4;
+
+private:
+    /**
+     * @brief Text run with the same style.
+     */
+    struct Run {
+        QString text;
+        QColor color;
+        QColor background;
+        bool bold;
+        bool italic;
+        int width;
+    };
+
+    struct LayoutKey {
+        QString html;
+        int width;
+
+        bool operator==(const LayoutKey& other) const {
+            return width==other.width && html==other.html;
+        }
+    };
+    friend uint qHash(const LayoutKey& key, uint seed=0) {
+        return qHash(key.html, seed) ^ static_cast<uint>(key.width);
+    }
+
+    /**
+     * @brief Laid out cell - either runs or document (if markup is not simple).
+     */
+    struct Layout {
+        QFont font;
+        QVector<Run> runs;
+        QTextDocument* document;
+        QSize size;
+
+        Layout() : document(nullptr) {}
+        ~Layout() { delete document; }
+    };
+
+    mutable QCache<LayoutKey,Layout> layoutCache;
+
+public:
+    explicit HtmlDelegate(QObject* parent=nullptr);
+    HtmlDelegate(const HtmlDelegate&) = delete;
+    HtmlDelegate(const HtmlDelegate&&) = delete;
+    HtmlDelegate &operator=(const HtmlDelegate&) = delete;
+    HtmlDelegate &operator=(const HtmlDelegate&&) = delete;
+    ~HtmlDelegate();
+
+    void clearCache() { layoutCache.clear(); }
+
 protected:
     void paint(
             QPainter* painter,
@@ -31,6 +94,19 @@ protected:
     QSize sizeHint(
             const QStyleOptionViewItem& option,
             const QModelIndex& index) const;
+
+private:
+    /**
+     * @brief Get cached layout or lay out HTML (width < 0 for unlimited width).
+     */
+    const Layout* getLayout(const QString& html, const QFont& font, int width) const;
+
+    /**
+     * @brief Parse simple markup to text runs - false is returned if markup is not supported.
+     */
+    static bool parseRuns(const QString& html, QVector<Run>& runs);
+    static bool parseSpanStyle(const QString& tag, Run& run);
+    static QFont runFont(const QFont& font, const Run& run);
 };
 
 #endif // M8RUI_HTML_DELEGATE_H
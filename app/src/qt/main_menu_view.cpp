@@ -112,6 +112,9 @@ MainMenuView::MainMenuView(MainWindowView& mainWindowView)
     actionMindExportCsv = new QAction(tr("&CSV"), mainWindow);
     actionMindExportCsv->setStatusTip(tr("Export all Notebooks/Markdown files as a single CSV file"));
     submenuMindExport->addAction(actionMindExportCsv);
+    actionMindExportHtml = new QAction(tr("&HTML"), mainWindow);
+    actionMindExportHtml->setStatusTip(tr("Export all Notebooks to a directory as HTML site - unchanged Notebooks are skipped"));
+    submenuMindExport->addAction(actionMindExportHtml);
 
     actionExit = new QAction(QIcon(":/menu-icons/exit.svg"), tr("E&xit"), mainWindow);
     actionExit->setShortcut(QKeySequence(Qt::CTRL+Qt::Key_Q));
@@ -75,6 +75,7 @@ public:
     QAction* actionMindPreferences;
     QMenu* submenuMindExport;
     QAction* actionMindExportCsv;
+    QAction* actionMindExportHtml;
     QAction* actionExit;
 
     // menu: Find
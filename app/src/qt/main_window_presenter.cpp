@@ -22,9 +22,16 @@ using namespace std;
 
 namespace m8r {
 
+constexpr int MainWindowPresenter::LEARNING_INTERVAL;
+constexpr int MainWindowPresenter::LEARNING_REFRESH_BATCHES;
+
 MainWindowPresenter::MainWindowPresenter(MainWindowView& view)
     : view(view),
-      config(Configuration::getInstance())
+      config(Configuration::getInstance()),
+      learningTimerId{0},
+      learningBatches{0},
+      htmlSiteExporter{nullptr},
+      htmlSiteExportWatcher{nullptr}
 {
     mind = new Mind{config};
 
@@ -149,11 +156,17 @@ MainWindowPresenter::MainWindowPresenter(MainWindowView& view)
     QObject::connect(configDialog, SIGNAL(saveConfigSignal()), distributor, SLOT(slotConfigurationUpdated()));
 
     // let Mind to learn active repository & preserve desired state
-    mind->learn();
+    startLearning();
 }
 
 MainWindowPresenter::~MainWindowPresenter()
 {
+    if(htmlSiteExportWatcher) {
+        // exporter doesn't access Os while writing, but it must finish before it's deleted
+        htmlSiteExportWatcher->waitForFinished();
+        delete htmlSiteExportWatcher;
+        delete htmlSiteExporter;
+    }
     if(mind) delete mind;
     if(mainMenu) delete mainMenu;
     if(statusBar) delete statusBar;
@@ -171,12 +184,76 @@ MainWindowPresenter::~MainWindowPresenter()
     // TODO deletes
 }
 
+void MainWindowPresenter::startLearning()
+{
+    // knowledge graph nodes are deleted on amnesia
+    orloj->invalidateNavigators();
+    mind->learnAsync();
+    learningBatches = 0;
+    if(mind->isLearning() && !learningTimerId) {
+        learningTimerId = startTimer(LEARNING_INTERVAL);
+    }
+}
+
+void MainWindowPresenter::timerEvent(QTimerEvent* event)
+{
+    if(event->timerId() != learningTimerId) {
+        QObject::timerEvent(event);
+        return;
+    }
+
+    bool learned = false;
+    if(mind->isLearning() && mind->learnBatch()) {
+        learned = true;
+        learningBatches++;
+    }
+
+    if(mind->isLearning()) {
+        // outlines table is usable while learning - refresh it w/ learned Os
+        if(learned
+             &&
+           orloj->isFacetActive(OrlojPresenterFacets::FACET_LIST_OUTLINES)
+             &&
+           learningBatches%LEARNING_REFRESH_BATCHES==1)
+        {
+            orloj->getOutlinesTable()->refresh(mind->getOutlines());
+        }
+        size_t done, total;
+        mind->remind().getLearningProgress(done, total);
+        statusBar->showInfo(tr("Learning notebooks %1/%2...").arg(done).arg(total));
+    } else {
+        killTimer(learningTimerId);
+        learningTimerId = 0;
+        MF_DEBUG("Learning finished in " << learningBatches << " batches" << endl);
+        // show configured view unless user already navigated elsewhere
+        if(orloj->isFacetActive(OrlojPresenterFacets::FACET_LIST_OUTLINES)) {
+            showInitialView();
+        } else {
+            statusBar->showMindStatistics();
+            showInitialMindState();
+        }
+    }
+}
+
+bool MainWindowPresenter::isLearning(const QString& feature)
+{
+    if(mind->isLearning()) {
+        statusBar->showInfo(tr("%1 is warming up - notebooks are still being learned...").arg(feature));
+        return true;
+    }
+    return false;
+}
+
 void MainWindowPresenter::showInitialView()
 {
     MF_DEBUG("Initial view to show " << mind->getOutlines().size() << " Os (scope is applied if active)" << endl);
 
     // UI
-    if(mind->getOutlines().size()) {
+    if(mind->isLearning()) {
+        // Os are learned progressively - configured view is shown once learning is finished
+        view.getCli()->setBreadcrumbPath("/outlines");
+        orloj->showFacetOutlineList(mind->getOutlines());
+    } else if(mind->getOutlines().size()) {
         if(config.getActiveRepository()->getMode()==Repository::RepositoryMode::REPOSITORY) {
             if(config.getActiveRepository()->isGithubRepository()) {
                 string key{config.getActiveRepository()->getDir()};
@@ -197,7 +274,7 @@ void MainWindowPresenter::showInitialView()
                     orloj->showFacetTagCloud();
                 } else if(!string{START_TO_RECENT}.compare(config.getStartupView())) {
                     vector<Note*> notes{};
-                    orloj->showFacetRecentNotes(mind->getAllNotes(notes));
+                    orloj->showFacetRecentNotes(mind->getMemoryDwell(notes, config.getRecentNotesUiLimit(), true));
                 } else if(!string{START_TO_EISENHOWER_MATRIX}.compare(config.getStartupView())) {
                     orloj->showFacetOrganizer(mind->getOutlines());
                 } else if(!string{START_TO_HOME_OUTLINE}.compare(config.getStartupView())) {
@@ -223,6 +300,7 @@ void MainWindowPresenter::showInitialView()
     } else {
         // NO Os > nothing to show
         // IMPROVE show homepage once it's implemented
+        orloj->invalidateNavigators();
         mind->amnesia();
         orloj->showFacetOutlineList(mind->getOutlines());
     }
@@ -234,8 +312,13 @@ void MainWindowPresenter::showInitialView()
     mainMenu->showFacetLiveNotePreview(config.isUiLiveNotePreview());
     orloj->setAspect(config.isUiLiveNotePreview()?OrlojPresenterFacetAspect::ASPECT_LIVE_PREVIEW:OrlojPresenterFacetAspect::ASPECT_NONE);
 
-    // move Mind to configured state
-    if(config.getDesiredMindState()==Configuration::MindState::THINKING) {
+    showInitialMindState();
+}
+
+void MainWindowPresenter::showInitialMindState()
+{
+    // move Mind to configured state (Mind can think once all Os are learned)
+    if(!mind->isLearning() && config.getDesiredMindState()==Configuration::MindState::THINKING) {
         MF_DEBUG("InitialView: asking Mind to THINK..." << endl);
         shared_future<bool> f = mind->think(); // move
         if(f.wait_for(chrono::microseconds(0)) == future_status::ready) {
@@ -461,6 +544,10 @@ void MainWindowPresenter::handleMindNewFile()
 
 void MainWindowPresenter::doActionMindThink()
 {
+    if(isLearning(tr("Thinking"))) {
+        return;
+    }
+
     shared_future<bool> f = mind->think(); // move
     if(f.wait_for(chrono::microseconds(0)) == future_status::ready) {
         // sync
@@ -631,7 +718,7 @@ void MainWindowPresenter::doActionMindRelearn(QString path)
         // remember new repository
         mdConfigRepresentation->save(config);
         // learn and show
-        mind->learn();
+        startLearning();
         showInitialView();
     } else {
         QMessageBox::critical(
@@ -653,6 +740,10 @@ void MainWindowPresenter::doActionFts()
 
 void MainWindowPresenter::doFts(const QString& pattern, bool doSearch)
 {
+    if(isLearning(tr("Full-text search"))) {
+        return;
+    }
+
     if(pattern.size()) {
         ftsDialog->setSearchPattern(pattern);
     }
@@ -823,7 +914,7 @@ void MainWindowPresenter::handleFindNoteByTag()
     if(findNoteByTagDialog->getChoice()) {
         Note* choice = (Note*)findNoteByTagDialog->getChoice();
 
-        choice->incReads();
+        mind->noteRead(choice);
         choice->makeDirty();
 
         orloj->showFacetOutline(choice->getOutline());
@@ -890,7 +981,7 @@ void MainWindowPresenter::handleFindNoteByName()
     if(findNoteByNameDialog->getChoice()) {
         Note* choice = (Note*)findNoteByNameDialog->getChoice();
 
-        choice->incReads();
+        mind->noteRead(choice);
         choice->makeDirty();
 
         orloj->showFacetOutline(choice->getOutline());
@@ -908,47 +999,31 @@ void MainWindowPresenter::handleFindNoteByName()
 
 void MainWindowPresenter::doActionFindNerPersons()
 {
-    if(orloj->isFacetActiveOutlineManagement()) {
-        nerChooseTagsDialog->clearCheckboxes();
-        nerChooseTagsDialog->getPersonsCheckbox()->setChecked(true);
-        nerChooseTagsDialog->show();
-    } else {
-        statusBar->showInfo(tr("Initializing NER and predicting..."));
-        QMessageBox::critical(&view, tr("NER"), tr("Memory NER not implemented yet."));
-    }
+    // NER in O (O/N view facet) or in whole memory
+    nerChooseTagsDialog->clearCheckboxes();
+    nerChooseTagsDialog->getPersonsCheckbox()->setChecked(true);
+    nerChooseTagsDialog->show();
 }
 void MainWindowPresenter::doActionFindNerLocations()
 {
-    if(orloj->isFacetActiveOutlineManagement()) {
-        nerChooseTagsDialog->clearCheckboxes();
-        nerChooseTagsDialog->getLocationsCheckbox()->setChecked(true);
-        nerChooseTagsDialog->show();
-    } else {
-        statusBar->showInfo(tr("Initializing NER and predicting..."));
-        QMessageBox::critical(&view, tr("NER"), tr("Memory NER not implemented yet."));
-    }
+    // NER in O (O/N view facet) or in whole memory
+    nerChooseTagsDialog->clearCheckboxes();
+    nerChooseTagsDialog->getLocationsCheckbox()->setChecked(true);
+    nerChooseTagsDialog->show();
 }
 void MainWindowPresenter::doActionFindNerOrganizations()
 {
-    if(orloj->isFacetActiveOutlineManagement()) {
-        nerChooseTagsDialog->clearCheckboxes();
-        nerChooseTagsDialog->getOrganizationsCheckbox()->setChecked(true);
-        nerChooseTagsDialog->show();
-    } else {
-        statusBar->showInfo(tr("Initializing NER and predicting..."));
-        QMessageBox::critical(&view, tr("NER"), tr("Memory NER not implemented yet."));
-    }
+    // NER in O (O/N view facet) or in whole memory
+    nerChooseTagsDialog->clearCheckboxes();
+    nerChooseTagsDialog->getOrganizationsCheckbox()->setChecked(true);
+    nerChooseTagsDialog->show();
 }
 void MainWindowPresenter::doActionFindNerMisc()
 {
-    if(orloj->isFacetActiveOutlineManagement()) {
-        nerChooseTagsDialog->clearCheckboxes();
-        nerChooseTagsDialog->getMiscCheckbox()->setChecked(true);
-        nerChooseTagsDialog->show();
-    } else {
-        statusBar->showInfo(tr("Initializing NER and predicting..."));
-        QMessageBox::critical(&view, tr("NER"), tr("Memory NER not implemented yet."));
-    }
+    // NER in O (O/N view facet) or in whole memory
+    nerChooseTagsDialog->clearCheckboxes();
+    nerChooseTagsDialog->getMiscCheckbox()->setChecked(true);
+    nerChooseTagsDialog->show();
 }
 
 NerMainWindowWorkerThread* MainWindowPresenter::startNerWorkerThread(
@@ -998,7 +1073,11 @@ void MainWindowPresenter::handleFindNerEntities()
     if(mind->isNerInitilized()) {
         statusBar->showInfo(tr("Recognizing named entities..."));
 
-        mind->recognizePersons(orloj->getOutlineView()->getCurrentOutline(), entityFilter, *result);
+        if(orloj->isFacetActiveOutlineOrNoteView()) {
+            mind->recognizePersons(orloj->getOutlineView()->getCurrentOutline(), entityFilter, *result);
+        } else {
+            mind->recognizeEntities(entityFilter, *result);
+        }
 
         chooseNerEntityResult(result);
     } else {
@@ -1053,7 +1132,7 @@ void MainWindowPresenter::handleFtsNerEntity()
         executeFts(
             nerResultDialog->getChoice(),
             false,
-            orloj->getOutlineView()->getCurrentOutline());
+            orloj->isFacetActiveOutlineOrNoteView()?orloj->getOutlineView()->getCurrentOutline():nullptr);
     }
 }
 
@@ -1062,7 +1141,7 @@ void MainWindowPresenter::handleFtsNerEntity()
 void MainWindowPresenter::doActionViewRecentNotes()
 {
     vector<Note*> notes{};
-    mind->getAllNotes(notes, true, true);
+    mind->getMemoryDwell(notes, config.getRecentNotesUiLimit(), true);
     orloj->showFacetRecentNotes(notes);
 }
 
@@ -1939,7 +2018,7 @@ void MainWindowPresenter::doActionOutlineHome()
         // if O has tag, then toggle (remove) it, else set the tag
         if(o->hasTag(t)) {
             o->removeTag(t);
-            mind->remind().remember(o->getKey());
+            mind->remember(o->getKey());
             statusBar->showInfo(tr("Home tag toggled/removed - Notebook '%1' is no longer home").arg(o->getName().c_str()));
         } else {
             if(mind->setOutlineUniqueTag(t, o->getKey())) {
@@ -1962,6 +2041,7 @@ void MainWindowPresenter::doActionOutlineForget()
             QString::fromStdString(orloj->getOutlineView()->getCurrentOutline()->getName()) +
             tr("' Notebook?"));
         if (choice == QMessageBox::Yes) {
+            orloj->invalidateNavigators();
             mind->outlineForget(orloj->getOutlineView()->getCurrentOutline()->getKey());
             orloj->slotShowOutlines();
         } // else do nothing
@@ -2009,7 +2089,66 @@ void MainWindowPresenter::handleMindCsvExport()
     if(isDirectoryOrFileExists(newFileDialog->getFilePath().toStdString().c_str())) {
         QMessageBox::critical(&view, tr("Export Error"), tr("Specified file path already exists!"));
     } else {
-        mind->remind().exportToCsv(exportMindToCsvDialog->getFilePath().toStdString());
+        mind->exportToCsv(exportMindToCsvDialog->getFilePath().toStdString(), true);
+    }
+}
+
+void MainWindowPresenter::doActionMindHtmlExport()
+{
+    if(htmlSiteExporter) {
+        QMessageBox::information(&view, tr("Export"), tr("HTML export is already running..."));
+        return;
+    }
+
+    QString homeDirectory
+        = QStandardPaths::locate(QStandardPaths::HomeLocation, QString(), QStandardPaths::LocateDirectory);
+
+    QFileDialog exportDialog{&view};
+    exportDialog.setWindowTitle(tr("Export Notebooks to HTML Directory"));
+    exportDialog.setFileMode(QFileDialog::Directory);
+    exportDialog.setDirectory(homeDirectory);
+    exportDialog.setViewMode(QFileDialog::Detail);
+
+    QStringList directoryNames{};
+    if(exportDialog.exec()) {
+        directoryNames = exportDialog.selectedFiles();
+        if(directoryNames.size()==1) {
+            // Os are snapshot in GUI thread, pages are rendered and written in background
+            htmlSiteExporter = new HtmlSiteExporter{mind->getOntology()};
+            try {
+                htmlSiteExporter->prepare(
+                    mind->remind().getOutlines(),
+                    config.getMemoryPath(),
+                    directoryNames[0].toStdString());
+            } catch(MindForgerException& e) {
+                delete htmlSiteExporter;
+                htmlSiteExporter = nullptr;
+                QMessageBox::critical(&view, tr("Export Error"), QString::fromUtf8(e.what()));
+                return;
+            }
+
+            statusBar->showInfo(tr("Exporting Notebooks to HTML..."));
+            htmlSiteExportWatcher = new QFutureWatcher<HtmlSiteExporter::Stats>{};
+            QObject::connect(
+                htmlSiteExportWatcher, SIGNAL(finished()),
+                this, SLOT(handleMindHtmlExportFinished()));
+            htmlSiteExportWatcher->setFuture(QtConcurrent::run(htmlSiteExporter, &HtmlSiteExporter::write));
+        } // else too many files
+    } // else directory closed / nothing choosen
+}
+
+void MainWindowPresenter::handleMindHtmlExportFinished()
+{
+    if(htmlSiteExportWatcher) {
+        HtmlSiteExporter::Stats stats = htmlSiteExportWatcher->result();
+        statusBar->showInfo(
+            tr("HTML export: %1 exported, %2 unchanged, %3 removed, %4 failed")
+                .arg(stats.exported).arg(stats.skipped).arg(stats.removed).arg(stats.failed));
+
+        htmlSiteExportWatcher->deleteLater();
+        htmlSiteExportWatcher = nullptr;
+        delete htmlSiteExporter;
+        htmlSiteExporter = nullptr;
     }
 }
 
@@ -2028,6 +2167,7 @@ void MainWindowPresenter::doActionOutlineTWikiImport()
     if(importDialog.exec()) {
         directoryNames = importDialog.selectedFiles();
         if(directoryNames.size()==1) {
+            orloj->invalidateNavigators();
             mind->learnOutlineTWiki(directoryNames[0].toStdString());
 
             // refresh O view
@@ -2144,6 +2284,7 @@ void MainWindowPresenter::doActionNoteForget()
 
             QAbstractButton* choosen = msgBox.clickedButton();
             if(yes == choosen) {
+                orloj->invalidateNavigators();
                 Outline* outline = mind->noteForget(note);
                 mind->remember(outline);
                 orloj->showFacetOutline(orloj->getOutlineView()->getCurrentOutline());
@@ -88,6 +88,10 @@ class MainWindowPresenter : public QObject
     static QString EXPORT_O_TO_HTML_TITLE;
     static QString EXPORT_O_TO_HTML_EXTENSION;
 
+    // progressive learning: period of learning a batch of Os (ms) and table refresh rate (in batches)
+    static constexpr int LEARNING_INTERVAL = 1000/50;
+    static constexpr int LEARNING_REFRESH_BATCHES = 10;
+
 private:
     MainWindowView& view;
 
@@ -130,6 +134,13 @@ private:
     NerChooseTagTypesDialog *nerChooseTagsDialog;
     NerResultDialog* nerResultDialog;
 
+    int learningTimerId;
+    int learningBatches;
+
+    // HTML site export running in background
+    HtmlSiteExporter* htmlSiteExporter;
+    QFutureWatcher<HtmlSiteExporter::Stats>* htmlSiteExportWatcher;
+
 public:
     explicit MainWindowPresenter(MainWindowView& view);
     MainWindowPresenter(const MainWindowPresenter&) = delete;
@@ -158,6 +169,11 @@ public:
     // dashboard(s)
     void showInitialView();
 
+    /**
+     * @brief Learn active repository progressively - Os are learned in batches on GUI thread timer.
+     */
+    void startLearning();
+
     // N view
     void handleNoteViewLinkClicked(const QUrl& url);
 
@@ -188,6 +204,8 @@ public slots:
     void doActionMindSnapshot();
     void doActionMindCsvExport();
     void handleMindCsvExport();
+    void doActionMindHtmlExport();
+    void handleMindHtmlExportFinished();
     void doActionExit();
     // recall
     void doActionFts();
@@ -333,6 +351,12 @@ private:
     void copyLinkOrImageToRepository(const std::string& srcPath, QString& path);
 
     void statusInfoPreviewFlickering();
+
+    void showInitialMindState();
+    bool isLearning(const QString& feature);
+
+protected:
+    void timerEvent(QTimerEvent* event) override;
 };
 
 }
@@ -27,6 +27,7 @@
 #include <QtWidgets>
 
 #include "../../lib/src/version.h"
+#include "../../lib/src/gear/tracer.h"
 #include "../../lib/src/representations/markdown/markdown_configuration_representation.h"
 
 #include "gear/qutils.h"
@@ -165,6 +166,7 @@ int main(int argc, char* argv[])
     std::string useRepository{};
     QString themeOptionValue{};
     QString configurationFilePath{};
+    QString traceFilePath{};
     if(argc > 1) {
         QCommandLineParser parser;
         // process command line as parameters/options are present
@@ -178,6 +180,10 @@ int main(int argc, char* argv[])
                 QCoreApplication::translate("main", "Load configuration from given <file>."),
                 QCoreApplication::translate("main", "file"));
         parser.addOption(configPathOption);
+        QCommandLineOption traceOption(QStringList() << "T" << "trace",
+                QCoreApplication::translate("main", "Trace and write Chrome trace to <file> (histograms to <file>.txt) on exit."),
+                QCoreApplication::translate("main", "file"));
+        parser.addOption(traceOption);
 #if defined(__APPLE__) || defined(_WIN32)
         QCommandLineOption macosDisableSecurityOption(QStringList() << "S" << "disable-web-security",
                 QCoreApplication::translate("main", "Disable WebEngine security to allow loading of images on macOS."));
@@ -209,6 +215,11 @@ int main(int argc, char* argv[])
         if(parser.isSet(configPathOption)) {
             configurationFilePath = parser.value(configPathOption);
         }
+
+        if(parser.isSet(traceOption)) {
+            traceFilePath = parser.value(traceOption);
+            m8r::Tracer::getInstance().setEnabled(true);
+        }
     }
     // else there are no parameters and options > simply load GUI
 
@@ -272,5 +283,13 @@ int main(int argc, char* argv[])
     mainWindowPresenter.showInitialView();
 
     // run application
-    return mindforgerApplication.exec();
+    int exitCode = mindforgerApplication.exec();
+
+    if(!traceFilePath.isEmpty()) {
+        m8r::Tracer::getInstance().setEnabled(false);
+        if(!m8r::Tracer::getInstance().exportTo(traceFilePath.toStdString())) {
+            cerr << "Error: Unable to write trace to: " << traceFilePath.toStdString() << endl;
+        }
+    }
+    return exitCode;
 }
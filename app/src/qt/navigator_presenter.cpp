@@ -63,6 +63,12 @@ void NavigatorPresenter::showInitialViewTags()
     view->refreshOnNextTimerTick(&subgraph);
 }
 
+void NavigatorPresenter::invalidate()
+{
+    subgraph.clear();
+    view->cleanupBeforeHide();
+}
+
 void NavigatorPresenter::shuffle()
 {
     view->shuffle();
@@ -55,6 +55,10 @@ public:
     void shuffle();
 
     void cleanupBeforeHide() { view->cleanupBeforeHide(); }
+    /**
+     * @brief Drop knowledge graph nodes held by presenter and view (before Mind forgets/learns).
+     */
+    void invalidate();
 
 private slots:
     void slotNodeSelected(NavigatorNode* node);
@@ -27,7 +27,11 @@ NerMainWindowWorkerThread::~NerMainWindowWorkerThread()
 
 void NerMainWindowWorkerThread::process()
 {
-    mind->recognizePersons(orloj->getOutlineView()->getCurrentOutline(), entityFilter, *result);
+    if(orloj->isFacetActiveOutlineOrNoteView()) {
+        mind->recognizePersons(orloj->getOutlineView()->getCurrentOutline(), entityFilter, *result);
+    } else {
+        mind->recognizeEntities(entityFilter, *result);
+    }
 
     progressDialog->hide();
 
@@ -22,15 +22,12 @@ namespace m8r {
 
 using namespace std;
 
-inline bool caseInsensitiveLessThan(const QString &a, const QString &b)
-{
-    return a.compare(b, Qt::CaseInsensitive) < 0;
-}
-
 NoteEditorView::NoteEditorView(QWidget* parent)
     : QPlainTextEdit(parent),
       parent(parent),
-      completedAndSelected(false)
+      completedAndSelected(false),
+      wordsIndex{},
+      wordsIndexRevision{-1}
 {
     hitCounter = 0;
 
@@ -53,7 +50,8 @@ NoteEditorView::NoteEditorView(QWidget* parent)
     // must be in unfiltered mode to show links
     completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
     completer->setModel(model);
-    completer->setModelSorting(QCompleter::CaseInsensitivelySortedModel);
+    // model is populated w/ ranked (most relevant first) completions
+    completer->setModelSorting(QCompleter::UnsortedModel);
     completer->setCaseSensitivity(Qt::CaseInsensitive);
     completer->setWrapAround(true);
 
@@ -447,10 +445,30 @@ void NoteEditorView::slotPerformLinkCompletion(
 
 void NoteEditorView::populateModel(const QString& completionPrefix)
 {
-    QStringList strings = toPlainText().split(QRegExp{"\\W+"});
-    strings.removeAll(completionPrefix);
-    strings.removeDuplicates();
-    qSort(strings.begin(), strings.end(), caseInsensitiveLessThan);
+    // incrementally sync words index w/ document - only changed lines are (re)tokenized
+    if(wordsIndexRevision != document()->revision()) {
+        wordsIndex.beginUpdate();
+        for(QTextBlock b = document()->begin(); b.isValid(); b = b.next()) {
+            const QString text = b.text();
+            size_t h = qHash(text);
+            if(!wordsIndex.touchLine(h)) {
+                wordsIndex.addLine(h, text.toStdString());
+            }
+        }
+        wordsIndex.endUpdate();
+        wordsIndexRevision = document()->revision();
+    }
+
+    vector<string> words{};
+    wordsIndex.complete(
+        completionPrefix.toStdString(),
+        words,
+        Configuration::EDITOR_MAX_AUTOCOMPLETE_RESULTS);
+
+    QStringList strings{};
+    for(string& w:words) {
+        strings.append(QString::fromStdString(w));
+    }
     model->setStringList(strings);
 }
 
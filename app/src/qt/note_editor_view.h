@@ -22,6 +22,7 @@
 #include <QtWidgets>
 
 #include "../../lib/src/gear/lang_utils.h"
+#include "../../lib/src/mind/completion_index.h"
 
 #include "note_edit_highlight.h"
 #include "widgets/line_number_panel.h"
@@ -59,6 +60,8 @@ private:
     bool completedAndSelected;
     QCompleter* completer;
     QStringListModel* model;
+    DocumentWordsIndex wordsIndex;
+    int wordsIndexRevision;
 
     bool tabsAsSpaces;
     int tabWidth;
@@ -191,14 +191,16 @@ void OrlojPresenter::showFacetRecentNotes(const vector<Note*>& notes)
 void OrlojPresenter::showFacetDashboard() {
     setFacet(OrlojPresenterFacets::FACET_DASHBOARD);
 
-    vector<Note*> allNotes{};
-    mind->getAllNotes(allNotes, true, true);
+    // recent Ns from memory dwell ~ w/o sorting all Ns
+    vector<Note*> recentNotes{};
+    mind->getMemoryDwell(recentNotes, config.getRecentNotesUiLimit(), true);
     map<const Tag*,int> allTags{};
     mind->getTagsCardinality(allTags);
 
     dashboardPresenter->refresh(
         mind->getOutlines(),
-        allNotes,
+        recentNotes,
+        mind->remind().getNotesCount(),
         allTags,
         mind->remind().getOutlineMarkdownsSize(),
         mind->getStatistics()
@@ -217,6 +219,12 @@ void OrlojPresenter::showFacetOrganizer(const vector<Outline*>& outlines)
     mainPresenter->getStatusBar()->showMindStatistics();
 }
 
+void OrlojPresenter::invalidateNavigators()
+{
+    navigatorPresenter->invalidate();
+    dashboardPresenter->getNavigatorDashboardlet()->invalidate();
+}
+
 void OrlojPresenter::showFacetKnowledgeGraphNavigator()
 {
     switch(activeFacet) {
@@ -281,7 +289,7 @@ void OrlojPresenter::showFacetOutline(Outline* outline)
         view->showFacetOutlineHeaderView();
     }
 
-    outline->incReads();
+    mind->outlineRead(outline);
     outline->makeDirty();
 
     mainPresenter->getMainMenu()->showFacetOutlineView();
@@ -644,7 +652,7 @@ void OrlojPresenter::slotShowNote(const QItemSelection& selected, const QItemSel
         // IMPROVE make my role constant
         Note* note = item->data(Qt::UserRole + 1).value<Note*>();
 
-        note->incReads();
+        mind->noteRead(note);
         note->makeDirty();
 
         showFacetNoteView(note);
@@ -662,7 +670,7 @@ void OrlojPresenter::slotShowNavigator()
 void OrlojPresenter::slotShowNoteNavigator(Note* note)
 {
     if(note) {
-        note->incReads();
+        mind->noteRead(note);
         note->makeDirty();
 
         showFacetNoteView(note);
@@ -684,8 +692,6 @@ void OrlojPresenter::slotShowOutlineNavigator(Outline* outline)
  */
 void OrlojPresenter::slotGetLinksForPattern(const QString& pattern)
 {
-    vector<Thing*> allThings{};
-    vector<string> thingsNames = vector<string>{};
     string prefix{pattern.toStdString()};
 
     Outline* currentOutline;
@@ -695,15 +701,8 @@ void OrlojPresenter::slotGetLinksForPattern(const QString& pattern)
         currentOutline = noteEditPresenter->getCurrentNote()->getOutline();
     }
 
-    mind->getAllThings(
-        allThings,
-        &thingsNames,
-        &prefix,
-        ThingNameSerialization::LINK,
-        currentOutline);
-
     vector<string>* links = new vector<string>{};
-    *links = thingsNames;
+    mind->getLinksForPrefix(prefix, *links, currentOutline);
 
     if(activeFacet == OrlojPresenterFacets::FACET_EDIT_OUTLINE_HEADER) {
         emit signalLinksForHeaderPattern(pattern, links);
@@ -133,6 +133,11 @@ public:
     NoteEditPresenter* getNoteEdit() const { return noteEditPresenter; }
 
     bool isFacetActive(const OrlojPresenterFacets facet) const { return activeFacet==facet;}
+
+    /**
+     * @brief Invalidate navigators as knowledge graph nodes are deleted when Mind forgets/learns.
+     */
+    void invalidateNavigators();
     bool isFacetActiveOutlineOrNoteView() {
         if(isFacetActive(OrlojPresenterFacets::FACET_VIEW_OUTLINE)
              ||
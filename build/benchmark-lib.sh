@@ -0,0 +1,90 @@
+#!/bin/bash
+#
+# MindForger thinking notebook
+#
+# Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+export OPTION_RECOMPILE=yes # recompile before running benchmarks (comment this line to disable)
+
+# synthetic repository size: 1000 / 10000 / 100000 Ns
+export OPTION_NOTES=1000
+# benchmarks to run e.g. "fts" or "aa" (comment this line to run all)
+#export OPTION_FILTER="fts"
+# Markdown to HTML transcoder: cmark / none (committed baselines were measured w/o transcoder)
+export OPTION_MD2HTML=none
+# baseline to compare results with (comment this line to disable) - baselines are committed
+# for every synthetic repository size, times are scaled to this machine by calibration workload;
+# missing baseline is recorded by the first run
+export OPTION_BASELINE="baselines/baseline-${OPTION_NOTES}-notes-${OPTION_MD2HTML}.json"
+
+# environment - to be specified in .bashrc or elsewhere:
+#   export M8R_CPU_CORES=7
+
+if [ -z ${M8R_CPU_CORES} ]
+then
+    echo "Set M8R_CPU_CORES env var to specify number of CPU cores to be used by compiler/make"
+    exit 1
+fi
+
+export SCRIPT_DIR=`pwd`
+export BUILD_DIR=${SCRIPT_DIR}/../lib/test
+
+# benchmarks MUST be built in release mode w/o MF_DEBUG output
+if [ ${OPTION_RECOMPILE} ]
+then
+    cd ${BUILD_DIR} && cd ../../ && make clean && rm *.a
+    cd ${BUILD_DIR} && cd ./benchmark && make clean
+    export QMAKE_OPTIONS="CONFIG+=release"
+    if [ "${OPTION_MD2HTML}" = "none" ]
+    then
+	export QMAKE_OPTIONS="${QMAKE_OPTIONS} CONFIG+=mfnomd2html"
+    fi
+    cd ${BUILD_DIR} && make clean && qmake -r mindforger-lib-benchmarks.pro ${QMAKE_OPTIONS} && make -j${M8R_CPU_CORES}
+    if [ ${?} -ne 0 ]
+    then
+	exit 1
+    fi
+fi
+
+export BENCHMARK_OPTIONS="--notes ${OPTION_NOTES} --output ${BUILD_DIR}/benchmark/benchmark-${OPTION_NOTES}-notes.json"
+if [ ${OPTION_FILTER} ]
+then
+    export BENCHMARK_OPTIONS="${BENCHMARK_OPTIONS} --filter ${OPTION_FILTER}"
+fi
+export RECORD_BASELINE=
+if [ ${OPTION_BASELINE} ]
+then
+    if [ -f ${BUILD_DIR}/benchmark/${OPTION_BASELINE} ]
+    then
+	export BENCHMARK_OPTIONS="${BENCHMARK_OPTIONS} --baseline ${BUILD_DIR}/benchmark/${OPTION_BASELINE}"
+    else
+	export RECORD_BASELINE=yes
+    fi
+fi
+
+# exit code 2 ~ regression, 3 ~ baseline of different build configuration
+cd ${BUILD_DIR}/benchmark && ./mindforger-lib-benchmarks ${BENCHMARK_OPTIONS}
+export BENCHMARK_EXIT_CODE=${?}
+
+if [ ${RECORD_BASELINE} ] && [ ${BENCHMARK_EXIT_CODE} -eq 0 ]
+then
+    mkdir -p `dirname ${BUILD_DIR}/benchmark/${OPTION_BASELINE}`
+    cp ${BUILD_DIR}/benchmark/benchmark-${OPTION_NOTES}-notes.json ${BUILD_DIR}/benchmark/${OPTION_BASELINE}
+    echo "Baseline recorded to ${BUILD_DIR}/benchmark/${OPTION_BASELINE}"
+fi
+exit ${BENCHMARK_EXIT_CODE}
+
+# eof
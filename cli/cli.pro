@@ -0,0 +1,112 @@
+# cli.pro     MindForger thinking notebook
+#
+# Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+#
+# This program is free software ; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License
+# as published by the Free Software Foundation ; either version 2
+# of the License, or (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY ; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+TARGET = mindforger-cli
+TEMPLATE = app
+
+# headless CLI is built w/o DO_MF_DEBUG - debug output would break JSON output
+
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= qt
+
+INCLUDEPATH += $$PWD/../lib/src
+DEPENDPATH += $$PWD/../lib/src
+
+
+# -L where to look for library, -l link the library
+win32 {
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../lib/release -lmindforger
+    else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../lib/debug -lmindforger
+} else {
+    LIBS += -L$$OUT_PWD/../lib -lmindforger
+}
+
+!mfnomd2html {
+  win32 {
+    DEFINES += MF_MD_2_HTML_CMARK
+    CONFIG(release, debug|release) {
+        LIBS += -L$$PWD/../deps/cmark-gfm/build/src/Release -lcmark-gfm_static
+        LIBS += -L$$PWD/../deps/cmark-gfm/build/extensions/Release -lcmark-gfm-extensions_static
+    } else:CONFIG(debug, debug|release) {
+        LIBS += -L$$PWD/../deps/cmark-gfm/build/src/Debug -lcmark-gfm_static
+        LIBS += -L$$PWD/../deps/cmark-gfm/build/extensions/Debug -lcmark-gfm-extensions_static
+    }
+  } else {
+    # cmark-gfm
+    DEFINES += MF_MD_2_HTML_CMARK
+    INCLUDEPATH += $$PWD/../deps/cmark-gfm/src
+    INCLUDEPATH += $$PWD/../deps/cmark-gfm/extensions
+    INCLUDEPATH += $$PWD/../deps/cmark-gfm/build/src
+    INCLUDEPATH += $$PWD/../deps/cmark-gfm/build/extensions
+    LIBS += -L$$PWD/../deps/cmark-gfm/build/extensions -lcmark-gfm-extensions
+    LIBS += -L$$PWD/../deps/cmark-gfm/build/src -lcmark-gfm
+  }
+} else {
+  DEFINES += MF_NO_MD_2_HTML
+}
+
+
+# zlib
+win32 {
+    INCLUDEPATH += $$PWD/../deps/zlib-win/include
+    DEPENDPATH += $$PWD/../deps/zlib-win/include
+
+    CONFIG(release, debug|release): LIBS += -L$$PWD/../deps/zlib-win/lib/ -lzlibwapi
+    else:CONFIG(debug, debug|release): LIBS += -L$$PWD/../deps/zlib-win/lib/ -lzlibwapi
+} else {
+    LIBS += -lz
+}
+
+#
+win32 {
+    LIBS += -lRpcrt4 -lOle32 -lShell32
+} else {
+    LIBS += -lpthread
+}
+
+# compiler options
+win32{
+    QMAKE_CXXFLAGS += /MP
+} else {
+    # linux and macos
+    mfnoccache {
+      QMAKE_CXX = g++
+    } else:!mfnocxx {
+      QMAKE_CXX = ccache g++
+    }
+    QMAKE_CXXFLAGS += -pedantic -std=c++11
+}
+
+SOURCES += \
+    ./src/mindforger_cli.cpp \
+    ./src/cli_command_processor.cpp \
+    ./src/cli_server.cpp
+
+HEADERS += \
+    ./src/cli_command_processor.h \
+    ./src/cli_server.h
+
+# ########################################
+# Linux installation: make install
+# ########################################
+
+binfile.files += mindforger-cli
+binfile.path = /usr/bin/
+INSTALLS += binfile
+
+# eof
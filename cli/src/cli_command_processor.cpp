@@ -0,0 +1,508 @@
+/*
+ cli_command_processor.cpp     MindForger command line interface
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "cli_command_processor.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+#include "representations/html/html_outline_representation.h"
+
+namespace m8r {
+
+using namespace std;
+
+void CliCommandProcessor::usage(ostream& out)
+{
+    out << "Commands:" << endl
+        << "  stats                         number of Os and Ns" << endl
+        << "  outlines                      list Os" << endl
+        << "  fts <pattern>                 find Ns (exact match)" << endl
+        << "  fts-ignore-case <pattern>     find Ns ignoring case" << endl
+        << "  fts-regexp <regexp>           find Ns matching regular expression" << endl
+        << "  tags                          list tags w/ cardinality" << endl
+        << "  tagged <tag>[,<tag>...]       find Os and Ns w/ all given tags" << endl
+        << "  associations <id>             Ns associated w/ N (or O) of given id" << endl
+        << "  associate <words>             Ns associated w/ words" << endl
+        << "  backlinks <id>                Ns linking N (or O) of given id" << endl
+        << "  html <id>                     N (or O) of given id rendered to HTML" << endl
+        << "  learn                         re-learn repository from disk" << endl
+        << "  export-csv <file>             export Ns to CSV" << endl
+        << "  export-html <directory>       export repository to static HTML site" << endl
+        << "  import-twiki <file>           import TWiki file as new O" << endl
+        << "  help                          this help" << endl
+        << "  quit                          stop processing of stdin" << endl;
+}
+
+bool CliCommandProcessor::isReadOnly(const string& command)
+{
+    // searches don't modify Ns, HTML is rendered by per request representation and
+    // AA calculations are cancelled (superseded) per caller
+    return command == "stats"
+        || command == "outlines"
+        || command == "fts"
+        || command == "fts-ignore-case"
+        || command == "fts-regexp"
+        || command == "tags"
+        || command == "tagged"
+        || command == "associations"
+        || command == "associate"
+        || command == "backlinks"
+        || command == "html";
+}
+
+CliCommandProcessor::CliCommandProcessor(Mind& mind)
+    : mind{mind},
+      thinkingMutex{},
+      thinking{false}
+{
+}
+
+CliCommandProcessor::~CliCommandProcessor()
+{
+}
+
+bool CliCommandProcessor::execute(const string& line, string& json)
+{
+    size_t b = line.find_first_not_of(" \t\r");
+    if(b == string::npos) {
+        json.clear();
+        return true;
+    }
+    size_t e = line.find_last_not_of(" \t\r");
+    size_t s = line.find_first_of(" \t", b);
+    if(s == string::npos || s > e) {
+        return execute(line.substr(b, e-b+1), "", json);
+    }
+    size_t a = line.find_first_not_of(" \t", s);
+    return execute(line.substr(b, s-b), line.substr(a, e-a+1), json);
+}
+
+bool CliCommandProcessor::execute(const string& command, const string& argument, string& json)
+{
+    json.assign("{\"command\":");
+    toJsonString(command, json);
+
+    string result{};
+    bool ok;
+    if(command == "stats") {
+        ok = stats(result);
+    } else if(command == "outlines") {
+        ok = outlines(result);
+    } else if(command == "fts") {
+        ok = fts(argument, FtsSearch::EXACT, result);
+    } else if(command == "fts-ignore-case") {
+        ok = fts(argument, FtsSearch::IGNORE_CASE, result);
+    } else if(command == "fts-regexp") {
+        ok = fts(argument, FtsSearch::REGEXP, result);
+    } else if(command == "tags") {
+        ok = tags(result);
+    } else if(command == "tagged") {
+        ok = tagged(argument, result);
+    } else if(command == "associations") {
+        ok = associations(argument, result);
+    } else if(command == "associate") {
+        ok = associate(argument, result);
+    } else if(command == "backlinks") {
+        ok = backlinks(argument, result);
+    } else if(command == "html") {
+        ok = html(argument, result);
+    } else if(command == "learn") {
+        ok = learn(result);
+    } else if(command == "export-csv") {
+        ok = exportCsv(argument, result);
+    } else if(command == "export-html") {
+        ok = exportHtml(argument, result);
+    } else if(command == "import-twiki") {
+        ok = importTWiki(argument, result);
+    } else {
+        error("Unknown command - see help", result);
+        ok = false;
+    }
+
+    json += ok?",\"ok\":true":",\"ok\":false";
+    json += result;
+    json += "}";
+    return ok;
+}
+
+bool CliCommandProcessor::stats(string& json)
+{
+    json += ",\"outlines\":" + std::to_string(mind.remind().getOutlinesCount());
+    json += ",\"notes\":" + std::to_string(mind.remind().getNotesCount());
+    return true;
+}
+
+bool CliCommandProcessor::outlines(string& json)
+{
+    json += ",\"outlines\":[";
+    bool first = true;
+    for(const Outline* o:mind.remind().getOutlines()) {
+        if(!first) json += ",";
+        first = false;
+        outlineToJson(o, json);
+    }
+    json += "]";
+    return true;
+}
+
+bool CliCommandProcessor::fts(const string& pattern, FtsSearch mode, string& json)
+{
+    if(pattern.empty()) {
+        error("Missing search pattern", json);
+        return false;
+    }
+
+    vector<Note*>* result = mind.findNoteFts(pattern, mode);
+    notesToJson(*result, json);
+    delete result;
+    return true;
+}
+
+bool CliCommandProcessor::tags(string& json)
+{
+    map<const Tag*,int> cardinality{};
+    mind.getTagsCardinality(cardinality);
+
+    json += ",\"tags\":[";
+    bool first = true;
+    for(auto& t:cardinality) {
+        if(!first) json += ",";
+        first = false;
+        json += "{\"name\":";
+        toJsonString(t.first->getName(), json);
+        json += ",\"count\":" + std::to_string(t.second) + "}";
+    }
+    json += "]";
+    return true;
+}
+
+bool CliCommandProcessor::tagged(const string& tagNames, string& json)
+{
+    vector<const Tag*> tags{};
+    bool unknown = false;
+    size_t b = 0;
+    while(b <= tagNames.size()) {
+        size_t e = tagNames.find(',', b);
+        if(e == string::npos) {
+            e = tagNames.size();
+        }
+        string name = tagNames.substr(b, e-b);
+        if(!name.empty()) {
+            // lookup doesn't create tags so that ontology is not changed by queries
+            const Tag* t = mind.remind().getOntology().getTags().get(name);
+            if(t) {
+                tags.push_back(t);
+            } else {
+                unknown = true;
+            }
+        }
+        b = e+1;
+    }
+    if(tags.empty() && !unknown) {
+        error("Missing tags", json);
+        return false;
+    }
+
+    vector<Outline*> outlines{};
+    if(!unknown) {
+        mind.findOutlinesByTags(tags, outlines);
+    }
+    json += ",\"outlines\":[";
+    for(size_t i=0; i<outlines.size(); i++) {
+        if(i) json += ",";
+        outlineToJson(outlines[i], json);
+    }
+    json += "]";
+
+    vector<Note*> notes{};
+    if(!unknown) {
+        mind.findNotesByTags(tags, notes);
+    }
+    notesToJson(notes, json);
+    return true;
+}
+
+bool CliCommandProcessor::findThing(const string& id, Outline*& outline, Note*& note, string& json)
+{
+    uint32_t i = static_cast<uint32_t>(strtoul(id.c_str(), nullptr, 10));
+    note = mind.remind().getThingsIds().getNote(i);
+    outline = note?nullptr:mind.remind().getThingsIds().getOutline(i);
+    if(!note && !outline) {
+        error("Unknown N or O id: " + id, json);
+        return false;
+    }
+    return true;
+}
+
+bool CliCommandProcessor::associations(const string& id, string& json)
+{
+    Outline* o;
+    Note* n;
+    if(!findThing(id, o, n, json)) {
+        return false;
+    }
+
+    vector<pair<Note*,float>> result{};
+    if(!getAssociations(result, o?ResourceType::OUTLINE:ResourceType::NOTE, o, n, "")) {
+        error("Associations are not available", json);
+        return false;
+    }
+
+    associationsToJson(result, json);
+    return true;
+}
+
+bool CliCommandProcessor::associate(const string& words, string& json)
+{
+    if(words.empty()) {
+        error("Missing words", json);
+        return false;
+    }
+
+    vector<pair<Note*,float>> result{};
+    if(!getAssociations(result, ResourceType::WORD, nullptr, nullptr, words)) {
+        error("Associations are not available", json);
+        return false;
+    }
+
+    associationsToJson(result, json);
+    return true;
+}
+
+bool CliCommandProcessor::backlinks(const string& id, string& json)
+{
+    Outline* o;
+    Note* n;
+    if(!findThing(id, o, n, json)) {
+        return false;
+    }
+
+    vector<Note*>* referees = o?mind.getRefereeNotes(*o):mind.getRefereeNotes(*n);
+    notesToJson(*referees, json);
+    delete referees;
+    return true;
+}
+
+bool CliCommandProcessor::html(const string& id, string& json)
+{
+    Outline* o;
+    Note* n;
+    if(!findThing(id, o, n, json)) {
+        return false;
+    }
+
+    // representation is not shared - requests may be rendered concurrently
+    HtmlOutlineRepresentation representation{mind.remind().getOntology(), nullptr};
+    string html{};
+    if(o) {
+        representation.to(o, &html, false, false, true, true);
+    } else {
+        representation.to(n, &html);
+    }
+    json += ",\"html\":";
+    toJsonString(html, json);
+    return true;
+}
+
+bool CliCommandProcessor::learn(string& json)
+{
+    mind.learn();
+    // learning stops thinking
+    thinking = false;
+    return stats(json);
+}
+
+bool CliCommandProcessor::exportCsv(const string& file, string& json)
+{
+    if(file.empty()) {
+        error("Missing CSV file", json);
+        return false;
+    }
+
+    mind.exportToCsv(file);
+    FILE* f = fopen(file.c_str(), "r");
+    if(!f) {
+        error("Unable to write CSV file: " + file, json);
+        return false;
+    }
+    fclose(f);
+
+    json += ",\"file\":";
+    toJsonString(file, json);
+    return true;
+}
+
+bool CliCommandProcessor::exportHtml(const string& directory, string& json)
+{
+    if(directory.empty()) {
+        error("Missing HTML site directory", json);
+        return false;
+    }
+
+    try {
+        HtmlSiteExporter::Stats stats = mind.remind().exportToHtmlSite(directory);
+        json += ",\"exported\":" + std::to_string(stats.exported);
+        json += ",\"skipped\":" + std::to_string(stats.skipped);
+        json += ",\"removed\":" + std::to_string(stats.removed);
+        json += ",\"failed\":" + std::to_string(stats.failed);
+        return !stats.failed;
+    } catch(MindForgerException& e) {
+        error(e.what(), json);
+        return false;
+    }
+}
+
+bool CliCommandProcessor::importTWiki(const string& file, string& json)
+{
+    if(file.empty()) {
+        error("Missing TWiki file", json);
+        return false;
+    }
+
+    Outline* o = mind.learnOutlineTWiki(file);
+    // O import re-learns Mind which stops thinking
+    thinking = false;
+    if(!o) {
+        error("Unable to import TWiki file: " + file, json);
+        return false;
+    }
+
+    json += ",\"outline\":";
+    outlineToJson(o, json);
+    return true;
+}
+
+bool CliCommandProcessor::think()
+{
+    lock_guard<mutex> criticalSection{thinkingMutex};
+    if(!thinking) {
+        mind.think().get();
+        thinking = Configuration::getInstance().getMindState()==Configuration::MindState::THINKING;
+    }
+    return thinking;
+}
+
+bool CliCommandProcessor::getAssociations(
+        vector<pair<Note*,float>>& result,
+        ResourceType type,
+        Outline* outline,
+        Note* note,
+        const string& words)
+{
+    if(!think()) {
+        return false;
+    }
+
+    // ASYNC AA doesn't fill associations on the first call - wait and ask again (cached)
+    for(int attempt=0; attempt<2; attempt++) {
+        unique_ptr<AssociatedNotes> associated{};
+        if(type == ResourceType::NOTE) {
+            associated.reset(new AssociatedNotes{type, note});
+        } else if(type == ResourceType::OUTLINE) {
+            associated.reset(new AssociatedNotes{type, outline});
+        } else {
+            associated.reset(new AssociatedNotes{type, words});
+        }
+
+        shared_future<bool> f = mind.getAssociatedNotes(*associated);
+        if(f.valid() && !f.get()) {
+            return false;
+        }
+        if(associated->getAssociations()) {
+            result = *associated->getAssociations();
+            return true;
+        }
+    }
+    return false;
+}
+
+void CliCommandProcessor::error(const string& message, string& json)
+{
+    json += ",\"error\":";
+    toJsonString(message, json);
+}
+
+void CliCommandProcessor::notesToJson(const vector<Note*>& notes, string& json)
+{
+    json += ",\"notes\":[";
+    for(size_t i=0; i<notes.size(); i++) {
+        if(i) json += ",";
+        noteToJson(notes[i], json);
+    }
+    json += "]";
+}
+
+void CliCommandProcessor::associationsToJson(const vector<pair<Note*,float>>& associations, string& json)
+{
+    json += ",\"associations\":[";
+    for(size_t a=0; a<associations.size(); a++) {
+        if(a) json += ",";
+        noteToJson(associations[a].first, json);
+        json.pop_back();
+        json += ",\"score\":" + std::to_string(associations[a].second) + "}";
+    }
+    json += "]";
+}
+
+void CliCommandProcessor::noteToJson(const Note* note, string& json)
+{
+    json += "{\"id\":" + std::to_string(note->getId()) + ",\"name\":";
+    toJsonString(note->getName(), json);
+    json += ",\"outline\":";
+    toJsonString(note->getOutline()->getKey(), json);
+    json += ",\"outlineName\":";
+    toJsonString(note->getOutline()->getName(), json);
+    json += "}";
+}
+
+void CliCommandProcessor::outlineToJson(const Outline* outline, string& json)
+{
+    json += "{\"id\":" + std::to_string(outline->getId()) + ",\"name\":";
+    toJsonString(outline->getName(), json);
+    json += ",\"key\":";
+    toJsonString(outline->getKey(), json);
+    json += ",\"notes\":" + std::to_string(outline->getNotesCount()) + "}";
+}
+
+void CliCommandProcessor::toJsonString(const string& s, string& json)
+{
+    json += '"';
+    for(char c:s) {
+        switch(c) {
+        case '"': json += "\\\""; break;
+        case '\\': json += "\\\\"; break;
+        case '\n': json += "\\n"; break;
+        case '\r': json += "\\r"; break;
+        case '\t': json += "\\t"; break;
+        default:
+            if(static_cast<unsigned char>(c) < 0x20) {
+                char escaped[7];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                json += escaped;
+            } else {
+                json += c;
+            }
+        }
+    }
+    json += '"';
+}
+
+}
@@ -0,0 +1,121 @@
+/*
+ cli_command_processor.h     MindForger command line interface
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_CLI_COMMAND_PROCESSOR_H
+#define M8R_CLI_COMMAND_PROCESSOR_H
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "mind/mind.h"
+
+namespace m8r {
+
+/**
+ * @brief Headless command processor.
+ *
+ * Executes one command (line) against learned Mind and serializes its result
+ * as ONE line of JSON - batch of commands read from stdin therefore gives
+ * JSON Lines output which can be easily consumed by scripts:
+ *
+ *   {"command":"fts","ok":true,"notes":[{"id":7,"name":"...","outline":"...","outlineName":"..."}]}
+ *   {"command":"associations","ok":false,"error":"..."}
+ *
+ * Thinking (AA) is started lazily - on the first associations command.
+ *
+ * Read-only commands (see isReadOnly()) can be executed concurrently once
+ * Mind thinks, the other commands change memory, files or Mind caches and
+ * must be exclusive.
+ */
+class CliCommandProcessor
+{
+public:
+    static void usage(std::ostream& out);
+
+    /**
+     * @brief Can be command executed concurrently w/ other read-only commands?
+     *
+     * Command is read-only if it doesn't modify Mind at all - incl. Ns, caches and AI state.
+     */
+    static bool isReadOnly(const std::string& command);
+
+    /**
+     * @brief Append string to JSON as (escaped) JSON string.
+     */
+    static void toJsonString(const std::string& s, std::string& json);
+
+private:
+    Mind& mind;
+    // thinking is started by the first command which needs it
+    std::mutex thinkingMutex;
+    std::atomic<bool> thinking;
+
+public:
+    explicit CliCommandProcessor(Mind& mind);
+    CliCommandProcessor(const CliCommandProcessor&) = delete;
+    CliCommandProcessor(const CliCommandProcessor&&) = delete;
+    CliCommandProcessor &operator=(const CliCommandProcessor&) = delete;
+    CliCommandProcessor &operator=(const CliCommandProcessor&&) = delete;
+    ~CliCommandProcessor();
+
+    /**
+     * @brief Execute command w/ argument and write its JSON result to json.
+     *
+     * @return false if command failed.
+     */
+    bool execute(const std::string& command, const std::string& argument, std::string& json);
+
+    /**
+     * @brief Split and execute command line e.g. "fts needle".
+     */
+    bool execute(const std::string& line, std::string& json);
+
+    /**
+     * @brief Start thinking (if not thinking yet) and wait for it.
+     */
+    bool think();
+
+private:
+    bool stats(std::string& json);
+    bool outlines(std::string& json);
+    bool fts(const std::string& pattern, FtsSearch mode, std::string& json);
+    bool tags(std::string& json);
+    bool tagged(const std::string& tagNames, std::string& json);
+    bool associations(const std::string& id, std::string& json);
+    bool associate(const std::string& words, std::string& json);
+    bool backlinks(const std::string& id, std::string& json);
+    bool html(const std::string& id, std::string& json);
+    bool learn(std::string& json);
+    bool exportCsv(const std::string& file, std::string& json);
+    bool exportHtml(const std::string& directory, std::string& json);
+    bool importTWiki(const std::string& file, std::string& json);
+
+    bool findThing(const std::string& id, Outline*& outline, Note*& note, std::string& json);
+    bool getAssociations(std::vector<std::pair<Note*,float>>& result, ResourceType type, Outline* outline, Note* note, const std::string& words);
+
+    static void error(const std::string& message, std::string& json);
+    static void notesToJson(const std::vector<Note*>& notes, std::string& json);
+    static void associationsToJson(const std::vector<std::pair<Note*,float>>& associations, std::string& json);
+    static void noteToJson(const Note* note, std::string& json);
+    static void outlineToJson(const Outline* outline, std::string& json);
+};
+
+}
+#endif // M8R_CLI_COMMAND_PROCESSOR_H
@@ -0,0 +1,433 @@
+/*
+ cli_server.cpp     MindForger command line interface
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "cli_server.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace m8r {
+
+using namespace std;
+
+constexpr int CliServer::LISTEN_BACKLOG;
+constexpr int CliServer::POLL_TIMEOUT_MS;
+constexpr size_t CliServer::MAX_FRAME_SIZE;
+
+CliServer::Connection::~Connection()
+{
+    close(fd);
+}
+
+bool CliServer::Connection::write(const string& frame)
+{
+    lock_guard<mutex> criticalSection{writeMutex};
+
+    string f{frame};
+    f += '\n';
+    size_t written = 0;
+    while(written < f.size()) {
+        ssize_t w = send(fd, f.data()+written, f.size()-written, MSG_NOSIGNAL);
+        if(w < 0) {
+            if(errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += static_cast<size_t>(w);
+    }
+    return true;
+}
+
+CliServer::CliServer(CliCommandProcessor& processor, const string& socketPath, unsigned threads)
+    : processor{processor},
+      socketPath{socketPath},
+      threads{threads?threads:thread::hardware_concurrency()},
+      running{false},
+      requestsMutex{},
+      requestsAvailable{},
+      requests{},
+      workers{},
+      gateMutex{},
+      gateChanged{},
+      readers{0},
+      waitingWriters{0},
+      writer{false}
+{
+    if(!this->threads) {
+        this->threads = 1;
+    }
+}
+
+CliServer::~CliServer()
+{
+}
+
+bool CliServer::serve()
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if(socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        cerr << "Invalid socket path: " << socketPath << endl;
+        return false;
+    }
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path)-1);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(listener < 0) {
+        cerr << "Unable to create socket: " << strerror(errno) << endl;
+        return false;
+    }
+    // stale socket of previous (killed) server
+    unlink(socketPath.c_str());
+    if(bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0
+       || listen(listener, LISTEN_BACKLOG) < 0)
+    {
+        cerr << "Unable to listen on socket " << socketPath << ": " << strerror(errno) << endl;
+        close(listener);
+        return false;
+    }
+
+    running = true;
+    for(unsigned i=0; i<threads; i++) {
+        workers.push_back(thread{&CliServer::worker, this});
+    }
+    MF_DEBUG("Serving " << socketPath << " w/ " << threads << " workers" << endl);
+
+    map<int,shared_ptr<Connection>> connections{};
+    vector<pollfd> fds{};
+    while(running) {
+        fds.clear();
+        fds.push_back(pollfd{listener, POLLIN, 0});
+        for(auto& c:connections) {
+            fds.push_back(pollfd{c.first, POLLIN, 0});
+        }
+
+        // timeout to notice stop() w/o a wake up pipe
+        int events = poll(fds.data(), fds.size(), POLL_TIMEOUT_MS);
+        if(events <= 0) {
+            if(events < 0 && errno != EINTR) {
+                cerr << "Unable to poll sockets: " << strerror(errno) << endl;
+                running = false;
+            }
+            continue;
+        }
+
+        if(fds[0].revents & POLLIN) {
+            int fd = accept(listener, nullptr, nullptr);
+            if(fd >= 0) {
+                connections[fd] = make_shared<Connection>(fd);
+            }
+        }
+        for(size_t i=1; i<fds.size(); i++) {
+            if(fds[i].revents) {
+                read(connections, fds[i].fd);
+            }
+        }
+    }
+
+    {
+        lock_guard<mutex> criticalSection{requestsMutex};
+        requests.clear();
+    }
+    requestsAvailable.notify_all();
+    for(thread& w:workers) {
+        w.join();
+    }
+    workers.clear();
+
+    connections.clear();
+    close(listener);
+    unlink(socketPath.c_str());
+    return true;
+}
+
+void CliServer::read(map<int,shared_ptr<Connection>>& connections, int fd)
+{
+    shared_ptr<Connection> c = connections[fd];
+
+    char chunk[4096];
+    ssize_t r = recv(fd, chunk, sizeof(chunk), 0);
+    if(r <= 0) {
+        if(r < 0 && errno == EINTR) {
+            return;
+        }
+        // connection is closed once its pending requests are served
+        connections.erase(fd);
+        return;
+    }
+    c->buffer.append(chunk, static_cast<size_t>(r));
+
+    size_t b = 0, e;
+    while((e = c->buffer.find('\n', b)) != string::npos) {
+        if(e > b) {
+            lock_guard<mutex> criticalSection{requestsMutex};
+            requests.push_back(Request{c, c->buffer.substr(b, e-b)});
+            requestsAvailable.notify_one();
+        }
+        b = e+1;
+    }
+    c->buffer.erase(0, b);
+    if(c->buffer.size() > MAX_FRAME_SIZE) {
+        c->write("{\"ok\":false,\"error\":\"Request frame too big\"}");
+        connections.erase(fd);
+    }
+}
+
+void CliServer::worker()
+{
+    while(true) {
+        Request request{};
+        {
+            unique_lock<mutex> criticalSection{requestsMutex};
+            requestsAvailable.wait(criticalSection, [this]{ return !running || !requests.empty(); });
+            if(!running) {
+                return;
+            }
+            request = std::move(requests.front());
+            requests.pop_front();
+        }
+        execute(request);
+    }
+}
+
+void CliServer::execute(Request& request)
+{
+    string id{}, command{}, argument{}, json{};
+    if(!parseRequest(request.frame, id, command, argument)) {
+        json.assign("{\"ok\":false,\"error\":\"Malformed request\"}");
+        if(!id.empty()) {
+            json.replace(0, 1, "{\"id\":" + id + ",");
+        }
+        request.connection->write(json);
+        return;
+    }
+
+    if(command == "shutdown") {
+        lockExclusive();
+        json.assign("{\"command\":\"shutdown\",\"ok\":true}");
+        stop();
+        unlockExclusive();
+    } else if(CliCommandProcessor::isReadOnly(command)) {
+        lockShared();
+        processor.execute(command, argument, json);
+        unlockShared();
+    } else {
+        lockExclusive();
+        processor.execute(command, argument, json);
+        // get warm again before readers are let in
+        processor.think();
+        unlockExclusive();
+    }
+
+    if(!id.empty()) {
+        json.replace(0, 1, "{\"id\":" + id + ",");
+    }
+    request.connection->write(json);
+}
+
+void CliServer::lockShared()
+{
+    unique_lock<mutex> criticalSection{gateMutex};
+    gateChanged.wait(criticalSection, [this]{ return !writer && !waitingWriters; });
+    readers++;
+}
+
+void CliServer::unlockShared()
+{
+    lock_guard<mutex> criticalSection{gateMutex};
+    if(!--readers) {
+        gateChanged.notify_all();
+    }
+}
+
+void CliServer::lockExclusive()
+{
+    unique_lock<mutex> criticalSection{gateMutex};
+    waitingWriters++;
+    gateChanged.wait(criticalSection, [this]{ return !writer && !readers; });
+    waitingWriters--;
+    writer = true;
+}
+
+void CliServer::unlockExclusive()
+{
+    lock_guard<mutex> criticalSection{gateMutex};
+    writer = false;
+    gateChanged.notify_all();
+}
+
+bool CliServer::isJsonNumber(const string& s)
+{
+    // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+    size_t i = 0;
+    auto digits = [&s, &i]() {
+        size_t b = i;
+        while(i < s.size() && s[i] >= '0' && s[i] <= '9') i++;
+        return i > b;
+    };
+    if(i < s.size() && s[i] == '-') {
+        i++;
+    }
+    if(i < s.size() && s[i] == '0') {
+        i++;
+    } else if(!digits()) {
+        return false;
+    }
+    if(i < s.size() && s[i] == '.') {
+        i++;
+        if(!digits()) {
+            return false;
+        }
+    }
+    if(i < s.size() && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if(i < s.size() && (s[i] == '+' || s[i] == '-')) {
+            i++;
+        }
+        if(!digits()) {
+            return false;
+        }
+    }
+    return i == s.size();
+}
+
+bool CliServer::parseRequest(const string& frame, string& id, string& command, string& argument)
+{
+    size_t i = 0;
+    auto skipSpaces = [&frame, &i]() {
+        while(i < frame.size() && (frame[i]==' ' || frame[i]=='\t' || frame[i]=='\r')) i++;
+    };
+    auto parseString = [&frame, &i](string& s) {
+        if(i >= frame.size() || frame[i] != '"') {
+            return false;
+        }
+        for(i++; i < frame.size(); i++) {
+            char c = frame[i];
+            if(c == '"') {
+                i++;
+                return true;
+            }
+            if(c == '\\') {
+                if(++i >= frame.size()) {
+                    return false;
+                }
+                switch(frame[i]) {
+                case 'n': s += '\n'; break;
+                case 't': s += '\t'; break;
+                case 'r': s += '\r'; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'u': {
+                    if(i+4 >= frame.size()) {
+                        return false;
+                    }
+                    unsigned long u = strtoul(frame.substr(i+1, 4).c_str(), nullptr, 16);
+                    // BMP code point to UTF-8
+                    if(u < 0x80) {
+                        s += static_cast<char>(u);
+                    } else if(u < 0x800) {
+                        s += static_cast<char>(0xC0 | (u >> 6));
+                        s += static_cast<char>(0x80 | (u & 0x3F));
+                    } else {
+                        s += static_cast<char>(0xE0 | (u >> 12));
+                        s += static_cast<char>(0x80 | ((u >> 6) & 0x3F));
+                        s += static_cast<char>(0x80 | (u & 0x3F));
+                    }
+                    i += 4;
+                    break;
+                }
+                default: s += frame[i];
+                }
+            } else {
+                s += c;
+            }
+        }
+        return false;
+    };
+
+    skipSpaces();
+    if(i >= frame.size() || frame[i++] != '{') {
+        return false;
+    }
+    skipSpaces();
+    if(i < frame.size() && frame[i] == '}') {
+        return false;
+    }
+    while(i < frame.size()) {
+        string key{};
+        skipSpaces();
+        if(!parseString(key)) {
+            return false;
+        }
+        skipSpaces();
+        if(i >= frame.size() || frame[i++] != ':') {
+            return false;
+        }
+        skipSpaces();
+
+        string value{};
+        size_t b = i;
+        if(i < frame.size() && frame[i] == '"') {
+            if(!parseString(value)) {
+                return false;
+            }
+        } else {
+            // number, true, false or null
+            while(i < frame.size() && frame[i] != ',' && frame[i] != '}' && frame[i] != ' ') i++;
+            value = frame.substr(b, i-b);
+            if(value.empty()) {
+                return false;
+            }
+        }
+        if(key == "id") {
+            id.clear();
+            if(frame[b] == '"') {
+                // string is escaped again - client's escaping might not be valid JSON
+                CliCommandProcessor::toJsonString(value, id);
+            } else if(isJsonNumber(value)) {
+                id = value;
+            } else {
+                return false;
+            }
+        } else if(key == "command") {
+            command = value;
+        } else if(key == "argument") {
+            argument = value;
+        }
+
+        skipSpaces();
+        if(i < frame.size() && frame[i] == ',') {
+            i++;
+        } else if(i < frame.size() && frame[i] == '}') {
+            return !command.empty();
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+}
@@ -0,0 +1,154 @@
+/*
+ cli_server.h     MindForger command line interface
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_CLI_SERVER_H
+#define M8R_CLI_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cli_command_processor.h"
+
+namespace m8r {
+
+/**
+ * @brief Query server which keeps learned and thinking Mind resident.
+ *
+ * Clients connect to Unix domain socket and send requests as frames - one JSON
+ * object per line (JSON strings have new lines escaped, therefore new line
+ * delimits frame):
+ *
+ *   {"id":1,"command":"fts","argument":"needle"}
+ *
+ * Response frame is the command result (see CliCommandProcessor) w/ request id
+ * - responses of pipelined requests may come in different order:
+ *
+ *   {"id":1,"command":"fts","ok":true,"notes":[...]}
+ *
+ * Requests are executed by a pool of workers. Read-only commands (FTS,
+ * associations, HTML, ...) run concurrently, commands which change memory
+ * (learn, import, ...) wait until running requests finish and run
+ * exclusively - every request works w/ consistent Mind. Server stops on shutdown request or stop().
+ */
+class CliServer
+{
+public:
+    static constexpr int LISTEN_BACKLOG = 16;
+    static constexpr int POLL_TIMEOUT_MS = 250;
+    static constexpr size_t MAX_FRAME_SIZE = 1<<20;
+
+private:
+    /**
+     * @brief Client connection - closed once there are no pending requests.
+     */
+    class Connection
+    {
+    private:
+        int fd;
+        std::mutex writeMutex;
+
+    public:
+        std::string buffer;
+
+        explicit Connection(int fd) : fd{fd}, writeMutex{}, buffer{} {}
+        Connection(const Connection&) = delete;
+        Connection(const Connection&&) = delete;
+        Connection &operator=(const Connection&) = delete;
+        Connection &operator=(const Connection&&) = delete;
+        ~Connection();
+
+        int getFd() const { return fd; }
+        bool write(const std::string& frame);
+    };
+
+    struct Request {
+        std::shared_ptr<Connection> connection;
+        std::string frame;
+    };
+
+    CliCommandProcessor& processor;
+    std::string socketPath;
+    unsigned threads;
+
+    std::atomic<bool> running;
+
+    std::mutex requestsMutex;
+    std::condition_variable requestsAvailable;
+    std::deque<Request> requests;
+    std::vector<std::thread> workers;
+
+    // read-only requests share Mind, other requests are exclusive (writers are preferred)
+    std::mutex gateMutex;
+    std::condition_variable gateChanged;
+    unsigned readers;
+    unsigned waitingWriters;
+    bool writer;
+
+public:
+    explicit CliServer(CliCommandProcessor& processor, const std::string& socketPath, unsigned threads=0);
+    CliServer(const CliServer&) = delete;
+    CliServer(const CliServer&&) = delete;
+    CliServer &operator=(const CliServer&) = delete;
+    CliServer &operator=(const CliServer&&) = delete;
+    ~CliServer();
+
+    /**
+     * @brief Serve requests until stopped.
+     *
+     * @return false if socket cannot be opened.
+     */
+    bool serve();
+
+    /**
+     * @brief Stop serving (lock-free - can be called from signal handler).
+     */
+    void stop() { running.store(false); }
+
+    /**
+     * @brief Parse request frame - flat JSON object w/ string and number values.
+     *
+     * @param id JSON value of request id (number or string) - echoed in response,
+     *           set even if the rest of the frame is malformed.
+     */
+    static bool parseRequest(const std::string& frame, std::string& id, std::string& command, std::string& argument);
+
+    /**
+     * @brief Is string valid JSON number?
+     */
+    static bool isJsonNumber(const std::string& s);
+
+private:
+    void read(std::map<int,std::shared_ptr<Connection>>& connections, int fd);
+    void worker();
+    void execute(Request& request);
+
+    void lockShared();
+    void unlockShared();
+    void lockExclusive();
+    void unlockExclusive();
+};
+
+}
+#endif // M8R_CLI_SERVER_H
@@ -0,0 +1,248 @@
+/*
+ mindforger_cli.cpp     MindForger command line interface
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include "cli_command_processor.h"
+#include "cli_server.h"
+
+#include "version.h"
+#include "config/configuration.h"
+#include "gear/tracer.h"
+#include "mind/mind.h"
+#include "representations/markdown/markdown_configuration_representation.h"
+
+using namespace std;
+using namespace m8r;
+
+static CliServer* server = nullptr;
+
+static void stopServer(int signal)
+{
+    (void)signal;
+    if(server) {
+        server->stop();
+    }
+}
+
+/**
+ * @brief Tracing enabled for the lifetime of the object, trace is exported on destruction.
+ */
+class TraceExport
+{
+private:
+    const string fileName;
+
+public:
+    explicit TraceExport(const string& fileName)
+        : fileName{fileName}
+    {
+        if(!fileName.empty()) {
+            Tracer::getInstance().setEnabled(true);
+        }
+    }
+    TraceExport(const TraceExport&) = delete;
+    TraceExport(const TraceExport&&) = delete;
+    TraceExport &operator=(const TraceExport&) = delete;
+    TraceExport &operator=(const TraceExport&&) = delete;
+    ~TraceExport() {
+        if(!fileName.empty()) {
+            Tracer::getInstance().setEnabled(false);
+            if(!Tracer::getInstance().exportTo(fileName)) {
+                cerr << "Unable to write trace to: " << fileName << endl;
+            }
+        }
+    }
+};
+
+static void usage()
+{
+    cout << "MindForger command line interface " << MINDFORGER_VERSION << endl
+         << endl
+         << "Usage: mindforger-cli [options] <repository> [<command> [<argument>]]" << endl
+         << "       mindforger-cli [options] --server <socket> <repository>" << endl
+         << endl
+         << "Learns repository (directory or Markdown file), executes command and prints" << endl
+         << "its result as JSON. If no command is given, then commands are read from stdin" << endl
+         << "(one per line) and results are printed as JSON Lines - repository is learned" << endl
+         << "just once for the whole batch." << endl
+         << endl
+         << "Server mode keeps learned and thinking repository in memory and serves" << endl
+         << "requests sent to Unix domain socket - one JSON object per line both ways:" << endl
+         << "  {\"id\":1,\"command\":\"fts\",\"argument\":\"needle\"}" << endl
+         << "Read-only requests (all but learn, export-* and import-*) are served" << endl
+         << "concurrently, request \"shutdown\" stops server." << endl
+         << endl
+         << "Options:" << endl
+         << "  -c, --config-file-path <file>  configuration to use (default ~/" << FILENAME_M8R_CONFIGURATION << ")" << endl
+         << "  -s, --server <socket>          serve requests on Unix domain socket" << endl
+         << "  -t, --threads <n>              server workers (default number of cores)" << endl
+         << "  -T, --trace <file>             write Chrome trace (chrome://tracing) to file" << endl
+         << "                                 and span histograms to <file>.txt on exit" << endl
+         << "  -h, --help                     this help" << endl
+         << "  -V, --version                  version" << endl
+         << endl;
+    CliCommandProcessor::usage(cout);
+    cout << endl
+         << "Exit code is 1 if any command fails." << endl;
+}
+
+int main(int argc, char** argv)
+{
+    string configFilePath{};
+    string socketPath{};
+    unsigned threads = 0;
+    string traceFilePath{};
+    string repositoryPath{};
+    string command{};
+    string argument{};
+
+    int i=1;
+    for(; i<argc; i++) {
+        string option{argv[i]};
+        if(option == "-h" || option == "--help") {
+            usage();
+            return 0;
+        } else if(option == "-V" || option == "--version") {
+            cout << MINDFORGER_VERSION << endl;
+            return 0;
+        } else if(option == "-c" || option == "--config-file-path"
+                  || option == "-s" || option == "--server"
+                  || option == "-t" || option == "--threads"
+                  || option == "-T" || option == "--trace")
+        {
+            if(i+1 >= argc) {
+                cerr << "Missing value of option: " << option << endl;
+                return 1;
+            }
+            const char* value = argv[++i];
+            if(option == "-c" || option == "--config-file-path") {
+                configFilePath = value;
+            } else if(option == "-s" || option == "--server") {
+                socketPath = value;
+            } else if(option == "-T" || option == "--trace") {
+                traceFilePath = value;
+            } else {
+                threads = static_cast<unsigned>(atoi(value));
+            }
+        } else if(option.size() > 1 && option[0] == '-') {
+            cerr << "Unknown option: " << option << endl;
+            usage();
+            return 1;
+        } else {
+            break;
+        }
+    }
+    if(i >= argc) {
+        cerr << "Missing repository" << endl;
+        usage();
+        return 1;
+    }
+    repositoryPath = argv[i++];
+    if(i < argc) {
+        command = argv[i++];
+        for(; i<argc; i++) {
+            if(!argument.empty()) argument += " ";
+            argument += argv[i];
+        }
+    }
+
+    /*
+     * Configuration
+     */
+
+    Configuration& config = Configuration::getInstance();
+    config.clear();
+    if(!configFilePath.empty()) {
+        config.setConfigFilePath(configFilePath);
+    }
+    MarkdownConfigurationRepresentation mdConfigRepresentation{};
+    mdConfigRepresentation.load(config);
+    // headless runs must not overwrite configuration of GUI (active repository, mind state)
+    config.setPersistent(false);
+
+    Repository* repository = RepositoryIndexer::getRepositoryForPath(repositoryPath);
+    if(!repository) {
+        cerr << "Not a MindForger repository or Markdown file: " << repositoryPath << endl;
+        return 1;
+    }
+    config.setActiveRepository(config.addRepository(repository));
+    config.setMindState(Configuration::MindState::SLEEPING);
+    if(!socketPath.empty()) {
+        if(!command.empty()) {
+            cerr << "Server doesn't execute command given on the command line: " << command << endl;
+            return 1;
+        }
+        // server keeps whole memory warm - lazy loading of O bodies would change shared Mind
+        config.setMemoryBudget(0);
+    }
+
+    /*
+     * Mind
+     */
+
+    TraceExport traceExport{traceFilePath};
+    unique_ptr<Mind> mind{new Mind{config}};
+    // learning reuses repository caches (AA model, HTML site export manifest, ...)
+    mind->learn();
+    CliCommandProcessor processor{*mind};
+
+    if(!socketPath.empty()) {
+        processor.think();
+        CliServer cliServer{processor, socketPath, threads};
+        server = &cliServer;
+        signal(SIGINT, stopServer);
+        signal(SIGTERM, stopServer);
+        bool ok = cliServer.serve();
+        server = nullptr;
+        return ok?0:1;
+    }
+
+    string json{};
+    if(!command.empty()) {
+        if(command == "help") {
+            CliCommandProcessor::usage(cout);
+            return 0;
+        }
+        bool ok = processor.execute(command, argument, json);
+        cout << json << endl;
+        return ok?0:1;
+    }
+
+    bool ok = true;
+    string line{};
+    while(getline(cin, line)) {
+        if(line == "quit") {
+            break;
+        } else if(line == "help") {
+            CliCommandProcessor::usage(cerr);
+            continue;
+        }
+        ok = processor.execute(line, json) && ok;
+        if(!json.empty()) {
+            // flush so that a pipe consumer gets result before sending next command
+            cout << json << endl;
+        }
+    }
+    return ok?0:1;
+}
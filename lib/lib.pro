@@ -76,15 +76,23 @@ SOURCES += \
     ./src/gear/datetime_utils.cpp \
     ./src/gear/file_utils.cpp \
     ./src/gear/string_utils.cpp \
+    ./src/gear/tracer.cpp \
+    ./src/gear/fuzzy_finder.cpp \
+    ./src/gear/directory_scanner.cpp \
+    ./src/gear/cancellation_token.cpp \
+    ./src/gear/text_arena.cpp \
     ./src/mind/ontology/ontology.cpp \
     ./src/model/note_type.cpp \
     ./src/model/note.cpp \
     ./src/model/outline_type.cpp \
     ./src/model/outline.cpp \
+    ./src/model/notes_tree_index.cpp \
+    ./src/model/notes_metadata.cpp \
     ./src/model/stencil.cpp \
     ./src/model/tag.cpp \
     ./src/persistence/filesystem_persistence.cpp \
     ./src/representations/html/html_outline_representation.cpp \
+    ./src/representations/html/html_site_exporter.cpp \
     ./src/representations/markdown/markdown_ast_node.cpp \
     ./src/representations/markdown/markdown_lexem.cpp \
     ./src/representations/markdown/markdown_lexer_sections.cpp \
@@ -96,6 +104,7 @@ SOURCES += \
     ./src/representations/outline_representation.cpp \
     ./src/mind/galaxy.cpp \
     ./src/mind/memory_dwell.cpp \
+    ./src/mind/things_id_index.cpp \
     ./src/mind/memory.cpp \
     ./src/mind/mind.cpp \
     ./src/mind/working_memory.cpp \
@@ -122,6 +131,7 @@ SOURCES += \
     src/mind/ai/nlp/word_frequency_list.cpp \
     src/gear/trie.cpp \
     src/mind/ai/nlp/stemmer/stemmer.cpp \
+    src/mind/ai/nlp/stem_cache.cpp \
     src/mind/ai/ai_aa_bow.cpp \
     src/mind/ai/ai_aa_weighted_fts.cpp \
     src/mind/ai/aa_notes_feature.cpp \
@@ -137,7 +147,8 @@ SOURCES += \
     src/representations/markdown/cmark_gfm_markdown_transcoder.cpp \
     src/mind/ai/autolinking/autolinking_mind.cpp \
     src/mind/ai/autolinking/cmark_aho_corasick_block_autolinking_preprocessor.cpp \
-    src/mind/limbo.cpp
+    src/mind/limbo.cpp \
+    src/mind/completion_index.cpp
 
 mfner {
     SOURCES += \
@@ -161,18 +172,26 @@ HEADERS += \
     ./src/gear/hash_map.h \
     ./src/gear/lang_utils.h \
     ./src/gear/string_utils.h \
+    ./src/gear/tracer.h \
+    ./src/gear/fuzzy_finder.h \
+    ./src/gear/directory_scanner.h \
+    ./src/gear/cancellation_token.h \
+    ./src/gear/text_arena.h \
     ./src/mind/ontology/ontology_vocabulary.h \
     ./src/mind/ontology/ontology.h \
     ./src/model/note_type.h \
     ./src/model/note.h \
     ./src/model/outline_type.h \
     ./src/model/outline.h \
+    ./src/model/notes_tree_index.h \
+    ./src/model/notes_metadata.h \
     ./src/model/resource_types.h \
     ./src/model/stencil.h \
     ./src/model/tag.h \
     ./src/persistence/filesystem_persistence.h \
     ./src/persistence/persistence.h \
     ./src/representations/html/html_outline_representation.h \
+    ./src/representations/html/html_site_exporter.h \
     ./src/representations/markdown/markdown_ast_node.h \
     ./src/representations/markdown/markdown_lexem.h \
     ./src/representations/markdown/markdown_lexer_sections.h \
@@ -185,6 +204,7 @@ HEADERS += \
     ./src/representations/outline_representation.h \
     ./src/mind/galaxy.h \
     ./src/mind/memory_dwell.h \
+    ./src/mind/things_id_index.h \
     ./src/mind/memory.h \
     ./src/mind/mind.h \
     ./src/mind/working_memory.h \
@@ -217,6 +237,7 @@ HEADERS += \
     src/gear/trie.h \
     src/mind/ai/nlp/char_provider.h \
     src/mind/ai/nlp/stemmer/stemmer.h \
+    src/mind/ai/nlp/stem_cache.h \
     src/mind/ai/nlp/stemmer/stemming/danish_stem.h \
     src/mind/ai/nlp/stemmer/stemming/dutch_stem.h \
     src/mind/ai/nlp/stemmer/stemming/english_stem.h \
@@ -257,7 +278,9 @@ HEADERS += \
     src/representations/markdown/cmark_gfm_markdown_transcoder.h \
     src/mind/ai/autolinking/autolinking_mind.h \
     src/mind/ai/autolinking/cmark_aho_corasick_block_autolinking_preprocessor.h \
-    src/mind/limbo.h
+    src/mind/limbo.h \
+    src/gear/prefix_index.h \
+    src/mind/completion_index.h
 
 mfner {
     HEADERS += \
@@ -39,6 +39,7 @@ const string Configuration::DEFAULT_TIME_SCOPE = string{"0y0m0d0h0m"};
 
 Configuration::Configuration()
     : asyncMindThreshold{},
+      persistent{true},
       activeRepository{},
       repositories{},
       writeMetadata{},
@@ -48,6 +49,7 @@ Configuration::Configuration()
       autolinkingCaseInsensitive{},
       md2HtmlOptions{},
       distributorSleepInterval{},
+      memoryBudget{},
       markdownQuoteSections{},
       uiNerdTargetAudience{},
       uiHtmlZoom{},
@@ -125,6 +127,7 @@ void Configuration::clear()
     repositories.clear();
 
     // lib
+    persistent = true;
     mindState = MindState::SLEEPING;
     writeMetadata = true;
     saveReadsMetadata = DEFAULT_SAVE_READS_METADATA;
@@ -153,6 +156,7 @@ void Configuration::clear()
     }
 
     distributorSleepInterval = DEFAULT_DISTRIBUTOR_SLEEP_INTERVAL;
+    memoryBudget = DEFAULT_MEMORY_BUDGET;
 
     // GUI
     uiNerdTargetAudience = false;
@@ -225,6 +229,8 @@ void Configuration::setActiveRepository(Repository* repository)
             limboPath.clear();
             limboPath += activeRepository->getDir();
 
+            mindPath.clear();
+
             if(repository->getType()==Repository::RepositoryType::MINDFORGER
                  &&
                repository->getMode()==Repository::RepositoryMode::REPOSITORY)
@@ -235,6 +241,10 @@ void Configuration::setActiveRepository(Repository* repository)
                 // TODO limbo class
                 limboPath+=FILE_PATH_SEPARATOR;
                 limboPath+=FILE_PATH_LIMBO;
+
+                mindPath += activeRepository->getDir();
+                mindPath+=FILE_PATH_SEPARATOR;
+                mindPath+=FILE_PATH_MIND;
             }
         } else {
             throw MindForgerException{"Active repository must be one of repositories known to Configuration!"};
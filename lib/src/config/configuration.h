@@ -48,8 +48,13 @@ constexpr const auto DIRNAME_M8R_REPOSITORY = "mindforger-repository";
 constexpr const auto FILE_PATH_M8R_REPOSITORY = "~/mindforger-repository";
 
 constexpr const auto FILENAME_M8R_CONFIGURATION = ".mindforger.md";
+constexpr const auto FILENAME_HTML_EXPORT_MANIFEST = ".mindforger-export";
+constexpr const auto FILENAME_THINGS_IDS = ".mindforger-ids";
+// ids of Markdown repositories are kept in user's configuration directory (file per repository)
+constexpr const auto DIRNAME_THINGS_IDS = ".mindforger-ids";
 constexpr const auto FILE_PATH_MEMORY = "memory";
 constexpr const auto FILE_PATH_MIND = "mind";
+constexpr const auto FILENAME_MIND_AA_NN_MODEL = "associations.genann";
 constexpr const auto FILE_PATH_LIMBO = "limbo";
 constexpr const auto FILE_PATH_STENCILS = "stencils";
 constexpr const auto FILE_PATH_OUTLINES = "notebooks";
@@ -150,6 +155,8 @@ public:
     static constexpr const int DEFAULT_ASYNC_MIND_THRESHOLD_BOW = 200;
     static constexpr const int DEFAULT_ASYNC_MIND_THRESHOLD_WEIGHTED_FTS = 10000;
     static constexpr const int DEFAULT_DISTRIBUTOR_SLEEP_INTERVAL = 500;
+    // MB of O bodies kept in memory, 0 for all bodies (no lazy loading)
+    static constexpr const unsigned DEFAULT_MEMORY_BUDGET = 0;
 
     static const std::string DEFAULT_ACTIVE_REPOSITORY_PATH;
     static const std::string DEFAULT_TIME_SCOPE;
@@ -185,6 +192,7 @@ public:
     static constexpr const bool DEFAULT_OS_TABLE_SORT_ORDER = false;
 
     static constexpr int EDITOR_MAX_AUTOCOMPLETE_LINES = 1000;
+    static constexpr int EDITOR_MAX_AUTOCOMPLETE_RESULTS = 50;
 
 private:
     explicit Configuration();
@@ -201,6 +209,8 @@ private:
     // Some platforms, e.g. Windows, distinquishes user home and user documents
     std::string userDocPath;
     std::string configFilePath;
+    // configuration is not saved if false e.g. headless runs must not overwrite GUI configuration
+    bool persistent;
 
     Repository* activeRepository;
     std::map<const std::string, Repository*> repositories;
@@ -208,6 +218,7 @@ private:
     // active repository memory, limbo, ... paths (efficiency)
     std::string memoryPath;
     std::string limboPath;
+    std::string mindPath;
 
     // lib configuration
     bool writeMetadata; // write metadata to MD - enabled in case of MINDFORGER_REPO only by default (can be disabled for all repository types)
@@ -221,6 +232,7 @@ private:
     unsigned int md2HtmlOptions;
     AssociationAssessmentAlgorithm aaAlgorithm;
     int distributorSleepInterval;
+    unsigned memoryBudget;
     bool markdownQuoteSections;
 
     // GUI configuration
@@ -272,8 +284,14 @@ public:
 
     std::string& getConfigFilePath() { return configFilePath; }
     void setConfigFilePath(const std::string customConfigFilePath) { configFilePath = customConfigFilePath; }
+    bool isPersistent() const { return persistent; }
+    void setPersistent(bool persistent) { this->persistent = persistent; }
     const std::string& getMemoryPath() const { return memoryPath; }
     const std::string& getLimboPath() const { return limboPath; }
+    /**
+     * @brief Mind directory w/ AI models (empty if repository is not MindForger repository).
+     */
+    const std::string& getMindPath() const { return mindPath; }
     const char* getRepositoryPathFromEnv();
     /**
      * @brief Create empty Markdown file.
@@ -326,6 +344,8 @@ public:
     void setAaAlgorithm(AssociationAssessmentAlgorithm aaa) { aaAlgorithm = aaa; }
     int getDistributorSleepInterval() const { return distributorSleepInterval; }
     void setDistributorSleepInterval(int sleepInterval) { distributorSleepInterval = sleepInterval; }
+    unsigned getMemoryBudget() const { return memoryBudget; }
+    void setMemoryBudget(unsigned megabytes) { memoryBudget = megabytes; }
     bool isMarkdownQuoteSections() const { return markdownQuoteSections; }
     void setMarkdownQuoteSections(bool markdownQuoteSections) { this->markdownQuoteSections = markdownQuoteSections; }
 
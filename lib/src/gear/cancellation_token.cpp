@@ -0,0 +1,63 @@
+/*
+ cancellation_token.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "cancellation_token.h"
+
+namespace m8r {
+
+using namespace std;
+
+CancellationToken::CancellationToken(const CancellationToken* parent)
+    : parent{parent},
+      cancelled{false},
+      deadline{0}
+{
+}
+
+CancellationToken::~CancellationToken()
+{
+}
+
+void CancellationToken::setDeadline(chrono::milliseconds timeout)
+{
+    Clock::rep d = (Clock::now() + timeout).time_since_epoch().count();
+    // 0 is reserved for no deadline
+    deadline.store(d ? d : 1, memory_order_release);
+}
+
+void CancellationToken::reset()
+{
+    cancelled.store(false, memory_order_release);
+    deadline.store(0, memory_order_release);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    if(cancelled.load(memory_order_acquire)) {
+        return true;
+    }
+
+    Clock::rep d = deadline.load(memory_order_acquire);
+    if(d && Clock::now().time_since_epoch().count() >= d) {
+        return true;
+    }
+
+    return parent && parent->isCancelled();
+}
+
+}
@@ -0,0 +1,73 @@
+/*
+ cancellation_token.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_CANCELLATION_TOKEN_H
+#define M8R_CANCELLATION_TOKEN_H
+
+#include <atomic>
+#include <chrono>
+
+namespace m8r {
+
+/**
+ * @brief Cooperative cancellation of long running computation.
+ *
+ * Computation polls the token (lock-free) at convenient points and stops
+ * once the token is cancelled (by another thread), its deadline passes
+ * or its parent token is cancelled. Work done so far is kept or dropped
+ * by the computation - token doesn't interrupt anything on its own.
+ */
+class CancellationToken
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    // cancellation of parent cancels this token (parent must outlive this token)
+    const CancellationToken* parent;
+    std::atomic<bool> cancelled;
+    // steady clock time since epoch, 0 ~ no deadline
+    std::atomic<Clock::rep> deadline;
+
+public:
+    explicit CancellationToken(const CancellationToken* parent=nullptr);
+    CancellationToken(const CancellationToken&) = delete;
+    CancellationToken(const CancellationToken&&) = delete;
+    CancellationToken &operator=(const CancellationToken&) = delete;
+    CancellationToken &operator=(const CancellationToken&&) = delete;
+    ~CancellationToken();
+
+    /**
+     * @brief Ask computation to stop (can be called from any thread).
+     */
+    void cancel() { cancelled.store(true, std::memory_order_release); }
+
+    /**
+     * @brief Cancel computation if it doesn't finish in given time (from now).
+     */
+    void setDeadline(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Clear cancellation and deadline to reuse token for another computation.
+     */
+    void reset();
+
+    bool isCancelled() const;
+};
+
+}
+#endif // M8R_CANCELLATION_TOKEN_H
@@ -18,6 +18,10 @@
  */
 #include "datetime_utils.h"
 
+#include <map>
+#include <mutex>
+#include <unordered_map>
+
 using namespace std;
 
 namespace m8r {
@@ -82,6 +86,81 @@ time_t datetimeSeconds(struct tm* datetime)
     return mktime(datetime);
 }
 
+/**
+ * @brief Days since epoch of proleptic Gregorian calendar date.
+ */
+static long daysFromCivil(long y, unsigned m, unsigned d)
+{
+    y -= m <= 2;
+    const long era = (y >= 0 ? y : y-399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153*(m + (m > 2 ? -3 : 9)) + 2)/5 + d-1;
+    const unsigned doe = yoe * 365 + yoe/4 - yoe/100 + doy;
+    return era * 146097 + static_cast<long>(doe) - 719468;
+}
+
+/**
+ * @brief Parse 1 or 2 (or more if allowed) digits number.
+ */
+static inline bool parseDigits(const char*& s, int& value, int maxDigits=2)
+{
+    if(*s < '0' || *s > '9') {
+        return false;
+    }
+    value = 0;
+    for(int i=0; i<maxDigits && *s>='0' && *s<='9'; i++, s++) {
+        value = value*10 + (*s-'0');
+    }
+    return true;
+}
+
+time_t datetimeSecondsFrom(const char* s)
+{
+    const char* c = s;
+    int year, month, day, hour, minute, second;
+    if(parseDigits(c, year, 4) && *c++=='-'
+       && parseDigits(c, month) && *c++=='-'
+       && parseDigits(c, day) && *c++==' '
+       && parseDigits(c, hour) && *c++==':'
+       && parseDigits(c, minute) && *c++==':'
+       && parseDigits(c, second)
+       && (!*c || isspace(*c))
+       && month>=1 && month<=12 && day>=1 && day<=31
+       && hour<=23 && minute<=59 && second<=60)
+    {
+        const long days = daysFromCivil(year, month, day);
+
+        // UTC offset (w/o DST as tm_isdst is 0) of the day is cached
+        static mutex offsetsMutex;
+        static unordered_map<long,time_t> offsets{};
+        time_t offset;
+        {
+            lock_guard<mutex> criticalSection{offsetsMutex};
+            auto o = offsets.find(days);
+            if(o != offsets.end()) {
+                offset = o->second;
+            } else {
+                struct tm midnight;
+                memset(&midnight, 0, sizeof midnight);
+                midnight.tm_year = year-1900;
+                midnight.tm_mon = month-1;
+                midnight.tm_mday = day;
+                offset = mktime(&midnight) - days*24*60*60;
+                offsets[days] = offset;
+            }
+        }
+
+        return days*24*60*60 + hour*60*60 + minute*60 + second + offset;
+    }
+
+    // slow path
+    struct tm datetime;
+    // C-style initialization as GCC doesn't like {}
+    memset(&datetime, 0, sizeof datetime);
+    datetimeFrom(s, &datetime);
+    return datetimeSeconds(&datetime);
+}
+
 enum class Pretty
 {
     TODAY,
@@ -95,22 +174,93 @@ std::string datetimeToPrettyHtml(const time_t ts)
     return datetimeToPrettyHtml(&ts);
 }
 
+/**
+ * @brief Local time calendar day - memoized as calling localtime() for every timestamp is expensive.
+ */
+struct PrettyDay {
+    time_t end;
+    int year;
+    int mon;
+    int mday;
+    int wday;
+    string yearText;
+    string dayText;
+    string weekdayText;
+};
+
+static constexpr size_t PRETTY_DAYS_CAPACITY = 1<<14;
+
+/**
+ * @brief Find day of given timestamp in memo (caller is expected to hold lock).
+ */
+static const PrettyDay& prettyDay(map<time_t,PrettyDay>& days, const time_t seconds)
+{
+    auto d = days.upper_bound(seconds);
+    if(d != days.begin()) {
+        --d;
+        if(seconds < d->second.end) {
+            return d->second;
+        }
+    }
+
+    if(days.size() >= PRETTY_DAYS_CAPACITY) {
+        days.clear();
+    }
+
+    tm ts;
+#ifndef _WIN32
+    localtime_r(&seconds, &ts);
+#else
+    localtime_s(&ts, &seconds);
+#endif
+    PrettyDay day{};
+    day.year = ts.tm_year;
+    day.mon = ts.tm_mon;
+    day.mday = ts.tm_mday;
+    day.wday = ts.tm_wday;
+    char text[50];
+    strftime(text, sizeof(text), "%Y", &ts);
+    day.yearText.assign(text);
+    strftime(text, sizeof(text), "%b %e", &ts);
+    day.dayText.assign(text);
+    strftime(text, sizeof(text), "%A", &ts);
+    day.weekdayText.assign(text);
+
+    // day boundaries (let mktime() to resolve DST)
+    tm boundary = ts;
+    boundary.tm_hour = boundary.tm_min = boundary.tm_sec = 0;
+    boundary.tm_isdst = -1;
+    time_t begin = mktime(&boundary);
+    boundary = ts;
+    boundary.tm_mday++;
+    boundary.tm_hour = boundary.tm_min = boundary.tm_sec = 0;
+    boundary.tm_isdst = -1;
+    day.end = mktime(&boundary);
+
+    return days.insert(pair<time_t,PrettyDay>(begin,day)).first->second;
+}
+
 constexpr time_t SIX_DAYS = 60 * 60 * 24 * 6;
 std::string datetimeToPrettyHtml(const time_t* seconds)
 {
     time_t now;
     time(&now);
 
-    tm tsS = *localtime(seconds);
-    tm* nowS = localtime(&now);
+    static mutex daysMutex;
+    static map<time_t,PrettyDay> days{};
+    lock_guard<mutex> criticalSection{daysMutex};
+
+    // copy as inserting the second day may flush memo
+    const PrettyDay tsS = prettyDay(days, *seconds);
+    const PrettyDay& nowS = prettyDay(days, now);
 
     Pretty pretty = Pretty::LONG_TIME_AGO;
 
-    if(tsS.tm_year==nowS->tm_year) {
-        if(tsS.tm_mon==nowS->tm_mon && tsS.tm_mday==nowS->tm_mday) {
+    if(tsS.year==nowS.year) {
+        if(tsS.mon==nowS.mon && tsS.mday==nowS.mday) {
             pretty = Pretty::TODAY;
         } else {
-            if(now-*seconds < SIX_DAYS && tsS.tm_wday<=nowS->tm_wday) {
+            if(now-*seconds < SIX_DAYS && tsS.wday<=nowS.wday) {
                 pretty = Pretty::THIS_WEEK;
             } else {
                 pretty = Pretty::THIS_YEAR;
@@ -123,26 +273,35 @@ std::string datetimeToPrettyHtml(const time_t* seconds)
     }
 
     const char *background;
-    char text[50];
+    string text;
     switch(pretty) {
     case Pretty::LONG_TIME_AGO:
         background = "BBBBBB";
-        strftime(text, sizeof(text), "%Y", &tsS);
+        text = tsS.yearText;
         break;
     case Pretty::THIS_YEAR:
         background = "888888";
-        strftime(text, sizeof(text), "%b %e", &tsS);
+        text = tsS.dayText;
         break;
     case Pretty::THIS_WEEK:
         background= "555555";
-        strftime(text, sizeof(text), "%A", &tsS);
+        text = tsS.weekdayText;
         break;
     // IMPROVE this month
-    case Pretty::TODAY:
+    case Pretty::TODAY: {
         background = "000000";
-        strftime(text, sizeof(text), "%R", &tsS);
+        tm ts;
+#ifndef _WIN32
+        localtime_r(seconds, &ts);
+#else
+        localtime_s(&ts, seconds);
+#endif
+        char hhmm[50];
+        strftime(hhmm, sizeof(hhmm), "%R", &ts);
+        text.assign(hhmm);
         break;
     }
+    }
 
     // note that long timestamp is added to the HTML - it is convenient for parsing/sorting/processing
     std::string result;
@@ -152,7 +311,7 @@ std::string datetimeToPrettyHtml(const time_t* seconds)
             "' style='background-color: #" +
             string(background) +
             "; color: #ffffff; text-align: center; white-space: pre;'>" + "&nbsp;&nbsp;" +
-            string(text) +
+            text +
             "&nbsp;&nbsp;" + "</div>";
     return result;
 }
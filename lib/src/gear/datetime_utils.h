@@ -43,10 +43,24 @@ namespace m8r {
 
 time_t datetimeNow();
 time_t datetimeSeconds(struct tm* datetime);
+/**
+ * @brief Parse %Y-%m-%d %H:%M:%S timestamp (as datetimeFrom() + datetimeSeconds() would).
+ *
+ * Fixed format is parsed w/o strptime() and UTC offset is cached per day,
+ * therefore mktime() (which consults time zone database) is called just once
+ * per day. Other formats fall back to strptime() and mktime().
+ */
+time_t datetimeSecondsFrom(const char* s);
 struct tm *datetimeFrom(const char* s);
 struct tm *datetimeFrom(const char* s, struct tm* datetime);
 char *datetimeTo(const struct tm *datetime, char* result);
 std::string datetimeToString(const time_t ts);
+/**
+ * @brief Pretty (relative to today) HTML timestamp.
+ *
+ * Local time of days is memoized, therefore pretty timestamps can be
+ * created on demand (they are not kept by Os/Ns).
+ */
 std::string datetimeToPrettyHtml(const time_t ts);
 std::string datetimeToPrettyHtml(const time_t* seconds);
 
@@ -0,0 +1,207 @@
+/*
+ directory_scanner.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "directory_scanner.h"
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include <algorithm>
+#include <thread>
+
+#include "../config/config.h"
+#include "file_utils.h"
+#include "tracer.h"
+
+namespace m8r {
+
+using namespace std;
+
+constexpr size_t DirectoryScanner::MAX_OPEN_DIRECTORIES;
+
+DirectoryScanner::DirectoryScanner(unsigned threads)
+    : threads{threads},
+      openDirectories{0},
+      busy{0}
+{
+    if(!this->threads) {
+        this->threads = thread::hardware_concurrency();
+        if(!this->threads) {
+            this->threads = 1;
+        }
+    }
+}
+
+DirectoryScanner::~DirectoryScanner()
+{
+}
+
+void DirectoryScanner::scan(const string& directory, vector<ScannedFile>& files)
+{
+    MF_TRACE_SPAN("indexer", "scan");
+
+    scanned.clear();
+    directories.clear();
+    directories.push_back(Directory{-1, directory});
+    openDirectories = 0;
+    busy = 0;
+
+    // calling thread is one of the workers
+    vector<thread> workers{};
+    for(unsigned i=1; i<threads; i++) {
+        workers.push_back(thread{&DirectoryScanner::scanWorker, this});
+    }
+    scanWorker();
+    for(thread& worker:workers) {
+        worker.join();
+    }
+
+    files.swap(scanned);
+    scanned.clear();
+    std::sort(files.begin(), files.end());
+}
+
+void DirectoryScanner::scanWorker()
+{
+    vector<ScannedFile> files{};
+    while(true) {
+        Directory directory{};
+        {
+            unique_lock<mutex> criticalSection{scanMutex};
+            // no directory to list and no busy worker which could find one ~ done
+            scanCondition.wait(criticalSection, [this]() {
+                return !directories.empty() || !busy;
+            });
+            if(directories.empty()) {
+                break;
+            }
+            directory = std::move(directories.front());
+            directories.pop_front();
+            if(directory.fd >= 0) {
+                openDirectories--;
+            }
+            busy++;
+        }
+
+        scanDirectory(directory, files);
+
+        lock_guard<mutex> criticalSection{scanMutex};
+        if(!--busy && directories.empty()) {
+            scanCondition.notify_all();
+        }
+    }
+
+    lock_guard<mutex> criticalSection{scanMutex};
+    scanned.insert(scanned.end(), files.begin(), files.end());
+}
+
+void DirectoryScanner::scanDirectory(Directory& directory, vector<ScannedFile>& files)
+{
+#ifndef _WIN32
+    int fd = directory.fd;
+    if(fd < 0) {
+        fd = open(directory.path.c_str(), O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+        if(fd < 0) {
+            return;
+        }
+    }
+    DIR* dir = fdopendir(fd);
+    if(!dir) {
+        close(fd);
+        return;
+    }
+
+    const struct dirent* entry;
+    struct stat status;
+    while((entry = readdir(dir)) != nullptr) {
+        const char* name = entry->d_name;
+        if(name[0]=='.' && (!name[1] || (name[1]=='.' && !name[2]))) {
+            continue;
+        }
+
+        unsigned char type = entry->d_type;
+        bool stated = false;
+        if(type == DT_UNKNOWN) {
+            // file system doesn't report entry types
+            if(fstatat(dirfd(dir), name, &status, AT_SYMLINK_NOFOLLOW)) {
+                continue;
+            }
+            type = S_ISDIR(status.st_mode) ? DT_DIR : (S_ISLNK(status.st_mode) ? DT_LNK : DT_REG);
+            stated = type != DT_LNK;
+        }
+
+        if(type == DT_DIR) {
+            Directory subdirectory{-1, directory.path};
+            subdirectory.path += FILE_PATH_SEPARATOR;
+            subdirectory.path += name;
+
+            lock_guard<mutex> criticalSection{scanMutex};
+            if(openDirectories < MAX_OPEN_DIRECTORIES) {
+                subdirectory.fd = openat(dirfd(dir), name, O_RDONLY|O_DIRECTORY|O_CLOEXEC);
+                if(subdirectory.fd >= 0) {
+                    openDirectories++;
+                }
+            }
+            directories.push_back(std::move(subdirectory));
+            scanCondition.notify_one();
+        } else {
+            // links are followed to their targets
+            if(!stated) {
+                if(fstatat(dirfd(dir), name, &status, 0) || S_ISDIR(status.st_mode)) {
+                    continue;
+                }
+            }
+            files.push_back(ScannedFile{directory.path, status.st_size, status.st_mtime});
+            files.back().path += FILE_PATH_SEPARATOR;
+            files.back().path += name;
+        }
+    }
+    // closes fd as well
+    closedir(dir);
+#else
+    DIR* dir = opendir(directory.path.c_str());
+    if(!dir) {
+        return;
+    }
+
+    const struct dirent* entry;
+    struct stat status;
+    string path{};
+    while((entry = readdir(dir)) != nullptr) {
+        const char* name = entry->d_name;
+        if(name[0]=='.' && (!name[1] || (name[1]=='.' && !name[2]))) {
+            continue;
+        }
+
+        path.assign(directory.path);
+        path += FILE_PATH_SEPARATOR;
+        path += name;
+        if(entry->d_type == DT_DIR) {
+            lock_guard<mutex> criticalSection{scanMutex};
+            directories.push_back(Directory{-1, path});
+            scanCondition.notify_one();
+        } else if(!stat(path.c_str(), &status)) {
+            files.push_back(ScannedFile{path, status.st_size, status.st_mtime});
+        }
+    }
+    closedir(dir);
+#endif
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ directory_scanner.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_DIRECTORY_SCANNER_H
+#define M8R_DIRECTORY_SCANNER_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace m8r {
+
+/**
+ * @brief File found by directory scanner.
+ */
+struct ScannedFile
+{
+    std::string path;
+    std::int64_t size;
+    time_t modified;
+
+    bool operator<(const ScannedFile& other) const { return path < other.path; }
+};
+
+/**
+ * @brief Recursive directory scanner.
+ *
+ * Directories are listed by worker threads in parallel. Entry type reported by
+ * readdir() is used to recognize directories w/o stat() and files are stat()-ed
+ * relatively to their directory (fstatat()) to get size and modification time
+ * in the same pass. Subdirectories are opened relatively to their parent (openat())
+ * while the number of open directories is low.
+ *
+ * Symbolic links to directories are not followed (cycles).
+ */
+class DirectoryScanner
+{
+public:
+    // max directories opened ahead (waiting for a worker)
+    static constexpr size_t MAX_OPEN_DIRECTORIES = 64;
+
+private:
+    struct Directory {
+        // opened directory or -1 if it must be opened by path
+        int fd;
+        std::string path;
+    };
+
+    unsigned threads;
+
+    std::mutex scanMutex;
+    std::condition_variable scanCondition;
+    std::deque<Directory> directories;
+    // directories opened ahead
+    size_t openDirectories;
+    // workers listing a directory
+    unsigned busy;
+    std::vector<ScannedFile> scanned;
+
+public:
+    explicit DirectoryScanner(unsigned threads=0);
+    DirectoryScanner(const DirectoryScanner&) = delete;
+    DirectoryScanner(const DirectoryScanner&&) = delete;
+    DirectoryScanner &operator=(const DirectoryScanner&) = delete;
+    DirectoryScanner &operator=(const DirectoryScanner&&) = delete;
+    ~DirectoryScanner();
+
+    /**
+     * @brief Find all files in the directory and its subdirectories.
+     *
+     * @param files found files (paths start w/ directory) sorted by path.
+     */
+    void scan(const std::string& directory, std::vector<ScannedFile>& files);
+
+private:
+    void scanWorker();
+    void scanDirectory(Directory& directory, std::vector<ScannedFile>& files);
+};
+
+}
+#endif // M8R_DIRECTORY_SCANNER_H
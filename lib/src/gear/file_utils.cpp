@@ -74,6 +74,61 @@ bool fileToLines(const string* filename, vector<string*>& lines, size_t &fileSiz
     return fileSize>0;
 }
 
+bool stringToLines(const string* text, vector<string*>& lines, size_t& size, TextArena& arena)
+{
+    if(text && !text->empty()) {
+        // lines are split like by getline(): trailing \n doesn't start a new line
+        size_t count = std::count(text->begin(), text->end(), '\n');
+        if(text->back() != '\n') {
+            count++;
+        }
+        arena.reserve(count);
+        lines.reserve(lines.size()+count);
+
+        const char* begin = text->data();
+        const char* end = begin+text->size();
+        while(begin<end) {
+            const char* eol = static_cast<const char*>(memchr(begin, '\n', end-begin));
+            if(!eol) {
+                eol = end;
+            }
+            lines.push_back(arena.add(begin, eol-begin));
+            size += eol-begin+1;
+            begin = eol+1;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool fileToLines(const string* filename, vector<string*>& lines, size_t &fileSize, TextArena& arena)
+{
+    // file is read at once to count lines before they are created in the arena
+    string text{};
+    fileToString(*filename, text);
+
+    stringToLines(&text, lines, fileSize, arena);
+    return fileSize>0;
+}
+
+bool fileToString(const string& filename, string& text)
+{
+    text.clear();
+    ifstream infile(filename, ios::in | ios::binary);
+    if(infile.seekg(0, ios::end)) {
+        streamoff size = infile.tellg();
+        if(size > 0) {
+            text.resize(static_cast<size_t>(size));
+            infile.seekg(0, ios::beg);
+            infile.read(&text[0], size);
+            text.resize(static_cast<size_t>(infile.gcount()));
+        }
+    }
+    infile.close();
+    return !text.empty();
+}
+
 string* fileToString(const string& filename)
 {
     ifstream is(filename);
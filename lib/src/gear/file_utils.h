@@ -43,6 +43,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
 #include <iterator>
 #include <string>
 #include <vector>
@@ -50,6 +51,7 @@
 #include "../debug.h"
 #include "../exceptions.h"
 #include "string_utils.h"
+#include "text_arena.h"
 
 #ifdef __linux__
 constexpr const auto FILE_PATH_SEPARATOR = "/";
@@ -96,7 +98,16 @@ void pathToDirectoryAndFile(const std::string& path, std::string& directory, std
 void pathToLinuxDelimiters(const std::string& path, std::string& linuxPath);
 bool stringToLines(const std::string* text, std::vector<std::string*>& lines);
 bool fileToLines(const std::string* filename, std::vector<std::string*>& lines, size_t& filesize);
+/**
+ * @brief Split text to lines allocated in the arena - lines are counted first so that arena chunk has exact size.
+ */
+bool stringToLines(const std::string* text, std::vector<std::string*>& lines, size_t& size, TextArena& arena);
+bool fileToLines(const std::string* filename, std::vector<std::string*>& lines, size_t& filesize, TextArena& arena);
 std::string* fileToString(const std::string& filename);
+/**
+ * @brief Read file at once w/o per line allocations.
+ */
+bool fileToString(const std::string& filename, std::string& text);
 void stringToFile(const std::string& filename, const std::string& content);
 time_t fileModificationTime(const std::string* filename);
 bool copyFile(const std::string& from, const std::string& to);
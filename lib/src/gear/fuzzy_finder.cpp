@@ -0,0 +1,431 @@
+/*
+ fuzzy_finder.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "fuzzy_finder.h"
+
+#include <algorithm>
+
+#include "string_utils.h"
+
+namespace m8r {
+
+using namespace std;
+
+constexpr int FuzzyFinder::SCORE_MATCH;
+constexpr int FuzzyFinder::SCORE_GAP_START;
+constexpr int FuzzyFinder::SCORE_GAP_EXTENSION;
+constexpr int FuzzyFinder::SCORE_LEADING_GAP;
+constexpr int FuzzyFinder::SCORE_LEADING_GAP_MAX;
+constexpr int FuzzyFinder::BONUS_BOUNDARY;
+constexpr int FuzzyFinder::BONUS_CAMEL;
+constexpr int FuzzyFinder::BONUS_CONSECUTIVE;
+constexpr int FuzzyFinder::BONUS_CASE;
+constexpr int FuzzyFinder::BONUS_FIRST_CHAR_MULTIPLIER;
+constexpr int FuzzyFinder::NO_MATCH;
+constexpr size_t FuzzyFinder::MIN_CANDIDATES_PER_THREAD;
+constexpr size_t FuzzyFinder::CANCEL_CHECK_STEP;
+
+static inline bool isLower(char c) { return c>='a' && c<='z'; }
+static inline bool isUpper(char c) { return c>='A' && c<='Z'; }
+static inline bool isDigit(char c) { return c>='0' && c<='9'; }
+// UTF-8 bytes are considered as letters
+static inline bool isWordChar(char c) { return isLower(c) || isUpper(c) || isDigit(c) || (c & 0x80); }
+
+/**
+ * @brief Bonus for matching character at given position of the name.
+ */
+static inline int boundaryBonus(const string& name, size_t i)
+{
+    if(!i) {
+        return FuzzyFinder::BONUS_BOUNDARY;
+    }
+    char p = name[i-1];
+    char c = name[i];
+    if(!isWordChar(p) && isWordChar(c)) {
+        // after space, -, _, /, ., (, ...
+        return FuzzyFinder::BONUS_BOUNDARY;
+    }
+    if((isLower(p) && isUpper(c)) || (!isDigit(p) && isDigit(c))) {
+        return FuzzyFinder::BONUS_CAMEL;
+    }
+    return 0;
+}
+
+FuzzyFinder::FuzzyFinder(unsigned threads)
+    : threads(threads),
+      lastQuery{},
+      lastIgnoreCase{false},
+      lastKeywords{false},
+      lastValid{false},
+      generation{0},
+      asyncThread{nullptr},
+      asyncStop{false},
+      asyncPending{false},
+      asyncGeneration{0},
+      asyncIgnoreCase{false},
+      asyncKeywords{false},
+      asyncLimit{0}
+{
+    if(!this->threads) {
+        this->threads = thread::hardware_concurrency();
+        if(!this->threads) {
+            this->threads = 1;
+        }
+    }
+}
+
+FuzzyFinder::~FuzzyFinder()
+{
+    if(asyncThread) {
+        {
+            lock_guard<mutex> asyncLock{asyncMutex};
+            asyncStop = true;
+            asyncPending = false;
+        }
+        generation++;
+        asyncCondition.notify_one();
+        asyncThread->join();
+        delete asyncThread;
+    }
+}
+
+void FuzzyFinder::setCandidates(const vector<string>& candidates)
+{
+    // supersede in-flight query to get the mutex quickly
+    generation++;
+    lock_guard<mutex> finderLock{finderMutex};
+
+    names = candidates;
+    lowerNames.clear();
+    lowerNames.reserve(names.size());
+    for(const string& n:names) {
+        string lowerName{};
+        lowerName.reserve(n.size());
+        stringToLower(n, lowerName);
+        lowerNames.push_back(lowerName);
+    }
+
+    lastValid = false;
+    lastMatches.clear();
+}
+
+int FuzzyFinder::score(
+        const string& name,
+        const string& lowerName,
+        const string& pattern,
+        const string& lowerPattern,
+        bool ignoreCase)
+{
+    const string& t = ignoreCase ? lowerName : name;
+    const string& p = ignoreCase ? lowerPattern : pattern;
+    if(p.empty()) {
+        return 0;
+    }
+    if(p.size() > t.size()) {
+        return NO_MATCH;
+    }
+
+    // forward scan: find the end of the first occurrence of the subsequence
+    size_t pi = 0;
+    size_t end = 0;
+    for(size_t i=0; i<t.size(); i++) {
+        if(t[i] == p[pi] && ++pi == p.size()) {
+            end = i+1;
+            break;
+        }
+    }
+    if(pi < p.size()) {
+        return NO_MATCH;
+    }
+
+    // backward scan: tighten the window from the end ~ shortest match ending there
+    size_t start = end;
+    while(pi) {
+        start--;
+        if(t[start] == p[pi-1]) {
+            pi--;
+        }
+    }
+
+    // score the window
+    int s = std::max(SCORE_LEADING_GAP_MAX, SCORE_LEADING_GAP*static_cast<int>(start));
+    bool inGap = false;
+    bool consecutive = false;
+    int chunkBonus = 0;
+    for(size_t i=start; i<end; i++) {
+        if(pi < p.size() && t[i] == p[pi]) {
+            int bonus = boundaryBonus(name, i);
+            if(consecutive) {
+                // consecutive chunk keeps the bonus of its first character
+                chunkBonus = std::max(chunkBonus, BONUS_CONSECUTIVE);
+                bonus = std::max(bonus, chunkBonus);
+            } else {
+                chunkBonus = bonus;
+            }
+            s += SCORE_MATCH + (pi ? bonus : bonus*BONUS_FIRST_CHAR_MULTIPLIER);
+            if(ignoreCase && name[i] == pattern[pi]) {
+                s += BONUS_CASE;
+            }
+            pi++;
+            inGap = false;
+            consecutive = true;
+        } else {
+            s += inGap ? SCORE_GAP_EXTENSION : SCORE_GAP_START;
+            inGap = true;
+            consecutive = false;
+        }
+    }
+
+    return s;
+}
+
+void FuzzyFinder::scoreRange(
+        const vector<string>& terms,
+        const vector<string>& lowerTerms,
+        bool ignoreCase,
+        const vector<size_t>* candidates,
+        size_t begin,
+        size_t end,
+        uint64_t queryGeneration,
+        vector<FuzzyMatch>& matches)
+{
+    for(size_t c=begin; c<end; c++) {
+        if(!((c-begin) % CANCEL_CHECK_STEP) && generation != queryGeneration) {
+            return;
+        }
+
+        size_t i = candidates ? (*candidates)[c] : c;
+        int s = 0;
+        for(size_t t=0; t<terms.size(); t++) {
+            int termScore = score(names[i], lowerNames[i], terms[t], lowerTerms[t], ignoreCase);
+            if(termScore == NO_MATCH) {
+                s = NO_MATCH;
+                break;
+            }
+            s += termScore;
+        }
+        if(s != NO_MATCH) {
+            matches.push_back(FuzzyMatch{i, s});
+        }
+    }
+}
+
+bool FuzzyFinder::find(
+        const string& query,
+        bool ignoreCase,
+        bool keywords,
+        size_t limit,
+        FuzzyFinderResult& result)
+{
+    return evaluate(query, ignoreCase, keywords, limit, ++generation, result);
+}
+
+bool FuzzyFinder::evaluate(
+        const string& query,
+        bool ignoreCase,
+        bool keywords,
+        size_t limit,
+        uint64_t queryGeneration,
+        FuzzyFinderResult& result)
+{
+    lock_guard<mutex> finderLock{finderMutex};
+    if(generation != queryGeneration) {
+        return false;
+    }
+
+    result.generation = queryGeneration;
+    result.query = query;
+    result.matches.clear();
+    result.total = 0;
+
+    vector<string> terms{};
+    if(keywords) {
+        size_t b = 0;
+        while(b < query.size()) {
+            size_t e = query.find(' ', b);
+            if(e == string::npos) {
+                e = query.size();
+            }
+            if(e > b) {
+                terms.push_back(query.substr(b, e-b));
+            }
+            b = e+1;
+        }
+    } else if(query.size()) {
+        terms.push_back(query);
+    }
+    vector<string> lowerTerms{};
+    for(const string& t:terms) {
+        string lowerTerm{};
+        stringToLower(t, lowerTerm);
+        lowerTerms.push_back(lowerTerm);
+    }
+
+    if(terms.empty()) {
+        // empty query matches everything in the original order
+        result.total = names.size();
+        for(size_t i=0; i<names.size() && i<limit; i++) {
+            result.matches.push_back(FuzzyMatch{i, 0});
+        }
+        lastValid = false;
+        return true;
+    }
+
+    // extended query matches a subset of the previous query matches
+    const vector<size_t>* candidates = nullptr;
+    if(lastValid
+       && lastIgnoreCase == ignoreCase
+       && lastKeywords == keywords
+       && query.size() >= lastQuery.size()
+       && query.compare(0, lastQuery.size(), lastQuery) == 0)
+    {
+        candidates = &lastMatches;
+    }
+    size_t count = candidates ? candidates->size() : names.size();
+
+    vector<FuzzyMatch> matches{};
+    size_t chunks = std::min<size_t>(threads, count/MIN_CANDIDATES_PER_THREAD);
+    if(chunks <= 1) {
+        scoreRange(terms, lowerTerms, ignoreCase, candidates, 0, count, queryGeneration, matches);
+    } else {
+        // static partitioning ~ candidates have similar length
+        vector<vector<FuzzyMatch>> partialMatches(chunks);
+        vector<thread> workers{};
+        size_t chunkSize = (count + chunks - 1) / chunks;
+        for(size_t c=0; c<chunks; c++) {
+            size_t b = c*chunkSize;
+            size_t e = std::min(count, b+chunkSize);
+            workers.push_back(thread{
+                &FuzzyFinder::scoreRange,
+                this,
+                std::cref(terms),
+                std::cref(lowerTerms),
+                ignoreCase,
+                candidates,
+                b,
+                e,
+                queryGeneration,
+                std::ref(partialMatches[c])});
+        }
+        for(thread& w:workers) {
+            w.join();
+        }
+        // concatenation keeps candidates order
+        for(vector<FuzzyMatch>& p:partialMatches) {
+            matches.insert(matches.end(), p.begin(), p.end());
+        }
+    }
+    if(generation != queryGeneration) {
+        return false;
+    }
+
+    lastQuery = query;
+    lastIgnoreCase = ignoreCase;
+    lastKeywords = keywords;
+    lastMatches.clear();
+    lastMatches.reserve(matches.size());
+    for(const FuzzyMatch& m:matches) {
+        lastMatches.push_back(m.index);
+    }
+    lastValid = true;
+
+    // top N: score, shorter name, original order
+    auto better = [this](const FuzzyMatch& a, const FuzzyMatch& b) {
+        if(a.score != b.score) {
+            return a.score > b.score;
+        }
+        if(names[a.index].size() != names[b.index].size()) {
+            return names[a.index].size() < names[b.index].size();
+        }
+        return a.index < b.index;
+    };
+    result.total = matches.size();
+    if(limit < matches.size()) {
+        std::partial_sort(matches.begin(), matches.begin()+limit, matches.end(), better);
+        matches.resize(limit);
+    } else {
+        std::sort(matches.begin(), matches.end(), better);
+    }
+    result.matches = std::move(matches);
+
+    return true;
+}
+
+uint64_t FuzzyFinder::findAsync(
+        const string& query,
+        bool ignoreCase,
+        bool keywords,
+        size_t limit,
+        Callback callback)
+{
+    uint64_t queryGeneration;
+    {
+        lock_guard<mutex> asyncLock{asyncMutex};
+        // supersede in-flight query
+        queryGeneration = ++generation;
+        asyncPending = true;
+        asyncGeneration = queryGeneration;
+        asyncQuery = query;
+        asyncIgnoreCase = ignoreCase;
+        asyncKeywords = keywords;
+        asyncLimit = limit;
+        asyncCallback = callback;
+
+        if(!asyncThread) {
+            asyncThread = new thread{&FuzzyFinder::asyncLoop, this};
+        }
+    }
+    asyncCondition.notify_one();
+    return queryGeneration;
+}
+
+void FuzzyFinder::asyncLoop()
+{
+    while(true) {
+        uint64_t queryGeneration;
+        string query{};
+        bool ignoreCase;
+        bool keywords;
+        size_t limit;
+        Callback callback{};
+        {
+            unique_lock<mutex> asyncLock{asyncMutex};
+            asyncCondition.wait(asyncLock, [this]{ return asyncStop || asyncPending; });
+            if(asyncStop) {
+                return;
+            }
+            asyncPending = false;
+            queryGeneration = asyncGeneration;
+            query = asyncQuery;
+            ignoreCase = asyncIgnoreCase;
+            keywords = asyncKeywords;
+            limit = asyncLimit;
+            callback = asyncCallback;
+        }
+
+        FuzzyFinderResult result{};
+        if(evaluate(query, ignoreCase, keywords, limit, queryGeneration, result)
+           && generation == queryGeneration
+           && callback)
+        {
+            callback(result);
+        }
+    }
+}
+
+} // m8r namespace
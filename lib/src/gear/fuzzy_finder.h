@@ -0,0 +1,202 @@
+/*
+ fuzzy_finder.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_FUZZY_FINDER_H
+#define M8R_FUZZY_FINDER_H
+
+#include <atomic>
+#include <climits>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace m8r {
+
+/**
+ * @brief Candidate matched by fuzzy finder.
+ */
+struct FuzzyMatch
+{
+    // index of the candidate as it was set to the finder
+    size_t index;
+    int score;
+};
+
+/**
+ * @brief Result of fuzzy finder query.
+ */
+struct FuzzyFinderResult
+{
+    std::uint64_t generation;
+    std::string query;
+    // top N matches sorted by score
+    std::vector<FuzzyMatch> matches;
+    // number of all matching candidates
+    size_t total;
+};
+
+/**
+ * @brief Fuzzy finder of names (fzf/Sublime Text like).
+ *
+ * Query characters must be found in the candidate as a subsequence. Matches
+ * are ranked by score which rewards matches at word boundaries (start of the
+ * name, after separator, camelCase humps), consecutive matched characters and
+ * case matches, and which penalizes gaps and late start of the match.
+ *
+ * Candidates are encoded once (lower case copies are kept), therefore typing
+ * doesn't allocate. When the query is extended (user types the next character),
+ * only candidates matched by the previous query are scored. Large candidate sets
+ * are scored in parallel chunks.
+ *
+ * findAsync() evaluates queries on finder's own thread - only the latest query
+ * is evaluated and evaluation of a query which was superseded by a newer one
+ * is abandoned, therefore GUI thread is never blocked by typing.
+ */
+class FuzzyFinder
+{
+public:
+    static constexpr int SCORE_MATCH = 16;
+    static constexpr int SCORE_GAP_START = -3;
+    static constexpr int SCORE_GAP_EXTENSION = -1;
+    static constexpr int SCORE_LEADING_GAP = -1;
+    static constexpr int SCORE_LEADING_GAP_MAX = -8;
+    static constexpr int BONUS_BOUNDARY = 8;
+    static constexpr int BONUS_CAMEL = 7;
+    static constexpr int BONUS_CONSECUTIVE = 4;
+    static constexpr int BONUS_CASE = 1;
+    static constexpr int BONUS_FIRST_CHAR_MULTIPLIER = 2;
+
+    static constexpr int NO_MATCH = INT_MIN;
+
+    // candidates scored by one thread
+    static constexpr size_t MIN_CANDIDATES_PER_THREAD = 8192;
+    // how often is checked whether the query was superseded
+    static constexpr size_t CANCEL_CHECK_STEP = 1024;
+
+    typedef std::function<void(FuzzyFinderResult&)> Callback;
+
+private:
+    unsigned threads;
+
+    // finder mutex guards candidates and the narrowing state
+    std::mutex finderMutex;
+    std::vector<std::string> names;
+    std::vector<std::string> lowerNames;
+
+    // matches of the last (complete) query - used to narrow extended query
+    std::string lastQuery;
+    bool lastIgnoreCase;
+    bool lastKeywords;
+    bool lastValid;
+    std::vector<size_t> lastMatches;
+
+    // incremented by each query and candidates change ~ in-flight query is superseded
+    std::atomic<std::uint64_t> generation;
+
+    std::mutex asyncMutex;
+    std::condition_variable asyncCondition;
+    std::thread* asyncThread;
+    bool asyncStop;
+    bool asyncPending;
+    std::uint64_t asyncGeneration;
+    std::string asyncQuery;
+    bool asyncIgnoreCase;
+    bool asyncKeywords;
+    size_t asyncLimit;
+    Callback asyncCallback;
+
+public:
+    explicit FuzzyFinder(unsigned threads=0);
+    FuzzyFinder(const FuzzyFinder&) = delete;
+    FuzzyFinder(const FuzzyFinder&&) = delete;
+    FuzzyFinder &operator=(const FuzzyFinder&) = delete;
+    FuzzyFinder &operator=(const FuzzyFinder&&) = delete;
+    ~FuzzyFinder();
+
+    /**
+     * @brief Set names to be searched - supersedes queries in progress.
+     */
+    void setCandidates(const std::vector<std::string>& candidates);
+    size_t size() const { return names.size(); }
+    const std::string& getCandidate(size_t index) const { return names[index]; }
+
+    /**
+     * @brief Find top limit candidates matching the query.
+     *
+     * @param keywords  split query by spaces to keywords which must all match (in any order).
+     * @return false if the query was superseded by a newer query or candidates change.
+     */
+    bool find(
+            const std::string& query,
+            bool ignoreCase,
+            bool keywords,
+            size_t limit,
+            FuzzyFinderResult& result);
+
+    /**
+     * @brief Find on finder's thread and pass result to callback (called from finder's thread).
+     *
+     * Callback is not called for queries superseded by newer ones.
+     *
+     * @return Generation of the query which is set to the result.
+     */
+    std::uint64_t findAsync(
+            const std::string& query,
+            bool ignoreCase,
+            bool keywords,
+            size_t limit,
+            Callback callback);
+
+    /**
+     * @brief Score name against a pattern (term w/o spaces in keywords mode).
+     *
+     * @return Score or NO_MATCH if pattern is not a subsequence of the name.
+     */
+    static int score(
+            const std::string& name,
+            const std::string& lowerName,
+            const std::string& pattern,
+            const std::string& lowerPattern,
+            bool ignoreCase);
+
+private:
+    bool evaluate(
+            const std::string& query,
+            bool ignoreCase,
+            bool keywords,
+            size_t limit,
+            std::uint64_t queryGeneration,
+            FuzzyFinderResult& result);
+    void scoreRange(
+            const std::vector<std::string>& terms,
+            const std::vector<std::string>& lowerTerms,
+            bool ignoreCase,
+            const std::vector<size_t>* candidates,
+            size_t begin,
+            size_t end,
+            std::uint64_t queryGeneration,
+            std::vector<FuzzyMatch>& matches);
+    void asyncLoop();
+};
+
+}
+#endif // M8R_FUZZY_FINDER_H
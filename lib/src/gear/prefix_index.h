@@ -0,0 +1,270 @@
+/*
+ prefix_index.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_PREFIX_INDEX_H
+#define M8R_PREFIX_INDEX_H
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <iterator>
+
+#include "string_utils.h"
+
+namespace m8r {
+
+/**
+ * @brief Case insensitive prefix index.
+ *
+ * Keys are kept in a sorted (contiguous) array of entries, therefore the range
+ * of keys w/ given prefix is found by binary search in O(log(n)). Entries are
+ * maintained incrementally - the same (key, value) pair added multiple times
+ * increments its weight (reference count), removal decrements it. Batches of
+ * keys should be added/removed at once: a batch is sorted and merged w/ entries
+ * in O(n + k*log(k)) instead of k inserts/erases which are O(n) each.
+ *
+ * Prefix lookup returns top N entries ranked by: case sensitive prefix match,
+ * weight and key length (shorter keys are closer to the prefix).
+ */
+template<class VALUE>
+class PrefixIndex
+{
+public:
+    struct Entry {
+        std::string lowerKey;
+        std::string key;
+        VALUE value;
+        unsigned weight;
+    };
+
+private:
+    std::vector<Entry> entries;
+
+public:
+    explicit PrefixIndex() {}
+    PrefixIndex(const PrefixIndex&) = delete;
+    PrefixIndex(const PrefixIndex&&) = delete;
+    PrefixIndex &operator=(const PrefixIndex&) = delete;
+    PrefixIndex &operator=(const PrefixIndex&&) = delete;
+    ~PrefixIndex() {}
+
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+    void clear() { entries.clear(); }
+    void reserve(size_t n) { entries.reserve(n); }
+
+    /**
+     * @brief Add key w/ value (or increment weight of already indexed pair).
+     */
+    void add(const std::string& key, VALUE value, unsigned weight=1);
+    /**
+     * @brief Decrement weight of (key, value) pair, remove it when weight drops to 0.
+     */
+    bool remove(const std::string& key, VALUE value, unsigned weight=1);
+    /**
+     * @brief Add batch of (key, value) pairs - entries are sorted once and merged.
+     */
+    void add(const std::vector<std::pair<std::string,VALUE>>& keys, unsigned weight=1);
+    /**
+     * @brief Remove batch of (key, value) pairs in a single pass over entries.
+     */
+    void remove(const std::vector<std::pair<std::string,VALUE>>& keys, unsigned weight=1);
+
+    /**
+     * @brief Find at most limit best ranked entries whose key starts w/ given prefix.
+     */
+    void find(const std::string& prefix, std::vector<const Entry*>& result, size_t limit) const;
+
+private:
+    static bool lowerKeyLess(const Entry& e, const std::string& k) {
+        return e.lowerKey.compare(k) < 0;
+    }
+
+    /**
+     * @brief Total order of entries: lower case key, key and value.
+     */
+    static int compareEntries(const Entry& e1, const Entry& e2) {
+        int c = e1.lowerKey.compare(e2.lowerKey);
+        if(!c) {
+            c = e1.key.compare(e2.key);
+            if(!c) {
+                if(std::less<VALUE>()(e1.value, e2.value)) {
+                    c = -1;
+                } else if(std::less<VALUE>()(e2.value, e1.value)) {
+                    c = 1;
+                }
+            }
+        }
+        return c;
+    }
+    static bool entryLess(const Entry& e1, const Entry& e2) {
+        return compareEntries(e1, e2) < 0;
+    }
+
+    void toSortedEntries(const std::vector<std::pair<std::string,VALUE>>& keys, unsigned weight, std::vector<Entry>& batch);
+};
+
+template<class VALUE>
+void PrefixIndex<VALUE>::toSortedEntries(
+        const std::vector<std::pair<std::string,VALUE>>& keys, unsigned weight, std::vector<Entry>& batch)
+{
+    batch.reserve(keys.size());
+    for(auto& k:keys) {
+        if(!k.first.empty()) {
+            batch.push_back(Entry{std::string{}, k.first, k.second, weight});
+            stringToLower(k.first, batch.back().lowerKey);
+        }
+    }
+    std::sort(batch.begin(), batch.end(), entryLess);
+}
+
+template<class VALUE>
+void PrefixIndex<VALUE>::add(const std::string& key, VALUE value, unsigned weight)
+{
+    if(key.empty()) {
+        return;
+    }
+
+    Entry e{std::string{}, key, value, weight};
+    stringToLower(key, e.lowerKey);
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), e, entryLess);
+    if(it != entries.end() && !compareEntries(*it, e)) {
+        it->weight += weight;
+    } else {
+        entries.insert(it, e);
+    }
+}
+
+template<class VALUE>
+bool PrefixIndex<VALUE>::remove(const std::string& key, VALUE value, unsigned weight)
+{
+    if(key.empty()) {
+        return false;
+    }
+
+    Entry e{std::string{}, key, value, weight};
+    stringToLower(key, e.lowerKey);
+
+    auto it = std::lower_bound(entries.begin(), entries.end(), e, entryLess);
+    if(it != entries.end() && !compareEntries(*it, e)) {
+        if(it->weight > weight) {
+            it->weight -= weight;
+        } else {
+            entries.erase(it);
+        }
+        return true;
+    }
+    return false;
+}
+
+template<class VALUE>
+void PrefixIndex<VALUE>::add(const std::vector<std::pair<std::string,VALUE>>& keys, unsigned weight)
+{
+    std::vector<Entry> batch{};
+    toSortedEntries(keys, weight, batch);
+    if(batch.empty()) {
+        return;
+    }
+
+    size_t middle = entries.size();
+    entries.reserve(middle+batch.size());
+    entries.insert(entries.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    std::inplace_merge(entries.begin(), entries.begin()+middle, entries.end(), entryLess);
+
+    // coalesce equal (key, value) pairs
+    auto last = entries.begin();
+    for(auto it=entries.begin()+1; it!=entries.end(); ++it) {
+        if(!compareEntries(*last, *it)) {
+            last->weight += it->weight;
+        } else if(++last != it) {
+            *last = std::move(*it);
+        }
+    }
+    entries.erase(++last, entries.end());
+}
+
+template<class VALUE>
+void PrefixIndex<VALUE>::remove(const std::vector<std::pair<std::string,VALUE>>& keys, unsigned weight)
+{
+    std::vector<Entry> batch{};
+    toSortedEntries(keys, weight, batch);
+    if(batch.empty()) {
+        return;
+    }
+
+    // both arrays are sorted - decrement weights in a single merge-like pass
+    auto it = entries.begin();
+    for(const Entry& b:batch) {
+        it = std::lower_bound(it, entries.end(), b, entryLess);
+        if(it != entries.end() && !compareEntries(*it, b)) {
+            it->weight = it->weight>b.weight ? it->weight-b.weight : 0;
+        }
+    }
+    entries.erase(
+        std::remove_if(entries.begin(), entries.end(), [](const Entry& e) { return !e.weight; }),
+        entries.end());
+}
+
+template<class VALUE>
+void PrefixIndex<VALUE>::find(const std::string& prefix, std::vector<const Entry*>& result, size_t limit) const
+{
+    if(prefix.empty() || !limit) {
+        return;
+    }
+
+    std::string lowerPrefix{};
+    stringToLower(prefix, lowerPrefix);
+
+    // entries w/ given prefix form a continuous range in the sorted array
+    auto begin = std::lower_bound(entries.begin(), entries.end(), lowerPrefix, lowerKeyLess);
+    auto end = begin;
+    while(end!=entries.end() && !end->lowerKey.compare(0, lowerPrefix.size(), lowerPrefix)) {
+        ++end;
+    }
+
+    std::vector<const Entry*> candidates{};
+    candidates.reserve(end-begin);
+    for(auto it=begin; it!=end; ++it) {
+        candidates.push_back(&(*it));
+    }
+
+    auto rank = [&prefix](const Entry* e1, const Entry* e2) {
+        bool c1 = !e1->key.compare(0, prefix.size(), prefix);
+        bool c2 = !e2->key.compare(0, prefix.size(), prefix);
+        if(c1 != c2) {
+            return c1;
+        }
+        if(e1->weight != e2->weight) {
+            return e1->weight > e2->weight;
+        }
+        if(e1->key.size() != e2->key.size()) {
+            return e1->key.size() < e2->key.size();
+        }
+        return e1->key.compare(e2->key) < 0;
+    };
+
+    size_t n = std::min(limit, candidates.size());
+    std::partial_sort(candidates.begin(), candidates.begin()+n, candidates.end(), rank);
+    result.insert(result.end(), candidates.begin(), candidates.begin()+n);
+}
+
+} // m8r namespace
+
+#endif // M8R_PREFIX_INDEX_H
@@ -81,6 +81,23 @@ static inline void stringToLower(const std::string& s, std::string& lowerS)
     }
 }
 
+/**
+ * @brief Append string to HTML w/ HTML special characters escaped.
+ */
+static inline void stringAppendHtmlEscaped(const std::string& s, std::string& html)
+{
+    for(const char c:s) {
+        switch(c) {
+        case '&': html += "&amp;"; break;
+        case '<': html += "&lt;"; break;
+        case '>': html += "&gt;"; break;
+        case '"': html += "&quot;"; break;
+        case '\'': html += "&#39;"; break;
+        default: html += c;
+        }
+    }
+}
+
 /**
  * @brief Trim leading and trailing whitespaces.
  *
@@ -0,0 +1,95 @@
+/*
+ text_arena.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "text_arena.h"
+
+#include <functional>
+
+namespace m8r {
+
+using namespace std;
+
+constexpr size_t TextArena::MIN_CHUNK_LINES;
+constexpr size_t TextArena::MAX_CHUNK_LINES;
+
+TextArena::TextArena()
+    : chunks{},
+      used{0},
+      count{0}
+{
+}
+
+TextArena::~TextArena()
+{
+    for(Chunk& c:chunks) {
+        delete[] c.lines;
+    }
+}
+
+void TextArena::reserve(size_t lines)
+{
+    if(lines && (chunks.empty() || chunks.back().capacity-used < lines)) {
+        // exact size: lines of a lexed file are counted beforehand
+        chunks.push_back(Chunk{new string[lines], lines});
+        used = 0;
+    }
+}
+
+string* TextArena::next()
+{
+    if(chunks.empty() || used == chunks.back().capacity) {
+        // chunks grow w/ the arena so that small Os don't waste memory
+        size_t capacity = chunks.empty() ? MIN_CHUNK_LINES : 2*chunks.back().capacity;
+        if(capacity > MAX_CHUNK_LINES) {
+            capacity = MAX_CHUNK_LINES;
+        }
+        chunks.push_back(Chunk{new string[capacity], capacity});
+        used = 0;
+    }
+
+    count++;
+    return chunks.back().lines + used++;
+}
+
+string* TextArena::add(string&& line)
+{
+    string* result = next();
+    result->swap(line);
+    return result;
+}
+
+string* TextArena::add(const char* text, size_t size)
+{
+    string* result = next();
+    result->assign(text, size);
+    return result;
+}
+
+bool TextArena::owns(const string* line) const
+{
+    less<const string*> before{};
+    // the last chunks are the biggest
+    for(auto c = chunks.rbegin(); c != chunks.rend(); ++c) {
+        if(!before(line, c->lines) && before(line, c->lines+c->capacity)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
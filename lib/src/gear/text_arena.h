@@ -0,0 +1,95 @@
+/*
+ text_arena.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_TEXT_ARENA_H
+#define M8R_TEXT_ARENA_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace m8r {
+
+/**
+ * @brief Arena of text lines allocated in chunks.
+ *
+ * Lines of a parsed Markdown file are lexed directly to the arena, which is
+ * shared by the O and its Ns (preamble, O and Ns descriptions), instead of
+ * being allocated (and freed) one by one. Arena lines are regular strings -
+ * they can be changed in place and are freed at once w/ the arena. Lines which
+ * are not owned by the arena (created by edits) are heap allocated and owned
+ * by O/N as before - see release().
+ */
+class TextArena
+{
+public:
+    static constexpr size_t MIN_CHUNK_LINES = 8;
+    static constexpr size_t MAX_CHUNK_LINES = 4096;
+
+private:
+    struct Chunk {
+        std::string* lines;
+        size_t capacity;
+    };
+
+    std::vector<Chunk> chunks;
+    // lines used in the last chunk
+    size_t used;
+    size_t count;
+
+public:
+    explicit TextArena();
+    TextArena(const TextArena&) = delete;
+    TextArena(const TextArena&&) = delete;
+    TextArena &operator=(const TextArena&) = delete;
+    TextArena &operator=(const TextArena&&) = delete;
+    ~TextArena();
+
+    /**
+     * @brief Ensure that next lines are added to a single chunk of exact size.
+     */
+    void reserve(size_t lines);
+
+    /**
+     * @brief Move line content to the arena.
+     *
+     * @return arena's line which is valid until the arena is destroyed.
+     */
+    std::string* add(std::string&& line);
+    std::string* add(const char* text, size_t size);
+
+    bool owns(const std::string* line) const;
+    size_t size() const { return count; }
+
+    /**
+     * @brief Delete line or free text of arena's line (arena may be nullptr).
+     */
+    static void release(std::string* line, const TextArena* arena) {
+        if(!arena || !arena->owns(line)) {
+            delete line;
+        } else {
+            std::string{}.swap(*line);
+        }
+    }
+
+private:
+    std::string* next();
+};
+
+}
+#endif // M8R_TEXT_ARENA_H
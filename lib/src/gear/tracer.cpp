@@ -0,0 +1,342 @@
+/*
+ tracer.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "tracer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+namespace m8r {
+
+using namespace std;
+
+constexpr int TraceHistogram::BUCKETS;
+constexpr size_t Tracer::RING_CAPACITY;
+constexpr const char* Tracer::REPORT_FILE_EXTENSION;
+
+atomic<bool> Tracer::enabled{false};
+
+/*
+ * Histogram
+ */
+
+TraceHistogram::TraceHistogram()
+    : count{0},
+      total{0},
+      min{UINT64_MAX},
+      max{0}
+{
+    std::fill(buckets, buckets+BUCKETS, 0);
+}
+
+void TraceHistogram::add(uint64_t duration)
+{
+    count++;
+    total += duration;
+    if(duration < min) min = duration;
+    if(duration > max) max = duration;
+
+    int bucket = 0;
+    while(duration > 1 && bucket < BUCKETS-1) {
+        duration >>= 1;
+        bucket++;
+    }
+    buckets[bucket]++;
+}
+
+void TraceHistogram::merge(const TraceHistogram& h)
+{
+    count += h.count;
+    total += h.total;
+    if(h.min < min) min = h.min;
+    if(h.max > max) max = h.max;
+    for(int i=0; i<BUCKETS; i++) {
+        buckets[i] += h.buckets[i];
+    }
+}
+
+uint64_t TraceHistogram::percentile(double p) const
+{
+    if(!count) {
+        return 0;
+    }
+
+    uint64_t rank = static_cast<uint64_t>(p*count);
+    if(rank >= count) rank = count-1;
+    uint64_t seen = 0;
+    for(int i=0; i<BUCKETS; i++) {
+        seen += buckets[i];
+        if(seen > rank) {
+            uint64_t upper = i<BUCKETS-1 ? (static_cast<uint64_t>(1)<<(i+1))-1 : UINT64_MAX;
+            return std::min(upper, max);
+        }
+    }
+    return max;
+}
+
+/*
+ * Ring
+ */
+
+TraceRing::TraceRing(unsigned tid, size_t capacity)
+    : tid{tid},
+      events(capacity),
+      next{0},
+      wrapped{false},
+      histograms{},
+      counters{}
+{
+}
+
+TraceRing::~TraceRing()
+{
+}
+
+void TraceRing::add(const TraceEvent& event)
+{
+    lock_guard<mutex> criticalSection{ringMutex};
+
+    TraceEvent& e = events[next];
+    e = event;
+    if(event.counter) {
+        // running total makes counter track in trace viewer
+        e.value = (counters[make_pair(event.category,event.name)] += event.value);
+    } else {
+        histograms[make_pair(event.category,event.name)].add(event.duration);
+    }
+
+    if(++next == events.size()) {
+        next = 0;
+        wrapped = true;
+    }
+}
+
+void TraceRing::clear()
+{
+    lock_guard<mutex> criticalSection{ringMutex};
+
+    next = 0;
+    wrapped = false;
+    histograms.clear();
+    counters.clear();
+}
+
+/*
+ * Tracer
+ */
+
+/**
+ * @brief Thread's handle of trace ring - ring is released when thread finishes.
+ */
+struct TraceRingHandle
+{
+    TraceRing* ring;
+
+    TraceRingHandle() : ring{nullptr} {}
+    ~TraceRingHandle() {
+        if(ring) {
+            Tracer::getInstance().releaseRing(ring);
+        }
+    }
+};
+
+static thread_local TraceRingHandle threadRing{};
+
+Tracer::Tracer()
+    : rings{},
+      freeRings{}
+{
+}
+
+Tracer::~Tracer()
+{
+    for(TraceRing* r:rings) {
+        delete r;
+    }
+}
+
+TraceRing* Tracer::getThreadRing()
+{
+    if(!threadRing.ring) {
+        lock_guard<mutex> criticalSection{ringsMutex};
+        if(freeRings.size()) {
+            threadRing.ring = freeRings.back();
+            freeRings.pop_back();
+        } else {
+            threadRing.ring = new TraceRing{static_cast<unsigned>(rings.size()+1), RING_CAPACITY};
+            rings.push_back(threadRing.ring);
+        }
+    }
+    return threadRing.ring;
+}
+
+void Tracer::releaseRing(TraceRing* ring)
+{
+    lock_guard<mutex> criticalSection{ringsMutex};
+    freeRings.push_back(ring);
+}
+
+void Tracer::span(const char* category, const char* name, uint64_t begin, uint64_t duration)
+{
+    getThreadRing()->add(TraceEvent{category, name, begin, duration, 0, false});
+}
+
+void Tracer::counter(const char* category, const char* name, int64_t delta)
+{
+    getThreadRing()->add(TraceEvent{category, name, nowNs(), 0, delta, true});
+}
+
+void Tracer::clear()
+{
+    lock_guard<mutex> criticalSection{ringsMutex};
+    for(TraceRing* r:rings) {
+        r->clear();
+    }
+}
+
+size_t Tracer::getEventsCount()
+{
+    lock_guard<mutex> criticalSection{ringsMutex};
+    size_t count = 0;
+    for(TraceRing* r:rings) {
+        lock_guard<mutex> ringCriticalSection{r->ringMutex};
+        count += r->wrapped ? r->events.size() : r->next;
+    }
+    return count;
+}
+
+static void toJsonString(ostream& out, const char* s)
+{
+    out << '"';
+    for(; *s; s++) {
+        switch(*s) {
+        case '"':
+        case '\\':
+            out << '\\' << *s;
+            break;
+        case '\n':
+            out << "\\n";
+            break;
+        default:
+            out << *s;
+        }
+    }
+    out << '"';
+}
+
+void Tracer::toChromeTrace(ostream& out)
+{
+    lock_guard<mutex> criticalSection{ringsMutex};
+
+    // trace event timestamps are in microseconds
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    for(TraceRing* r:rings) {
+        lock_guard<mutex> ringCriticalSection{r->ringMutex};
+
+        size_t size = r->wrapped ? r->events.size() : r->next;
+        size_t begin = r->wrapped ? r->next : 0;
+        for(size_t i=0; i<size; i++) {
+            const TraceEvent& e = r->events[(begin+i) % r->events.size()];
+
+            out << (first?"\n":",\n") << "{\"name\":";
+            toJsonString(out, e.name);
+            out << ",\"cat\":";
+            toJsonString(out, e.category);
+            if(e.counter) {
+                out << ",\"ph\":\"C\",\"ts\":" << e.timestamp/1000 << "." << setw(3) << setfill('0') << e.timestamp%1000
+                    << ",\"pid\":1,\"tid\":" << r->tid
+                    << ",\"args\":{\"value\":" << e.value << "}}";
+            } else {
+                out << ",\"ph\":\"X\",\"ts\":" << e.timestamp/1000 << "." << setw(3) << setfill('0') << e.timestamp%1000
+                    << ",\"dur\":" << e.duration/1000 << "." << setw(3) << setfill('0') << e.duration%1000
+                    << ",\"pid\":1,\"tid\":" << r->tid << "}";
+            }
+            first = false;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+}
+
+void Tracer::toHistogramReport(ostream& out)
+{
+    // aggregate by name text - the same literal may have different address in different translation units
+    map<string,TraceHistogram> histograms{};
+    map<string,int64_t> counters{};
+    {
+        lock_guard<mutex> criticalSection{ringsMutex};
+        for(TraceRing* r:rings) {
+            lock_guard<mutex> ringCriticalSection{r->ringMutex};
+            for(auto& h:r->histograms) {
+                histograms[string{h.first.first}+"/"+h.first.second].merge(h.second);
+            }
+            for(auto& c:r->counters) {
+                counters[string{c.first.first}+"/"+c.first.second] += c.second;
+            }
+        }
+    }
+
+    out << left << setw(32) << "span" << right
+        << setw(10) << "count"
+        << setw(14) << "total [ms]"
+        << setw(12) << "mean [us]"
+        << setw(12) << "min [us]"
+        << setw(12) << "p50 [us]"
+        << setw(12) << "p90 [us]"
+        << setw(12) << "p99 [us]"
+        << setw(12) << "max [us]" << endl;
+    out << fixed << setprecision(1);
+    for(auto& h:histograms) {
+        const TraceHistogram& s = h.second;
+        out << left << setw(32) << h.first << right
+            << setw(10) << s.count
+            << setw(14) << s.total/1000000.
+            << setw(12) << s.total/1000./s.count
+            << setw(12) << s.min/1000.
+            << setw(12) << s.percentile(.5)/1000.
+            << setw(12) << s.percentile(.9)/1000.
+            << setw(12) << s.percentile(.99)/1000.
+            << setw(12) << s.max/1000. << endl;
+    }
+
+    if(counters.size()) {
+        out << endl << left << setw(32) << "counter" << right << setw(14) << "total" << endl;
+        for(auto& c:counters) {
+            out << left << setw(32) << c.first << right << setw(14) << c.second << endl;
+        }
+    }
+    out.unsetf(ios_base::floatfield);
+}
+
+bool Tracer::exportTo(const string& fileName)
+{
+    ofstream trace{fileName};
+    toChromeTrace(trace);
+    trace.close();
+
+    ofstream report{fileName + REPORT_FILE_EXTENSION};
+    toHistogramReport(report);
+    report.close();
+
+    return trace.good() && report.good();
+}
+
+} // m8r namespace
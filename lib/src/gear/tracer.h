@@ -0,0 +1,231 @@
+/*
+ tracer.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_TRACER_H
+#define M8R_TRACER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../debug.h"
+
+// MF_NO_TRACING to be enabled in qmake to compile tracing out:
+//   - configuration: DEFINES = MF_NO_TRACING
+#ifndef MF_NO_TRACING
+    #define MF_TRACE_CONCAT_(A, B) A ## B
+    #define MF_TRACE_CONCAT(A, B) MF_TRACE_CONCAT_(A, B)
+    // span lasts until the end of enclosing scope, category and name MUST be string literals
+    #define MF_TRACE_SPAN(CATEGORY, NAME) m8r::TraceSpan MF_TRACE_CONCAT(mfTraceSpan, __LINE__){CATEGORY, NAME}
+    #define MF_TRACE_COUNTER(CATEGORY, NAME, DELTA) \
+        do { if(m8r::Tracer::isEnabled()) { m8r::Tracer::getInstance().counter(CATEGORY, NAME, DELTA); } } while (0)
+#else
+    #define MF_TRACE_SPAN(CATEGORY, NAME) do {;} while (0)
+    #define MF_TRACE_COUNTER(CATEGORY, NAME, DELTA) do {;} while (0)
+#endif // MF_NO_TRACING
+
+namespace m8r {
+
+/**
+ * @brief Trace event - either span (duration) or counter (delta).
+ */
+struct TraceEvent
+{
+    const char* category;
+    const char* name;
+    // span: begin and duration, counter: time and running total
+    uint64_t timestamp;
+    uint64_t duration;
+    int64_t value;
+    bool counter;
+};
+
+/**
+ * @brief Log2 histogram of span durations.
+ */
+struct TraceHistogram
+{
+    static constexpr int BUCKETS = 64;
+
+    uint64_t count;
+    uint64_t total;
+    uint64_t min;
+    uint64_t max;
+    // bucket i counts durations in [2^i, 2^(i+1)) ns
+    uint64_t buckets[BUCKETS];
+
+    explicit TraceHistogram();
+
+    void add(uint64_t duration);
+    void merge(const TraceHistogram& h);
+    /**
+     * @brief Approximate percentile (upper bound of the bucket) in ns.
+     */
+    uint64_t percentile(double p) const;
+};
+
+/**
+ * @brief Per-thread trace ring buffer.
+ *
+ * Ring is written by its owner thread only, mutex is uncontended unless
+ * trace is exported. Ring is retained (w/ its events) when thread finishes
+ * and reused by the next new thread.
+ */
+class TraceRing
+{
+    friend class Tracer;
+
+private:
+    const unsigned tid;
+    std::mutex ringMutex;
+
+    std::vector<TraceEvent> events;
+    size_t next;
+    bool wrapped;
+
+    // aggregated for all events (not only those retained in ring) by category and name
+    std::map<std::pair<const char*,const char*>,TraceHistogram> histograms;
+    std::map<std::pair<const char*,const char*>,int64_t> counters;
+
+public:
+    explicit TraceRing(unsigned tid, size_t capacity);
+    TraceRing(const TraceRing&) = delete;
+    TraceRing(const TraceRing&&) = delete;
+    TraceRing &operator=(const TraceRing&) = delete;
+    TraceRing &operator=(const TraceRing&&) = delete;
+    ~TraceRing();
+
+    void add(const TraceEvent& event);
+    void clear();
+};
+
+/**
+ * @brief Low overhead tracer w/ named spans and counters.
+ *
+ * Tracing is disabled by default and it can be toggled at runtime - disabled
+ * tracer costs a relaxed atomic load per span. Events are recorded to per-thread
+ * rings (the oldest events are overwritten), aggregated statistics are kept
+ * for all events. Trace can be exported as Chrome trace event JSON (chrome://tracing)
+ * and as histogram report.
+ */
+class Tracer
+{
+public:
+    static constexpr size_t RING_CAPACITY = 1<<15;
+    static constexpr const char* REPORT_FILE_EXTENSION = ".txt";
+
+    static Tracer& getInstance()
+    {
+        static Tracer SINGLETON{};
+        return SINGLETON;
+    }
+
+    static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+private:
+    static std::atomic<bool> enabled;
+
+    std::mutex ringsMutex;
+    std::vector<TraceRing*> rings;
+    std::vector<TraceRing*> freeRings;
+
+    explicit Tracer();
+
+public:
+    Tracer(const Tracer&) = delete;
+    Tracer(const Tracer&&) = delete;
+    Tracer &operator=(const Tracer&) = delete;
+    Tracer &operator=(const Tracer&&) = delete;
+    ~Tracer();
+
+    void setEnabled(bool enable) { enabled.store(enable, std::memory_order_relaxed); }
+
+    void span(const char* category, const char* name, uint64_t begin, uint64_t duration);
+    void counter(const char* category, const char* name, int64_t delta);
+
+    /**
+     * @brief Drop recorded events and statistics.
+     */
+    void clear();
+
+    size_t getEventsCount();
+
+    /**
+     * @brief Export events in Chrome trace event format.
+     */
+    void toChromeTrace(std::ostream& out);
+
+    /**
+     * @brief Export span histograms and counter totals as text report.
+     */
+    void toHistogramReport(std::ostream& out);
+
+    /**
+     * @brief Export Chrome trace to file and histogram report to file w/ .txt suffix.
+     */
+    bool exportTo(const std::string& fileName);
+
+    /**
+     * @brief Give ring of finished thread to another thread.
+     */
+    void releaseRing(TraceRing* ring);
+
+private:
+    TraceRing* getThreadRing();
+};
+
+/**
+ * @brief RAII span - duration of the enclosing scope is traced.
+ */
+class TraceSpan
+{
+private:
+    const char* category;
+    const char* name;
+    uint64_t begin;
+
+public:
+    explicit TraceSpan(const char* category, const char* name)
+        : category{category},
+          name{name},
+          begin{Tracer::isEnabled()?Tracer::nowNs():0}
+    {}
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan(const TraceSpan&&) = delete;
+    TraceSpan &operator=(const TraceSpan&) = delete;
+    TraceSpan &operator=(const TraceSpan&&) = delete;
+    ~TraceSpan() {
+        if(begin) {
+            Tracer::getInstance().span(category, name, begin, Tracer::nowNs()-begin);
+        }
+    }
+};
+
+}
+#endif // M8R_TRACER_H
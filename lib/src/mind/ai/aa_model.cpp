@@ -21,8 +21,253 @@
 
 namespace m8r {
 
-AssociationAssessmentModel::AssociationAssessmentModel() = default;
+using namespace std;
 
-AssociationAssessmentModel::~AssociationAssessmentModel() = default;
+AssociationAssessmentModel::AssociationAssessmentModel()
+    : ann{nullptr}
+{
+}
+
+AssociationAssessmentModel::~AssociationAssessmentModel()
+{
+    clear();
+}
+
+void AssociationAssessmentModel::train(
+        const vector<float>& features,
+        const vector<float>& labels,
+        int epochs,
+        double learningRate,
+        unsigned threads,
+        const CancellationToken* cancellation)
+{
+    clear();
+
+    const size_t count = labels.size();
+    if(!count || features.size() != count*INPUTS) {
+        MF_DEBUG("AA.NN: no training data (" << count << " labels / " << features.size() << " features)" << endl);
+        return;
+    }
+
+#ifdef DO_MF_DEBUG
+    MF_DEBUG("AA.NN: training on " << count << " pairs..." << endl);
+    auto begin = chrono::high_resolution_clock::now();
+#endif
+
+    ann = genann_init(INPUTS, 1, HIDDEN, 1);
+    // initial weights are set using fixed seed to get reproducible models
+    mt19937 random{2020};
+    uniform_real_distribution<double> initialWeight{-.5, .5};
+    for(int i=0; i<ann->total_weights; i++) {
+        ann->weight[i] = initialWeight(random);
+    }
+    // sigmoid lookup table is lazily initialized on the first call - do it before it's shared by threads
+    genann_act_sigmoid_cached(0.);
+
+    if(!threads) {
+        threads = thread::hardware_concurrency();
+    }
+    threads = std::max(1u, std::min(threads, static_cast<unsigned>(count/MIN_PAIRS_PER_THREAD)));
+
+    vector<size_t> order(count);
+    for(size_t i=0; i<count; i++) {
+        order[i] = i;
+    }
+
+    vector<genann*> shardAnns{};
+    if(threads > 1) {
+        for(unsigned t=0; t<threads; t++) {
+            shardAnns.push_back(genann_copy(ann));
+        }
+    }
+
+    for(int epoch=0; epoch<epochs; epoch++) {
+        shuffle(order.begin(), order.end(), random);
+
+        if(threads == 1) {
+            trainShard(ann, features, labels, order, 0, count, learningRate);
+        } else {
+            // every shard starts from the averaged model of previous epoch
+            vector<thread> workers{};
+            for(unsigned t=0; t<threads; t++) {
+                memcpy(shardAnns[t]->weight, ann->weight, sizeof(double) * ann->total_weights);
+                workers.push_back(thread{
+                    trainShard,
+                    shardAnns[t],
+                    std::cref(features),
+                    std::cref(labels),
+                    std::cref(order),
+                    count*t/threads,
+                    count*(t+1)/threads,
+                    learningRate});
+            }
+            for(thread& w:workers) {
+                w.join();
+            }
+
+            for(int i=0; i<ann->total_weights; i++) {
+                double sum = 0.;
+                for(genann* s:shardAnns) {
+                    sum += s->weight[i];
+                }
+                ann->weight[i] = sum/threads;
+            }
+        }
+
+        if(cancellation && cancellation->isCancelled()) {
+            MF_DEBUG("AA.NN: training cancelled in epoch " << epoch << endl);
+            break;
+        }
+    }
+
+    for(genann* s:shardAnns) {
+        genann_free(s);
+    }
+    if(cancellation && cancellation->isCancelled()) {
+        clear();
+        return;
+    }
+
+#ifdef DO_MF_DEBUG
+    auto end = chrono::high_resolution_clock::now();
+    MF_DEBUG("AA.NN: trained in " << chrono::duration_cast<chrono::milliseconds>(end-begin).count() << "ms using " << threads << " thread(s)" << endl);
+#endif
+}
+
+void AssociationAssessmentModel::trainShard(
+        genann* shardAnn,
+        const vector<float>& features,
+        const vector<float>& labels,
+        const vector<size_t>& order,
+        size_t begin,
+        size_t end,
+        double learningRate)
+{
+    double input[INPUTS];
+    double desired;
+    for(size_t i=begin; i<end; i++) {
+        const float* f = features.data() + order[i]*INPUTS;
+        for(int k=0; k<INPUTS; k++) {
+            input[k] = f[k];
+        }
+        desired = labels[order[i]];
+        genann_train(shardAnn, input, &desired, learningRate);
+    }
+}
+
+void AssociationAssessmentModel::score(const float* features, size_t count, float* scores) const
+{
+    if(!ann) {
+        std::fill(scores, scores+count, 0.f);
+        return;
+    }
+
+    // genann layout: each neuron has bias weight followed by its input weights
+    const double* hiddenWeights = ann->weight;
+    const double* outputWeights = ann->weight + HIDDEN*(INPUTS+1);
+    double hidden[BATCH_BLOCK_SIZE*HIDDEN];
+
+    for(size_t b=0; b<count; b+=BATCH_BLOCK_SIZE) {
+        const size_t n = std::min(BATCH_BLOCK_SIZE, count-b);
+        const float* x = features + b*INPUTS;
+
+        // hidden layer neuron by neuron for the whole block so that its weights stay hot
+        const double* w = hiddenWeights;
+        for(int j=0; j<HIDDEN; j++, w+=INPUTS+1) {
+            for(size_t s=0; s<n; s++) {
+                const float* xs = x + s*INPUTS;
+                double sum = -w[0];
+                for(int k=0; k<INPUTS; k++) {
+                    sum += w[k+1] * xs[k];
+                }
+                hidden[s*HIDDEN+j] = ann->activation_hidden(sum);
+            }
+        }
+
+        // output layer
+        for(size_t s=0; s<n; s++) {
+            const double* hs = hidden + s*HIDDEN;
+            double sum = -outputWeights[0];
+            for(int j=0; j<HIDDEN; j++) {
+                sum += outputWeights[j+1] * hs[j];
+            }
+            scores[b+s] = static_cast<float>(ann->activation_output(sum));
+        }
+    }
+}
+
+constexpr const auto MODEL_FILE_MAGIC = "mindforger-aa-nn";
+
+bool AssociationAssessmentModel::save(const string& path, uint64_t fingerprint) const
+{
+    if(!ann) {
+        return false;
+    }
+
+    FILE* out = fopen(path.c_str(), "w");
+    if(!out) {
+        MF_DEBUG("AA.NN: unable to save model to " << path << endl);
+        return false;
+    }
+    fprintf(out, "%s %d %" PRIx64 "\n", MODEL_FILE_MAGIC, FORMAT_VERSION, fingerprint);
+    genann_write(ann, out);
+    fclose(out);
+
+    MF_DEBUG("AA.NN: model saved to " << path << endl);
+    return true;
+}
+
+bool AssociationAssessmentModel::load(const string& path, uint64_t fingerprint)
+{
+    FILE* in = fopen(path.c_str(), "r");
+    if(!in) {
+        return false;
+    }
+
+    // stale model (trained on different data) or model in old format is not loaded
+    char magic[32];
+    int version;
+    uint64_t modelFingerprint;
+    if(fscanf(in, "%31s %d %" SCNx64, magic, &version, &modelFingerprint) != 3
+         || strcmp(magic, MODEL_FILE_MAGIC)
+         || version != FORMAT_VERSION
+         || modelFingerprint != fingerprint)
+    {
+        fclose(in);
+        MF_DEBUG("AA.NN: stale or incompatible model " << path << endl);
+        return false;
+    }
+
+    genann* loaded = genann_read(in);
+    fclose(in);
+
+    if(loaded
+         && loaded->inputs == INPUTS
+         && loaded->hidden_layers == 1
+         && loaded->hidden == HIDDEN
+         && loaded->outputs == 1)
+    {
+        clear();
+        ann = loaded;
+        genann_act_sigmoid_cached(0.);
+
+        MF_DEBUG("AA.NN: model loaded from " << path << endl);
+        return true;
+    }
+
+    if(loaded) {
+        genann_free(loaded);
+    }
+    MF_DEBUG("AA.NN: invalid model " << path << endl);
+    return false;
+}
+
+void AssociationAssessmentModel::clear()
+{
+    if(ann) {
+        genann_free(ann);
+        ann = nullptr;
+    }
+}
 
 } // m8r namespace
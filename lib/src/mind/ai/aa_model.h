@@ -19,15 +19,52 @@
 #ifndef M8R_ASSOCIATION_ASSESSMENT_MODEL_H
 #define M8R_ASSOCIATION_ASSESSMENT_MODEL_H
 
+#include <cstdint>
+#include <cstdio>
+#include <cinttypes>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+
+#include "../../debug.h"
+#include "../../gear/cancellation_token.h"
 #include "aa_notes_feature.h"
+#include "nn/genann.h"
 
 namespace m8r {
 
 /**
  * @brief Associations assessment neural network model.
+ *
+ * Feed-forward NN (genann) which scores N pair features (see AssociationAssessmentNotesFeature)
+ * to [0,1] association assessment. Model is trained on N pairs mined from Memory,
+ * and it can be persisted to/restored from file. Persisted model is stamped w/ format
+ * version and fingerprint of data it was trained on - model trained on different
+ * data (or stored in different format) is not loaded, so that it's retrained.
+ *
+ * Features of candidate pairs are passed in a contiguous row-major batch
+ * i.e. FEATURES_SIZE floats per pair.
  */
 class AssociationAssessmentModel
 {
+public:
+    static constexpr int INPUTS = AssociationAssessmentNotesFeature::FEATURES_SIZE;
+    static constexpr int HIDDEN = 8;
+
+    // increment whenever features, topology or training data mining change
+    static constexpr int FORMAT_VERSION = 1;
+
+    // pairs scored at once by batch forward pass (hidden layer outputs fit L1 cache)
+    static constexpr size_t BATCH_BLOCK_SIZE = 256;
+    // minimum number of training pairs per training thread
+    static constexpr size_t MIN_PAIRS_PER_THREAD = 1000;
+
+private:
+    genann* ann;
+
 public:
     explicit AssociationAssessmentModel();
     AssociationAssessmentModel(const AssociationAssessmentModel&) = delete;
@@ -35,6 +72,60 @@ public:
     AssociationAssessmentModel &operator=(const AssociationAssessmentModel&) = delete;
     AssociationAssessmentModel &operator=(const AssociationAssessmentModel&&) = delete;
     ~AssociationAssessmentModel();
+
+    bool isTrained() const { return ann!=nullptr; }
+
+    /**
+     * @brief Train model from scratch.
+     *
+     * Training data are sharded among threads, each thread trains its copy
+     * of the model on its shard and the copies are averaged after every epoch.
+     *
+     * @param features  contiguous features - INPUTS floats per pair.
+     * @param labels    1 if pair is associated, 0 otherwise.
+     * @param threads   number of training threads (0 to detect).
+     * @param cancellation  checked after every epoch - cancelled model is kept untrained.
+     */
+    void train(
+            const std::vector<float>& features,
+            const std::vector<float>& labels,
+            int epochs,
+            double learningRate,
+            unsigned threads=0,
+            const CancellationToken* cancellation=nullptr);
+
+    /**
+     * @brief Score batch of pairs - count * INPUTS features to count scores.
+     */
+    void score(const float* features, size_t count, float* scores) const;
+    float score(const float* features) const {
+        float result;
+        score(features, 1, &result);
+        return result;
+    }
+
+    /**
+     * @brief Save trained model to file w/ fingerprint of training data.
+     */
+    bool save(const std::string& path, uint64_t fingerprint) const;
+
+    /**
+     * @brief Load model from file - model is kept untrained if file is not valid model,
+     * it has different format version or it was trained on data w/ different fingerprint.
+     */
+    bool load(const std::string& path, uint64_t fingerprint);
+
+    void clear();
+
+private:
+    static void trainShard(
+            genann* shardAnn,
+            const std::vector<float>& features,
+            const std::vector<float>& labels,
+            const std::vector<size_t>& order,
+            size_t begin,
+            size_t end,
+            double learningRate);
 };
 
 }
@@ -61,6 +61,11 @@ public:
 
     void clearFeatures();
 
+    /**
+     * @brief Get features as FEATURES_SIZE floats to be passed to NN.
+     */
+    const float* getFeatures() const { return features; }
+
     void setHaveMutualRel(bool haveRel) {
         features[IDX_HAVE_MUTUAL_REL] = haveRel?1.f:0.f;
     }
@@ -24,7 +24,8 @@ using namespace std;
 
 Ai::Ai(Memory& memory, Mind& mind)
 #ifdef MF_NER
-    : ner{}
+    : ner{},
+      nerCancellation{}
 #endif
 {
     switch(Configuration::getInstance().getAaAlgorithm()) {
@@ -50,11 +51,4 @@ Ai::~Ai()
     if(aa) delete aa;
 }
 
-void Ai::trainAaNn()
-{
-    MF_DEBUG("AI: training AA NN..." << endl);
-    // TODO train NN using a reasonable number of features: createAaFeature()
-    MF_DEBUG("AI: AA NN trained!" << endl);
-}
-
 } // m8r namespace
@@ -21,11 +21,13 @@
 
 #include <vector>
 #include <future>
+#include <memory>
 #include <mutex>
 
 #include "../mind.h"
 #include "../../model/outline.h"
 #include "../memory.h"
+#include "../../gear/cancellation_token.h"
 #include "./aa_model.h"
 #include "./ai_aa_weighted_fts.h"
 #include "./ai_aa_bow.h"
@@ -59,7 +61,7 @@ namespace m8r {
  *     V
  *  THINKING
  *     |
- *   amnesia(), sleep() ... if no computation is in progress
+ *   amnesia(), sleep() ... running computations (dreaming included) are interrupted
  *     |
  *     V
  *  SLEEPING
@@ -82,13 +84,15 @@ private:
      */
 
     NamedEntityRecognition ner;
+    // running batch recognition - accessed using atomic_load()/atomic_store() only
+    std::shared_ptr<CancellationToken> nerCancellation;
 #endif
 
     /*
      * Neural network models
      */
 
-    // TODO AssociationAssessmentModel* aaModel;
+    // AA NN model (AssociationAssessmentModel) is owned, trained and used by BoW AA
 
 public:
     explicit Ai(Memory& memory, Mind& mind);
@@ -119,6 +123,15 @@ public:
         return aa->getAssociatedNotes(note, associations);
     }
 
+    /**
+     * @brief Get cached Note associations.
+     *
+     * NOT synchronized by caller - reads published AI snapshot.
+     */
+    bool getCachedAssociatedNotes(const Note* note, std::vector<std::pair<Note*,float>>& associations) const {
+        return aa->getCachedAssociatedNotes(note, associations);
+    }
+
     std::shared_future<bool> getAssociatedNotes(Outline* outline, std::vector<std::pair<Note*,float>>& associations) {
         return aa->getAssociatedNotes(outline, associations);
     }
@@ -136,10 +149,34 @@ public:
     void recognizePersons(const Outline* outline, int entityFilter, std::vector<NerNamedEntity>& result) {
         ner.recognizePersons(outline, entityFilter, result);
     }
+
+    /**
+     * @brief Recognize named entities in Os (batch).
+     */
+    void recognizeEntities(const std::vector<Outline*>& outlines, int entityFilter, std::vector<NerNamedEntity>& result) {
+        std::shared_ptr<CancellationToken> cancellation = std::make_shared<CancellationToken>();
+        std::atomic_store(&nerCancellation, cancellation);
+        ner.recognizeEntities(outlines, entityFilter, result, cancellation.get());
+    }
+#endif
+
+    /**
+     * @brief Interrupt running computations (dreaming, associations, NER).
+     *
+     * NOT synchronized by caller - used to stop computation which blocks Mind.
+     */
+    void interrupt() {
+        aa->interrupt();
+#ifdef MF_NER
+        std::shared_ptr<CancellationToken> cancellation = std::atomic_load(&nerCancellation);
+        if(cancellation) {
+            cancellation->cancel();
+        }
 #endif
+    }
 
     /**
-     * @brief Clear, but don't deallocate.
+     * @brief Clear, but don't deallocate - running computations are interrupted.
      *
      * Synchronized by caller ~ Mind.
      */
@@ -156,12 +193,9 @@ public:
         return aa->amnesia();
     }
 
-private:
-
-    /**
-     * @brief Train associations assessment neural network once memory is learned.
-     */
-    void trainAaNn();
+    std::shared_ptr<const BagOfWords> getBagOfWords() const {
+        return aa->getBagOfWords();
+    }
 
 public:
 #ifdef DO_MF_DEBUG
@@ -20,12 +20,15 @@
 #define M8R_AI_ASSOCIATIONS_ASSESSMENT_H
 
 #include <future>
+#include <memory>
 #include <vector>
 
 #include "../../model/outline.h"
 
 namespace m8r {
 
+class BagOfWords;
+
 /**
  * @brief Asssociations assessment interface.
  *
@@ -74,7 +77,16 @@ public:
     virtual std::shared_future<bool> getAssociatedNotes(const std::string& words, std::vector<std::pair<Note*,float>>& associations, const Note* self) = 0;
 
     /**
-     * @brief Clear.
+     * @brief Ask running computations (dreaming, associations) to stop ASAP.
+     *
+     * Lock-free - can be called w/o Mind synchronization e.g. to interrupt
+     * an assessment which blocks Mind. Superseded/interrupted computations
+     * finish w/ false future.
+     */
+    virtual void interrupt() {}
+
+    /**
+     * @brief Clear - running computations are interrupted and awaited.
      */
     virtual bool sleep() = 0;
 
@@ -82,6 +94,23 @@ public:
      * @brief Forget everything.
      */
     virtual bool amnesia() = 0;
+
+    /**
+     * @brief Get BoW if AA implementation builds it, nullptr otherwise.
+     */
+    virtual std::shared_ptr<const BagOfWords> getBagOfWords() const { return nullptr; }
+
+    /**
+     * @brief Get associated Notes if they are immediately available (lock-free).
+     *
+     * Can be called w/o Mind synchronization - false is returned if associations
+     * are not cached (use getAssociatedNotes() then).
+     */
+    virtual bool getCachedAssociatedNotes(const Note* note, std::vector<std::pair<Note*,float>>& associations) const {
+        UNUSED_ARG(note);
+        UNUSED_ARG(associations);
+        return false;
+    }
 };
 
 }
@@ -17,22 +17,46 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "ai_aa_bow.h"
+#include "../../gear/tracer.h"
 
 namespace m8r {
 
 using namespace std;
 
+constexpr size_t AiAaBoW::AA_CANCELLATION_STRIDE;
+
+AiAaBoW::Generation::Generation(unsigned long epoch, CommonWordsBlacklist& blacklist)
+    : epoch{epoch},
+      lexicon{},
+      tokenizer{lexicon,blacklist},
+      bow{},
+      notes{},
+      offsets{},
+      aaModel{},
+      aaMatrix{},
+      leaderboards{make_shared<const Leaderboards>()},
+      leaderboardWip{}
+{
+}
+
 AiAaBoW::AiAaBoW(Memory& memory, Mind& mind)
     : mind(mind),
       memory(memory),
-      lexicon{},
       wordBlacklist{},
-      tokenizer{lexicon,wordBlacklist}
+      generation{},
+      epoch{0},
+      dreamCancellation{},
+      leaderboardCancellationsMutex{},
+      leaderboardCancellations{},
+      busyWorkers{0}
 {
 }
 
 AiAaBoW::~AiAaBoW()
 {
+    interrupt();
+    awaitWorkers();
+
     // delete dead threads
     auto zombieIterator
         = std::remove_if(runningWorkers.begin(),
@@ -41,7 +65,7 @@ AiAaBoW::~AiAaBoW()
     runningWorkers.erase(zombieIterator, runningWorkers.end());
 }
 
-void AiAaBoW::addWorkerAndCleanZombies(thread* t)
+void AiAaBoW::addWorkerAndCleanZombies(thread* t, const function<void()>& task)
 {
     lock_guard<mutex> criticalSection{runningWorkersMutex};
     MF_DEBUG("AA.BoW: workers+zombies " << runningWorkers.size() << endl);
@@ -53,181 +77,464 @@ void AiAaBoW::addWorkerAndCleanZombies(thread* t)
 
     // add new one
     runningWorkers.push_back(t);
+    busyWorkers++;
+    // worker detaches itself under this lock, therefore it's assigned first
+    *t = thread(task);
 
     MF_DEBUG("AA.BoW: workers " << runningWorkers.size() << endl);
 }
 
+void AiAaBoW::workerFinished(thread* t)
+{
+    lock_guard<mutex> criticalSection{runningWorkersMutex};
+    t->detach(); // indicate that thread finished
+    busyWorkers--;
+    workersFinished.notify_all();
+}
+
+void AiAaBoW::awaitWorkers()
+{
+    unique_lock<mutex> criticalSection{runningWorkersMutex};
+    workersFinished.wait(criticalSection, [this]() { return !busyWorkers; });
+}
+
+void AiAaBoW::interrupt()
+{
+    shared_ptr<CancellationToken> cancellation = atomic_load(&dreamCancellation);
+    if(cancellation) {
+        cancellation->cancel();
+    }
+
+    lock_guard<mutex> criticalSection{leaderboardCancellationsMutex};
+    for(auto& c:leaderboardCancellations) {
+        c.second->cancel();
+    }
+}
+
 // it's presumed that caller ensures the correct Mind state & synchronization
 shared_future<bool> AiAaBoW::dream() {
+    shared_ptr<CancellationToken> cancellation = make_shared<CancellationToken>();
+    atomic_store(&dreamCancellation, cancellation);
+
     if(memory.getNotesCount() > Configuration::getInstance().getAsyncMindThreshold()) {
         MF_DEBUG("AA.BoW: ASYNC dream..." << endl);
         mind.incActiveProcesses();
 
-        // packaged task is parametrized by function/method signature (not return type)
-        std::packaged_task<bool (AiAaBoW*,thread*)> learnMemoryTask([](AiAaBoW* a,thread* t) { return a->learnMemorySync(t); });
-        future<bool> result = learnMemoryTask.get_future(); // move
+        // worker is registered before it starts and finishes once result is set so that it can be awaited
+        shared_ptr<promise<bool>> learned = make_shared<promise<bool>>();
+        future<bool> result = learned->get_future(); // move
         thread* t = new thread{};
-        *t = thread(std::move(learnMemoryTask), this, t);
-        addWorkerAndCleanZombies(t);
+        addWorkerAndCleanZombies(t, [this, cancellation, learned, t]() {
+            learned->set_value(learnMemorySync(cancellation, t));
+            workerFinished(t);
+        });
 
         return shared_future<bool>(std::move(result));
     } else {
         MF_DEBUG("AA.BoW: SYNC dream..." << endl);
         promise<bool> p{};
-        bool status = learnMemorySync();
+        bool status = learnMemorySync(cancellation);
         p.set_value(status);
 
-        mind.persistMindState(Configuration::MindState::THINKING);
+        if(status) {
+            mind.persistMindState(Configuration::MindState::THINKING);
+        }
 
         return shared_future<bool>(p.get_future());
     }
 }
 
-bool AiAaBoW::learnMemorySync(thread* t)
+bool AiAaBoW::learnMemorySync(shared_ptr<CancellationToken> cancellation, thread* t)
 {
+    MF_TRACE_SPAN("aa", "dream");
     MF_DEBUG("AA.BoW: LEARNING memory to BoW..." << endl);
-    notes.clear();
-    memory.getAllNotes(notes);
-    // let N know it's indexed in AI
-    for(size_t i=0; i<notes.size(); i++) {
-        notes[i]->setAiAaMatrixIndex(static_cast<int>(i));
+
+    // new generation is built aside - readers keep using the published one
+    shared_ptr<Generation> g = make_shared<Generation>(++epoch, wordBlacklist);
+    memory.getAllNotes(g->notes);
+    g->offsets.reserve(g->notes.size());
+    for(size_t i=0; i<g->notes.size(); i++) {
+        g->offsets[g->notes[i]] = i;
     }
 
     // build lexicon and BoW
-    lexicon.clear();
-    bow.clear();
-    for(Note* n:notes) {
-        NoteCharProvider chars{n};
-        WordFrequencyList* wfl = new WordFrequencyList{&lexicon};
-        tokenizer.tokenize(chars, *wfl);
-        bow.add(n, wfl);
-    }
-    // prepare DATA to quickly create association assessment features
-    lexicon.recalculateWeights();
-    bow.reorderDocVectorsByWeight();
+    for(Note* n:g->notes) {
+        if(cancellation->isCancelled()) {
+            break;
+        }
+        WordFrequencyList* wfl = new WordFrequencyList{&g->lexicon};
+        g->tokenizer.tokenize(n, *wfl);
+        g->bow.add(n, wfl);
+    }
+
+    if(!cancellation->isCancelled()) {
+        // prepare DATA to quickly create association assessment features
+        g->lexicon.recalculateWeights();
+        g->bow.reorderDocVectorsByWeight();
 
 #ifdef DO_MF_DEBUG
-    lexicon.print();
-    bow.print();
+        g->lexicon.print();
+        g->bow.print();
 #endif
 
-    // AA to be built incrementally - just initialize it
-    if(notes.size() != aaMatrix.size()) {
-        aaMatrix.clear();
-        aaMatrix.resize(notes.size());
-        for(size_t i=0; i<aaMatrix.size(); ++i) {
-            aaMatrix[i].resize(aaMatrix.size(),(float)AiAaBoW::AA_NOT_SET); // C++ :-Z constexpr w/ internal linkage does NOT have to be solved in compile time > workaround via temporary var
+        // AA to be built incrementally - just initialize it
+        g->aaMatrix.resize(g->notes.size());
+        for(size_t i=0; i<g->aaMatrix.size(); ++i) {
+            g->aaMatrix[i].resize(g->aaMatrix.size(),(float)AiAaBoW::AA_NOT_SET); // C++ :-Z constexpr w/ internal linkage does NOT have to be solved in compile time > workaround via temporary var
         }
+
+        // NN scores AA features once trained
+        trainAaModel(*g, *cancellation);
+    }
+
+    // interrupted dream is dropped - Mind which interrupted it goes asleep
+    bool learned = !cancellation->isCancelled();
+    if(learned) {
+        publish(g);
+        MF_DEBUG("AA.BoW: generation " << g->epoch << " published" << endl);
+
+        mind.persistMindState(Configuration::MindState::THINKING);
+        MF_DEBUG("AA.BoW: memory LEARNED!" << endl);
     } else {
-        for(size_t i=0; i<aaMatrix.size(); ++i) {
-            std::fill(aaMatrix[i].begin(), aaMatrix[i].end(), (float)AiAaBoW::AA_NOT_SET); // C++ :-Z constexpr w/ internal linkage does NOT have to be solved in compile time > workaround via temporary var
-        }
+        MF_DEBUG("AA.BoW: dreaming of generation " << g->epoch << " INTERRUPTED" << endl);
     }
 
-    // NN to be trained on demand - just initialize it
+    if(t) {
+        // only ASYNC dream is counted as active process
+        mind.decActiveProcesses();
+    }
+    return learned;
+}
 
-    mind.persistMindState(Configuration::MindState::THINKING);
-    mind.decActiveProcesses();
-    if(t) t->detach(); // indicate that thread finished
+shared_ptr<const BagOfWords> AiAaBoW::getBagOfWords() const
+{
+    shared_ptr<Generation> g = snapshot();
+    if(g) {
+        // aliasing constructor ~ BoW keeps whole generation alive
+        return shared_ptr<const BagOfWords>(g, &g->bow);
+    }
+    return nullptr;
+}
 
-    MF_DEBUG("AA.BoW: memory LEARNED!" << endl);
-    return true;
+bool AiAaBoW::getCachedAssociatedNotes(const Note* note, vector<pair<Note*,float>>& associations) const
+{
+    shared_ptr<Generation> g = snapshot();
+    if(g) {
+        shared_ptr<const Leaderboards> leaderboards = atomic_load(&g->leaderboards);
+        auto cachedLeaderboard = leaderboards->find(note);
+        if(cachedLeaderboard != leaderboards->end()) {
+            // copy leaderboard to ENSURE it's validity even if Mind/AI will be cleared/asleep/...
+            associations.insert(associations.end(), cachedLeaderboard->second.begin(), cachedLeaderboard->second.end());
+            return true;
+        }
+    }
+    return false;
+}
+
+void AiAaBoW::publishLeaderboard(Generation& g, const Note* n, const vector<pair<Note*,float>>& leaderboard)
+{
+    lock_guard<mutex> criticalSection{g.leaderboardsMutex};
+
+    // copy-on-write: readers holding previous leaderboards are not affected
+    shared_ptr<Leaderboards> leaderboards = make_shared<Leaderboards>(*g.leaderboards);
+    (*leaderboards)[n] = leaderboard;
+    atomic_store(&g.leaderboards, shared_ptr<const Leaderboards>(leaderboards));
+    g.leaderboardWip.erase(n);
 }
 
 // it's presumed that caller ensures the correct Mind state & synchronization
 shared_future<bool> AiAaBoW::getAssociatedNotes(const Note* note, vector<pair<Note*,float>>& associations) {
-    auto cachedLeaderboard = leaderboardCache.find(note);
-    if(cachedLeaderboard != leaderboardCache.end()) {
+    if(getCachedAssociatedNotes(note, associations)) {
         MF_DEBUG("AA.BoW: SYNC leaderboard calculation for '" << note->getName() << "'" << endl);
-        // copy leaderboard to ENSURE it's validity even if Mind/AI will be cleared/asleep/...
-        for(auto p:cachedLeaderboard->second) {
-            associations.push_back(p);
-        }
         // indicate that it's immediately available
         promise<bool> p{};
         p.set_value(true);
         return shared_future<bool>(p.get_future());
-    } else {        
-        MF_DEBUG("AA.BoW: ASYNC leaderboard calculation for '" << note->getName() << "'" << endl);
-        if(leaderboardWip.find(note) != leaderboardWip.end()) {
-            // calculation WIP & future OWNER will update what needs to be updated -> intentionally NOT sharing futures
-            promise<bool> p{};
-            p.set_value(false);
-            MF_DEBUG("AA.BoW: leaderboard WIP for '" << note->getName() << "'" << endl);
-            return p.get_future(); // move
-        } else {
-            mind.incActiveProcesses();
-            MF_DEBUG("AA.BoW: starting THREAD for '" << note->getName() << "'" << endl);
+    }
 
-            // packaged task is parametrized by function/method signature (not return type)
-            packaged_task<bool (AiAaBoW*,const Note*,thread*)> calculateLeaderboardTask([](AiAaBoW* a, const Note* n, thread* t) { return a->calculateLeaderboardSync(n,t); });
-            future<bool> result = calculateLeaderboardTask.get_future(); // move
-            thread* t = new thread{};
-            *t = thread(std::move(calculateLeaderboardTask), this, note, t); // run task w/ handle to self thread
-            addWorkerAndCleanZombies(t);
+    shared_ptr<Generation> g = snapshot();
+    if(!g) {
+        promise<bool> p{};
+        p.set_value(false);
+        return shared_future<bool>(p.get_future());
+    }
+
+    MF_DEBUG("AA.BoW: ASYNC leaderboard calculation for '" << note->getName() << "'" << endl);
+    // worker is registered before it starts and finishes once result is set so that it can be awaited
+    shared_ptr<promise<bool>> calculated = make_shared<promise<bool>>();
+    shared_future<bool> result = calculated->get_future().share();
+    {
+        lock_guard<mutex> criticalSection{g->leaderboardsMutex};
+        auto wip = g->leaderboardWip.find(note);
+        if(wip != g->leaderboardWip.end()) {
+            // calculation WIP - caller shares future of its OWNER (and doesn't supersede it)
+            MF_DEBUG("AA.BoW: leaderboard WIP for '" << note->getName() << "'" << endl);
+            return wip->second;
+        }
+        g->leaderboardWip[note] = result;
+    }
 
-            return shared_future<bool>(std::move(result));
+    // user moved on ~ calculation of the previous leaderboard of the caller is superseded
+    shared_ptr<CancellationToken> cancellation = make_shared<CancellationToken>();
+    thread::id caller = this_thread::get_id();
+    {
+        lock_guard<mutex> criticalSection{leaderboardCancellationsMutex};
+        shared_ptr<CancellationToken>& callerCancellation = leaderboardCancellations[caller];
+        if(callerCancellation) {
+            callerCancellation->cancel();
         }
+        callerCancellation = cancellation;
     }
+
+    mind.incActiveProcesses();
+    MF_DEBUG("AA.BoW: starting THREAD for '" << note->getName() << "'" << endl);
+
+    thread* t = new thread{};
+    // run task w/ handle to self thread
+    addWorkerAndCleanZombies(t, [this, g, note, caller, cancellation, calculated, t]() {
+        bool leaderboardCalculated = calculateLeaderboardSync(g, note, cancellation, t);
+        {
+            lock_guard<mutex> criticalSection{leaderboardCancellationsMutex};
+            auto callerCancellation = leaderboardCancellations.find(caller);
+            if(callerCancellation != leaderboardCancellations.end() && callerCancellation->second == cancellation) {
+                leaderboardCancellations.erase(callerCancellation);
+            }
+        }
+        calculated->set_value(leaderboardCalculated);
+        workerFinished(t);
+    });
+
+    return result;
 }
 
 // Pre-calculate/calculate code CANNOT be reused as pre-calculate relies on rows w/ lower index
 // to fill the beginning of the line.
 // This is a private method called from AI ~ AI state/async/critical sections handled by caller.
-void AiAaBoW::calculateAaRow(size_t y)
+bool AiAaBoW::calculateAaRow(Generation& g, size_t y, const CancellationToken& cancellation)
 {
     MF_DEBUG("AA.BoW: Calculating AA row " << y << "..." << endl);
     // calculate row and column that cross diagonal on [y][y]
 
     // check diagonal to find out whether the cross has been already calculated
-    if(aaMatrix[y][y] == 1.f) {
-        return;
+    if(g.aaMatrix[y][y] == 1.f) {
+        return true;
     }
 
-    float aa;
     AssociationAssessmentNotesFeature aaFeature{};
+    // features of the whole row are scored by NN in a single batch
+    vector<size_t> columns{};
+    vector<float> batch{};
+    vector<float> scores{};
+
+    bool cancelled = false;
+    for(size_t x=0; x<g.aaMatrix.size(); x++) {
+        // rankings calculated so far are stored and reused by the next calculation
+        if(!((x+1)%AA_CANCELLATION_STRIDE) && cancellation.isCancelled()) {
+            cancelled = true;
+            break;
+        }
 
-    notes[y]->setAiAaMatrixIndex(y);
-    for(size_t x=0; x<aaMatrix.size(); x++) {
         // set diagonal at the end
         if(x!=y) {
             // skip if value has been already calculated
-            if(aaMatrix[y][x] == AA_NOT_SET) {
-                Note* n1 = notes[x];
-                Note* n2 = notes[y];
-
-                aaFeature.setHaveMutualRel(false); // TODO
-                aaFeature.setTypeMatches(n1->getType()==n2->getType());
-                aaFeature.setSimilaritySameOutline(n1->getOutline()==n2->getOutline());
-                aaFeature.setSimilarityByTags(calculateSimilarityByTags(n1->getTags(),n2->getTags()));
-                aaFeature.setSimilarityByTitles(calculateSimilarityByTitles(n1->getName(),n2->getName()));
-                aaFeature.setSimilarityByDescription(calculateSimilarityByWords(*bow.get(n1),*bow.get(n2),AA_WORD_RELEVANCY_THRESHOLD));
-                aaFeature.setSimilarityBySameTargetRels(0.0); // TODO nice
-
-                aa = aaFeature.areNotesAssociatedMetric();
-
-                // set AA ranking both below and above diagonal - detection will be faster later (no check x>y needed)
-                aaMatrix[x][y] = aa;
-                aaMatrix[y][x] = aa;
+            if(g.aaMatrix[y][x] == AA_NOT_SET) {
+                calculateAaFeature(g, g.notes[x], g.notes[y], aaFeature);
+
+                columns.push_back(x);
+                if(g.aaModel.isTrained()) {
+                    batch.insert(
+                        batch.end(),
+                        aaFeature.getFeatures(),
+                        aaFeature.getFeatures()+AssociationAssessmentNotesFeature::FEATURES_SIZE);
+                } else {
+                    scores.push_back(aaFeature.areNotesAssociatedMetric());
+                }
             }
         }
     }
+    if(g.aaModel.isTrained()) {
+        scores.resize(columns.size());
+        g.aaModel.score(batch.data(), columns.size(), scores.data());
+    }
+
+    for(size_t i=0; i<columns.size(); i++) {
+        // set AA ranking both below and above diagonal - detection will be faster later (no check x>y needed)
+        g.aaMatrix[columns[i]][y] = scores[i];
+        g.aaMatrix[y][columns[i]] = scores[i];
+    }
+
+    if(cancelled) {
+        MF_DEBUG("AA.BoW: AA row " << y << " calculation INTERRUPTED" << endl);
+        return false;
+    }
 
     // set diagonal at the end to indicate calculation is done (consider reentrancy)
-    aaMatrix[y][y] = 1.;
+    g.aaMatrix[y][y] = 1.;
 
 #ifdef DO_MF_DEBUG
     MF_DEBUG("AA.BoW: AA row calculated!" << endl);
     //printAa();
     //assertAaSymmetry();
 #endif
+    return true;
+}
+
+void AiAaBoW::calculateAaFeature(Generation& g, Note* n1, Note* n2, AssociationAssessmentNotesFeature& aaFeature)
+{
+    aaFeature.setHaveMutualRel(false); // TODO
+    aaFeature.setTypeMatches(n1->getType()==n2->getType());
+    aaFeature.setSimilaritySameOutline(n1->getOutline()==n2->getOutline());
+    aaFeature.setSimilarityByTags(calculateSimilarityByTags(n1->getTags(),n2->getTags()));
+    aaFeature.setSimilarityByTitles(calculateSimilarityByTitles(g,n1->getName(),n2->getName()));
+    aaFeature.setSimilarityByDescription(calculateSimilarityByWords(g,*g.bow.get(n1),*g.bow.get(n2),AA_WORD_RELEVANCY_THRESHOLD));
+    aaFeature.setSimilarityBySameTargetRels(0.0); // TODO nice
+}
+
+// This is a private method called from AI ~ AI state/async/critical sections handled by caller.
+void AiAaBoW::trainAaModel(Generation& g, const CancellationToken& cancellation)
+{
+    // model is persisted only in MindForger repository mind directory
+    string modelPath{};
+    uint64_t fingerprint = 0;
+    const string& mindPath = Configuration::getInstance().getMindPath();
+    if(!mindPath.empty() && isDirectory(mindPath.c_str())) {
+        modelPath += mindPath;
+        modelPath += FILE_PATH_SEPARATOR;
+        modelPath += FILENAME_MIND_AA_NN_MODEL;
+
+        fingerprint = calculateAaModelFingerprint(g);
+        if(g.aaModel.load(modelPath, fingerprint)) {
+            return;
+        }
+    }
+
+    vector<float> features{};
+    vector<float> labels{};
+    mineAaTrainingPairs(g, features, labels, cancellation);
+    g.aaModel.train(features, labels, AA_NN_EPOCHS, AA_NN_LEARNING_RATE, 0, &cancellation);
+
+    if(g.aaModel.isTrained() && !modelPath.empty()) {
+        g.aaModel.save(modelPath, fingerprint);
+    }
+}
+
+namespace {
+
+// 64-bit FNV-1a
+inline void fingerprintBytes(uint64_t& h, const void* data, size_t size)
+{
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for(size_t i=0; i<size; i++) {
+        h ^= bytes[i];
+        h *= 1099511628211ULL;
+    }
+}
+
+inline void fingerprintString(uint64_t& h, const string& s)
+{
+    fingerprintBytes(h, s.data(), s.size()+1);
+}
+
+} // anonymous namespace
+
+uint64_t AiAaBoW::calculateAaModelFingerprint(Generation& g) const
+{
+    uint64_t h = 14695981039346656037ULL;
+
+    // model format and feature layout
+    const int layout[] = {
+        AssociationAssessmentModel::FORMAT_VERSION,
+        AssociationAssessmentModel::INPUTS,
+        AssociationAssessmentModel::HIDDEN,
+        AA_WORD_RELEVANCY_THRESHOLD
+    };
+    fingerprintBytes(h, layout, sizeof(layout));
+    const float titleWordBonus = AA_TITLE_WORD_BONUS;
+    fingerprintBytes(h, &titleWordBonus, sizeof(titleWordBonus));
+    // vocabulary - lexicon is ordered by word, therefore it doesn't depend on Ns learning order
+    for(auto& w:g.lexicon.get()) {
+        fingerprintString(h, w.first);
+    }
+
+    return h;
 }
 
 // This is a private method called from AI ~ AI state/async/critical sections handled by caller.
-void AiAaBoW::precalculateAa()
+void AiAaBoW::mineAaTrainingPairs(Generation& g, vector<float>& features, vector<float>& labels, const CancellationToken& cancellation)
+{
+    features.clear();
+    labels.clear();
+
+    AssociationAssessmentNotesFeature aaFeature{};
+    auto addPair = [&](Note* n1, Note* n2, float label) {
+        calculateAaFeature(g, n1, n2, aaFeature);
+        features.insert(
+            features.end(),
+            aaFeature.getFeatures(),
+            aaFeature.getFeatures()+AssociationAssessmentNotesFeature::FEATURES_SIZE);
+        labels.push_back(label);
+    };
+
+    // associated: N and its direct children
+    map<const Note*,const Note*> parents{};
+    vector<Note*> children{};
+    size_t positives = 0;
+    for(Note* n:g.notes) {
+        if(cancellation.isCancelled()) {
+            features.clear();
+            labels.clear();
+            return;
+        }
+        children.clear();
+        n->getOutline()->getDirectNoteChildren(n, children);
+        for(Note* c:children) {
+            parents[c] = n;
+            if(positives < AA_NN_MAX_POSITIVE_PAIRS) {
+                addPair(n, c, 1.f);
+                positives++;
+            }
+        }
+    }
+    if(positives < AA_NN_MIN_POSITIVE_PAIRS) {
+        MF_DEBUG("AA.BoW: too few associated N pairs to train NN: " << positives << endl);
+        features.clear();
+        labels.clear();
+        return;
+    }
+
+    // not associated: balanced mix of random Ns from the same O and from different Os (fixed seed ~ reproducible)
+    mt19937 generator{2020};
+    uniform_int_distribution<size_t> anyNote{0, g.notes.size()-1};
+    size_t negatives = 0;
+    for(size_t attempt=0; negatives<positives && attempt<4*positives; attempt++) {
+        Note* n1 = g.notes[anyNote(generator)];
+        Note* n2;
+        bool sameOutline = negatives%2;
+        if(sameOutline) {
+            const vector<Note*>& outlineNotes = n1->getOutline()->getNotes();
+            n2 = outlineNotes[generator()%outlineNotes.size()];
+        } else {
+            n2 = g.notes[anyNote(generator)];
+            if(n1->getOutline() == n2->getOutline()) {
+                continue;
+            }
+        }
+
+        if(n1 == n2 || parents[n1] == n2 || parents[n2] == n1) {
+            continue;
+        }
+        addPair(n1, n2, 0.f);
+        negatives++;
+    }
+
+    MF_DEBUG("AA.BoW: mined " << positives << " associated and " << negatives << " not associated N pairs" << endl);
+}
+
+// This is a private method called from AI ~ AI state/async/critical sections handled by caller.
+void AiAaBoW::precalculateAa(Generation& g)
 {
 #ifdef DO_MF_DEBUG
-    static const float UNIQUE_AA_CELLS = (float)(notes.size()*notes.size()/2.+notes.size()/2.);
+    static const float UNIQUE_AA_CELLS = (float)(g.notes.size()*g.notes.size()/2.+g.notes.size()/2.);
     MF_DEBUG("  Building AA matrix w/ " << UNIQUE_AA_CELLS << " UNIQUE rankings..." << endl);
     float c=0;
     float p;
@@ -236,39 +543,29 @@ void AiAaBoW::precalculateAa()
     // calculate FULL matrix of Ns associativity assessment for every N1 and N2 tuple
     float aa;
     AssociationAssessmentNotesFeature aaFeature{};
-    for(size_t y=0; y<aaMatrix.size(); y++) {
-        notes[y]->setAiAaMatrixIndex(y); // sets index for ALL notes in notes vector
-
+    for(size_t y=0; y<g.aaMatrix.size(); y++) {
 #ifdef DO_MF_DEBUG
         p = c/(UNIQUE_AA_CELLS/100.);
-        MF_DEBUG("    " << (int)p << "% AA matrix rankings for '" << notes[y]->getName() << "'" << endl);
+        MF_DEBUG("    " << (int)p << "% AA matrix rankings for '" << g.notes[y]->getName() << "'" << endl);
 #endif
 
         // calculate only values ABOVE diagonal i.e. initialize x=y
-        for(size_t x=y; x<aaMatrix.size(); x++) {
+        for(size_t x=y; x<g.aaMatrix.size(); x++) {
 #ifdef DO_MF_DEBUG
             c++;
 #endif
 
             if(x==y) {
-                aaMatrix[x][y] = 1.;
+                g.aaMatrix[x][y] = 1.;
             } else {
-                Note* n1 = notes[x];
-                Note* n2 = notes[y];
-
-                aaFeature.setHaveMutualRel(false); // TODO
-                aaFeature.setTypeMatches(n1->getType()==n2->getType());
-                aaFeature.setSimilaritySameOutline(n1->getOutline()==n2->getOutline());
-                aaFeature.setSimilarityByTags(calculateSimilarityByTags(n1->getTags(),n2->getTags()));
-                aaFeature.setSimilarityByTitles(calculateSimilarityByTitles(n1->getName(),n2->getName()));
-                aaFeature.setSimilarityByDescription(calculateSimilarityByWords(*bow.get(n1),*bow.get(n2),AA_WORD_RELEVANCY_THRESHOLD));
-                aaFeature.setSimilarityBySameTargetRels(0.0); // TODO nice
-
-                aa = aaFeature.areNotesAssociatedMetric();
+                calculateAaFeature(g, g.notes[x], g.notes[y], aaFeature);
+                aa = g.aaModel.isTrained()
+                    ? g.aaModel.score(aaFeature.getFeatures())
+                    : aaFeature.areNotesAssociatedMetric();
 
                 // set AA ranking both below and above diagonal - detection will be faster later (no check x>y needed)
-                aaMatrix[x][y] = aa;
-                aaMatrix[y][x] = aa;
+                g.aaMatrix[x][y] = aa;
+                g.aaMatrix[y][x] = aa;
             }
         }
     }
@@ -276,25 +573,24 @@ void AiAaBoW::precalculateAa()
 #ifdef DO_MF_DEBUG
     MF_DEBUG("  AA matrix built!" << endl);
     //printAa();
-    assertAaSymmetry();
+    assertAaSymmetry(g);
 #endif
 }
 
-float AiAaBoW::calculateSimilarityByTitles(const string& t1, const string& t2)
+float AiAaBoW::calculateSimilarityByTitles(Generation& g, const string& t1, const string& t2)
 {
-    StringCharProvider cp1{t1};
-    WordFrequencyList v1{&lexicon};
-    tokenizer.tokenize(cp1, v1, false, true, false);
-    StringCharProvider cp2{t2};
-    WordFrequencyList v2{&lexicon};
-    tokenizer.tokenize(cp2, v2, false, true, false);
+    // tokenization adds title words to lexicon - caller holds AA mutex of published generation
+    WordFrequencyList v1{&g.lexicon};
+    g.tokenizer.tokenize(t1, v1, false, true, false);
+    WordFrequencyList v2{&g.lexicon};
+    g.tokenizer.tokenize(t2, v2, false, true, false);
 
     // calculate overlap
     if(!v1.size() || !v2.size()) {
         return 0.;
     } else {
         // direct access for efficiency
-        WordFrequencyList intersection{&lexicon};
+        WordFrequencyList intersection{&g.lexicon};
         float iWeight=0, uWeight=0;
 
         for(auto& e:v1.iterable()) {
@@ -363,13 +659,13 @@ float AiAaBoW::calculateSimilarityByTags(const vector<const Tag*>* t1, const vec
 }
 
 // consider ONLY most valuable words via threshold - many irrelevat words would kill the score (irrelevant words make noise)
-float AiAaBoW::calculateSimilarityByWords(WordFrequencyList& v1, WordFrequencyList& v2, int threshold)
+float AiAaBoW::calculateSimilarityByWords(Generation& g, WordFrequencyList& v1, WordFrequencyList& v2, int threshold)
 {
     if(!v1.size() || !v2.size()) {
         return 0.;
     } else {
         // direct access for efficiency
-        WordFrequencyList intersection{&lexicon};
+        WordFrequencyList intersection{&g.lexicon};
         float iWeight=0, uWeight=0;
         int t=0;
 
@@ -377,7 +673,7 @@ float AiAaBoW::calculateSimilarityByWords(WordFrequencyList& v1, WordFrequencyLi
         for(auto& e:v1.iterable()) {
             if(t++>=threshold) break;
 
-            float w = lexicon.get(e.first)->weight;
+            float w = g.lexicon.get(e.first)->weight;
             uWeight += w;
             if(v2.contains(e.first)) {
                 iWeight += w;
@@ -393,7 +689,7 @@ float AiAaBoW::calculateSimilarityByWords(WordFrequencyList& v1, WordFrequencyLi
             if(++t>=threshold) break;
 
             if(!intersection.contains(e.first)) {
-                float w = lexicon.get(e.first)->weight;
+                float w = g.lexicon.get(e.first)->weight;
                 uWeight += w;
                 if(v1.contains(e.first)) {
                     iWeight += w;
@@ -409,99 +705,111 @@ float AiAaBoW::calculateSimilarityByWords(WordFrequencyList& v1, WordFrequencyLi
     }
 }
 
-bool AiAaBoW::calculateLeaderboardSync(const Note* n, thread* t)
+bool AiAaBoW::calculateLeaderboardSync(
+        shared_ptr<Generation> g,
+        const Note* n,
+        shared_ptr<CancellationToken> cancellation,
+        thread* t)
 {
+    MF_TRACE_SPAN("aa", "leaderboard");
     MF_DEBUG("AA.BoW: SYNC leaderboard calculation for '" << n->getName() << "' in thread " << t << endl);
 
     // If N was REMOVED, then nobody will ask for leaderboard.
     // If N was MODIFIED, then leaderboard will not be accurate (but it's not critical).
     // If N was ADDED, then I don't have data - no leaderboard provided.
-    if(n->getAiAaMatrixIndex() != AA_NOT_SET) {
-        // check cache
-        auto cachedLeaderboard = leaderboardCache.find(n);
-        if(cachedLeaderboard != leaderboardCache.end()) {
-            return true;
-        }
+    auto offset = g->offsets.find(n);
+    vector<pair<Note*,float>> leaderboard{};
+    bool calculated = true;
+    if(offset != g->offsets.end()) {
+        // AA matrix rows are shared by all workers of the generation
+        lock_guard<mutex> criticalSection{g->aaMutex};
 
         // calculate row/column of AA matrix & build leaderboard
-        calculateAaRow(n->getAiAaMatrixIndex());
-
-        int aaLeaderboard[AA_LEADERBOARD_SIZE][2];
-        for(int i=0; i<AA_LEADERBOARD_SIZE; i++) {
-            aaLeaderboard[i][0] = aaLeaderboard[i][1] = AA_NOT_SET;
-        }
+        calculated = calculateAaRow(*g, offset->second, *cancellation);
+        if(calculated) {
+            int aaLeaderboard[AA_LEADERBOARD_SIZE][2];
+            for(int i=0; i<AA_LEADERBOARD_SIZE; i++) {
+                aaLeaderboard[i][0] = aaLeaderboard[i][1] = AA_NOT_SET;
+            }
 
-        float aa;
-        for(size_t x=0, y=n->getAiAaMatrixIndex(); x<notes.size(); x++) {
-            if(x==y) continue; // self on diagonal
-
-            aa = aaMatrix[x][y];
-
-            if(aa > aaLeaderboard[AA_LEADERBOARD_SIZE-1][0]) { // covers also lb[][]==NOT_SET (== -1)
-                // find target leaderboard row
-                size_t target;
-                for(target=0; target<AA_LEADERBOARD_SIZE; target++) {
-                    if(aaLeaderboard[target][0] == AA_NOT_SET) {
-                        break; // fill empty row -> no shift needed
-                    } else {
-                        if(aa > aaMatrix[aaLeaderboard[target][0]][aaLeaderboard[target][1]]) {
-                            break;
+            float aa;
+            for(size_t x=0, y=offset->second; x<g->notes.size(); x++) {
+                if(x==y) continue; // self on diagonal
+
+                aa = g->aaMatrix[x][y];
+
+                // compare w/ AA of the last leaderboard row (not its coordinate) so that the target row is always found
+                if(aaLeaderboard[AA_LEADERBOARD_SIZE-1][0] == AA_NOT_SET
+                     ||
+                   aa > g->aaMatrix[aaLeaderboard[AA_LEADERBOARD_SIZE-1][0]][aaLeaderboard[AA_LEADERBOARD_SIZE-1][1]])
+                {
+                    // find target leaderboard row
+                    size_t target;
+                    for(target=0; target<AA_LEADERBOARD_SIZE; target++) {
+                        if(aaLeaderboard[target][0] == AA_NOT_SET) {
+                            break; // fill empty row -> no shift needed
+                        } else {
+                            if(aa > g->aaMatrix[aaLeaderboard[target][0]][aaLeaderboard[target][1]]) {
+                                break;
+                            }
                         }
                     }
-                }
 
-                /// empty row > no shift needed
-                if(aaLeaderboard[target][0] != AA_NOT_SET) {
-                    // shift leaderboard
-                    int sx = aaLeaderboard[target][0];
-                    int sy = aaLeaderboard[target][1];
-                    for(size_t ll=target; ll<AA_LEADERBOARD_SIZE; ll++) {
-                        if(aaLeaderboard[ll][0]!=AA_NOT_SET) {
-                            int tx=aaLeaderboard[ll][0];
-                            int ty=aaLeaderboard[ll][1];
-                            aaLeaderboard[ll][0]=sx;
-                            aaLeaderboard[ll][1]=sy;
-                            sx=tx;
-                            sy=ty;
-                        } else {
-                            aaLeaderboard[ll][0]=sx;
-                            aaLeaderboard[ll][1]=sy;
-                            break;
+                    /// empty row > no shift needed
+                    if(aaLeaderboard[target][0] != AA_NOT_SET) {
+                        // shift leaderboard
+                        int sx = aaLeaderboard[target][0];
+                        int sy = aaLeaderboard[target][1];
+                        for(size_t ll=target; ll<AA_LEADERBOARD_SIZE; ll++) {
+                            if(aaLeaderboard[ll][0]!=AA_NOT_SET) {
+                                int tx=aaLeaderboard[ll][0];
+                                int ty=aaLeaderboard[ll][1];
+                                aaLeaderboard[ll][0]=sx;
+                                aaLeaderboard[ll][1]=sy;
+                                sx=tx;
+                                sy=ty;
+                            } else {
+                                aaLeaderboard[ll][0]=sx;
+                                aaLeaderboard[ll][1]=sy;
+                                break;
+                            }
                         }
                     }
-                }
 
-                // assign value
-                aaLeaderboard[target][0]=x;
-                aaLeaderboard[target][1]=y;
+                    // assign value
+                    aaLeaderboard[target][0]=x;
+                    aaLeaderboard[target][1]=y;
+                }
             }
-        }
 
-        MF_DEBUG("Leaderboard of " << n->getName() << " (" << n->getOutline()->getName() << "):" << endl);
-        vector<pair<Note*,float>> leaderboard{};
-        for(int i=0; i<AA_LEADERBOARD_SIZE && aaLeaderboard[i][0]!=AA_NOT_SET; i++) {
-            MF_DEBUG("  #" << i << " " <<
-                     notes[aaLeaderboard[i][0]]->getName() << " (" << notes[aaLeaderboard[i][0]]->getOutline()->getName() << ")" <<
-                     " ~ " << aaMatrix[aaLeaderboard[i][0]][aaLeaderboard[i][1]] << endl);
-            leaderboard.push_back(std::make_pair(notes[aaLeaderboard[i][0]],aaMatrix[aaLeaderboard[i][0]][aaLeaderboard[i][1]]));
+            MF_DEBUG("Leaderboard of " << n->getName() << " (" << n->getOutline()->getName() << "):" << endl);
+            for(int i=0; i<AA_LEADERBOARD_SIZE && aaLeaderboard[i][0]!=AA_NOT_SET; i++) {
+                MF_DEBUG("  #" << i << " " <<
+                         g->notes[aaLeaderboard[i][0]]->getName() << " (" << g->notes[aaLeaderboard[i][0]]->getOutline()->getName() << ")" <<
+                         " ~ " << g->aaMatrix[aaLeaderboard[i][0]][aaLeaderboard[i][1]] << endl);
+                leaderboard.push_back(std::make_pair(g->notes[aaLeaderboard[i][0]],g->aaMatrix[aaLeaderboard[i][0]][aaLeaderboard[i][1]]));
+            }
         }
-
-        // cache leaderboard (copied)
-        leaderboardCache[n] = leaderboard;
     }
 
-    leaderboardWip.erase(n);
+    if(calculated) {
+        // cache leaderboard (copied) - N which was ADDED gets empty leaderboard until next dream
+        publishLeaderboard(*g, n, leaderboard);
+    } else {
+        // superseded leaderboard is NOT published - it's calculated again when asked for
+        lock_guard<mutex> criticalSection{g->leaderboardsMutex};
+        g->leaderboardWip.erase(n);
+    }
     mind.decActiveProcesses();
-    if(t) t->detach(); // indicate that thread finished
-    return true;
+    return calculated;
 }
 
-void AiAaBoW::assertAaSymmetry()
+void AiAaBoW::assertAaSymmetry(Generation& g)
 {
     MF_DEBUG("AI: checking AA symmetry..." << endl);
-    for(size_t i=0; i<aaMatrix.size(); ++i) {
-        for(size_t j=0; i<aaMatrix.size(); ++i) {
-            if(aaMatrix[i][j] != aaMatrix[j][i]) {
+    for(size_t i=0; i<g.aaMatrix.size(); ++i) {
+        for(size_t j=0; i<g.aaMatrix.size(); ++i) {
+            if(g.aaMatrix[i][j] != g.aaMatrix[j][i]) {
                 MF_DEBUG("  Symmetry ERROR: aa["<<i<<"]["<<j<<"]" << endl);
             }
         }
@@ -511,10 +819,10 @@ void AiAaBoW::assertAaSymmetry()
 
 // it's presumed that caller ensures the correct Mind state & synchronization
 bool AiAaBoW::sleep() {
-    lexicon.clear();
-    notes.clear();
-    outlines.clear();
-    bow.clear();
+    // dreaming and leaderboards calculations are stopped - generation is freed
+    interrupt();
+    awaitWorkers();
+    publish(nullptr);
 
     return true;
 }
@@ -522,7 +830,6 @@ bool AiAaBoW::sleep() {
 // it's presumed that caller ensures the correct Mind state & synchronization
 bool AiAaBoW::amnesia() {
     sleep();
-    aaMatrix.clear();
 
     return true;
 }
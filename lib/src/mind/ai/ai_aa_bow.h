@@ -19,10 +19,20 @@
 #ifndef M8R_AI_ASSOCIATIONS_ASSESSMENT_BOW_H
 #define M8R_AI_ASSOCIATIONS_ASSESSMENT_BOW_H
 
+#include <atomic>
+#include <condition_variable>
+#include <functional>
 #include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "../mind.h"
+#include "../../gear/cancellation_token.h"
 #include "ai_aa.h"
+#include "aa_model.h"
 #include "./nlp/markdown_tokenizer.h"
 #include "./nlp/note_char_provider.h"
 #include "./nlp/bag_of_words.h"
@@ -45,42 +55,81 @@ private:
     static constexpr float AA_NOT_SET = -1.f;
     static constexpr int AA_WORD_RELEVANCY_THRESHOLD = 10; // use 10 words w/ highest weight from vectors (and ignore others - irrelevant can bring noice with volume)
     static constexpr float AA_TITLE_WORD_BONUS = 0.2f;
+    // AA matrix row calculation checks cancellation every N columns
+    static constexpr size_t AA_CANCELLATION_STRIDE = 256;
+
+    // NN is trained only if memory provides enough associated (parent/child) N pairs
+    static constexpr size_t AA_NN_MIN_POSITIVE_PAIRS = 100;
+    static constexpr size_t AA_NN_MAX_POSITIVE_PAIRS = 10000;
+    static constexpr int AA_NN_EPOCHS = 30;
+    static constexpr double AA_NN_LEARNING_RATE = 0.3;
+
+    // associate Ns as you READ: N -> O/N
+    // IMPROVE thing*,float - both O and N to be association
+    typedef std::map<const Note*,std::vector<std::pair<Note*,float>>> Leaderboards;
+
+    /**
+     * @brief Generation of BoW AA index.
+     *
+     * Dreaming builds a new generation aside and publishes it atomically (RCU):
+     * readers get a consistent snapshot w/o locks and the generation is freed
+     * once the last reader (worker) releases it. Published generation is immutable
+     * except lazily calculated AA matrix rows (calculated by workers under AA mutex)
+     * and leaderboards which are replaced copy-on-write.
+     */
+    struct Generation {
+        unsigned long epoch;
+
+        Lexicon lexicon; // IMPROVE merge Standford GloVe word vectors (https://nlp.stanford.edu/projects/glove/)
+        MarkdownTokenizer tokenizer;
+        BagOfWords bow;
+
+        // Ns - vector index is used as ID through other data structures
+        std::vector<Note*> notes; // IMPROVE make N* pair where .second is N embedding w/ classifications/attributes
+        std::unordered_map<const Note*,size_t> offsets;
+
+        // NN scoring AA features - metric is used if NN is not trained
+        AssociationAssessmentModel aaModel;
+
+        // guards AA matrix and lexicon (tokenization of titles adds words)
+        std::mutex aaMutex;
+        // Associations assessment matrix w/ rankings for any N1/N2 tuple (diagonal symmetry).
+        std::vector<std::vector<float>> aaMatrix; // IMPROVE: notesAA and outlinesAA ~ Notes assocications assessment
+
+        // readers use atomic_load(), writers copy, modify and atomic_store() under the mutex
+        std::shared_ptr<const Leaderboards> leaderboards;
+        std::mutex leaderboardsMutex;
+        // leaderboards being calculated - shared by callers which ask for them meanwhile
+        std::map<const Note*,std::shared_future<bool>> leaderboardWip;
+
+        explicit Generation(unsigned long epoch, CommonWordsBlacklist& blacklist);
+        Generation(const Generation&) = delete;
+        Generation(const Generation&&) = delete;
+        Generation &operator=(const Generation&) = delete;
+        Generation &operator=(const Generation&&) = delete;
+        ~Generation() {}
+    };
 
 private:
     Mind& mind;
     Memory& memory;
 
-    Lexicon lexicon; // IMPROVE merge Standford GloVe word vectors (https://nlp.stanford.edu/projects/glove/)
     CommonWordsBlacklist wordBlacklist;
-    BagOfWords bow;
-    MarkdownTokenizer tokenizer;
-
-    /*
-     * Data sets
-     */
-
-    // Os - vector index is used as ID through other data structures like similarity matrices
-    std::vector<Outline*> outlines; // IMPROVE make O* pair where .second is O embedding w/ classifications/attributes
-    // Ns - vector index is used as ID through other data structures
-    std::vector<Note*> notes; // IMPROVE make N* pair where .second is N embedding w/ classifications/attributes
 
-    /*
-     * Associations
-     */
+    // published generation - accessed using atomic_load()/atomic_store() only
+    std::shared_ptr<Generation> generation;
+    std::atomic<unsigned long> epoch;
 
-    // associate Ns as you READ: N -> O/N
-    // IMPROVE thing*,float - both O and N to be association
-    std::map<const Note*,std::vector<std::pair<Note*,float>>> leaderboardCache;
-    std::set<const Note*> leaderboardWip;
+    // running dream - accessed using atomic_load()/atomic_store() only
+    std::shared_ptr<CancellationToken> dreamCancellation;
+    // the most recent leaderboard calculation of each caller (thread) - superseded by caller's
+    // next calculation only, therefore concurrent callers don't cancel each other
+    std::mutex leaderboardCancellationsMutex;
+    std::map<std::thread::id,std::shared_ptr<CancellationToken>> leaderboardCancellations;
 
     // associate as you WRITE: word(s) -> O/N
     // IMPROVE std::map<const Note*,std::vector<std::pair<string*,float>>> leaderboardCache;
 
-    // Associations assessment matrix w/ rankings for any N1/N2 tuple (diagonal symmetry).
-    // Changed from float** to vector<vector>> to enable row/col extension on new N/O
-    // (keep & avoid realloc)
-    std::vector<std::vector<float>> aaMatrix; // IMPROVE: notesAA and outlinesAA ~ Notes assocications assessment
-
 public:
     explicit AiAaBoW(Memory& memory, Mind& mind);
     AiAaBoW(const AiAaBoW&) = delete;
@@ -97,6 +146,9 @@ public:
      * If future is valid and true, then associated N are copied to vector passed as arg,
      * else waith for future to become valid and then call this method again (i.e. async
      * variant does NOT copies computed associated Ns to provided vector).
+     *
+     * Caller's previous calculation is superseded (cancelled), calculations of other
+     * callers (threads) are not. Leaderboard being calculated is shared by callers.
      */
     virtual std::shared_future<bool> getAssociatedNotes(const Note* note, std::vector<std::pair<Note*,float>>& associations);
 
@@ -121,17 +173,27 @@ public:
         return std::shared_future<bool>(p.get_future());
     }
 
+    virtual void interrupt();
+
     virtual bool sleep();
 
     virtual bool amnesia();
 
+    virtual std::shared_ptr<const BagOfWords> getBagOfWords() const;
+
+    /**
+     * @brief Get leaderboard from published generation w/o locking.
+     */
+    virtual bool getCachedAssociatedNotes(const Note* note, std::vector<std::pair<Note*,float>>& associations) const;
+
 private:
 
     /*
      * Worker threads:
      *  1. packaged task is assigned to thread
      *  2. thread performs the task and calls detach() on self when finishes
-     *     to indicate that it's ready to be deleted
+     *     to indicate that it's ready to be deleted (under workers mutex, which
+     *     is held when thread is started ~ never before it's assigned)
      *  3. if main thread detects that !thread.joinable(), then it can be deleted;
      *     cleanup is done on any new thread launch AND/OR by this class destructor.
      */
@@ -139,18 +201,37 @@ private:
     // IMPROVE introduce a LIMIT on number of running threads in configuration
     std::vector<std::thread*> runningWorkers;
     std::mutex runningWorkersMutex;
+    // workers which didn't finish their task yet (guarded by running workers mutex)
+    size_t busyWorkers;
+    std::condition_variable workersFinished;
 
 private:
 
     /**
      * @brief Learn Memory to start thinking.
+     *
+     * Interrupted dreaming doesn't publish anything and returns false.
      */
-    bool learnMemorySync(std::thread* t = nullptr);
+    bool learnMemorySync(std::shared_ptr<CancellationToken> cancellation, std::thread* t = nullptr);
 
     /**
      * @brief Calculate leaderboard and indicate that it has been stored to cache.
+     *
+     * Interrupted (superseded) calculation doesn't publish leaderboard and returns false.
+     */
+    bool calculateLeaderboardSync(
+            std::shared_ptr<Generation> g,
+            const Note* n,
+            std::shared_ptr<CancellationToken> cancellation,
+            std::thread* t = nullptr);
+
+    std::shared_ptr<Generation> snapshot() const { return std::atomic_load(&generation); }
+    void publish(std::shared_ptr<Generation> g) { std::atomic_store(&generation, g); }
+
+    /**
+     * @brief Publish (copy-on-write) leaderboard of N in given generation.
      */
-    bool calculateLeaderboardSync(const Note* n, std::thread* t = nullptr);
+    void publishLeaderboard(Generation& g, const Note* n, const std::vector<std::pair<Note*,float>>& leaderboard);
 
     /**
      * @brief Initialize blacklist using common words.
@@ -165,19 +246,48 @@ private:
      *
      * LONG running method.
      */
-    void precalculateAa();
+    void precalculateAa(Generation& g);
 
     /**
      * @brief Calculate AA row/column cross i.e. associations of N with *all* other Ns.
      *
-     * LONG running method on bigger repositories.
+     * LONG running method on bigger repositories. Cancelled calculation keeps
+     * rankings calculated so far and returns false (row is completed later).
+     */
+    bool calculateAaRow(Generation& g, size_t y, const CancellationToken& cancellation);
+
+    /**
+     * @brief Calculate association assessment features of N pair.
+     */
+    void calculateAaFeature(Generation& g, Note* n1, Note* n2, AssociationAssessmentNotesFeature& aaFeature);
+
+    /**
+     * @brief Load NN model or train it on N pairs mined from memory (and save it to mind).
+     *
+     * Persisted model is used only if it has the same layout and vocabulary (see fingerprint).
      */
-    void calculateAaRow(size_t y);
+    void trainAaModel(Generation& g, const CancellationToken& cancellation);
+
+    /**
+     * @brief Fingerprint of NN model inputs - format version, feature layout and vocabulary.
+     *
+     * Fingerprint is deterministic - it doesn't depend on Ns order (learning threads)
+     * nor their modification times.
+     */
+    uint64_t calculateAaModelFingerprint(Generation& g) const;
+
+    /**
+     * @brief Mine labeled N pairs from memory to train NN.
+     *
+     * Ns in parent/child relationship are associated, randomly chosen Ns (from the same
+     * as well as from different Os) are not.
+     */
+    void mineAaTrainingPairs(Generation& g, std::vector<float>& features, std::vector<float>& labels, const CancellationToken& cancellation);
 
     /**
      * @brief Calculate similarity of two word vectors.
      */
-    float calculateSimilarityByWords(WordFrequencyList& v1, WordFrequencyList& v2, int threshold=1000);
+    float calculateSimilarityByWords(Generation& g, WordFrequencyList& v1, WordFrequencyList& v2, int threshold=1000);
 
     /**
      * @brief Calculate similarity of two tag lists.
@@ -187,34 +297,39 @@ private:
     /**
      * @brief Calculate similarity of two N/O names.
      */
-    float calculateSimilarityByTitles(const std::string& t1, const std::string& t2);
+    float calculateSimilarityByTitles(Generation& g, const std::string& t1, const std::string& t2);
 
     /**
      * @brief Check AA matrix symmetry.
      */
-    void assertAaSymmetry();
+    void assertAaSymmetry(Generation& g);
+
+    /**
+     * @brief Remove finished workers, add new one and start it w/ given task.
+     */
+    void addWorkerAndCleanZombies(std::thread* t, const std::function<void()>& task);
 
     /**
-     * @brief Get AA leaderboard from cache.
+     * @brief Indicate that worker finished its task (it may still run) - detaches the worker.
      */
-    bool getCachedLeaderboard(const Note* n, std::vector<std::pair<Note*,float>>& leaderboard);
+    void workerFinished(std::thread* t);
 
     /**
-     * @brief Remove finished workers and add new one.
+     * @brief Wait for workers to finish their tasks.
      */
-    void addWorkerAndCleanZombies(std::thread* t);
+    void awaitWorkers();
 
 public:
 #ifdef DO_MF_DEBUG
-    void printAa() {
+    void printAa(Generation& g) {
         std::cout << "AA Matrix:" << std::endl;
-        for(size_t i=0; i<aaMatrix.size(); i++) {
+        for(size_t i=0; i<g.aaMatrix.size(); i++) {
             std::cout << "AA[" << i << "] = ";
-            for(size_t j=0; j<aaMatrix.size(); j++) {
-                if(aaMatrix[i][j] == -1) {
+            for(size_t j=0; j<g.aaMatrix.size(); j++) {
+                if(g.aaMatrix[i][j] == -1) {
                     std::cout << "_ ";
                 } else {
-                    std::cout << aaMatrix[i][j] << " ";
+                    std::cout << g.aaMatrix[i][j] << " ";
                 }
             }
             std::cout << std::endl;
@@ -18,16 +18,37 @@
 */
 #include "ai_aa_weighted_fts.h"
 
+#include <thread>
+
+#include "../../gear/tracer.h"
+
 namespace m8r {
 
 using namespace std;
 
-AiAaWeightedFts::AiAaWeightedFts(Memory& memory, Mind& mind)
+constexpr size_t AiAaWeightedFts::MIN_NOTES_PER_THREAD;
+constexpr size_t AiAaWeightedFts::LEADERBOARDS_CACHE_SIZE;
+constexpr int AiAaWeightedFts::ASSESSMENT_DEADLINE_MS;
+
+AiAaWeightedFts::AiAaWeightedFts(Memory& memory, Mind& mind, unsigned threads)
     : mind(mind),
       memory(memory),
-      commonWords{}
+      commonWords{},
+      threads{threads},
+      texts{},
+      textsOutlines{},
+      textsByOutline{},
+      leaderboards{},
+      assessment{}
 {
     lastMindDeleteWatermark = mind.getDeleteWatermark();
+
+    if(!this->threads) {
+        this->threads = thread::hardware_concurrency();
+        if(!this->threads) {
+            this->threads = 1;
+        }
+    }
 }
 
 AiAaWeightedFts::~AiAaWeightedFts()
@@ -36,6 +57,7 @@ AiAaWeightedFts::~AiAaWeightedFts()
 
 void AiAaWeightedFts::refreshNotes(bool checkWatermark)
 {
+    MF_TRACE_SPAN("fts", "refresh notes");
 #ifdef DO_MF_DEBUG
     MF_DEBUG("AA.FTS Ns refresh - check watermark " << boolalpha << checkWatermark << endl);
     auto begin = chrono::high_resolution_clock::now();
@@ -67,6 +89,94 @@ shared_future<bool> AiAaWeightedFts::dream()
     return shared_future<bool>(std::move(p.get_future()));
 }
 
+/*
+ * Text cache
+ */
+
+static void toLowerJoined(const vector<string*>& lines, string& joined)
+{
+    joined.clear();
+    string s{};
+    for(string* l:lines) {
+        if(l) {
+            s.clear();
+            stringToLower(*l, s);
+            joined += s;
+            joined += '\n';
+        }
+    }
+}
+
+void AiAaWeightedFts::refreshText(const Outline* outline, OutlineText& text)
+{
+    text.revision = outline->getRevision();
+    text.modified = outline->getModified();
+
+    text.name.clear();
+    stringToLower(outline->getName(), text.name);
+    toLowerJoined(outline->getDescription(), text.description);
+
+    // Ns are mostly unchanged - reuse text of N w/ the same revision at the same offset
+    const vector<Note*>& outlineNotes = outline->getNotes();
+    vector<NoteText> previous{};
+    previous.swap(text.notes);
+    text.notes.resize(outlineNotes.size());
+    for(size_t i=0; i<outlineNotes.size(); i++) {
+        const Note* n = outlineNotes[i];
+        NoteText& t = text.notes[i];
+        if(i<previous.size()
+             && previous[i].note == n
+             && previous[i].revision == n->getRevision()
+             && previous[i].modified == n->getModified())
+        {
+            t = std::move(previous[i]);
+        } else {
+            t.note = n;
+            t.revision = n->getRevision();
+            t.modified = n->getModified();
+            stringToLower(n->getName(), t.name);
+            toLowerJoined(n->getDescription(), t.description);
+        }
+    }
+
+    text.valid = true;
+}
+
+bool AiAaWeightedFts::refreshTexts()
+{
+    const vector<Outline*>& outlines = memory.getOutlines();
+
+    bool changed = outlines != textsOutlines;
+    if(changed) {
+        textsOutlines = outlines;
+        textsByOutline.clear();
+        for(Outline* o:outlines) {
+            textsByOutline.push_back(&texts[o]);
+        }
+        // forget texts of forgotten Os
+        if(texts.size() > outlines.size()) {
+            unordered_map<const Outline*,OutlineText> alive{};
+            for(size_t i=0; i<outlines.size(); i++) {
+                alive[outlines[i]] = std::move(*textsByOutline[i]);
+            }
+            texts.swap(alive);
+            for(size_t i=0; i<outlines.size(); i++) {
+                textsByOutline[i] = &texts[outlines[i]];
+            }
+        }
+    }
+
+    // stale texts are refreshed lazily by assessment (in parallel)
+    if(!changed) {
+        for(size_t i=0; i<textsOutlines.size(); i++) {
+            if(isStale(textsOutlines[i], *textsByOutline[i])) {
+                return true;
+            }
+        }
+    }
+    return changed;
+}
+
 /*
  * WORDS -> Ns
  */
@@ -111,8 +221,13 @@ void AiAaWeightedFts::tokenizeAndStripString(string s, const bool ignoreCase, ve
     }
 }
 
-vector<pair<Note*,float>>* AiAaWeightedFts::assessNotesWithFallback(const string& regexp, Outline* scope, const Note* self)
+vector<pair<Note*,float>>* AiAaWeightedFts::assessNotesWithFallback(
+        const string& regexp,
+        Outline* scope,
+        const Note* self,
+        const CancellationToken& cancellation)
 {                         
+    MF_TRACE_SPAN("aa", "fts assessment");
     vector<pair<Note*,float>>* result = new vector<pair<Note*,float>>();
     if(regexp.empty()) return result;
 
@@ -131,14 +246,7 @@ vector<pair<Note*,float>>* AiAaWeightedFts::assessNotesWithFallback(const string
     if(r.size()) words.push_back(r);
 
     // exact match
-    if(scope) {
-        assessNotesInOutline(scope, result, words, ignoreCase);
-    } else {
-        const vector<m8r::Outline*> outlines = memory.getOutlines();
-        for(Outline* outline:outlines) {
-            assessNotesInOutline(outline, result, words, ignoreCase);
-        }
-    }
+    assessNotes(scope, result, words, cancellation);
     // remove self in case that result can become empty
     if(self && result->size() == 1 && result->begin()->first == self) {
         result->clear();
@@ -146,7 +254,7 @@ vector<pair<Note*,float>>* AiAaWeightedFts::assessNotesWithFallback(const string
 
     // FALLBACK: if exact match failed, split regexp to words (if it's multi-word) and try FTS assessment word by word
     // IMPROVE this may take longer than single search > implement ASYNC run w/ distributor based refresh
-    if(result->empty()) {
+    if(result->empty() && !cancellation.isCancelled()) {
         MF_DEBUG("AA.FTS.fallback for '" << regexp << "'" << endl);
         words.clear();
         tokenizeAndStripString(regexp, ignoreCase, words);
@@ -155,107 +263,154 @@ vector<pair<Note*,float>>* AiAaWeightedFts::assessNotesWithFallback(const string
         MF_DEBUG("AA.FTS.fallback words: " << words.size() << endl);
         if(words.size()) {
             // IMPROVE: iterate 3 *most valuable* words (now the first 3 words are considered, value is ignored)
-            words.resize(FTS_SEARCH_THRESHOLD_MULTIWORD);
-            // search using words
-            if(scope) {
-                assessNotesInOutline(scope, result, words, ignoreCase);
-            } else {
-                const vector<m8r::Outline*> outlines = memory.getOutlines();
-                for(Outline* outline:outlines) {
-                    assessNotesInOutline(outline, result, words, ignoreCase);
-                }
+            if(words.size() > FTS_SEARCH_THRESHOLD_MULTIWORD) {
+                // resize() w/ fewer words would add empty words which match everything
+                words.resize(FTS_SEARCH_THRESHOLD_MULTIWORD);
             }
+            // search using words
+            assessNotes(scope, result, words, cancellation);
         }
     }
 
-    // sort to have the best match in head
+    // sort to have the best match in head (stable to get the same leaderboard regardless threads)
     if(result->size()) {
-        std::sort(result->begin(), result->end(), weightedMatchesComparator);
+        std::stable_sort(result->begin(), result->end(), weightedMatchesComparator);
     }
 
     return result;
 }
 
-void AiAaWeightedFts::assessNotesInOutline(Outline* outline, vector<pair<Note*,float>>* result, vector<string>& regexps, const bool ignoreCase)
+void AiAaWeightedFts::assessNotes(
+        Outline* scope,
+        vector<pair<Note*,float>>* result,
+        vector<string>& regexps,
+        const CancellationToken& cancellation)
 {
-    // IMPROVE make this faster - do NOT convert to lower case, but compare it in that method > will do less
-    if(ignoreCase) {
-        // case INSENSITIVE
-
-        // O matches
-        float oScore = 0.f;
-        string s{};
-        // O.title matches
-        stringToLower(outline->getName(), s);
-        for(auto& regexp:regexps) {
-            if(s.find(regexp)!=string::npos) {
-                oScore += 100.f;
-            }
+    if(scope) {
+        auto t = texts.find(scope);
+        if(t == texts.end()) {
+            OutlineText text{};
+            assessNotesInOutline(scope, text, result, regexps);
+        } else {
+            assessNotesInOutline(scope, t->second, result, regexps);
         }
-        // O.description matches
-        float matches = 0.f;
-        for(string* d:outline->getDescription()) {
-            if(d) {
-                s.clear();
-                stringToLower(*d, s);
-                for(auto& regexp:regexps) {
-                    // find all matches (regexp matched more than once)
-                    size_t m = s.find(regexp, 0);
-                    while(m != string::npos) {
-                        matches++;
-                        m = s.find(regexp,m+1);
-                    }
-                }
-            }
+        return;
+    }
+
+    size_t notesCount = 0;
+    for(Outline* o:textsOutlines) {
+        notesCount += o->getNotes().size();
+    }
+    size_t workersCount = std::min<size_t>(threads, 1 + notesCount/MIN_NOTES_PER_THREAD);
+    workersCount = std::min(workersCount, textsOutlines.size());
+    if(workersCount <= 1) {
+        for(size_t i=0; i<textsOutlines.size() && !cancellation.isCancelled(); i++) {
+            assessNotesInOutline(textsOutlines[i], *textsByOutline[i], result, regexps);
         }
-        if(matches != 0.f) {
-            oScore += 10.f*matches;
-            result->push_back(std::make_pair(outline->getOutlineDescriptorAsNote(),oScore));
+        return;
+    }
+
+    // partitions of Os are assessed in parallel, results are concatenated in Os order
+    vector<vector<pair<Note*,float>>> partialResults(workersCount);
+    auto worker = [&](size_t w) {
+        size_t begin = (w*textsOutlines.size())/workersCount;
+        size_t end = ((w+1)*textsOutlines.size())/workersCount;
+        for(size_t i=begin; i<end && !cancellation.isCancelled(); i++) {
+            assessNotesInOutline(textsOutlines[i], *textsByOutline[i], &partialResults[w], regexps);
         }
+    };
+    vector<thread> workers{};
+    for(size_t w=1; w<workersCount; w++) {
+        workers.push_back(thread{worker, w});
+    }
+    worker(0);
+    for(thread& t:workers) {
+        t.join();
+    }
+    for(auto& r:partialResults) {
+        result->insert(result->end(), r.begin(), r.end());
+    }
+}
 
-        // O's score will contribute to N's score as a bonus > normalize it
-        //MF_DEBUG(" AA.FTS O>N '" << outline->getName() << "' ~ " << oScore << endl);
-        oScore /= 10.f;
+void AiAaWeightedFts::assessNotesInOutline(Outline* outline, OutlineText& text, vector<pair<Note*,float>>* result, vector<string>& regexps)
+{
+    // case is always INSENSITIVE - see FTS search for case sensitive search
+    if(isStale(outline, text)) {
+        refreshText(outline, text);
+    }
 
-        // O's N matches
-        float nScore = 0.f;
-        for(Note* note:outline->getNotes()) {
-            nScore = oScore;
-            // time scope @ AI
-            if(mind.getScopeAspect().isOutOfScope(note)) {
-                continue;
-            }
-            // N.title matches
-            s.clear();
-            stringToLower(note->getName(), s);
-            for(auto& regexp:regexps) {
-                if(s.find(regexp)!=string::npos) {
-                    nScore += 100.f;
-                }
-            }
-            // N.description matches
-            float matches=0.;
-            for(string* d:note->getDescription()) {
-                if(d) {
-                    s.clear();
-                    stringToLower(*d, s);
-                    for(auto& regexp:regexps) {
-                        // find them all
-                        size_t m = s.find(regexp, 0);
-                        while(m != string::npos) {
-                            matches++;
-                            m = s.find(regexp,m+1);
-                        }
-                    }
-                }
+    // O matches
+    float oScore = 0.f;
+    // O.title matches
+    for(auto& regexp:regexps) {
+        if(text.name.find(regexp)!=string::npos) {
+            oScore += 100.f;
+        }
+    }
+    // O.description matches
+    float matches = 0.f;
+    for(auto& regexp:regexps) {
+        // find all matches (regexp matched more than once)
+        size_t m = text.description.find(regexp, 0);
+        while(m != string::npos) {
+            matches++;
+            m = text.description.find(regexp,m+1);
+        }
+    }
+    if(matches != 0.f) {
+        oScore += 10.f*matches;
+        result->push_back(std::make_pair(outline->getOutlineDescriptorAsNote(),oScore));
+    }
+
+    // O's score will contribute to N's score as a bonus > normalize it
+    //MF_DEBUG(" AA.FTS O>N '" << outline->getName() << "' ~ " << oScore << endl);
+    oScore /= 10.f;
+
+    // O's N matches
+    float nScore = 0.f;
+    const vector<Note*>& outlineNotes = outline->getNotes();
+    for(size_t i=0; i<outlineNotes.size(); i++) {
+        Note* note = outlineNotes[i];
+        const NoteText& t = text.notes[i];
+        nScore = oScore;
+        // time scope @ AI
+        if(mind.getScopeAspect().isOutOfScope(note)) {
+            continue;
+        }
+        // N.title matches
+        for(auto& regexp:regexps) {
+            if(t.name.find(regexp)!=string::npos) {
+                nScore += 100.f;
             }
-            if(nScore!=0.f || matches!=0.f) {
-                nScore += 10.f*matches;
-                result->push_back(std::make_pair(note,nScore));
-                //MF_DEBUG(" AA.FTS > N '" << note->getName() << "' ~ " << nScore << endl);
+        }
+        // N.description matches
+        float matches=0.;
+        for(auto& regexp:regexps) {
+            // find them all
+            size_t m = t.description.find(regexp, 0);
+            while(m != string::npos) {
+                matches++;
+                m = t.description.find(regexp,m+1);
             }
         }
-    } // IMPROVE case sensitive version is NOT needed - was removed - see FTS search
+        if(nScore!=0.f || matches!=0.f) {
+            nScore += 10.f*matches;
+            result->push_back(std::make_pair(note,nScore));
+            //MF_DEBUG(" AA.FTS > N '" << note->getName() << "' ~ " << nScore << endl);
+        }
+    }
+}
+
+void AiAaWeightedFts::cacheLeaderboard(
+        const string& words,
+        const Note* self,
+        bool found,
+        const vector<pair<Note*,float>>& associations)
+{
+    if(leaderboards.size() >= LEADERBOARDS_CACHE_SIZE) {
+        leaderboards.pop_back();
+    }
+    leaderboards.push_front(Leaderboard{words, self, found, associations});
 }
 
 std::shared_future<bool> AiAaWeightedFts::getAssociatedNotes(
@@ -280,9 +435,38 @@ std::shared_future<bool> AiAaWeightedFts::getAssociatedNotes(
     // Ns mut be refreshed from Mind to consider O/N deletes and scope changes
     refreshNotes(true);
 
-    // find matches
-    vector<pair<Note*,float>>* m = assessNotesWithFallback(words, nullptr, self);
+    // leaderboards are valid until any O is changed - time scope is relative, therefore it's not cached
+    if(refreshTexts()) {
+        leaderboards.clear();
+    }
+    const bool cacheable = !mind.getScopeAspect().isEnabled();
+    if(cacheable) {
+        for(auto l=leaderboards.begin(); l!=leaderboards.end(); ++l) {
+            if(l->self==self && l->words==words) {
+                MF_DEBUG("AA.FTS.words '" << words << "' leaderboard served from cache" << endl);
+                leaderboards.splice(leaderboards.begin(), leaderboards, l);
+                associations.insert(associations.end(), l->associations.begin(), l->associations.end());
+                std::promise<bool> p{};
+                p.set_value(l->found);
+                return std::shared_future<bool>(p.get_future());
+            }
+        }
+    }
+
+    // find matches - assessment can be interrupted by Mind or run out of time
+    shared_ptr<CancellationToken> cancellation = make_shared<CancellationToken>();
+    cancellation->setDeadline(chrono::milliseconds(ASSESSMENT_DEADLINE_MS));
+    atomic_store(&assessment, cancellation);
+    vector<pair<Note*,float>>* m = assessNotesWithFallback(words, nullptr, self, *cancellation);
     unique_ptr<vector<pair<Note*,float>>> mKiller{m}; // auto delete
+    atomic_store(&assessment, shared_ptr<CancellationToken>{});
+    if(cancellation->isCancelled()) {
+        // incomplete matches are neither provided nor cached
+        MF_DEBUG("AA.FTS.words '" << words << "' assessment INTERRUPTED" << endl);
+        std::promise<bool> p{};
+        p.set_value(false);
+        return std::shared_future<bool>(p.get_future());
+    }
 
     // calculate leaderboard
     if(m->size()>0) {
@@ -312,12 +496,17 @@ std::shared_future<bool> AiAaWeightedFts::getAssociatedNotes(
             }
         } else {
             // there are no associations (there was ONLY self which was filtered out)
+            if(cacheable) {
+                cacheLeaderboard(words, self, false, associations);
+            }
             std::promise<bool> p{};
             p.set_value(false);
             return std::shared_future<bool>(p.get_future());
         }
 
-        // no need to CACHE as FTS matching is fast (~100ms on 1.000s Ns repos)
+        if(cacheable) {
+            cacheLeaderboard(words, self, true, associations);
+        }
 
 #ifdef DO_MF_DEBUG
         auto end = chrono::high_resolution_clock::now();
@@ -328,6 +517,9 @@ std::shared_future<bool> AiAaWeightedFts::getAssociatedNotes(
         return std::shared_future<bool>(p.get_future());
     } else {
         // there are no associations
+        if(cacheable) {
+            cacheLeaderboard(words, self, false, associations);
+        }
         std::promise<bool> p{};
         p.set_value(false);
         return std::shared_future<bool>(p.get_future());
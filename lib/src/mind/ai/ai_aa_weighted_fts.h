@@ -20,11 +20,15 @@
 #define M8R_AI_ASSOCIATIONS_ASSESSMENT_WEIGHTED_FTS_H
 
 #include <future>
+#include <list>
+#include <memory>
 #include <vector>
 #include <map>
+#include <unordered_map>
 
 #include "ai_aa.h"
 #include "../mind.h"
+#include "../../gear/cancellation_token.h"
 #include "../../gear/hash_map.h"
 #include "./nlp/common_words_blacklist.h"
 #include "./nlp/markdown_tokenizer.h"
@@ -40,6 +44,8 @@ class Memory;
  * Description:
  * - This method has own FTS implementation to compute weights and leverage O/N relationships
  *   while searching the best result.
+ * - Lower case text of Os/Ns is cached (and refreshed on O/N revision change), Os are
+ *   assessed in parallel on large repositories and recent leaderboards are kept in LRU.
  * - IMPROVE this class is designed to run SYNCHRONOUSLY - for ASYNC modus operandi Mind/AI/this class
  *   cooperation and synchronization protocols must be architected.
  */
@@ -47,19 +53,73 @@ class AiAaWeightedFts : public AiAssociationsAssessment
 {
     // in case that FTS for name fails, name is split to words - too many words would take too much time
     static constexpr int FTS_SEARCH_THRESHOLD_MULTIWORD = 3;
+    // Os are assessed in parallel only if there is enough Ns for every thread
+    static constexpr size_t MIN_NOTES_PER_THREAD = 1000;
+    // "think as you write" asks for the same words repeatedly
+    static constexpr size_t LEADERBOARDS_CACHE_SIZE = 32;
+    // assessment which doesn't finish in time gives up (stale "think as you write" request)
+    static constexpr int ASSESSMENT_DEADLINE_MS = 3000;
 
 private:
+    /**
+     * @brief Lower case N text - reused until N revision changes.
+     */
+    struct NoteText {
+        const Note* note;
+        u_int32_t revision;
+        time_t modified;
+        std::string name;
+        // lines joined w/ \n
+        std::string description;
+    };
+
+    /**
+     * @brief Lower case O text - refreshed when O revision changes.
+     */
+    struct OutlineText {
+        u_int32_t revision;
+        time_t modified;
+        bool valid;
+        std::string name;
+        std::string description;
+        std::vector<NoteText> notes;
+
+        OutlineText() : revision{0}, modified{0}, valid{false} {}
+    };
+
+    struct Leaderboard {
+        std::string words;
+        const Note* self;
+        bool found;
+        std::vector<std::pair<Note*,float>> associations;
+    };
+
     Mind& mind;
     Memory& memory;
     CommonWordsBlacklist commonWords;
+    unsigned threads;
 
     std::vector<Note*> notes;
 
     // IMPROVE in addition to watermark also scope change should be tracked ~ mind.scopeWatermark
     int lastMindDeleteWatermark;
 
+    // lower case text cache - Os of the last assessment and their texts (in the same order)
+    std::unordered_map<const Outline*,OutlineText> texts;
+    std::vector<Outline*> textsOutlines;
+    std::vector<OutlineText*> textsByOutline;
+
+    // LRU of (words, self) leaderboards (most recent first) - dropped on any O change
+    std::list<Leaderboard> leaderboards;
+
+    // running assessment - accessed using atomic_load()/atomic_store() only
+    std::shared_ptr<CancellationToken> assessment;
+
 public:
-    explicit AiAaWeightedFts(Memory& memory, Mind& mind);
+    /**
+     * @param threads   number of threads assessing Os, 0 to use all cores.
+     */
+    explicit AiAaWeightedFts(Memory& memory, Mind& mind, unsigned threads=0);
     AiAaWeightedFts(const AiAaWeightedFts&) = delete;
     AiAaWeightedFts(const AiAaWeightedFts&&) = delete;
     AiAaWeightedFts &operator=(const AiAaWeightedFts&) = delete;
@@ -82,8 +142,19 @@ public:
 
     virtual std::shared_future<bool> getAssociatedNotes(const std::string& words, std::vector<std::pair<Note*,float>>& associations, const Note* self);
 
+    virtual void interrupt() {
+        std::shared_ptr<CancellationToken> cancellation = std::atomic_load(&assessment);
+        if(cancellation) {
+            cancellation->cancel();
+        }
+    }
+
     virtual bool sleep() {
         notes.clear();
+        texts.clear();
+        textsOutlines.clear();
+        textsByOutline.clear();
+        leaderboards.clear();
         return true;
     }
 
@@ -93,15 +164,43 @@ public:
 
 private:
     void refreshNotes(bool checkWatermark);
+    /**
+     * @brief Sync text cache w/ Os in memory.
+     *
+     * @return true if any O was added, removed or modified.
+     */
+    bool refreshTexts();
+    static bool isStale(const Outline* outline, const OutlineText& text) {
+        return !text.valid
+            || text.revision != outline->getRevision()
+            || text.modified != outline->getModified()
+            || text.notes.size() != outline->getNotes().size();
+    }
+    static void refreshText(const Outline* outline, OutlineText& text);
+    void cacheLeaderboard(
+            const std::string& words,
+            const Note* self,
+            bool found,
+            const std::vector<std::pair<Note*,float>>& associations);
     void tokenizeAndStripString(std::string s, const bool ignoreCase, std::vector<std::string>& words);
 
     std::shared_future<bool> getAssociatedNotes(const std::string& words, std::vector<std::pair<Note*,float>>& associations, Outline* self);
 
-    // getAssociatedNotes(){assessNs,leaderboard}
-    //   -> assessNsWithFallback(){2lowercase,iterateOs,fallback}
-    //     -> assessNs@O()
-    std::vector<std::pair<Note*,float>>* assessNotesWithFallback(const std::string& regexp, Outline* scope, const Note* self);
-    void assessNotesInOutline(Outline* outline, std::vector<std::pair<Note*,float>>* result, std::vector<std::string>& regexp, const bool ignoreCase);
+    // getAssociatedNotes(){LRU,assessNs,leaderboard}
+    //   -> assessNsWithFallback(){2lowercase,fallback}
+    //     -> assessNs(){partition Os to threads}
+    //       -> assessNs@O()
+    std::vector<std::pair<Note*,float>>* assessNotesWithFallback(
+            const std::string& regexp,
+            Outline* scope,
+            const Note* self,
+            const CancellationToken& cancellation);
+    void assessNotes(
+            Outline* scope,
+            std::vector<std::pair<Note*,float>>* result,
+            std::vector<std::string>& regexps,
+            const CancellationToken& cancellation);
+    void assessNotesInOutline(Outline* outline, OutlineText& text, std::vector<std::pair<Note*,float>>* result, std::vector<std::string>& regexps);
 };
 
 }
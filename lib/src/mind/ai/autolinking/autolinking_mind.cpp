@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "autolinking_mind.h"
+#include "../../../gear/tracer.h"
 
 #include "../../mind.h"
 
@@ -47,6 +48,7 @@ bool AutolinkingMind::aliasSizeComparator(const Thing* t1, const Thing* t2)
 
 void AutolinkingMind::updateTrieIndex()
 {
+    MF_TRACE_SPAN("autolinking", "reindex");
     // IMPROVE update indices only if an O/N is modified (except writing read timestamps)
 
 #ifdef DO_MF_DEBUG
@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "cmark_aho_corasick_block_autolinking_preprocessor.h"
+#include "../../../gear/tracer.h"
 // cmark-gfm headers must NOT be included in header - Win builds fail
 #ifdef MF_MD_2_HTML_CMARK
   #include <cmark-gfm.h>
@@ -75,6 +76,7 @@ namespace m8r {
 
 using namespace std;
 
+#ifdef MF_MD_2_HTML_CMARK
 /*
  * OOC methods to avoid the need for having cmark-gfm.h in the header which causes
  * problems with Windows build.
@@ -261,6 +263,7 @@ void injectThingsLinks(cmark_node* srcNode, Mind& mind)
         node = injectAstTxtNode(srcNode, node, at);
     }
 }
+#endif
 
 /*
  * Preprocessor.
@@ -281,6 +284,7 @@ void CmarkAhoCorasickBlockAutolinkingPreprocessor::process(
         const vector<string*>& md,
         string& amd)
 {
+    MF_TRACE_SPAN("autolinking", "process");
 #ifdef MF_MD_2_HTML_CMARK
 
 #ifdef DO_MF_DEBUG
@@ -293,10 +297,8 @@ void CmarkAhoCorasickBlockAutolinkingPreprocessor::process(
 #endif
 
     insensitive = Configuration::getInstance().isAutolinkingCaseInsensitive();
-
-    // IMPROVE measure time in here and if over give limit, than STOP injecting
-    // and leave i.e. what happens is that a time SLA will be fulfilled and
-    // some part (prefix) of the input MD will be autolinked.
+    // once time budget is exceeded, links are NOT injected i.e. prefix of MD is autolinked
+    startDeadline();
 
     if(md.size()) {
         string mds{};
@@ -319,7 +321,9 @@ void CmarkAhoCorasickBlockAutolinkingPreprocessor::process(
             // process TEXT nodes whose parent is PARAGRAPH
             if(CMARK_NODE_TEXT == cmark_node_get_type(node)
                  &&
-               CMARK_NODE_PARAGRAPH == cmark_node_get_type(cmark_node_parent(node)))
+               CMARK_NODE_PARAGRAPH == cmark_node_get_type(cmark_node_parent(node))
+                 &&
+               !deadline.isCancelled())
             {
                 MF_DEBUG("[Autolinking] text node: '" << cmark_node_get_literal(node) << "'" << endl);
                 injectThingsLinks(node, mind);
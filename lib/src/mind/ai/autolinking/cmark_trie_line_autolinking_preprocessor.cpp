@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "cmark_trie_line_autolinking_preprocessor.h"
+#include "../../../gear/tracer.h"
 
 /*
  * DEPRECATED
@@ -106,6 +107,12 @@ void CmarkTrieLineAutolinkingPreprocessor::processAndAutolinkBlock(
         vector<string*>& block,
         string& amd)
 {
+    // time budget exceeded > keep the rest of MD as it is
+    if(deadline.isCancelled()) {
+        processProtectedBlock(block, amd);
+        return;
+    }
+
     if(block.size()) {
         string blockString{}, autolinkedBlock{};
         toString(block, blockString);
@@ -123,6 +130,7 @@ void CmarkTrieLineAutolinkingPreprocessor::process(
         const vector<string*>& md,
         string& amd)
 {
+    MF_TRACE_SPAN("autolinking", "process");
 #ifdef MF_MD_2_HTML_CMARK
 
 #ifdef DO_MF_DEBUG
@@ -135,14 +143,11 @@ void CmarkTrieLineAutolinkingPreprocessor::process(
 #endif
 
     insensitive = Configuration::getInstance().isAutolinkingCaseInsensitive();
+    // once time budget is exceeded, blocks are kept as they are i.e. prefix of MD is autolinked
+    startDeadline();
 
     vector<string*> block{};
     if(md.size()) {
-
-        // IMPROVE measure time in here and if over give limit, than STOP injecting
-        // and leave i.e. what happens is that a time SLA will be fulfilled and
-        // some part (prefix) of the input MD will be autolinked.
-
         bool inCodeBlock=false, inMathBlock=false;
         for(string* l:md) {
             if(l && stringStartsWith(*l, CODE_BLOCK)) {
@@ -202,13 +207,10 @@ void CmarkTrieLineAutolinkingPreprocessor::processLineByLine(
     std::vector<std::string*> amdl{};
 
     insensitive = Configuration::getInstance().isAutolinkingCaseInsensitive();
+    // once time budget is exceeded, lines are kept as they are i.e. prefix of MD is autolinked
+    startDeadline();
 
     if(md.size()) {
-
-        // IMPROVE measure time in here and if over give limit, than STOP injecting
-        // and leave i.e. what happens is that a time SLA will be fulfilled and
-        // some part (prefix) of the input MD will be autolinked.
-
         bool inCodeBlock=false, inMathBlock=false;
         for(string* l:md) {
             // every line is autolinked SEPARATELY
@@ -226,7 +228,7 @@ void CmarkTrieLineAutolinkingPreprocessor::processLineByLine(
                 nl->assign(*l);
                 amdl.push_back(nl);
             } else if(l) {
-                if(l->size() && !inCodeBlock && !inMathBlock) {
+                if(l->size() && !inCodeBlock && !inMathBlock && !deadline.isCancelled()) {
                     parseMarkdownLine(l, nl);
                     amdl.push_back(nl);
                 } else {
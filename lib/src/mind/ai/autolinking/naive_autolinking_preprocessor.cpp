@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "naive_autolinking_preprocessor.h"
+#include "../../../gear/tracer.h"
 
 #ifndef MF_MD_2_HTML_CMARK
 
@@ -60,6 +61,11 @@ bool NaiveAutolinkingPreprocessor::containsLinkCodeMath(const string* line)
     return false;
 }
 
+static bool aliasSizeComparator(const Thing* t1, const Thing* t2)
+{
+    return t1->getAutolinkingAlias().size() > t2->getAutolinkingAlias().size();
+}
+
 void NaiveAutolinkingPreprocessor::updateThingsIndex()
 {
     // IMPROVE update indices only if an O/N is modified (except writing read timestamps)
@@ -93,9 +99,11 @@ void NaiveAutolinkingPreprocessor::updateThingsIndex()
 
 void NaiveAutolinkingPreprocessor::process(const vector<string*>& md, string &amd)
 {
+    MF_TRACE_SPAN("autolinking", "process");
     MF_DEBUG("[Autolinking] NAIVE" << endl);
 
     insensitive = Configuration::getInstance().isAutolinkingCaseInsensitive();
+    startDeadline();
 
     // IMPROVE: inefficient ~ used as naive autolinker is for experiments only
     updateThingsIndex();
@@ -111,6 +119,13 @@ void NaiveAutolinkingPreprocessor::process(const vector<string*>& md, string &am
 
             string* nl = new string{};
 
+            // time budget exceeded > keep the rest of lines as they are
+            if(deadline.isCancelled()) {
+                nl->append(*l);
+                amdl.push_back(nl);
+                continue;
+            }
+
             // skip code/math/... blocks
             if(stringStartsWith(*l, CODE_BLOCK)) {
                 inCodeBlock = !inCodeBlock;                
@@ -145,7 +160,7 @@ void NaiveAutolinkingPreprocessor::process(const vector<string*>& md, string &am
                     // IMPROVE loop to be changed to Aho-Corasic trie
 
                     // inject Os, then Ns
-                    for(Thing* t:mind.autolink()->getThings()) {
+                    for(Thing* t:things) {
                         size_t found;
                         bool match, insensitiveMatch;
                         string lowerAlias{};
@@ -29,9 +29,12 @@ const string AutolinkingPreprocessor::MF_URL_HOST = string{"links.mindforger.com
 const string AutolinkingPreprocessor::MF_URL_PREFIX = AutolinkingPreprocessor::MF_URL_PROTOCOL + AutolinkingPreprocessor::MF_URL_HOST + "/";
 const string AutolinkingPreprocessor::FILE_URL_PROTOCOL = string{"file://"};
 
+constexpr int AutolinkingPreprocessor::AUTOLINKING_DEADLINE_MS;
+
 AutolinkingPreprocessor::AutolinkingPreprocessor(Mind& mind)
     : insensitive{true},
-      mind{mind}
+      mind{mind},
+      deadline{}
 {
 }
 
@@ -39,4 +42,10 @@ AutolinkingPreprocessor::~AutolinkingPreprocessor()
 {
 }
 
+void AutolinkingPreprocessor::startDeadline()
+{
+    deadline.reset();
+    deadline.setDeadline(chrono::milliseconds(AUTOLINKING_DEADLINE_MS));
+}
+
 } // m8r namespace
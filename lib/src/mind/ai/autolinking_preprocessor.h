@@ -22,6 +22,7 @@
 #include "../../representations/representation_interceptor.h"
 #include "../../mind/mind.h"
 #include "../../gear/trie.h"
+#include "../../gear/cancellation_token.h"
 #include "../../debug.h"
 
 namespace m8r {
@@ -32,6 +33,9 @@ namespace m8r {
  * Autolinking pre-processor injects Os and Ns text links to Markdown
  * text based on their names. Pre-processor output is valid Markdown text
  * which is typically rendered to HTML or other representation.
+ *
+ * Autolinking has time budget - once it's exceeded, the rest of the text
+ * is kept w/o links (prefix of the text is autolinked).
  */
 class AutolinkingPreprocessor : public RepresentationInterceptor
 {
@@ -46,11 +50,16 @@ public:
     static const std::string MATH_BLOCK;
     static const std::string FILE_URL_PROTOCOL;
 
+    static constexpr int AUTOLINKING_DEADLINE_MS = 1000;
+
 protected:
     bool insensitive;
 
     Mind& mind;
 
+    // time budget of running process()
+    CancellationToken deadline;
+
 public:
     explicit AutolinkingPreprocessor(Mind& mind);
     AutolinkingPreprocessor(const AutolinkingPreprocessor&) = delete;
@@ -63,6 +72,12 @@ public:
      * @brief Inject links to given MD source (list of rows) and return valid MD string.
      */
     virtual void process(const std::vector<std::string*>& in, std::string& out) = 0;
+
+protected:
+    /**
+     * @brief Start time budget of process() - check deadline.isCancelled() then.
+     */
+    void startDeadline();
 };
 
 }
@@ -78,6 +78,14 @@ public:
         return bow[t];
     }
 
+    /**
+     * @brief Find doc words w/o modifying BoW (safe to be called concurrently).
+     */
+    const WordFrequencyList* find(const Thing* t) const {
+        auto i = bow.find(const_cast<Thing*>(t));
+        return i != bow.end() ? i->second : nullptr;
+    }
+
     void reorderDocVectorsByWeight();
 
 #ifdef DO_MF_DEBUG
@@ -23,7 +23,7 @@ namespace m8r {
 using namespace std;
 
 MarkdownTokenizer::MarkdownTokenizer(Lexicon& lexicon, CommonWordsBlacklist& blacklist)
-    : lexicon(lexicon), blacklist(blacklist), stemmer{}
+    : lexicon(lexicon), blacklist(blacklist), stemCache{}, stemmed{}
 {
 }
 
@@ -142,16 +142,73 @@ void MarkdownTokenizer::tokenize(CharProvider& md, WordFrequencyList& wfl, bool
             break;
         }
     }
+    // last word of the stream
+    handleWord(wfl, w, stem, useBlacklist);
 
     lexicon.recalculateWeights();
 }
 
+void MarkdownTokenizer::tokenize(const Note* note, WordFrequencyList& wfl, bool useBlacklist, bool lowercase, bool stem)
+{
+    string w{};
+    // N name and every description line are followed by new line (see NoteCharProvider)
+    tokenizeSpan(note->getName().c_str(), note->getName().size(), true, w, wfl, useBlacklist, lowercase, stem);
+    for(const string* line:note->getDescription()) {
+        tokenizeSpan(line->c_str(), line->size(), true, w, wfl, useBlacklist, lowercase, stem);
+    }
+
+    lexicon.recalculateWeights();
+}
+
+void MarkdownTokenizer::tokenize(const string& text, WordFrequencyList& wfl, bool useBlacklist, bool lowercase, bool stem)
+{
+    string w{};
+    tokenizeSpan(text.c_str(), text.size(), false, w, wfl, useBlacklist, lowercase, stem);
+
+    lexicon.recalculateWeights();
+}
+
+void MarkdownTokenizer::tokenizeSpan(
+        const char* s,
+        size_t n,
+        bool delimited,
+        string& w,
+        WordFrequencyList& wfl,
+        bool useBlacklist,
+        bool lowercase,
+        bool stem)
+{
+    for(size_t i=0; i<n; i++) {
+        const char c = s[i];
+        if(c == '-') {
+            // check lookahead to accept words like: self-awareness
+            if((i+1<n && s[i+1]!='-') || (i+1==n && delimited)) {
+                w += c;
+                continue;
+            }
+        }
+
+        if(isNonAlpha(c)) {
+            handleWord(wfl, w, stem, useBlacklist);
+        } else {
+            if(lowercase) {
+                w += tolower(c);
+            } else {
+                w += c;
+            }
+        }
+    }
+
+    handleWord(wfl, w, stem, useBlacklist);
+}
+
 void MarkdownTokenizer::handleWord(WordFrequencyList& wfl, string &w, bool stem, bool useBlacklist)
 {
     if(w.size()>1) {
         // stem
         if(stem) {
-            w = stemmer.stem(w);
+            stemCache.stem(w, stemmed);
+            w.swap(stemmed);
         }
 
         // remove common words
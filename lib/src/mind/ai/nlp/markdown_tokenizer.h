@@ -27,7 +27,8 @@
 #include "char_provider.h"
 #include "lexicon.h"
 #include "word_frequency_list.h"
-#include "stemmer/stemmer.h"
+#include "stem_cache.h"
+#include "../../../model/note.h"
 
 namespace m8r {
 
@@ -38,7 +39,7 @@ namespace m8r {
  *
  *   - hardcoded delimiters
  *   - filters out words w/ length <1
- *   - stems words (optional)
+ *   - stems words (optional, memoized by stem cache)
  *   - computes token frequency via Lexicon
  *
  * See also:
@@ -53,7 +54,8 @@ class MarkdownTokenizer
      */
     CommonWordsBlacklist& blacklist;
 
-    Stemmer stemmer;
+    StemCache stemCache;
+    std::string stemmed;
 
 public:
     explicit MarkdownTokenizer(Lexicon& lexicon, CommonWordsBlacklist& blacklist);
@@ -68,6 +70,21 @@ public:
      */
     void tokenize(CharProvider& md, WordFrequencyList& wfl, bool useBlacklist=true, bool lowercase=true, bool stem=true);
 
+    /**
+     * @brief Tokenize N name and description lines.
+     *
+     * N is tokenized in place - line by line - w/o narrowing it to a string
+     * (tokens are the same as if NoteCharProvider would be used).
+     */
+    void tokenize(const Note* note, WordFrequencyList& wfl, bool useBlacklist=true, bool lowercase=true, bool stem=true);
+
+    /**
+     * @brief Tokenize string in place.
+     */
+    void tokenize(const std::string& text, WordFrequencyList& wfl, bool useBlacklist=true, bool lowercase=true, bool stem=true);
+
+    StemCache& getStemCache() { return stemCache; }
+
     /**
      * @brief Remove non-alpha numeric characters from the 1st word and return it.
      */
@@ -84,6 +101,10 @@ public:
     static bool isNonAlpha(char c);
 
 private:
+    /**
+     * @brief Tokenize span of characters, delimited span is followed by (virtual) new line.
+     */
+    void tokenizeSpan(const char* s, size_t n, bool delimited, std::string& w, WordFrequencyList& wfl, bool useBlacklist, bool lowercase, bool stem);
     inline void handleWord(WordFrequencyList& wfl, std::string &w, bool stem, bool useBlacklist);
 };
 
@@ -17,13 +17,14 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "named_entity_recognition.h"
+#include "../../../gear/tracer.h"
 
 namespace m8r {
 
 using namespace std;
 
 NamedEntityRecognition::NamedEntityRecognition()
-    : initilized{false}, nerModel{}
+    : initilized{false}, nerModel{}, cache{}
 {
 }
 
@@ -36,6 +37,15 @@ void NamedEntityRecognition::setNerModel(const std::string& nerModel) {
 
     initilized = false;
     nerModelPath = nerModel;
+
+    // entities recognized by other model are not valid
+    clearCache();
+}
+
+void NamedEntityRecognition::clearCache()
+{
+    std::lock_guard<mutex> criticalSection{cacheMutex};
+    cache.clear();
 }
 
 // this method is NOT synchronized - callers are synchronized so that race condition is avoided
@@ -72,26 +82,92 @@ bool NamedEntityRecognition::loadAndInitNerModel()
     return true;
 }
 
-vector<string> NamedEntityRecognition::tokenizeFile(const string& filename)
+void NamedEntityRecognition::tokenizeFile(const string& filename, vector<string>& tokens)
 {
     ifstream fin(filename.c_str());
     if(!fin) {
-        cout << "Unable to load input text file" << endl;
-        exit(EXIT_FAILURE);
+        throw MindForgerException{"Unable to load input text file " + filename};
     }
 
     // The conll_tokenizer splits the contents of an istream into a bunch of words and is
     // MITIE's default tokenization method.
     mitie::conll_tokenizer tok(fin);
-    std::vector<string> tokens;
     string token;
 
-    // Read the tokens out of the file one at a time and store into tokens.    
+    // Read the tokens out of the file one at a time and store into tokens.
+    tokens.clear();
     while(tok(token)) {
         tokens.push_back(token);
     }
+}
+
+bool NamedEntityRecognition::predictEntities(const string& filename, WorkerState& state, vector<NerNamedEntity>& entities)
+{
+    try {
+        // tokenize data to prepare it for the tagger
+        MF_DEBUG("NER: tokenizing O " << filename << endl);
+        tokenizeFile(filename, state.tokens);
+
+        // Now detect all the entities in the text file we loaded. The output of this function
+        // is a set of "chunks" of tokens, each a named entity. Additionally a confidence score
+        // for each "chunk" is available by using the predict() method.  The larger the score
+        // the more confident MITIE is in the tag.
+#ifdef DO_MF_DEBUG
+        MF_DEBUG("NER predicting..." << endl);
+        auto begin = chrono::high_resolution_clock::now();
+#endif
+        // model is shared by workers: predict() does NOT modify the model
+        nerModel.predict(state.tokens, state.chunks, state.chunkTags, state.chunkScores);
+#ifdef DO_MF_DEBUG
+        auto end = chrono::high_resolution_clock::now();
+        MF_DEBUG("NER prediction done in " << chrono::duration_cast<chrono::microseconds>(end-begin).count()/1000.0 << "ms" << endl);
+#endif
+
+        MF_DEBUG("\nNumber of named entities detected: " << state.chunks.size() << endl);
+        string entityName{};
+        for(unsigned int i = 0; i < state.chunks.size(); ++i) {
+            // chunks[i] defines a half open range in tokens that contains the entity.
+            entityName.clear();
+            for(unsigned long j = state.chunks[i].first; j < state.chunks[i].second; ++j) {
+                entityName += state.tokens[j];
+                entityName += " ";
+            }
+            if(entityName.size()) {
+                entityName.pop_back(); // remove trailing " "
+            }
+            MF_DEBUG("   Tag " << state.chunkTags[i] << ": " << fixed << setprecision(3) << state.chunkScores[i] << ": " << entityName << endl);
+
+            NerNamedEntity entity{
+                entityName,
+                static_cast<NerNamedEntityType>(1<<state.chunkTags[i]),
+                static_cast<float>(state.chunkScores[i])};
+            entities.push_back(entity);
+        }
 
-    return tokens;
+        return true;
+    }
+    catch(std::exception& e) {
+        cerr << "NRE error: " << e.what() << endl;
+    }
+
+    return false;
+}
+
+bool NamedEntityRecognition::getCachedEntities(const Outline* outline, int entityTypeFilter, vector<NerNamedEntity>& result)
+{
+    std::lock_guard<mutex> criticalSection{cacheMutex};
+
+    auto c = cache.find(outline->getKey());
+    if(c != cache.end() && c->second.revision == outline->getModified()) {
+        for(const NerNamedEntity& e:c->second.entities) {
+            if(e.type & entityTypeFilter) {
+                result.push_back(e);
+            }
+        }
+        return true;
+    }
+
+    return false;
 }
 
 bool NamedEntityRecognition::recognizePersons(vector<NerNamedEntity>& result)
@@ -113,66 +189,126 @@ bool NamedEntityRecognition::recognizePersons(const Outline* outline, int entity
 {
     std::lock_guard<mutex> criticalSection{initMutex};
 
-    if(loadAndInitNerModel())     {
-        try {
-            // tokenize data to prepare it for the tagger
-            MF_DEBUG("NER: tokenizing O " << outline->getKey() << endl);
-            std::vector<string> tokens = tokenizeFile(outline->getKey());
-
-            std::vector<pair<unsigned long, unsigned long> > chunks;
-            std::vector<unsigned long> chunk_tags;
-            std::vector<double> chunk_scores;
-
-            // Now detect all the entities in the text file we loaded and print them to the screen.
-            // The output of this function is a set of "chunks" of tokens, each a named entity.
-            // Additionally, if it is useful for your application a confidence score for each "chunk"
-            // is available by using the predict() method.  The larger the score the more
-            // confident MITIE is in the tag.
-#ifdef DO_MF_DEBUG
-            MF_DEBUG("NER predicting..." << endl);
-            auto begin = chrono::high_resolution_clock::now();
-#endif
-            nerModel.predict(tokens, chunks, chunk_tags, chunk_scores);
-#ifdef DO_MF_DEBUG
-            auto end = chrono::high_resolution_clock::now();
-            MF_DEBUG("NER prediction done in " << chrono::duration_cast<chrono::microseconds>(end-begin).count()/1000.0 << "ms" << endl);
-#endif
+    if(getCachedEntities(outline, entityTypeFilter, result)) {
+        MF_DEBUG("NER: entities of O " << outline->getKey() << " served from cache" << endl);
+        return true;
+    }
 
-            // If a confidence score is not necessary for your application you can detect entities
-            // using the operator() method as shown in the following line.
-            //ner(tokens, chunks, chunk_tags);
-
-            MF_DEBUG("\nNumber of named entities detected: " << chunks.size() << endl);
-            const std::vector<string> tagstr = nerModel.get_tag_name_strings();
-            string entityName{};
-            for (unsigned int i = 0; i < chunks.size(); ++i) {
-                if((1<<chunk_tags[i]) & entityTypeFilter) {
-                    MF_DEBUG("   Tag " << chunk_tags[i] << ": ");
-                    MF_DEBUG("Score: " << fixed << setprecision(3) << chunk_scores[i] << ": ");
-                    MF_DEBUG("" << tagstr[chunk_tags[i]] << ": ");
-                    // chunks[i] defines a half open range in tokens that contains the entity.
-                    entityName.clear();
-                    for(unsigned long j = chunks[i].first; j < chunks[i].second; ++j) {
-                        entityName += tokens[j];
-                        entityName += " ";
-                        MF_DEBUG(tokens[j] << " ");
-                    }
-                    entityName.pop_back(); // remove trailing " "
-                    MF_DEBUG(endl);
-
-                    NerNamedEntity entity{entityName,static_cast<NerNamedEntityType>(1<<chunk_tags[i]),static_cast<float>(chunk_scores[i])};
-                    result.push_back(entity);
+    if(loadAndInitNerModel()) {
+        WorkerState state{};
+        CachedEntities cached{outline->getModified(), {}};
+        if(predictEntities(outline->getKey(), state, cached.entities)) {
+            for(const NerNamedEntity& e:cached.entities) {
+                if(e.type & entityTypeFilter) {
+                    result.push_back(e);
                 }
             }
 
+            std::lock_guard<mutex> cacheCriticalSection{cacheMutex};
+            cache[outline->getKey()] = cached;
             return true;
         }
-        catch(std::exception& e) {
-            cerr << "NRE error: " << e.what() << endl;
-        }
     }
 
     return false;
 }
 
+bool NamedEntityRecognition::recognizeEntities(
+        const vector<Outline*>& outlines,
+        int entityTypeFilter,
+        vector<NerNamedEntity>& result,
+        const CancellationToken* cancellation)
+{
+    MF_TRACE_SPAN("ner", "recognize");
+    std::lock_guard<mutex> criticalSection{initMutex};
+
+#ifdef DO_MF_DEBUG
+    auto begin = chrono::high_resolution_clock::now();
+#endif
+
+    // find Os which are not cached (or cached for older revision)
+    vector<const Outline*> misses{};
+    {
+        std::lock_guard<mutex> cacheCriticalSection{cacheMutex};
+        for(const Outline* o:outlines) {
+            auto c = cache.find(o->getKey());
+            if(c == cache.end() || c->second.revision != o->getModified()) {
+                misses.push_back(o);
+            }
+        }
+    }
+
+    if(misses.size()) {
+        if(!loadAndInitNerModel()) {
+            return false;
+        }
+
+        // predict in parallel: workers take Os one by one, each w/ its own state
+        vector<vector<NerNamedEntity>> predicted(misses.size());
+        vector<char> predictedOk(misses.size(), 0);
+        atomic<size_t> next{0};
+        auto worker = [this, &misses, &predicted, &predictedOk, &next, cancellation]() {
+            WorkerState state{};
+            size_t i;
+            while((!cancellation || !cancellation->isCancelled()) && (i = next++) < misses.size()) {
+                predictedOk[i] = predictEntities(misses[i]->getKey(), state, predicted[i]);
+            }
+        };
+
+        size_t threadsCount = std::max(1u, std::thread::hardware_concurrency());
+        threadsCount = std::min(threadsCount, misses.size());
+        MF_DEBUG("NER: predicting entities in " << misses.size() << " Os using " << threadsCount << " threads" << endl);
+        vector<thread> workers{};
+        for(size_t t=1; t<threadsCount; t++) {
+            workers.push_back(thread{worker});
+        }
+        worker();
+        for(thread& w:workers) {
+            w.join();
+        }
+
+        std::lock_guard<mutex> cacheCriticalSection{cacheMutex};
+        for(size_t i=0; i<misses.size(); i++) {
+            if(predictedOk[i]) {
+                CachedEntities& cached = cache[misses[i]->getKey()];
+                cached.revision = misses[i]->getModified();
+                cached.entities.swap(predicted[i]);
+            }
+        }
+    }
+
+    if(cancellation && cancellation->isCancelled()) {
+        MF_DEBUG("NER: recognition of entities in " << outlines.size() << " Os INTERRUPTED" << endl);
+        return false;
+    }
+
+    // answer from cache: deduplicate entities across Os keeping the highest score
+    map<pair<string,int>,size_t> entityToResult{};
+    vector<NerNamedEntity> entities{};
+    for(const Outline* o:outlines) {
+        entities.clear();
+        getCachedEntities(o, entityTypeFilter, entities);
+        for(const NerNamedEntity& e:entities) {
+            auto r = entityToResult.find(make_pair(e.name, static_cast<int>(e.type)));
+            if(r == entityToResult.end()) {
+                entityToResult[make_pair(e.name, static_cast<int>(e.type))] = result.size();
+                result.push_back(e);
+            } else if(result[r->second].score < e.score) {
+                result[r->second].score = e.score;
+            }
+        }
+    }
+    std::stable_sort(
+        result.begin(),
+        result.end(),
+        [](const NerNamedEntity& e1, const NerNamedEntity& e2) { return e1.score > e2.score; });
+
+#ifdef DO_MF_DEBUG
+    auto end = chrono::high_resolution_clock::now();
+    MF_DEBUG("NER: " << result.size() << " entities recognized in " << outlines.size() << " Os (" << misses.size() << " predicted) in " << chrono::duration_cast<chrono::microseconds>(end-begin).count()/1000.0 << "ms" << endl);
+#endif
+
+    return true;
+}
+
 } // m8r namespace
@@ -21,6 +21,11 @@
 
 #include <vector>
 #include <string>
+#include <map>
+#include <ctime>
+#include <thread>
+#include <atomic>
+#include <algorithm>
 
 #include <iostream>
 #include <iomanip>
@@ -35,18 +40,50 @@
 #include "ner_named_entity.h"
 
 #include "../../../model/outline.h"
+#include "../../../gear/cancellation_token.h"
+#include "../../../exceptions.h"
 
 namespace m8r {
 
+/**
+ * @brief Named-entity recognition.
+ *
+ * Entities of all types recognized in an O are cached per O revision (O
+ * modification timestamp), therefore repeated queries (with any entity type
+ * filter) are answered from the cache. Batch recognition predicts entities
+ * of cache-missing Os in parallel - NER model is shared (read only)
+ * and each worker thread has its own tokenization/prediction state.
+ */
 class NamedEntityRecognition
 {
 private:
+    /**
+     * @brief Per worker thread NER state (buffers reused across Os).
+     */
+    struct WorkerState {
+        std::vector<std::string> tokens;
+        std::vector<std::pair<unsigned long, unsigned long>> chunks;
+        std::vector<unsigned long> chunkTags;
+        std::vector<double> chunkScores;
+    };
+
+    struct CachedEntities {
+        time_t revision;
+        std::vector<NerNamedEntity> entities;
+    };
+
     std::mutex initMutex;
     bool initilized;
 
     std::string  nerModelPath;
     mitie::named_entity_extractor nerModel;
 
+    /**
+     * @brief O key -> entities (of all types) recognized in given O revision.
+     */
+    std::map<std::string,CachedEntities> cache;
+    std::mutex cacheMutex;
+
 public:
     explicit NamedEntityRecognition();
     NamedEntityRecognition(const NamedEntityRecognition&) = delete;
@@ -74,8 +111,33 @@ public:
      */
     bool recognizePersons(const Outline* outline, int entityTypeFilter, std::vector<NerNamedEntity>& result);
 
+    /**
+     * @brief NRE entities in Os - batch (parallel) recognition.
+     *
+     * Entities are deduplicated across Os (the highest score is kept) and
+     * sorted by score. Cancelled recognition caches entities of Os predicted
+     * so far and returns false.
+     */
+    bool recognizeEntities(
+            const std::vector<Outline*>& outlines,
+            int entityTypeFilter,
+            std::vector<NerNamedEntity>& result,
+            const CancellationToken* cancellation=nullptr);
+
+    void clearCache();
+
 private:
-    std::vector<std::string> tokenizeFile(const std::string& filename);
+    void tokenizeFile(const std::string& filename, std::vector<std::string>& tokens);
+
+    /**
+     * @brief Recognize entities of all types in O file (NOT synchronized, model must be initialized).
+     */
+    bool predictEntities(const std::string& filename, WorkerState& state, std::vector<NerNamedEntity>& entities);
+
+    /**
+     * @brief Get cached entities of given types, return false on cache miss.
+     */
+    bool getCachedEntities(const Outline* outline, int entityTypeFilter, std::vector<NerNamedEntity>& result);
 
     /**
      * @brief Load and initialize NER model file.
@@ -0,0 +1,101 @@
+/*
+ stem_cache.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "stem_cache.h"
+
+namespace m8r {
+
+using namespace std;
+
+StemCache::StemCache(size_t capacity)
+    : stemmer{},
+      capacity{capacity},
+      generation{0},
+      words{},
+      stemIds{},
+      stems{},
+      hits{0},
+      misses{0}
+{
+}
+
+StemCache::~StemCache()
+{
+}
+
+int StemCache::stem(const string& word, string& stem)
+{
+    lock_guard<mutex> criticalSection{cacheMutex};
+
+    auto w = words.find(word);
+    if(w != words.end()) {
+        ++hits;
+        stem.assign(*stems[w->second]);
+        return w->second;
+    }
+
+    ++misses;
+    if(words.size() >= capacity) {
+        flush();
+    }
+
+    stem = stemmer.stem(word);
+    // intern stem
+    int id;
+    auto s = stemIds.find(stem);
+    if(s != stemIds.end()) {
+        id = s->second;
+    } else {
+        id = static_cast<int>(stems.size());
+        stems.push_back(&(stemIds.insert(pair<string,int>(stem, id)).first->first));
+    }
+    words[word] = id;
+
+    return id;
+}
+
+unsigned StemCache::getGeneration()
+{
+    lock_guard<mutex> criticalSection{cacheMutex};
+    return generation;
+}
+
+size_t StemCache::size()
+{
+    lock_guard<mutex> criticalSection{cacheMutex};
+    return words.size();
+}
+
+void StemCache::clear()
+{
+    lock_guard<mutex> criticalSection{cacheMutex};
+    flush();
+    hits = misses = 0;
+}
+
+void StemCache::flush()
+{
+    MF_DEBUG("[StemCache] flushing " << words.size() << " words / " << stems.size() << " stems (" << hits << " hits / " << misses << " misses)" << std::endl);
+
+    words.clear();
+    stems.clear();
+    stemIds.clear();
+    generation++;
+}
+
+} // m8r namespace
@@ -0,0 +1,94 @@
+/*
+ stem_cache.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_STEM_CACHE_H
+#define M8R_STEM_CACHE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+
+#include "../../../debug.h"
+#include "stemmer/stemmer.h"
+
+namespace m8r {
+
+/**
+ * @brief Bounded and thread safe word to stem memoization cache.
+ *
+ * Snowball stemming is expensive and the same (small) set of words
+ * is stemmed over and over again when Notes are re-tokenized. Cache
+ * maps words to interned stems - many words share the same stem, therefore
+ * each stem is kept just once and identified by its (integer) id.
+ *
+ * When the number of cached words reaches the capacity, the cache is
+ * flushed ~ stem ids are valid only until next flush (generation).
+ */
+class StemCache
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1<<16;
+
+private:
+    Stemmer stemmer;
+
+    size_t capacity;
+    unsigned generation;
+
+    // word -> stem id
+    std::unordered_map<std::string,int> words;
+    // stem -> stem id
+    std::unordered_map<std::string,int> stemIds;
+    // stem id -> stem
+    std::vector<const std::string*> stems;
+
+    unsigned long hits;
+    unsigned long misses;
+
+    std::mutex cacheMutex;
+
+public:
+    explicit StemCache(size_t capacity=DEFAULT_CAPACITY);
+    StemCache(const StemCache&) = delete;
+    StemCache(const StemCache&&) = delete;
+    StemCache &operator=(const StemCache&) = delete;
+    StemCache &operator=(const StemCache&&) = delete;
+    ~StemCache();
+
+    /**
+     * @brief Stem word to stem and return id of the interned stem.
+     */
+    int stem(const std::string& word, std::string& stem);
+
+    /**
+     * @brief Get generation - incremented on every flush.
+     */
+    unsigned getGeneration();
+    size_t size();
+    unsigned long getHits() const { return hits; }
+    unsigned long getMisses() const { return misses; }
+
+    void clear();
+
+private:
+    void flush();
+};
+
+}
+#endif // M8R_STEM_CACHE_H
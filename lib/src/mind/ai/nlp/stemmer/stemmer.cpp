@@ -31,7 +31,7 @@ Stemmer::~Stemmer()
 {
 }
 
-string Stemmer::stem(string word)
+string Stemmer::stem(const string& word)
 {
     // IMPROVE: despite stemmer works in wstring mode, MindForger runs just in string mode - wstring to come later when entire application is switched
     std::wstringstream swide;
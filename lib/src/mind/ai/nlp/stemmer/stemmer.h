@@ -73,7 +73,7 @@ public:
 
     void setLanguage(Language lang) { this->language = lang; }
 
-    std::string stem(std::string word);
+    std::string stem(const std::string& word);
 };
 
 }
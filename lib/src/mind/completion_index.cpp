@@ -0,0 +1,208 @@
+/*
+ completion_index.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "completion_index.h"
+
+namespace m8r {
+
+using namespace std;
+
+/*
+ * Things
+ */
+
+ThingsCompletionIndex::ThingsCompletionIndex()
+    : index{},
+      indexed{}
+{
+}
+
+ThingsCompletionIndex::~ThingsCompletionIndex()
+{
+}
+
+void ThingsCompletionIndex::reindex(const vector<Outline*>& outlines)
+{
+#ifdef DO_MF_DEBUG
+    auto begin = chrono::high_resolution_clock::now();
+#endif
+
+    clear();
+
+    // keys are collected and sorted at once - per key sorted inserts would be O(n^2)
+    vector<pair<string,Thing*>> all{};
+    for(Outline* o:outlines) {
+        vector<pair<string,Thing*>>& names = indexed[o];
+        collectNames(o, names);
+        all.insert(all.end(), names.begin(), names.end());
+    }
+    index.add(all);
+
+#ifdef DO_MF_DEBUG
+    auto end = chrono::high_resolution_clock::now();
+    MF_DEBUG("[Completion] things index w/ " << index.size() << " names built in: " << chrono::duration_cast<chrono::microseconds>(end-begin).count()/1000.0 << "ms" << endl);
+#endif
+}
+
+void ThingsCompletionIndex::update(Outline* outline)
+{
+    if(outline) {
+        forget(outline);
+
+        vector<pair<string,Thing*>>& names = indexed[outline];
+        collectNames(outline, names);
+        index.add(names);
+    }
+}
+
+void ThingsCompletionIndex::collectNames(Outline* outline, vector<pair<string,Thing*>>& names)
+{
+    names.reserve(outline->getNotesCount()+1);
+    names.push_back(pair<string,Thing*>(outline->getName(), outline));
+    for(Note* n:outline->getNotes()) {
+        names.push_back(pair<string,Thing*>(n->getName(), n));
+    }
+}
+
+void ThingsCompletionIndex::forget(const Outline* outline)
+{
+    auto it = indexed.find(outline);
+    if(it != indexed.end()) {
+        index.remove(it->second);
+        indexed.erase(it);
+    }
+}
+
+void ThingsCompletionIndex::clear()
+{
+    index.clear();
+    indexed.clear();
+}
+
+void ThingsCompletionIndex::complete(const string& prefix, vector<Thing*>& result, size_t limit) const
+{
+    vector<const PrefixIndex<Thing*>::Entry*> entries{};
+    index.find(prefix, entries, limit);
+    for(auto e:entries) {
+        result.push_back(e->value);
+    }
+}
+
+/*
+ * Document words
+ */
+
+DocumentWordsIndex::DocumentWordsIndex()
+    : lines{},
+      index{}
+{
+}
+
+DocumentWordsIndex::~DocumentWordsIndex()
+{
+}
+
+void DocumentWordsIndex::tokenize(const string& line, vector<string>& words)
+{
+    // word ~ \w+ (bytes of UTF-8 multibyte characters are considered to be word characters)
+    size_t begin = string::npos;
+    for(size_t i=0; i<=line.size(); i++) {
+        unsigned char c = i<line.size()?static_cast<unsigned char>(line[i]):' ';
+        if(isalnum(c) || c=='_' || c>=0x80) {
+            if(begin == string::npos) {
+                begin = i;
+            }
+        } else if(begin != string::npos) {
+            words.push_back(line.substr(begin, i-begin));
+            begin = string::npos;
+        }
+    }
+}
+
+void DocumentWordsIndex::beginUpdate()
+{
+    for(auto& l:lines) {
+        l.second.seen = 0;
+    }
+}
+
+bool DocumentWordsIndex::touchLine(size_t lineHash)
+{
+    auto it = lines.find(lineHash);
+    if(it != lines.end()) {
+        Line& l = it->second;
+        if(++l.seen > l.count) {
+            // yet another copy of an indexed line
+            l.count++;
+            for(const string& w:l.words) {
+                index.add(w, 0);
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+void DocumentWordsIndex::addLine(size_t lineHash, const string& line)
+{
+    Line& l = lines[lineHash];
+    l.count = l.seen = 1;
+    l.words.clear();
+    tokenize(line, l.words);
+    for(const string& w:l.words) {
+        index.add(w, 0);
+    }
+}
+
+void DocumentWordsIndex::endUpdate()
+{
+    for(auto it=lines.begin(); it!=lines.end(); ) {
+        Line& l = it->second;
+        while(l.count > l.seen) {
+            for(const string& w:l.words) {
+                index.remove(w, 0);
+            }
+            l.count--;
+        }
+        if(!l.count) {
+            it = lines.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void DocumentWordsIndex::clear()
+{
+    lines.clear();
+    index.clear();
+}
+
+void DocumentWordsIndex::complete(const string& prefix, vector<string>& result, size_t limit) const
+{
+    vector<const PrefixIndex<int>::Entry*> entries{};
+    // +1 as prefix itself (word being written) is typically indexed
+    index.find(prefix, entries, limit+1);
+    for(auto e:entries) {
+        if(result.size() < limit && e->key.compare(prefix)) {
+            result.push_back(e->key);
+        }
+    }
+}
+
+} // m8r namespace
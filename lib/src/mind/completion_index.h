@@ -0,0 +1,139 @@
+/*
+ completion_index.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_COMPLETION_INDEX_H
+#define M8R_COMPLETION_INDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "../debug.h"
+#include "../gear/prefix_index.h"
+#include "../model/outline.h"
+#include "../model/note.h"
+
+namespace m8r {
+
+/**
+ * @brief Things (Os and Ns) names completion index.
+ *
+ * Index is maintained incrementally - Outline's Ns are re-indexed
+ * when the O is remembered/forgotten. Completion returns ranked top N
+ * Things, link serialization is left to the caller so that it's done
+ * only for the results which are shown.
+ */
+class ThingsCompletionIndex
+{
+private:
+    PrefixIndex<Thing*> index;
+
+    /**
+     * @brief Names under which O and its Ns were indexed (names might have changed since).
+     */
+    std::map<const Outline*,std::vector<std::pair<std::string,Thing*>>> indexed;
+
+public:
+    explicit ThingsCompletionIndex();
+    ThingsCompletionIndex(const ThingsCompletionIndex&) = delete;
+    ThingsCompletionIndex(const ThingsCompletionIndex&&) = delete;
+    ThingsCompletionIndex &operator=(const ThingsCompletionIndex&) = delete;
+    ThingsCompletionIndex &operator=(const ThingsCompletionIndex&&) = delete;
+    ~ThingsCompletionIndex();
+
+    /**
+     * @brief Rebuild index from scratch e.g. on learn.
+     */
+    void reindex(const std::vector<Outline*>& outlines);
+    /**
+     * @brief Update O and its Ns e.g. on remember.
+     */
+    void update(Outline* outline);
+    /**
+     * @brief Remove O and its Ns from index e.g. on forget.
+     */
+    void forget(const Outline* outline);
+    void clear();
+
+    size_t size() const { return index.size(); }
+
+    /**
+     * @brief Find at most limit best ranked Things w/ name starting with prefix.
+     */
+    void complete(const std::string& prefix, std::vector<Thing*>& result, size_t limit) const;
+
+private:
+    static void collectNames(Outline* outline, std::vector<std::pair<std::string,Thing*>>& names);
+};
+
+/**
+ * @brief Words completion index of a document (e.g. text in the editor).
+ *
+ * Document lines are identified by hash of their content, therefore synchronization
+ * of the index with the document tokenizes only lines which were added and
+ * untokenizes only lines which were removed since the last synchronization:
+ *
+ *   index.beginUpdate();
+ *   for(line:lines) if(!index.touchLine(hash(line))) index.addLine(hash(line), line);
+ *   index.endUpdate();
+ */
+class DocumentWordsIndex
+{
+private:
+    struct Line {
+        unsigned count;
+        unsigned seen;
+        std::vector<std::string> words;
+    };
+
+    std::unordered_map<size_t,Line> lines;
+    PrefixIndex<int> index;
+
+public:
+    explicit DocumentWordsIndex();
+    DocumentWordsIndex(const DocumentWordsIndex&) = delete;
+    DocumentWordsIndex(const DocumentWordsIndex&&) = delete;
+    DocumentWordsIndex &operator=(const DocumentWordsIndex&) = delete;
+    DocumentWordsIndex &operator=(const DocumentWordsIndex&&) = delete;
+    ~DocumentWordsIndex();
+
+    void beginUpdate();
+    /**
+     * @brief Mark line w/ given hash as present - returns false if it's not indexed (yet).
+     */
+    bool touchLine(size_t lineHash);
+    void addLine(size_t lineHash, const std::string& line);
+    /**
+     * @brief Remove words of lines which were not touched/added since beginUpdate().
+     */
+    void endUpdate();
+    void clear();
+
+    size_t size() const { return index.size(); }
+
+    /**
+     * @brief Find at most limit most frequent words starting with prefix (prefix itself excluded).
+     */
+    void complete(const std::string& prefix, std::vector<std::string>& result, size_t limit) const;
+
+    static void tokenize(const std::string& line, std::vector<std::string>& words);
+};
+
+}
+#endif // M8R_COMPLETION_INDEX_H
@@ -43,7 +43,11 @@ KnowledgeGraph::KnowledgeGraph(
         long unsigned outlinesColor,
         long unsigned notesColor
         )
-    : mind{mind}
+    : mind{mind},
+      thingNodes{},
+      tagNodes{},
+      subgraphCache{},
+      memoryWatermark{-1}
 {
     mindNode = new KnowledgeGraphNode{KnowledgeGraphNodeType::MIND, "MIND", mindColor, 5};
     tagsNode = new KnowledgeGraphNode{KnowledgeGraphNodeType::TAGS, "tags"};
@@ -59,6 +63,8 @@ KnowledgeGraph::KnowledgeGraph(
 
 KnowledgeGraph::~KnowledgeGraph()
 {
+    clear();
+
     delete mindNode;
     delete tagsNode;
     delete outlinesNode;
@@ -67,6 +73,46 @@ KnowledgeGraph::~KnowledgeGraph()
     //delete stencilsNode;
 }
 
+void KnowledgeGraph::clear()
+{
+    subgraphCache.clear();
+    memoryWatermark = -1;
+
+    for(auto& n:thingNodes) {
+        delete n.second;
+    }
+    thingNodes.clear();
+    for(auto& n:tagNodes) {
+        delete n.second;
+    }
+    tagNodes.clear();
+}
+
+void KnowledgeGraph::forget(const Outline* outline)
+{
+    for(const Note* n:outline->getNotes()) {
+        forget(n);
+    }
+
+    auto k = thingNodes.find(outline);
+    if(k != thingNodes.end()) {
+        delete k->second;
+        thingNodes.erase(k);
+    }
+    subgraphCache.clear();
+}
+
+void KnowledgeGraph::forget(const Note* note)
+{
+    auto k = thingNodes.find(note);
+    if(k != thingNodes.end()) {
+        delete k->second;
+        thingNodes.erase(k);
+        // cached subgraphs might refer the node
+        subgraphCache.clear();
+    }
+}
+
 KnowledgeGraphNode* KnowledgeGraph::getNode(KnowledgeGraphNodeType type)
 {
     switch(type) {
@@ -94,28 +140,49 @@ KnowledgeGraphNode* KnowledgeGraph::getNode(KnowledgeGraphNodeType type)
     return nullptr;
 }
 
+// pooled node is refreshed as Thing might have been changed since node creation
 KnowledgeGraphNode* KnowledgeGraph::getNode(Outline* o)
 {
-    KnowledgeGraphNode* k = new KnowledgeGraphNode{
-            KnowledgeGraphNodeType::OUTLINE,
-            o->getName(),
-            outlinesColor,
-            static_cast<unsigned int>(o->getNotesCount())};
-    k->setThing(o);
+    KnowledgeGraphNode*& k = thingNodes[o];
+    if(!k) {
+        k = new KnowledgeGraphNode{KnowledgeGraphNodeType::OUTLINE, o->getName()};
+        k->setThing(o);
+    } else {
+        k->setType(KnowledgeGraphNodeType::OUTLINE);
+        k->setName(o->getName());
+    }
+    k->setColor(outlinesColor);
+    k->setCardinality(static_cast<unsigned int>(o->getNotesCount()));
 
     return k;
 }
 
 KnowledgeGraphNode* KnowledgeGraph::getNode(Note* n)
 {
-    KnowledgeGraphNode* k = new KnowledgeGraphNode{KnowledgeGraphNodeType::NOTE, n->getName(), notesColor};
-    k->setThing(n);
+    KnowledgeGraphNode*& k = thingNodes[n];
+    if(!k) {
+        k = new KnowledgeGraphNode{KnowledgeGraphNodeType::NOTE, n->getName()};
+        k->setThing(n);
+    } else {
+        k->setType(KnowledgeGraphNodeType::NOTE);
+        k->setName(n->getName());
+    }
+    k->setColor(notesColor);
     k->setCardinality(n->getOutline()->getDirectNoteChildrenCount(n));
 
     return k;
 }
 
-// TODO this method leaks a lot - knowledge graph nodes
+KnowledgeGraphNode* KnowledgeGraph::getNode(const Tag* t)
+{
+    KnowledgeGraphNode*& k = tagNodes[t];
+    if(!k) {
+        k = new KnowledgeGraphNode{KnowledgeGraphNodeType::TAG, t->getName(), t->getColor().asLong()};
+    }
+
+    return k;
+}
+
 void KnowledgeGraph::getRelatedNodes(KnowledgeGraphNode* centralNode, KnowledgeSubGraph& subgraph)
 {
     subgraph.clear();
@@ -127,182 +194,157 @@ void KnowledgeGraph::getRelatedNodes(KnowledgeGraphNode* centralNode, KnowledgeS
     //stencilsNode->setCardinality(static_cast<unsigned int>(mind->remind().getStencils().size()));
     //limboNode->...
 
+    // evict subgraphs calculated for previous memory (scope may change anytime - don't cache)
+    if(memoryWatermark != mind->getMemoryWatermark() || mind->getScopeAspect().isEnabled()) {
+        subgraphCache.clear();
+        memoryWatermark = mind->getMemoryWatermark();
+    }
+
+    auto cached = subgraphCache.find(centralNode);
+    if(cached == subgraphCache.end()) {
+        // refresh central node as it might have been changed as well
+        if(centralNode->getType() == KnowledgeGraphNodeType::OUTLINE) {
+            getNode(centralNode->getOutline());
+        } else if(centralNode->getType() == KnowledgeGraphNodeType::NOTE) {
+            getNode(centralNode->getNode());
+        }
+
+        cached = subgraphCache.insert(
+            std::make_pair(centralNode, vector<pair<KnowledgeGraphNode*,bool>>{})).first;
+        calculateRelatedNodes(centralNode, cached->second);
+    }
+
+    subgraph.setCentralNode(centralNode);
+    for(auto& r:cached->second) {
+        if(r.second) {
+            subgraph.addParent(r.first);
+        } else {
+            subgraph.addChild(r.first);
+        }
+    }
+}
+
+void KnowledgeGraph::calculateRelatedNodes(KnowledgeGraphNode* centralNode, vector<pair<KnowledgeGraphNode*,bool>>& related)
+{
+    static const bool PARENT = true;
+    static const bool CHILD = false;
+
     // significant ontology things
     if(centralNode == mindNode) {
-        subgraph.setCentralNode(mindNode);
-
-        subgraph.addChild(tagsNode);
-        subgraph.addChild(outlinesNode);
-        subgraph.addChild(notesNode);
-        //subgraph.addChild(stencilsNode);
-        //subgraph.addChild(limboNode);
+        related.push_back(make_pair(tagsNode, CHILD));
+        related.push_back(make_pair(outlinesNode, CHILD));
+        related.push_back(make_pair(notesNode, CHILD));
+        //related.push_back(make_pair(stencilsNode, CHILD));
+        //related.push_back(make_pair(limboNode, CHILD));
 
         return;
     } else if(centralNode == outlinesNode) {
-        subgraph.setCentralNode(outlinesNode);
-
         const vector<Outline*>& outlines = mind->getOutlines();
-        if(outlines.size()) {
-            KnowledgeGraphNode* k;
-            for(Outline* o:outlines) {
-                // TODO: reuse and delete - map<Thing*,Node*>
-                k = new KnowledgeGraphNode{KnowledgeGraphNodeType::OUTLINE, o->getName(), outlinesColor, static_cast<unsigned int>(o->getNotesCount())};
-                k->setThing(o);
-                subgraph.addChild(k);
-            }
+        related.reserve(outlines.size()+1);
+        for(Outline* o:outlines) {
+            related.push_back(make_pair(getNode(o), CHILD));
         }
 
-        subgraph.addParent(mindNode);
+        related.push_back(make_pair(mindNode, PARENT));
 
         return;
     } else if(centralNode == notesNode) {
-        subgraph.setCentralNode(notesNode);
-
         // IMPROVE limit maximum number of Ns to be rendered - avoid MF trashing when rendering 1M of nodes
         vector<Note*> notes{};
         mind->getAllNotes(notes);
-        if(notes.size()) {
-            KnowledgeGraphNode* k;
-            std::vector<Note*> nc;
-            for(Note* n:notes) {
-                // TODO: reuse and delete - map<Thing*,Node*>
-                k = new KnowledgeGraphNode{KnowledgeGraphNodeType::NOTE, n->getName(), notesColor};
-                k->setThing(n);
-                k->setCardinality(n->getOutline()->getDirectNoteChildrenCount(n));
-                subgraph.addChild(k);
-            }
+        related.reserve(notes.size()+1);
+        for(Note* n:notes) {
+            related.push_back(make_pair(getNode(n), CHILD));
         }
 
-        subgraph.addParent(mindNode);
+        related.push_back(make_pair(mindNode, PARENT));
 
         return;
     } else if(centralNode == tagsNode) {
-        subgraph.setCentralNode(tagsNode);
-
         // IMPROVE iterate map, don't load tags
         map<const Tag*,int> tagsCardinality{};
         mind->getTagsCardinality(tagsCardinality);
-        KnowledgeGraphNode* n;
-        vector<const Tag*>& tags = mind->getTags().values();
+        KnowledgeGraphNode* k;
+        vector<const Tag*> tags = mind->getTags().values();
+        related.reserve(tags.size()+1);
         for(const Tag* t:tags) {
-            // TODO: reuse and delete - map<Thing*,Node*>
-            n = new KnowledgeGraphNode{KnowledgeGraphNodeType::TAG, t->getName(), t->getColor().asLong(), static_cast<unsigned>(tagsCardinality[t])};
-            subgraph.addChild(n);
+            k = getNode(t);
+            k->setCardinality(static_cast<unsigned>(tagsCardinality[t]));
+            related.push_back(make_pair(k, CHILD));
         }
 
-        subgraph.addParent(mindNode);
+        related.push_back(make_pair(mindNode, PARENT));
 
         return;
     } else /* if(centralNode == stencilsNode) {
-        subgraph.setCentralNode(stencilsNode);
-
-        subgraph.addParent(mindNode);
+        related.push_back(make_pair(mindNode, PARENT));
 
         return;
     } else if(centralNode == limboNode) {
-        subgraph.setCentralNode(limboNode);
-
-        subgraph.addParent(mindNode);
+        related.push_back(make_pair(mindNode, PARENT));
 
         return;
     } */
 
     // things by type
     if(centralNode->getType() == KnowledgeGraphNodeType::OUTLINE) {
-        subgraph.setCentralNode(centralNode);
-
         Outline* o = static_cast<Outline*>(centralNode->getThing());
-        KnowledgeGraphNode* k;
         // child Ns only
         vector<Note*> children{};
         o->getDirectNoteChildren(children);
         for(Note* n:children) {
-            // TODO: reuse and delete - map<Thing*,Node*>
-            k = new KnowledgeGraphNode{KnowledgeGraphNodeType::NOTE, n->getName(), notesColor};
-            k->setThing(n);
-            k->setCardinality(n->getOutline()->getDirectNoteChildrenCount(n));
-            subgraph.addChild(k);
+            related.push_back(make_pair(getNode(n), CHILD));
         }
 
         const std::vector<const Tag*>* tags = o->getTags();
         for(const Tag* t:*tags) {
-            // TODO: reuse and delete - map<Thing*,Node*>
-            k = new KnowledgeGraphNode{KnowledgeGraphNodeType::TAG, t->getName(), t->getColor().asLong()};
-            subgraph.addChild(k);
+            related.push_back(make_pair(getNode(t), CHILD));
         }
 
-        subgraph.addParent(outlinesNode);
+        related.push_back(make_pair(outlinesNode, PARENT));
 
         return;
     } else if(centralNode->getType() == KnowledgeGraphNodeType::NOTE) {
-        subgraph.setCentralNode(centralNode);
-
         Note* n = static_cast<Note*>(centralNode->getThing());
-        KnowledgeGraphNode* k;
-        k = new KnowledgeGraphNode{KnowledgeGraphNodeType::OUTLINE, n->getOutline()->getName(), outlinesColor, static_cast<unsigned int>(n->getOutline()->getNotesCount())};
-        k->setThing(n->getOutline());
-        subgraph.addParent(k);
+        related.push_back(make_pair(getNode(n->getOutline()), PARENT));
 
         // child Ns
         vector<Note*> children{};
         n->getOutline()->getDirectNoteChildren(n, children);
-        for(Note* n:children) {
-            // TODO: reuse and delete - map<Thing*,Node*>
-            k = new KnowledgeGraphNode{KnowledgeGraphNodeType::NOTE, n->getName(), notesColor};
-            k->setThing(n);
-            k->setCardinality(n->getOutline()->getDirectNoteChildrenCount(n));
-            subgraph.addChild(k);
+        for(Note* c:children) {
+            related.push_back(make_pair(getNode(c), CHILD));
         }
 
         const std::vector<const Tag*>* tags = n->getTags();
         for(const Tag* t:*tags) {
-            // TODO: reuse and delete - map<Thing*,Node*>
-            k = new KnowledgeGraphNode{KnowledgeGraphNodeType::TAG, t->getName(), t->getColor().asLong()};
-            subgraph.addChild(k);
+            related.push_back(make_pair(getNode(t), CHILD));
         }
 
-        subgraph.addParent(notesNode);
+        related.push_back(make_pair(notesNode, PARENT));
 
         return;
     } else if(centralNode->getType() == KnowledgeGraphNodeType::TAG) {
-        subgraph.setCentralNode(centralNode);
-
         vector<const Tag*> tags{};
         tags.push_back(mind->getOntology().findOrCreateTag(centralNode->getName()));
         // Os
         vector<Outline*> outlines{};
         mind->findOutlinesByTags(tags, outlines);
-        if(outlines.size()) {
-            KnowledgeGraphNode* k;
-            for(Outline* o:outlines) {
-                // TODO: reuse and delete - map<Thing*,Node*>
-                k = new KnowledgeGraphNode{KnowledgeGraphNodeType::OUTLINE, o->getName(), outlinesColor, static_cast<unsigned int>(o->getNotesCount())};
-                k->setThing(o);
-                subgraph.addChild(k);
-            }
+        for(Outline* o:outlines) {
+            related.push_back(make_pair(getNode(o), CHILD));
         }
 
         // Ns
         vector<Note*> notes{};
         mind->findNotesByTags(tags, notes);
-        if(notes.size()) {
-            KnowledgeGraphNode* k;
-            for(Note* n:notes) {
-                // TODO: reuse and delete - map<Thing*,Node*>
-                k = new KnowledgeGraphNode{KnowledgeGraphNodeType::NOTE, n->getName(), notesColor};
-                k->setThing(n);
-                k->setCardinality(n->getOutline()->getDirectNoteChildrenCount(n));
-                subgraph.addChild(k);
-            }
+        for(Note* n:notes) {
+            related.push_back(make_pair(getNode(n), CHILD));
         }
 
-        subgraph.addParent(tagsNode);
+        related.push_back(make_pair(tagsNode, PARENT));
 
         return;
     } /* else if(centralNode->getType() == KnowledgeGraphNodeType::STENCIL) {
-        subgraph.setCentralNode(centralNode);
-
-        subgraph.addParent(stencilsNode);
+        related.push_back(make_pair(stencilsNode, PARENT));
 
         return;
     } */
@@ -19,6 +19,8 @@
 #ifndef M8R_KNOWLEDGE_GRAPH_H
 #define M8R_KNOWLEDGE_GRAPH_H
 
+#include <map>
+
 #include "mind.h"
 #include "../model/tag.h"
 
@@ -58,7 +60,11 @@ public:
         this->name = name;
         this->color = color;
         this->cardinality = cardinality;
+        this->thing = nullptr;
     }
+    void setType(KnowledgeGraphNodeType type) { this->type = type; }
+    void setName(const std::string& name) { this->name = name; }
+    void setColor(long unsigned color) { this->color = color; }
     void setThing(Thing* thing) { this->thing = thing; }
     const std::string& getName() const { return name; }
     long getColor() const { return color; }
@@ -106,10 +112,30 @@ public:
     }
 };
 
+/**
+ * @brief Knowledge graph.
+ *
+ * Nodes representing Things and Tags are pooled - there is exactly one node
+ * per Thing/Tag, which is reused (and refreshed) on navigation. Pooled nodes are
+ * owned by the graph and deleted when the graph is cleared i.e. when Mind
+ * learns a new Memory, or when their Thing is forgotten. Clients (navigator)
+ * must drop nodes they hold before Mind forgets Things or learns.
+ *
+ * Calculated subgraphs are cached and evicted whenever Memory changes
+ * (see Mind's memory watermark), so repeated navigation costs are flat.
+ */
 class KnowledgeGraph
 {
     Mind* mind;
 
+    // node pool: Thing/Tag -> node
+    std::map<const Thing*,KnowledgeGraphNode*> thingNodes;
+    std::map<const Tag*,KnowledgeGraphNode*> tagNodes;
+
+    // subgraph cache: central node -> related nodes in the order they were calculated (true ~ parent)
+    std::map<const KnowledgeGraphNode*,std::vector<std::pair<KnowledgeGraphNode*,bool>>> subgraphCache;
+    int memoryWatermark;
+
     KnowledgeGraphNode* mindNode;
     KnowledgeGraphNode* tagsNode;
     KnowledgeGraphNode* outlinesNode;
@@ -138,6 +164,25 @@ public:
     KnowledgeGraphNode* getNode(Outline* outline);
     KnowledgeGraphNode* getNode(Note* note);
     void getRelatedNodes(KnowledgeGraphNode* centralNode, KnowledgeSubGraph& subgraph);
+
+    /**
+     * @brief Delete node of O and nodes of its Ns e.g. when O is forgotten.
+     */
+    void forget(const Outline* outline);
+    /**
+     * @brief Delete node of N e.g. when N is forgotten.
+     */
+    void forget(const Note* note);
+    /**
+     * @brief Delete pooled nodes and cached subgraphs.
+     */
+    void clear();
+
+    size_t getNodesCount() const { return thingNodes.size() + tagNodes.size(); }
+
+private:
+    KnowledgeGraphNode* getNode(const Tag* tag);
+    void calculateRelatedNodes(KnowledgeGraphNode* centralNode, std::vector<std::pair<KnowledgeGraphNode*,bool>>& related);
 };
 
 }
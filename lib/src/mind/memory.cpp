@@ -18,12 +18,17 @@
  */
 #include "memory.h"
 
+#include <algorithm>
+
+#include "../gear/tracer.h"
 #include "../gear/string_utils.h"
 
 using namespace std;
 
 namespace m8r {
 
+constexpr size_t Memory::LEARN_BATCH_SIZE;
+
 Memory::Memory(
         Configuration& configuration,
         Ontology& ontology,
@@ -35,7 +40,18 @@ Memory::Memory(
       persistence(new FilesystemPersistence{mdRepresentation, htmlRepresentation}),
       twikiRepresentation{mdRepresentation, persistence},
       csvRepresentation{},
-      limbo{configuration}
+      limbo{configuration},
+      outlinesNamesIndexValid{false},
+      outlinesNamesIndexRevision{0},
+      rememberWatermark{0},
+      dwell{},
+      learningNext{0},
+      learningCancel{false},
+      learningParsed{0},
+      learningLearned{0},
+      learning{false},
+      lazyBodies{false},
+      bodiesBytes{0}
 {
     cache = true;
     mindScope = nullptr;
@@ -53,42 +69,28 @@ vector<Stencil*>& Memory::getStencils(ResourceType type)
     }
 }
 
-void Memory::learn()
+void Memory::learn(unsigned threads)
+{
+    MF_TRACE_SPAN("memory", "learn");
+
+    learnAsync(threads);
+    while(learning) {
+        learnBatch(0, true);
+    }
+}
+
+shared_future<bool> Memory::learnAsync(unsigned threads)
 {
+    stopLearning();
     aware = true;
+    lazyBodies = false;
 
     repositoryIndexer.index(config.getActiveRepository());
+    thingsIds.load(getThingsIdsPath(), config.getActiveRepository()->getDir()+FILE_PATH_SEPARATOR);
 
-#ifdef DO_MF_DEBUG
     MF_DEBUG(endl << "LEARNING repository in mode " << config.getActiveRepository()->getMode() << ":");
-    auto begin = chrono::high_resolution_clock::now();
-#endif
 
     if(config.getActiveRepository()->getMode() == Repository::RepositoryMode::REPOSITORY) {
-        MF_DEBUG(endl << "Markdown files:");
-        for(const string* markdownFile:repositoryIndexer.getMarkdownFiles()) {
-            Outline* outline = mdRepresentation.outline(File(*markdownFile));
-            MF_DEBUG(endl << "  '" << *markdownFile << "' format " << (outline->getFormat()==MarkdownDocument::Format::MINDFORGER?"MF":"MD"));
-
-            // fix O type according to repository type
-            switch(config.getActiveRepository()->getType()) {
-            case Repository::RepositoryType::MINDFORGER:
-                outline->setFormat(MarkdownDocument::Format::MINDFORGER);
-                break;
-            case Repository::RepositoryType::MARKDOWN:
-                outline->setFormat(MarkdownDocument::Format::MARKDOWN);
-                break;
-            }
-
-            if(outline->isVirgin()) {
-                MF_DEBUG(endl << "    VIRGIN ~ most probably wrongly parsed > SKIPPING it");
-                delete outline;
-            } else {
-                outlines.push_back(outline);
-                outlinesMap.insert(map<string,Outline*>::value_type(outline->getKey(), outline));
-            }
-        }
-
         MF_DEBUG(endl << "Outline stencils:");
         for(const string* file:repositoryIndexer.getOutlineStencilsFileNames()) {
             Stencil* stencil = new Stencil{*file, ResourceType::OUTLINE};
@@ -105,8 +107,31 @@ void Memory::learn()
             MF_DEBUG(endl << "  " << stencil->getFilePath());
         }
 
-        MF_DEBUG(endl);
+        // Markdown files are parsed by workers (the biggest first), Os are learned in batches
+        repositoryIndexer.getMarkdownFilesBySize(learningFiles);
+        learningNext = 0;
+        learningCancel = false;
+        learningParsed = 0;
+        learningLearned = 0;
+        learningPromise = promise<bool>{};
+        learningFuture = learningPromise.get_future().share();
+        lazyBodies = config.getMemoryBudget() > 0;
+        if(learningFiles.empty()) {
+            learningPromise.set_value(true);
+            return learningFuture;
+        }
+        learning = true;
+
+        if(!threads) {
+            threads = thread::hardware_concurrency();
+        }
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, learningFiles.size())));
+        MF_DEBUG(endl << "Markdown files: " << learningFiles.size() << " parsed by " << threads << " worker(s)" << endl);
+        for(unsigned i=0; i<threads; i++) {
+            learningWorkers.push_back(thread{&Memory::learnWorker, this});
+        }
         // IMPROVE consider repositoryIndexer.clean() to save memory
+        return learningFuture;
     } else {
         MF_DEBUG(endl << "Single markdown file: " << repositoryIndexer.getMarkdownFiles().size());
         if(repositoryIndexer.getMarkdownFiles().size() == 1) {
@@ -127,22 +152,251 @@ void Memory::learn()
                 delete outline;
             } else {
                 outlines.push_back(outline);
-                outlinesMap.insert(map<string,Outline*>::value_type(outline->getKey(), outline));
+                outlinesMap.insert(make_pair(outline->getKey(), outline));
             }
 
             MF_DEBUG(endl);
         } // else wrong number of files (typically none)
+        MF_TRACE_COUNTER("memory", "outlines", static_cast<int64_t>(outlines.size()));
+        invalidateOutlinesNamesIndex();
+        dwell.learn(outlines);
+        thingsIds.learn(outlines);
+        thingsIds.save();
+    }
+
+    promise<bool> p{};
+    p.set_value(true);
+    return p.get_future();
+}
+
+void Memory::learnWorker()
+{
+    size_t i;
+    while(!learningCancel && (i = learningNext++) < learningFiles.size()) {
+        MarkdownDocument* md = new MarkdownDocument{learningFiles[i]};
+        if(lazyBodies) {
+            md->fromHeaders();
+        } else {
+            md->from();
+        }
+
+        lock_guard<mutex> criticalSection{learningMutex};
+        learningStaged.push_back(md);
+        learningParsed++;
+        learningCondition.notify_all();
+    }
+}
+
+size_t Memory::learnBatch(size_t limit, bool wait)
+{
+    if(!learning) {
+        return 0;
+    }
+    MF_TRACE_SPAN("memory", "learn batch");
+
+    vector<MarkdownDocument*> batch{};
+    bool parsed;
+    {
+        unique_lock<mutex> criticalSection{learningMutex};
+        if(wait) {
+            learningCondition.wait(criticalSection, [this]() {
+                return !learningStaged.empty() || learningParsed == learningFiles.size();
+            });
+        }
+        size_t count = limit ? std::min(limit, learningStaged.size()) : learningStaged.size();
+        batch.assign(learningStaged.begin(), learningStaged.begin()+count);
+        learningStaged.erase(learningStaged.begin(), learningStaged.begin()+count);
+        parsed = learningStaged.empty() && learningParsed == learningFiles.size();
+    }
+
+    for(MarkdownDocument* md:batch) {
+        learnOutline(mdRepresentation.outline(*md));
+        delete md;
+    }
+    learningLearned += batch.size();
+    if(batch.size()) {
+        invalidateOutlinesNamesIndex();
+    }
+
+    if(parsed) {
+        for(thread& worker:learningWorkers) {
+            worker.join();
+        }
+        learningWorkers.clear();
+        thingsIds.learn(outlines);
+        thingsIds.save();
+        learning = false;
+        learningPromise.set_value(true);
+        MF_TRACE_COUNTER("memory", "outlines", static_cast<int64_t>(outlines.size()));
+        MF_DEBUG("LEARNED " << outlines.size() << " Os" << endl);
+    }
+
+    return batch.size();
+}
+
+void Memory::learnOutline(Outline* outline)
+{
+    MF_DEBUG(endl << "  '" << outline->getKey() << "' format " << (outline->getFormat()==MarkdownDocument::Format::MINDFORGER?"MF":"MD"));
+
+    // fix O type according to repository type
+    switch(config.getActiveRepository()->getType()) {
+    case Repository::RepositoryType::MINDFORGER:
+        outline->setFormat(MarkdownDocument::Format::MINDFORGER);
+        break;
+    case Repository::RepositoryType::MARKDOWN:
+        outline->setFormat(MarkdownDocument::Format::MARKDOWN);
+        break;
+    }
+
+    if(outline->isVirgin()) {
+        MF_DEBUG(endl << "    VIRGIN ~ most probably wrongly parsed > SKIPPING it");
+        delete outline;
+    } else {
+        if(lazyBodies) {
+            outline->setBodyLoader(this);
+        }
+        outlines.push_back(outline);
+        outlinesMap.insert(make_pair(outline->getKey(), outline));
+        dwell.remember(outline);
+    }
+}
+
+void Memory::loadBody(Outline* outline)
+{
+    lock_guard<mutex> criticalSection{bodiesMutex};
+    // body might have been loaded by another thread
+    if(outline->isBodyLoaded()) {
+        return;
+    }
+    MF_TRACE_SPAN("memory", "load body");
+
+    // tags and types are known from headers, therefore ontology is not modified
+    Outline* full = mdRepresentation.outline(File{outline->getKey()});
+    if(!outline->acquireBody(full)) {
+        // caller might iterate Ns, therefore O is relearned later by the thread which owns memory
+        if(std::find(replacedBodies.begin(), replacedBodies.end(), outline) == replacedBodies.end()) {
+            replacedBodies.push_back(outline);
+        }
+    }
+    delete full;
+
+    size_t bytes = outline->getBytesize();
+    bodies.push_front(make_pair(outline, bytes));
+    bodiesIndex[outline] = bodies.begin();
+    bodiesBytes += bytes;
+    MF_TRACE_COUNTER("memory", "bodies bytes", static_cast<int64_t>(bodiesBytes));
+}
+
+bool Memory::reindexReplacedBodies()
+{
+    vector<Outline*> reindex{};
+    {
+        lock_guard<mutex> criticalSection{bodiesMutex};
+        reindex.swap(replacedBodies);
+        for(Outline* o:reindex) {
+            MF_TRACE_SPAN("memory", "relearn body");
+            Outline* full = mdRepresentation.outline(File{o->getKey()});
+            vector<Note*> replaced{};
+            o->replaceNotes(full, replaced);
+            // replaced Ns might be referenced by indices and caches, therefore they're kept until amnesia
+            replacedNotes.insert(replacedNotes.end(), replaced.begin(), replaced.end());
+            delete full;
+
+            // body might have been evicted since it was loaded
+            size_t bytes = o->getBytesize();
+            auto b = bodiesIndex.find(o);
+            if(b != bodiesIndex.end()) {
+                bodiesBytes -= b->second->second;
+                b->second->second = bytes;
+            } else {
+                bodies.push_front(make_pair(o, bytes));
+                bodiesIndex[o] = bodies.begin();
+            }
+            bodiesBytes += bytes;
+        }
+        MF_TRACE_COUNTER("memory", "bodies bytes", static_cast<int64_t>(bodiesBytes));
+    }
+    for(Outline* o:reindex) {
+        thingsIds.relearn(o);
+        dwell.remember(o);
+    }
+    if(!reindex.empty()) {
+        thingsIds.save();
+    }
+    return !reindex.empty();
+}
+
+void Memory::touchBody(Outline* outline)
+{
+    lock_guard<mutex> criticalSection{bodiesMutex};
+    auto b = bodiesIndex.find(outline);
+    if(b != bodiesIndex.end()) {
+        bodies.splice(bodies.begin(), bodies, b->second);
+    }
+}
+
+size_t Memory::trimBodies()
+{
+    size_t evicted = 0;
+    if(lazyBodies) {
+        const size_t budget = static_cast<size_t>(config.getMemoryBudget())*1024*1024;
+        lock_guard<mutex> criticalSection{bodiesMutex};
+        // the most recently used body is always kept
+        while(bodiesBytes > budget && bodies.size() > 1) {
+            pair<Outline*,size_t> b = bodies.back();
+            bodies.pop_back();
+            bodiesIndex.erase(b.first);
+            bodiesBytes -= b.second;
+            // modified (dirty) O stays loaded and it's no longer tracked
+            if(b.first->evictBody()) {
+                evicted++;
+            }
+        }
+        MF_TRACE_COUNTER("memory", "bodies bytes", static_cast<int64_t>(bodiesBytes));
+    }
+    return evicted;
+}
+
+void Memory::forgetBody(Outline* outline)
+{
+    lock_guard<mutex> criticalSection{bodiesMutex};
+    auto b = bodiesIndex.find(outline);
+    if(b != bodiesIndex.end()) {
+        bodiesBytes -= b->second->second;
+        bodies.erase(b->second);
+        bodiesIndex.erase(b);
     }
+    replacedBodies.erase(std::remove(replacedBodies.begin(), replacedBodies.end(), outline), replacedBodies.end());
+}
 
-#ifdef DO_MF_DEBUG
-    auto end = chrono::high_resolution_clock::now();
-    MF_DEBUG("LEARNED in " << chrono::duration_cast<chrono::microseconds>(end-begin).count()/1000.0 << "ms" << endl);
-#endif
+void Memory::stopLearning()
+{
+    if(learning) {
+        learningCancel = true;
+        for(thread& worker:learningWorkers) {
+            worker.join();
+        }
+        learningWorkers.clear();
+        for(MarkdownDocument* md:learningStaged) {
+            delete md;
+        }
+        learningStaged.clear();
+        learning = false;
+        learningPromise.set_value(false);
+    }
+    learningFiles.clear();
 }
 
 void Memory::amnesia()
 {
+    stopLearning();
     aware = false;
+    {
+        lock_guard<mutex> criticalSection{bodiesMutex};
+        bodies.clear();
+        bodiesIndex.clear();
+        bodiesBytes = 0;
+    }
 
     repositoryIndexer.clear();
 
@@ -154,11 +408,19 @@ void Memory::amnesia()
     }
     outlines.clear();
     outlinesMap.clear();
+    invalidateOutlinesNamesIndex();
+    dwell.clear();
+    thingsIds.clear();
 
     for(Outline*& outline:limboOutlines) {
         delete outline;
     }
     limboOutlines.clear();
+    for(Note*& note:replacedNotes) {
+        delete note;
+    }
+    replacedNotes.clear();
+    replacedBodies.clear();
 
     for(Stencil*& stencil:outlineStencils) {
         delete stencil;
@@ -200,7 +462,11 @@ void Memory::remember(const std::string& outlineKey)
     if((o=getOutline(outlineKey)) != nullptr) {
         o->makeModified();
         o->checkAndFixProperties();
+        thingsIds.remember(o);
         persistence->save(o);
+        thingsIds.save();
+        dwell.remember(o);
+        rememberWatermark++;
     } else {
         throw MindForgerException{
             "Save: unable to find outline w/ given key (" + outlineKey + ") to save"
@@ -217,12 +483,17 @@ void Memory::remember(Outline* outline)
     }
 
     outline->checkAndFixProperties();
+    thingsIds.remember(outline);
     persistence->save(outline);
+    thingsIds.save();
 
     if(!getOutline(outline->getKey())) {
         outlines.push_back(outline);
-        outlinesMap.insert(map<string,Outline*>::value_type(outline->getKey(), outline));
+        outlinesMap.insert(make_pair(outline->getKey(), outline));
+        invalidateOutlinesNamesIndex();
     }
+    dwell.remember(outline);
+    rememberWatermark++;
 }
 
 void Memory::exportToHtml(Outline* outline, const string& fileName)
@@ -230,26 +501,76 @@ void Memory::exportToHtml(Outline* outline, const string& fileName)
     persistence->saveAsHtml(outline, fileName);
 }
 
-void Memory::exportToCsv(const string&  fileName)
+HtmlSiteExporter::Stats Memory::exportToHtmlSite(const string& directory)
+{
+    HtmlSiteExporter exporter{ontology};
+    return exporter.to(outlines, config.getMemoryPath(), directory);
+}
+
+void Memory::exportToCsv(const string&  fileName, const BagOfWords* bow)
 {
-    csvRepresentation.to(outlines, fileName);
+    csvRepresentation.to(outlines, fileName, bow);
 }
 
 void Memory::forget(Outline* outline)
 {
+    // O in limbo keeps its body as its file is moved
+    outline->loadBody();
+    forgetBody(outline);
+    outline->setBodyLoader(nullptr);
+
     outlinesMap.erase(outline->getKey());
     limboOutlines.push_back(outline);
     outlines.erase(std::remove(outlines.begin(), outlines.end(), outline), outlines.end());
+    invalidateOutlinesNamesIndex();
+    dwell.forget(outline);
+    thingsIds.forget(outline);
+    thingsIds.save();
+}
+
+string Memory::getThingsIdsPath() const
+{
+    const Repository* repository = config.getActiveRepository();
+    string path{};
+    if(!repository->isReadOnly()) {
+        if(!config.getMindPath().empty() && isDirectory(config.getMindPath().c_str())) {
+            path += config.getMindPath();
+            path += FILE_PATH_SEPARATOR;
+            path += FILENAME_THINGS_IDS;
+        } else if(!config.getConfigFilePath().empty()) {
+            // Markdown directories/files are not written - ids file is kept in configuration
+            // directory and named by repository path hash (ids are kept in memory only if not possible)
+            string directory{}, file{};
+            pathToDirectoryAndFile(config.getConfigFilePath(), directory, file);
+            directory += FILE_PATH_SEPARATOR;
+            directory += DIRNAME_THINGS_IDS;
+            if(isDirectory(directory.c_str()) || createDirectory(directory)) {
+                string repositoryPath{repository->getDir()};
+                if(repository->getMode() == Repository::RepositoryMode::FILE) {
+                    repositoryPath += FILE_PATH_SEPARATOR;
+                    repositoryPath += repository->getFile();
+                }
+                path += directory;
+                path += FILE_PATH_SEPARATOR;
+                path += HtmlSiteExporter::hash(repositoryPath);
+            }
+        }
+    }
+    return path;
 }
 
 Memory::~Memory()
 {
+    stopLearning();
     for(Outline*& outline:outlines) {
         delete outline;
     }
     for(Outline*& outline:limboOutlines) {
         delete outline;
     }
+    for(Note*& note:replacedNotes) {
+        delete note;
+    }
     for(Stencil*& stencil:outlineStencils) {
         delete stencil;
     }
@@ -299,14 +620,11 @@ void Memory::sortByName(vector<Outline*>& os) const
     std::sort(os.begin(), os.end(), compareOutlineNames);
 }
 
-bool compareNoteReads(const Note* n1, const Note* n2)
-{
-    return n1->getRead() > n2->getRead();
-}
-
 void Memory::sortByRead(vector<Note*>& ns) const
 {
-    std::sort(ns.begin(), ns.end(), compareNoteReads);
+    NotesMetadata metadata{};
+    metadata.assign(ns);
+    metadata.sortByRead(ns);
 }
 
 string Memory::createOutlineKey(const string* name)
@@ -321,7 +639,7 @@ string Memory::createLimboKey(const string* name)
 
 Outline* Memory::getOutline(const string& key)
 {
-    map<string,Outline*>::const_iterator entry = outlinesMap.find(key);
+    auto entry = outlinesMap.find(key);
     if(entry == outlinesMap.end()) {
         return nullptr;
     } else {
@@ -329,6 +647,44 @@ Outline* Memory::getOutline(const string& key)
     }
 }
 
+Note* Memory::getNote(const string& key)
+{
+    // mangled N name never contains #, O key might
+    size_t offset = key.rfind('#');
+    if(offset != string::npos) {
+        Outline* o = getOutline(key.substr(0, offset));
+        if(o) {
+            return o->getNoteByMangledName(key.substr(offset+1));
+        }
+    }
+    return nullptr;
+}
+
+void Memory::invalidateOutlinesNamesIndex()
+{
+    lock_guard<mutex> criticalSection{outlinesNamesIndexMutex};
+    outlinesNamesIndexValid = false;
+}
+
+void Memory::findOutlinesByName(const string& name, vector<Outline*>& result) const
+{
+    lock_guard<mutex> criticalSection{outlinesNamesIndexMutex};
+
+    if(!outlinesNamesIndexValid || outlinesNamesIndexRevision != Outline::getNamesRevision()) {
+        outlinesNamesIndexRevision = Outline::getNamesRevision();
+        outlinesNamesIndex.clear();
+        for(Outline* o:outlines) {
+            outlinesNamesIndex[o->getName()].push_back(o);
+        }
+        outlinesNamesIndexValid = true;
+    }
+
+    auto entry = outlinesNamesIndex.find(name);
+    if(entry != outlinesNamesIndex.end()) {
+        result.insert(result.end(), entry->second.begin(), entry->second.end());
+    }
+}
+
 std::vector<Note*>& Memory::getAllNotes(vector<Note*>& notes, bool doSortByRead, bool addNoteForOutline) const
 {
     for(Outline* o:outlines) {
@@ -360,6 +716,11 @@ std::vector<Note*>& Memory::getAllNotes(vector<Note*>& notes, bool doSortByRead,
     return notes;
 }
 
+vector<Note*>& Memory::getMemoryDwell(vector<Note*>& notes, size_t limit, bool addNoteForOutline) const
+{
+    return dwell.getTop(limit, addNoteForOutline, mindScope, notes);
+}
+
 const OutlineType* Memory::toOutlineType(const MarkdownAstSectionMetadata& meta)
 {
     UNUSED_ARG(meta);
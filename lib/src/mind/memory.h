@@ -19,8 +19,15 @@
 #ifndef M8R_MEMORY_H_
 #define M8R_MEMORY_H_
 
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <list>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
 #include "../debug.h"
 #include "../exceptions.h"
@@ -30,10 +37,12 @@
 #include "../representations/markdown/markdown_document.h"
 #include "../representations/markdown/markdown_outline_representation.h"
 #include "../representations/html/html_outline_representation.h"
+#include "../representations/html/html_site_exporter.h"
 #include "../representations/twiki/twiki_outline_representation.h"
 #include "../representations/csv/csv_outline_representation.h"
 #include "../model/outline.h"
 #include "../model/note.h"
+#include "../model/notes_metadata.h"
 #include "../model/stencil.h"
 #include "../model/tag.h"
 #include "../model/resource_types.h"
@@ -41,11 +50,17 @@
 #include "../persistence/filesystem_persistence.h"
 #include "aspect/mind_scope_aspect.h"
 #include "limbo.h"
+#include "memory_dwell.h"
+#include "things_id_index.h"
 
 namespace m8r {
 
-class Memory
+class Memory : public OutlineBodyLoader
 {
+public:
+    // max Os created from parsed Markdown files by one learnBatch() call
+    static constexpr size_t LEARN_BATCH_SIZE = 64;
+
 private:
     /**
      * @brief Indicates whether Mind learned a repository.
@@ -79,8 +94,52 @@ private:
 
     std::vector<Outline*> limboOutlines;
 
-    // IMPROVE unordered_map
-    std::map<std::string,Outline*> outlinesMap;
+    std::unordered_map<std::string,Outline*> outlinesMap;
+
+    // O name to Os w/ such name (in memory order) - built on demand, rebuilt
+    // when Os are added/removed or any O is renamed
+    mutable std::mutex outlinesNamesIndexMutex;
+    mutable std::unordered_map<std::string,std::vector<Outline*>> outlinesNamesIndex;
+    mutable bool outlinesNamesIndexValid;
+    mutable unsigned long outlinesNamesIndexRevision;
+
+    // incremented whenever an O is remembered (saved) - also by callers which bypass Mind
+    int rememberWatermark;
+
+    // Ns ordered by recency/frequency - maintained on learn/remember/forget/read
+    MemoryDwell dwell;
+
+    // stable ids of Os and Ns - reconciled on learn, maintained on remember/forget
+    ThingsIdIndex thingsIds;
+
+    // progressive learning - Markdown files are parsed by workers and staged,
+    // Os are created from staged documents by learnBatch() as ontology and
+    // memory structures are not thread safe
+    std::vector<std::thread> learningWorkers;
+    std::vector<const std::string*> learningFiles;
+    std::atomic<size_t> learningNext;
+    std::atomic<bool> learningCancel;
+    std::mutex learningMutex;
+    std::condition_variable learningCondition;
+    std::vector<MarkdownDocument*> learningStaged;
+    size_t learningParsed;
+    std::atomic<size_t> learningLearned;
+    std::atomic<bool> learning;
+    std::promise<bool> learningPromise;
+    std::shared_future<bool> learningFuture;
+
+    // lazy bodies - if memory budget is set, then Os are learned w/ headers only,
+    // bodies are loaded on access and the least recently used ones are evicted
+    bool lazyBodies;
+    std::mutex bodiesMutex;
+    // loaded bodies (O and its bytes) - the most recently used first
+    std::list<std::pair<Outline*,size_t>> bodies;
+    std::unordered_map<Outline*,std::list<std::pair<Outline*,size_t>>::iterator> bodiesIndex;
+    size_t bodiesBytes;
+    // Os whose loaded body didn't match headers - to be relearned by reindexReplacedBodies()
+    std::vector<Outline*> replacedBodies;
+    // Ns replaced by relearning - kept until amnesia as indices and caches might reference them
+    std::vector<Note*> replacedNotes;
 
 public:
     explicit Memory(
@@ -97,10 +156,76 @@ public:
 
     /**
      * @brief Learn repository content.
+     *
+     * Markdown files are parsed in parallel (threads=0 ~ hardware concurrency).
      */
-    void learn();
+    void learn(unsigned threads=0);
     bool isAware() { return aware; }
 
+    /**
+     * @brief Start progressive learning of repository content.
+     *
+     * Repository is indexed and stencils are loaded synchronously, while Markdown
+     * files are parsed by worker threads. Parsed files are turned to Os by learnBatch()
+     * calls, therefore memory can be used as soon as the first batch is learned.
+     *
+     * @return future resolved when all Os are learned, false if learning was interrupted.
+     */
+    std::shared_future<bool> learnAsync(unsigned threads=0);
+
+    /**
+     * @brief Learn Os from Markdown files parsed so far (call from the learning thread).
+     *
+     * @param limit max number of files to process, 0 for all parsed files.
+     * @param wait  block until at least one file is parsed.
+     * @return number of processed files.
+     */
+    size_t learnBatch(size_t limit=LEARN_BATCH_SIZE, bool wait=false);
+
+    /**
+     * @brief Is progressive learning in progress i.e. not all Os learned yet?
+     */
+    bool isLearning() const { return learning; }
+    void getLearningProgress(size_t& learned, size_t& total) const {
+        learned = learningLearned;
+        total = learningFiles.size();
+    }
+
+    /**
+     * @brief Remember watermark is incremented whenever an O is remembered.
+     */
+    int getRememberWatermark() const { return rememberWatermark; }
+    /**
+     * @brief Are Os learned w/ headers only and their bodies loaded on access?
+     */
+    bool isLazyBodies() const { return lazyBodies; }
+    /**
+     * @brief Load body of O learned w/ headers only (thread safe).
+     */
+    virtual void loadBody(Outline* outline) override;
+    /**
+     * @brief Relearn Os whose body didn't match headers on body load i.e. replace their Ns and reindex them.
+     *
+     * Call it from the thread which owns memory when nobody iterates Ns.
+     *
+     * @return some O was relearned.
+     */
+    bool reindexReplacedBodies();
+    /**
+     * @brief Mark O body as the most recently used one.
+     */
+    void touchBody(Outline* outline);
+    /**
+     * @brief Evict the least recently used bodies while loaded bodies exceed memory budget.
+     *
+     * Evicted body strings are deleted, therefore call it only when nobody holds Os
+     * descriptions (no thinking or other Mind processes running).
+     *
+     * @return number of evicted bodies.
+     */
+    size_t trimBodies();
+    size_t getLoadedBodiesBytes() const { return bodiesBytes; }
+
     /**
      * @brief Forget everything.
      */
@@ -138,10 +263,18 @@ public:
      */
     void exportToHtml(Outline* outline, const std::string& fileName);
 
+    /**
+     * @brief Export all Outlines to HTML site directory.
+     *
+     * Export is incremental - Outlines which didn't change since
+     * the last export to the directory are skipped.
+     */
+    HtmlSiteExporter::Stats exportToHtmlSite(const std::string& directory);
+
     /**
      * @brief Export Mind to CSV.
      */
-    void exportToCsv(const std::string& fileName);
+    void exportToCsv(const std::string& fileName, const BagOfWords* bow=nullptr);
 
     /**
      * @brief Forget Outline.
@@ -188,6 +321,16 @@ public:
      */
     Outline* getOutline(const std::string &key);
 
+    /**
+     * @brief Get N by its key (O key # mangled N name).
+     */
+    Note* getNote(const std::string& key);
+
+    /**
+     * @brief Find Os w/ given name (exact match).
+     */
+    void findOutlinesByName(const std::string& name, std::vector<Outline*>& result) const;
+
     /**
      * @brief Get Ns of all outlines.
      *
@@ -196,6 +339,22 @@ public:
      */
     std::vector<Note*>& getAllNotes(std::vector<Note*>& notes, bool sortByRead=false, bool addNoteForOutline=false) const;
 
+    /**
+     * @brief Get top Ns by recency/frequency w/o scanning all Ns.
+     *
+     * @param limit             maximum number of Ns, 0 for all Ns
+     * @param addNoteForOutline add also N for every O
+     */
+    std::vector<Note*>& getMemoryDwell(std::vector<Note*>& notes, size_t limit, bool addNoteForOutline=false) const;
+    MemoryDwell& getMemoryDwell() { return dwell; }
+    const MemoryDwell& getMemoryDwell() const { return dwell; }
+
+    /**
+     * @brief Get index of Os and Ns stable ids.
+     */
+    ThingsIdIndex& getThingsIds() { return thingsIds; }
+    const ThingsIdIndex& getThingsIds() const { return thingsIds; }
+
     /*
      * UTILS
      */
@@ -206,6 +365,12 @@ public:
 
 private:
     const OutlineType* toOutlineType(const MarkdownAstSectionMetadata&);
+    void invalidateOutlinesNamesIndex();
+    void learnOutline(Outline* outline);
+    void learnWorker();
+    void stopLearning();
+    void forgetBody(Outline* outline);
+    std::string getThingsIdsPath() const;
 
 };
 
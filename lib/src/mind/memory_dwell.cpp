@@ -18,15 +18,165 @@
 */
 #include "memory_dwell.h"
 
+#include <algorithm>
+#include <cmath>
+
 namespace m8r {
 
-MemoryDwell::MemoryDwell() {
-	// TODO Auto-generated constructor stub
+using namespace std;
+
+constexpr double MemoryDwell::HALF_LIFE;
+
+MemoryDwell::MemoryDwell()
+    : entries{},
+      notesIndex{},
+      outlinesIndex{}
+{
+}
+
+MemoryDwell::~MemoryDwell()
+{
+}
+
+double MemoryDwell::score(u_int32_t reads, time_t read, time_t modified)
+{
+    return std::log2(1. + reads) + static_cast<double>(std::max(read, modified)) / HALF_LIFE;
+}
+
+void MemoryDwell::add(Note* note, Outline* outline, bool descriptor, double score)
+{
+    auto n = notesIndex.find(note);
+    if(n != notesIndex.end()) {
+        if(n->second->outline != outline) {
+            // N was refactored to another O
+            vector<const Note*>& ns = outlinesIndex[n->second->outline];
+            ns.erase(std::remove(ns.begin(), ns.end(), note), ns.end());
+            outlinesIndex[outline].push_back(note);
+        }
+        entries.erase(n->second);
+        n->second = entries.insert(Entry{score, note, outline, descriptor}).first;
+    } else {
+        notesIndex[note] = entries.insert(Entry{score, note, outline, descriptor}).first;
+        outlinesIndex[outline].push_back(note);
+    }
+}
+
+void MemoryDwell::remove(const Outline* outline)
+{
+    auto o = outlinesIndex.find(outline);
+    if(o != outlinesIndex.end()) {
+        // Ns are NOT dereferenced - they might be deleted
+        for(const Note* n:o->second) {
+            auto entry = notesIndex.find(n);
+            if(entry != notesIndex.end()) {
+                entries.erase(entry->second);
+                notesIndex.erase(entry);
+            }
+        }
+        outlinesIndex.erase(o);
+    }
+}
+
+void MemoryDwell::learn(const vector<Outline*>& outlines)
+{
+    lock_guard<mutex> criticalSection{dwellMutex};
+
+    entries.clear();
+    notesIndex.clear();
+    outlinesIndex.clear();
+    for(Outline* o:outlines) {
+        add(o->getOutlineDescriptorAsNote(), o, true, score(o->getReads(), o->getRead(), o->getModified()));
+        for(Note* n:o->getNotes()) {
+            add(n, o, false, score(n->getReads(), n->getRead(), n->getModified()));
+        }
+    }
+}
+
+void MemoryDwell::remember(Outline* outline)
+{
+    lock_guard<mutex> criticalSection{dwellMutex};
 
+    remove(outline);
+    add(
+        outline->getOutlineDescriptorAsNote(),
+        outline,
+        true,
+        score(outline->getReads(), outline->getRead(), outline->getModified()));
+    for(Note* n:outline->getNotes()) {
+        add(n, outline, false, score(n->getReads(), n->getRead(), n->getModified()));
+    }
 }
 
-MemoryDwell::~MemoryDwell() {
-	// TODO Auto-generated destructor stub
+void MemoryDwell::forget(const Outline* outline)
+{
+    lock_guard<mutex> criticalSection{dwellMutex};
+
+    remove(outline);
+}
+
+void MemoryDwell::read(Note* note)
+{
+    if(note && note->getOutline()) {
+        lock_guard<mutex> criticalSection{dwellMutex};
+
+        add(note, note->getOutline(), false, score(note->getReads(), note->getRead(), note->getModified()));
+    }
+}
+
+void MemoryDwell::read(Outline* outline)
+{
+    if(outline) {
+        lock_guard<mutex> criticalSection{dwellMutex};
+
+        add(
+            outline->getOutlineDescriptorAsNote(),
+            outline,
+            true,
+            score(outline->getReads(), outline->getRead(), outline->getModified()));
+    }
+}
+
+void MemoryDwell::clear()
+{
+    lock_guard<mutex> criticalSection{dwellMutex};
+
+    entries.clear();
+    notesIndex.clear();
+    outlinesIndex.clear();
+}
+
+size_t MemoryDwell::size() const
+{
+    lock_guard<mutex> criticalSection{dwellMutex};
+
+    return entries.size();
+}
+
+vector<Note*>& MemoryDwell::getTop(
+        size_t limit,
+        bool addNoteForOutline,
+        const MindScopeAspect* scope,
+        vector<Note*>& notes) const
+{
+    lock_guard<mutex> criticalSection{dwellMutex};
+
+    size_t count = 0;
+    for(const Entry& e:entries) {
+        if(limit && count >= limit) {
+            break;
+        }
+        if(e.descriptor) {
+            if(addNoteForOutline && (!scope || scope->isInScope(e.outline))) {
+                // descriptor is synchronized w/ O on get
+                notes.push_back(e.outline->getOutlineDescriptorAsNote());
+                count++;
+            }
+        } else if(!scope || scope->isInScope(e.note)) {
+            notes.push_back(e.note);
+            count++;
+        }
+    }
+    return notes;
 }
 
 } // m8r namespace
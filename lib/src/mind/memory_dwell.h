@@ -19,12 +19,114 @@
 #ifndef M8R_MEMORY_DWELL_H_
 #define M8R_MEMORY_DWELL_H_
 
+#include <ctime>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "../model/outline.h"
+#include "../model/note.h"
+#include "aspect/mind_scope_aspect.h"
+
 namespace m8r {
 
-class MemoryDwell {
+/**
+ * @brief Memory dwell - Ns (and Os) where the mind dwells most.
+ *
+ * Ns are ordered by decayed recency/frequency (frecency) score: reads of a N
+ * weight its last access (read or modify) and the weight halves every
+ * HALF_LIFE seconds. As the decay is the same for all Ns, the order doesn't
+ * change in time and the score can be kept in time invariant (logarithmic)
+ * form:
+ *
+ *   score = log2(1 + reads) + max(read, modified) / HALF_LIFE
+ *
+ * Ns are kept in an ordered set, therefore N read/save is O(log(n)) and the
+ * top K Ns are served w/o scanning the repository.
+ */
+class MemoryDwell
+{
+public:
+    // decayed weight of a read halves every week
+    static constexpr double HALF_LIFE = 7.*24.*60.*60.;
+
+private:
+    struct Entry {
+        double score;
+        Note* note;
+        // O of the N, N is O descriptor if descriptor is set
+        Outline* outline;
+        bool descriptor;
+    };
+
+    struct EntryComparator {
+        bool operator()(const Entry& e1, const Entry& e2) const {
+            return e1.score > e2.score || (e1.score == e2.score && std::less<const Note*>()(e1.note, e2.note));
+        }
+    };
+
+    typedef std::set<Entry,EntryComparator> Entries;
+
+    mutable std::mutex dwellMutex;
+
+    Entries entries;
+    // N to its entry - N read/save updates single entry
+    std::unordered_map<const Note*,Entries::iterator> notesIndex;
+    // O to indexed Ns (incl. descriptor) - removal doesn't touch (possibly deleted) Ns
+    std::unordered_map<const Outline*,std::vector<const Note*>> outlinesIndex;
+
 public:
-	MemoryDwell();
-	virtual ~MemoryDwell();
+    explicit MemoryDwell();
+    MemoryDwell(const MemoryDwell&) = delete;
+    MemoryDwell(const MemoryDwell&&) = delete;
+    MemoryDwell &operator=(const MemoryDwell&) = delete;
+    MemoryDwell &operator=(const MemoryDwell&&) = delete;
+    virtual ~MemoryDwell();
+
+    static double score(u_int32_t reads, time_t read, time_t modified);
+
+    /**
+     * @brief Index all Ns of given Os.
+     */
+    void learn(const std::vector<Outline*>& outlines);
+
+    /**
+     * @brief (Re)index O and its Ns e.g. on save - O's Ns might be added or deleted.
+     */
+    void remember(Outline* outline);
+
+    /**
+     * @brief Remove O and its Ns from the index - Ns might be already deleted.
+     */
+    void forget(const Outline* outline);
+
+    /**
+     * @brief Update N score after N was read.
+     */
+    void read(Note* note);
+    void read(Outline* outline);
+
+    void clear();
+    size_t size() const;
+
+    /**
+     * @brief Get top Ns by score.
+     *
+     * @param limit             maximum number of Ns, 0 for all Ns
+     * @param addNoteForOutline include O descriptors as Ns
+     * @param scope             skip Os/Ns which are not in scope (if set)
+     */
+    std::vector<Note*>& getTop(
+            size_t limit,
+            bool addNoteForOutline,
+            const MindScopeAspect* scope,
+            std::vector<Note*>& notes) const;
+
+private:
+    void add(Note* note, Outline* outline, bool descriptor, double score);
+    void remove(const Outline* outline);
 };
 
 } // m8r namespace
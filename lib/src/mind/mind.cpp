@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "mind.h"
+#include "../gear/tracer.h"
 
 #ifdef MF_MD_2_HTML_CMARK
   #include "ai/autolinking/autolinking_mind.h"
@@ -43,7 +44,7 @@ Mind::Mind(Configuration &configuration)
 #ifdef MF_MD_2_HTML_CMARK
       autolinking{new AutolinkingMind{*this}},
 #else
-      autolinking{nullptr}
+      autolinking{nullptr},
 #endif
       exclusiveMind{},
       timeScopeAspect{},
@@ -52,6 +53,7 @@ Mind::Mind(Configuration &configuration)
 {
     ai = new Ai{memory,*this};
     deleteWatermark = 0;
+    memoryWatermark = 0;
     activeProcesses = 0;
     associationsSemaphore = 0;
 
@@ -86,24 +88,66 @@ Mind::~Mind()
  * THINKING
  */
 
-bool Mind::learn()
+bool Mind::learn(unsigned threads)
 {
     MF_DEBUG("@Learn" << endl);
+    // computation which holds Mind would delay learning
+    ai->interrupt();
     lock_guard<mutex> criticalSection{exclusiveMind};
 
-    if(config.getMindState()!=Configuration::MindState::DREAMING && !activeProcesses) {
-        MF_DEBUG("Learning..." << endl);
-        mindAmnesia();
-        memory.learn();
+    MF_DEBUG("Learning..." << endl);
+    mindAmnesia();
+    memory.learn(threads);
+    mindLearned();
+    return true;
+}
+
+shared_future<bool> Mind::learnAsync()
+{
+    MF_DEBUG("@Learn async" << endl);
+    ai->interrupt();
+    lock_guard<mutex> criticalSection{exclusiveMind};
+
+    MF_DEBUG("Learning progressively..." << endl);
+    mindAmnesia();
+    shared_future<bool> learned = memory.learnAsync();
+    if(!memory.isLearning()) {
+        mindLearned();
+    }
+    return learned;
+}
+
+size_t Mind::learnBatch()
+{
+    lock_guard<mutex> criticalSection{exclusiveMind};
+
+    if(memory.isLearning()) {
+        size_t learned = memory.learnBatch();
+        if(learned) {
+            memoryWatermark++;
+        }
+        if(!memory.isLearning()) {
+            mindLearned();
+        }
+        return learned;
+    }
+    return 0;
+}
+
+/* It does NOT need mutex because it's private and can be called from Mind only.
+ */
+void Mind::mindLearned()
+{
+    memoryWatermark++;
+    // O descriptors are refreshed while Mind is exclusive so that searches don't write them
+    for(Outline* o:memory.getOutlines()) {
+        o->getOutlineDescriptorAsNote();
+    }
+    thingsCompletion.reindex(memory.getOutlines());
 #ifdef MF_MD_2_HTML_CMARK
-        autolinking->reindex();
+    autolinking->reindex();
 #endif
-        MF_DEBUG("Mind LEARNED " << memory.getOutlinesCount() << " Os" << endl);
-        return true;
-    } else {
-        MF_DEBUG("Learn: CANNOT learn because Mind is DREAMING and/or there are " << activeProcesses << " active Mind processes" << endl);
-        return false;
-    }
+    MF_DEBUG("Mind LEARNED " << memory.getOutlinesCount() << " Os" << endl);
 }
 
 shared_future<bool> Mind::think()
@@ -111,7 +155,7 @@ shared_future<bool> Mind::think()
     MF_DEBUG("@Think w/ threshold " << config.getAsyncMindThreshold() << endl);
     lock_guard<mutex> criticalSection{exclusiveMind};
 
-    if(config.getMindState()==Configuration::MindState::SLEEPING) {
+    if(config.getMindState()==Configuration::MindState::SLEEPING && !memory.isLearning()) {
         if(config.getAsyncMindThreshold() > memory.getNotesCount()) {
             // get ready for thinking - dream() changes state to THINKING on its finish
             return mindDream();
@@ -124,7 +168,7 @@ shared_future<bool> Mind::think()
             return p.get_future();
         }
     } else {
-        MF_DEBUG("Think: CANNOT think because Mind is DREAMING or already THINKING (asleep first)" << endl);
+        MF_DEBUG("Think: CANNOT think because Mind is LEARNING, DREAMING or already THINKING (asleep first)" << endl);
         promise<bool> p;
         p.set_value(false);
         return p.get_future();
@@ -168,6 +212,7 @@ shared_future<bool> Mind::mindDream()
 bool Mind::sleep()
 {
     MF_DEBUG("@Sleep" << endl);
+    ai->interrupt();
     lock_guard<mutex> criticalSection{exclusiveMind};
     if(mindSleep()) {
         persistMindState(Configuration::MindState::SLEEPING);
@@ -182,24 +227,22 @@ bool Mind::sleep()
  */
 bool Mind::mindSleep()
 {
-    if(config.getMindState()!=Configuration::MindState::DREAMING && !activeProcesses) {
-        // AI can asleep ONLY if there are no active mental processes
-        if(ai->sleep()) {
-            meditateAssociations();
+    // AI interrupts active mental processes (dreaming included) and waits for them to finish
+    if(ai->sleep()) {
+        meditateAssociations();
 
-            allNotesCache.clear();
-            memoryDwell.clear();
-            triples.clear();
+        allNotesCache.clear();
+        triples.clear();
 
-            MF_DEBUG("Mind IS sleeping..." << endl);
-            return true;
-        } else {
-            MF_DEBUG("Sleep: CANNOT asleep because there are " << activeProcesses << " active Mind processes" << endl);
-            return false;
+        // interrupted dream will never switch Mind to THINKING
+        if(config.getMindState()==Configuration::MindState::DREAMING) {
+            config.setMindState(Configuration::MindState::SLEEPING);
         }
+
+        MF_DEBUG("Mind IS sleeping..." << endl);
+        return true;
     } else {
-        MF_DEBUG("Sleep: CANNOT asleep because Mind is DREAMING (wait for " << activeProcesses << " dreaming processes to finish)" << endl);
-        // DREAMING cannot be cancelled > wait for dream() to finish before calling sleep() again.
+        MF_DEBUG("Sleep: CANNOT asleep because there are " << activeProcesses << " active Mind processes" << endl);
         return false;
     }
 }
@@ -207,6 +250,7 @@ bool Mind::mindSleep()
 bool Mind::amnesia()
 {
     MF_DEBUG("@Amnesia" << endl);
+    ai->interrupt();
     lock_guard<mutex> criticalSection{exclusiveMind};
     if(mindAmnesia()) {
         persistMindState(Configuration::MindState::SLEEPING);
@@ -218,6 +262,16 @@ bool Mind::amnesia()
 
 shared_future<bool> Mind::getAssociatedNotes(AssociatedNotes& associations)
 {
+    // cached associations are read from AI snapshot w/o blocking on (dreaming) Mind
+    if(associations.getSourceType()==NOTE
+         &&
+       ai->getCachedAssociatedNotes(associations.getNote(), *associations.getAssociations()))
+    {
+        promise<bool> p{};
+        p.set_value(true);
+        return shared_future<bool>(p.get_future());
+    }
+
     lock_guard<mutex> criticalSection{exclusiveMind};
 
     if(config.getMindState()==Configuration::MindState::THINKING) {
@@ -248,18 +302,20 @@ shared_future<bool> Mind::getAssociatedNotes(AssociatedNotes& associations)
  */
 bool Mind::mindAmnesia()
 {
-    if(config.getMindState()!=Configuration::MindState::DREAMING && !activeProcesses) {
-        mindSleep();
-
+    // AI must NOT use Memory which is going to be forgotten
+    if(mindSleep()) {
         // forget EVERYTHING
         memory.amnesia();
+        memoryWatermark++;
+        thingsCompletion.clear();
+        knowledgeGraph->clear();
 #ifdef MF_MD_2_HTML_CMARK
         autolinking->clear();
 #endif
         MF_DEBUG("Mind WITH amnesia" << endl);
         return true;
     } else {
-        MF_DEBUG("Amnesia: CANNOT asleep because Mind is DREAMING (wait for " << activeProcesses << " dreaming processes to finish)" << endl);
+        MF_DEBUG("Amnesia: CANNOT forget because there are " << activeProcesses << " active Mind processes" << endl);
         return false;
     }
 }
@@ -279,7 +335,7 @@ bool Mind::autolinkFindLongestPrefixWord(std::string& s, std::string& r) const
 {
 #ifdef MF_MD_2_HTML_CMARK
     return autolinking->findLongestPrefixWord(s, r);
-#elif
+#else
     return false;
 #endif
 }
@@ -292,6 +348,8 @@ bool Mind::autolinkFindLongestPrefixWord(std::string& s, std::string& r) const
 void Mind::remember(const std::string& outlineKey)
 {
     memory.remember(outlineKey);
+    memoryWatermark++;
+    thingsCompletion.update(memory.getOutline(outlineKey));
 
     // TODO onRemembering()
 
@@ -305,6 +363,8 @@ void Mind::remember(const std::string& outlineKey)
 void Mind::remember(Outline* outline)
 {
     memory.remember(outline);
+    memoryWatermark++;
+    thingsCompletion.update(outline);
 
     // TODO onRemembering()
 
@@ -317,7 +377,10 @@ void Mind::remember(Outline* outline)
 
 void Mind::forget(Outline* outline)
 {
+    knowledgeGraph->forget(outline);
     memory.forget(outline);
+    memoryWatermark++;
+    thingsCompletion.forget(outline);
 
     // TODO onRemembering()
 
@@ -328,17 +391,25 @@ void Mind::forget(Outline* outline)
 #endif
 }
 
-
-const vector<Note*>& Mind::getMemoryDwell(int pageSize) const
+void Mind::exportToCsv(const string& fileName, bool withBow)
 {
-    UNUSED_ARG(pageSize);
+    lock_guard<mutex> criticalSection{exclusiveMind};
 
-    return memoryDwell;
+    shared_ptr<const BagOfWords> bow{};
+    if(withBow && config.getMindState()==Configuration::MindState::THINKING) {
+        bow = ai->getBagOfWords();
+    }
+    memory.exportToCsv(fileName, bow.get());
+}
+
+vector<Note*>& Mind::getMemoryDwell(vector<Note*>& notes, size_t limit, bool addNoteForOutline) const
+{
+    return memory.getMemoryDwell(notes, limit, addNoteForOutline);
 }
 
 size_t Mind::getMemoryDwellDepth() const
 {
-    return memoryDwell.size();
+    return memory.getMemoryDwell().size();
 }
 
 /*
@@ -470,9 +541,7 @@ void Mind::findNoteFts(
 // IMPROVE consider result be parameter passed by caller (reuse, mem)
 vector<Note*>* Mind::findNoteFts(const string& pattern, FtsSearch searchMode, Outline* outlineScope)
 {
-    if(allNotesCache.size()) {
-        allNotesCache.clear();
-    }
+    MF_TRACE_SPAN("fts", "find");
 
     vector<Note*>* result = new vector<Note*>();
 
@@ -514,17 +583,78 @@ vector<Note*>* Mind::getReferencedNotes(const Note& note, const Outline& outline
 
 vector<Note*>* Mind::getRefereeNotes(const Note& note) const
 {
-    UNUSED_ARG(note);
-
-    return nullptr;
+    MF_TRACE_SPAN("mind", "backlinks");
+    vector<Note*>* result = new vector<Note*>();
+    string key{note.getOutline()->getKey()};
+    key += "#";
+    key += note.getMangledName();
+    for(Outline* o:memory.getOutlines()) {
+        findReferees(key, false, &note, *o, *result);
+    }
+    return result;
 }
 
 vector<Note*>* Mind::getRefereeNotes(const Note& note, const Outline& outline) const
 {
-    UNUSED_ARG(note);
-    UNUSED_ARG(outline);
+    vector<Note*>* result = new vector<Note*>();
+    string key{note.getOutline()->getKey()};
+    key += "#";
+    key += note.getMangledName();
+    findReferees(key, false, &note, outline, *result);
+    return result;
+}
 
-    return nullptr;
+vector<Note*>* Mind::getRefereeNotes(const Outline& outline) const
+{
+    MF_TRACE_SPAN("mind", "backlinks");
+    vector<Note*>* result = new vector<Note*>();
+    for(Outline* o:memory.getOutlines()) {
+        if(o != &outline) {
+            findReferees(outline.getKey(), true, nullptr, *o, *result);
+        }
+    }
+    return result;
+}
+
+void Mind::findReferees(
+        const string& key,
+        bool anchors,
+        const Note* self,
+        const Outline& outline,
+        vector<Note*>& result) const
+{
+    // links are written relative to the referencing O e.g. [N](../o.md#n) or [N](#n)
+    string url = RepositoryIndexer::makePathRelative(config.getActiveRepository(), outline.getKey(), key);
+    pathToLinuxDelimiters(url, url);
+    string target{"]("};
+    target += url;
+
+    for(Note* n:outline.getNotes()) {
+        if(n == self) {
+            continue;
+        }
+        bool referee = false;
+        for(Link* l:n->getLinks()) {
+            if(l->getUrl() == url) {
+                referee = true;
+                break;
+            }
+        }
+        for(size_t i=0; !referee && i<n->getDescription().size(); i++) {
+            const string& line = *n->getDescription()[i];
+            for(size_t p = line.find(target); p != string::npos; p = line.find(target, p+1)) {
+                // link ends w/ ), title or (for O) N anchor - prefix of longer path is not a link
+                char c = p+target.size() < line.size() ? line[p+target.size()] : 0;
+                if(c == ')' || c == ' ' || (anchors && c == '#')) {
+                    referee = true;
+                    break;
+                }
+            }
+        }
+        if(referee) {
+            result.push_back(n);
+        }
+    }
 }
 
 void Mind::findNotesByTags(const vector<const Tag*>& tags, vector<Note*>& result) const
@@ -568,20 +698,8 @@ void Mind::getAllThings(
                 string s{};
                 switch(as) {
                 case ThingNameSerialization::LINK:
-                    // IMPROVE make this Note's method
-                    {
-                        s += "[";
-                        s += o->getName();
-                        s += "](";
-                        string p = RepositoryIndexer::makePathRelative(
-                             config.getActiveRepository(),
-                             currentO?currentO->getKey():o->getKey(),
-                             o->getKey());
-                        pathToLinuxDelimiters(p, p);
-                        s += p;
-                        s += ")";
-                        break;
-                    }
+                    outlineToLink(o, currentO, s);
+                    break;
                 case ThingNameSerialization::NAME:
                 case ThingNameSerialization::SCOPED_NAME:
                 default:
@@ -607,22 +725,8 @@ void Mind::getAllThings(
                     s += n->getName();
                     break;
                 case ThingNameSerialization::LINK:
-                    // IMPROVE make this Note's method
-                    {
-                        s += "[";
-                        s += n->getName();
-                        s += " (";
-                        s += n->getOutline()->getName();
-                        s += ")](";
-                        string p = RepositoryIndexer::makePathRelative(
-                             config.getActiveRepository(),
-                             currentO?currentO->getKey():n->getOutline()->getKey(),
-                             n->getKey());
-                        pathToLinuxDelimiters(p, p);
-                        s += p;
-                        s += ")";
-                        break;
-                    }
+                    noteToLink(n, currentO, s);
+                    break;
                 case ThingNameSerialization::SCOPED_NAME:
                 default:
                     {
@@ -640,6 +744,69 @@ void Mind::getAllThings(
     }
 }
 
+void Mind::outlineToLink(const Outline* o, const Outline* currentO, string& link) const
+{
+    link += "[";
+    link += o->getName();
+    link += "](";
+    string p = RepositoryIndexer::makePathRelative(
+         config.getActiveRepository(),
+         currentO?currentO->getKey():o->getKey(),
+         o->getKey());
+    pathToLinuxDelimiters(p, p);
+    link += p;
+    link += ")";
+}
+
+void Mind::noteToLink(Note* n, const Outline* currentO, string& link) const
+{
+    link += "[";
+    link += n->getName();
+    link += " (";
+    link += n->getOutline()->getName();
+    link += ")](";
+    string p = RepositoryIndexer::makePathRelative(
+         config.getActiveRepository(),
+         currentO?currentO->getKey():n->getOutline()->getKey(),
+         n->getKey());
+    pathToLinuxDelimiters(p, p);
+    link += p;
+    link += ")";
+}
+
+void Mind::getLinksForPrefix(
+    const string& prefix,
+    vector<string>& links,
+    Outline* currentO,
+    size_t limit)
+{
+    vector<Thing*> things{};
+    // over-fetch when scoped as some of the best ranked Things might be out of scope
+    thingsCompletion.complete(prefix, things, scopeAspect.isEnabled()?4*limit:limit);
+
+    for(Thing* t:things) {
+        if(links.size() >= limit) {
+            break;
+        }
+
+        string link{};
+        Note* n = dynamic_cast<Note*>(t);
+        if(n) {
+            if(scopeAspect.isOutOfScope(n)) {
+                continue;
+            }
+            noteToLink(n, currentO, link);
+        } else {
+            Outline* o = static_cast<Outline*>(t);
+            if(scopeAspect.isOutOfScope(o)) {
+                continue;
+            }
+            outlineToLink(o, currentO, link);
+        }
+        links.push_back(link);
+    }
+}
+
 const vector<Outline*>& Mind::getOutlines() const
 {
     // IMPROVE PERF use dirty flag to avoid result-rebuilt
@@ -820,6 +987,7 @@ bool Mind::setOutlineUniqueTag(const Tag* tag, const string& outlineKey)
         // mark O as modified
         o->addTag(tag);
         memory.remember(o->getKey());
+        memoryWatermark++;
         return true;
     } else {
         return false;
@@ -919,6 +1087,8 @@ Outline* Mind::outlineClone(const std::string& outlineKey)
         Outline* clonedOutline = new Outline{*o};
         clonedOutline->setKey(memory.createOutlineKey(&o->getName()));
         memory.remember(clonedOutline);
+        memoryWatermark++;
+        thingsCompletion.update(clonedOutline);
         onRemembering();
         return clonedOutline;
     } else {
@@ -941,6 +1111,13 @@ bool Mind::outlineForget(string outlineKey)
     return false;
 }
 
+void Mind::outlineRead(Outline* outline)
+{
+    outline->incReads();
+    memory.getMemoryDwell().read(outline);
+    bodyRead(outline);
+}
+
 Note* Mind::noteNew(
         const std::string& outlineKey,
         const uint16_t offset,
@@ -974,10 +1151,9 @@ Note* Mind::noteNew(
         n->setProgress(progress);
         n->completeProperties(n->getModified());
 
-        n->setReadPretty();
-        n->setModifiedPretty();
-
         o->addNote(n, NO_PARENT==offset?0:offset);
+        memory.getMemoryDwell().read(n);
+        memoryWatermark++;
         return n;
     } else {
         throw MindForgerException("Outline for given key not found!");
@@ -988,6 +1164,7 @@ Note* Mind::noteClone(const string& outlineKey, const Note* newNote)
 {
     Outline* o = memory.getOutline(outlineKey);
     if(o) {
+        memoryWatermark++;
         return o->cloneNote(newNote);
     } else {
         throw MindForgerException("Outline for given key not found!");
@@ -1012,6 +1189,9 @@ Outline* Mind::noteRefactor(Note* noteToRefactor, const string& targetOutlineKey
 
             memory.remember(sourceOutline);
             memory.remember(targetOutline);
+            memoryWatermark++;
+            thingsCompletion.update(sourceOutline);
+            thingsCompletion.update(targetOutline);
 
             return targetOutline;
         } else {
@@ -1028,17 +1208,57 @@ Outline* Mind::noteForget(Note* note)
     if(o) {
         deleteWatermark++;
 
+        vector<Note*> children{};
+        o->getAllNoteChildren(note, &children);
+        for(Note* c:children) {
+            knowledgeGraph->forget(c);
+        }
+        knowledgeGraph->forget(note);
+
         note->getOutline()->forgetNote(note);
+        // reindex O as N and its children are deleted
+        memory.getMemoryDwell().remember(o);
+        memory.getThingsIds().remember(o);
+        memoryWatermark++;
         return o;
     } else {
         throw MindForgerException("Unable find Outline from which should be the Note deleted!");
     }
 }
 
+void Mind::noteRead(Note* note)
+{
+    note->makeRead();
+    memory.getMemoryDwell().read(note);
+    bodyRead(note->getOutline());
+}
+
+/* Bodies are evicted only when Mind sleeps and there are no Mind processes
+ * as (asynchronous) associations and dreaming read Ns descriptions. Os whose
+ * body didn't match headers are relearned only when there are no Mind processes
+ * as they iterate Ns.
+ */
+void Mind::bodyRead(Outline* outline)
+{
+    if(memory.isLazyBodies() && outline) {
+        memory.touchBody(outline);
+
+        lock_guard<mutex> criticalSection{exclusiveMind};
+        if(!activeProcesses && memory.reindexReplacedBodies()) {
+            allNotesCache.clear();
+            memoryWatermark++;
+        }
+        if(config.getMindState()==Configuration::MindState::SLEEPING && !activeProcesses) {
+            memory.trimBodies();
+        }
+    }
+}
+
 void Mind::noteUp(Note* note, Outline::Patch* patch)
 {
     if(note) {
         note->getOutline()->moveNoteUp(note, patch);
+        memoryWatermark++;
     }
 }
 
@@ -1046,6 +1266,7 @@ void Mind::noteDown(Note* note, Outline::Patch* patch)
 {
     if(note) {
         note->getOutline()->moveNoteDown(note, patch);
+        memoryWatermark++;
     }
 }
 
@@ -1053,6 +1274,7 @@ void Mind::noteFirst(Note* note, Outline::Patch* patch)
 {
     if(note) {
         note->getOutline()->moveNoteToFirst(note, patch);
+        memoryWatermark++;
     }
 }
 
@@ -1060,6 +1282,7 @@ void Mind::noteLast(Note* note, Outline::Patch* patch)
 {
     if(note) {
         note->getOutline()->moveNoteToLast(note, patch);
+        memoryWatermark++;
     }
 }
 
@@ -1067,6 +1290,7 @@ void Mind::notePromote(Note* note, Outline::Patch* patch)
 {
     if(note) {
         note->getOutline()->promoteNote(note, patch);
+        memoryWatermark++;
     }
 }
 
@@ -1074,12 +1298,18 @@ void Mind::noteDemote(Note* note, Outline::Patch* patch)
 {
     if(note) {
         note->getOutline()->demoteNote(note, patch);
+        memoryWatermark++;
     }
 }
 
 void Mind::noteOnRename(const std::string& oldName, const std::string& newName)
 {
+#ifdef MF_MD_2_HTML_CMARK
     autolinking->update(oldName, newName);
+#else
+    UNUSED_ARG(oldName);
+    UNUSED_ARG(newName);
+#endif
 }
 
 void Mind::onRemembering()
@@ -1162,21 +1392,19 @@ void Mind::recognizePersons(const Outline* outline, int entityFilter, std::vecto
     ai->recognizePersons(outline, entityFilter, result);
 }
 
+void Mind::recognizeEntities(int entityFilter, std::vector<NerNamedEntity>& result) {
+    ai->recognizeEntities(memory.getOutlines(), entityFilter, result);
+}
+
 #endif
 
 // unique_ptr template BREAKS Qt Developer indentation > stored at EOF
 unique_ptr<vector<Outline*>> Mind::findOutlineByNameFts(const string& pattern) const
 {
     // IMPROVE implement regexp and other search options by reusing HSTR code
-    // IMPROVE PERF this method is extremely inefficient > use cached map (stack member) evicted on memory modification
     unique_ptr<vector<Outline*>> result{new vector<Outline*>()};
     if(pattern.size()) {
-        vector<Outline*> outlines = memory.getOutlines();
-        for(Outline* outline:outlines) {
-            if(!pattern.compare(outline->getName())) {
-                result->push_back(outline);
-            }
-        }
+        memory.findOutlinesByName(pattern, *result);
     }
     return result;
 }
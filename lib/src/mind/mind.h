@@ -19,6 +19,7 @@
 #ifndef M8R_MIND_H_
 #define M8R_MIND_H_
 
+#include <atomic>
 #include <inttypes.h>
 #include <memory>
 #include <mutex>
@@ -28,6 +29,7 @@
 #include "knowledge_graph.h"
 #include "ai/ai.h"
 #include "associated_notes.h"
+#include "completion_index.h"
 #include "ontology/thing_class_rel_triple.h"
 #include "aspect/mind_scope_aspect.h"
 #include "../config/configuration.h"
@@ -166,10 +168,19 @@ private:
      */
     int deleteWatermark;
 
+    /**
+     * @brief Memory watermark is incremented whenever Memory changes.
+     *
+     * It's incremented when Os are learned, remembered or forgotten and when
+     * Ns are created, deleted, refactored or moved. This is a dirty flag used
+     * by other components to evict caches (knowledge graph, ...).
+     */
+    int memoryWatermark;
+
     /**
      * @brief Active mental processes.
      */
-    int activeProcesses;
+    std::atomic<int> activeProcesses;
 
     /**
      * @brief Need for associations.
@@ -203,20 +214,17 @@ private:
      */
     std::vector<Triple*> triples;
 
-    /**
-     * @brief Notes time machine.
-     *
-     * This member represents memory dwell - a structure of Notes that represents their
-     * relevance to the present. Deeper Note is, less relevant it is.
-     */
-    std::vector<Note*> memoryDwell;
-
     /**
      * @brief Cache of all Notes across all Outlines: built on FTS traversal, evicted on
      * any save/modification/delete.
      */
     std::vector<Note*> allNotesCache;
 
+    /**
+     * @brief Os and Ns names index used for (link) completion.
+     */
+    ThingsCompletionIndex thingsCompletion;
+
     /**
      * @brief Time scope.
      */
@@ -242,6 +250,10 @@ public:
     HtmlOutlineRepresentation* getHtmlRepresentation() { return &htmlRepresentation; }
 
     int getDeleteWatermark() const { return deleteWatermark; }
+    /**
+     * @brief Memory changes w/ Os remembered directly by Memory (e.g. Ns moved in UI) included.
+     */
+    int getMemoryWatermark() const { return memoryWatermark + memory.getRememberWatermark(); }
 
     /**
      * @brief Synchronize both desired and current state and persist it.
@@ -260,8 +272,27 @@ public:
      * @brief Learn new MindForger/Markdown repository/directory/file defined by configuration AND *preserve* desired mind state (it's NOT changed).
      *
      * Mind and Memory is RESET i.e. this method does NOT add new knowledge, but it starts over.
+     * Running AI computations (dreaming, associations) are interrupted.
+     * Markdown files are parsed in parallel (threads=0 ~ hardware concurrency).
+     */
+    bool learn(unsigned threads=0);
+
+    /**
+     * @brief Learn repository progressively i.e. Os become available in batches.
+     *
+     * Files are parsed in background, Os are learned by learnBatch() calls from the
+     * thread which owns the Mind (GUI thread). Searches, autolinking and thinking are
+     * not available until learning is finished - see isLearning().
+     */
+    std::shared_future<bool> learnAsync();
+
+    /**
+     * @brief Learn next batch of Os - once all Os are learned, Mind's indices are built.
+     *
+     * @return number of processed files.
      */
-    bool learn();
+    size_t learnBatch();
+    bool isLearning() const { return memory.isLearning(); }
 
     /**
      * @brief Think to do useful things for user when searching, viewing or editing.
@@ -274,7 +305,8 @@ public:
     /**
      * @brief Sleep to clear Mind, keep Memory and relax.
      *
-     * Memory is kept, but Mind is cleared. No thinking or dreaming.
+     * Memory is kept, but Mind is cleared. No thinking or dreaming - running
+     * dreaming and associations are interrupted.
      */
     bool sleep();
 
@@ -317,6 +349,12 @@ public:
 
     bool isNerInitilized() const;
     void recognizePersons(const Outline* outline, int entityFilter, std::vector<NerNamedEntity>& result);
+    /**
+     * @brief Recognize named entities in all Os in memory.
+     *
+     * Entities are cached per O revision i.e. only new/modified Os are processed.
+     */
+    void recognizeEntities(int entityFilter, std::vector<NerNamedEntity>& result);
 
 #endif
 
@@ -344,6 +382,14 @@ public:
      */
     void forget(Outline* outline);
 
+    /**
+     * @brief Export all Outlines to CSV file.
+     *
+     * N term vectors are exported if requested and BoW is available
+     * (BoW associations assessment and AI is thinking).
+     */
+    void exportToCsv(const std::string& fileName, bool withBow=false);
+
     /**
      * @brief Get ontology.
      */
@@ -352,10 +398,14 @@ public:
     /**
      * @brief Get memory dwell.
      *
-     * Get all Notes ordered by their importance in memory and
-     * trimmed by forgetting threshold.
+     * Memory dwell is a structure of Notes that represents their relevance
+     * to the present - Notes are ordered by decayed recency/frequency of their
+     * use. Deeper Note is, less relevant it is.
+     *
+     * @param limit             maximum number of Notes, 0 for all Notes
+     * @param addNoteForOutline add also Note for every Outline
      */
-    const std::vector<Note*>& getMemoryDwell(int pageSize = ALL_ENTRIES) const;
+    std::vector<Note*>& getMemoryDwell(std::vector<Note*>& notes, size_t limit, bool addNoteForOutline=false) const;
     size_t getMemoryDwellDepth() const;
 
     /*
@@ -367,6 +417,11 @@ public:
      */
     std::unique_ptr<std::vector<Outline*>> findOutlineByNameFts(const std::string& pattern) const;
     //std::vector<Note*>* findNoteByNameFts(const std::string& pattern) const;
+    /**
+     * @brief Find Ns (and O descriptors) by name and description.
+     *
+     * Search doesn't modify Mind, therefore searches can run concurrently once Mind learned.
+     */
     std::vector<Note*>* findNoteFts(
             const std::string& pattern,
             const FtsSearch mode = FtsSearch::EXACT,
@@ -400,11 +455,19 @@ public:
     std::vector<Note*>* getReferencedNotes(const Note& note, const Outline& outline) const;
 
     /**
-     * @brief Get Notes that reference the note (incoming).
+     * @brief Get Notes that reference the note (incoming) i.e. backlinks.
+     *
+     * Referee N either has Markdown link to the note in its description
+     * or metadata link. Caller is responsible for deletion of the result.
      */
     std::vector<Note*>* getRefereeNotes(const Note& note) const;
     std::vector<Note*>* getRefereeNotes(const Note& note, const Outline& outline) const;
 
+    /**
+     * @brief Get Notes of other Outlines that reference the outline or its Notes.
+     */
+    std::vector<Note*>* getRefereeNotes(const Outline& outline) const;
+
     /*
      * LABELS and TAGS
      */
@@ -479,6 +542,18 @@ public:
     const std::vector<Outline*>& getOutlines() const;
     std::vector<Outline*>* getOutlinesOfType(const OutlineType& type) const;
 
+    /**
+     * @brief Get (at most limit) best ranked O/N Markdown links for given O/N name prefix.
+     *
+     * Names index is maintained incrementally and links (relative paths) are
+     * serialized only for Things which make it to the result.
+     */
+    void getLinksForPrefix(
+            const std::string& prefix,
+            std::vector<std::string>& links,
+            Outline* currentO=nullptr,
+            size_t limit=Configuration::EDITOR_MAX_AUTOCOMPLETE_RESULTS);
+
     std::vector<Note*>& getAllNotes(std::vector<Note*>& notes, bool sortByRead=false, bool addNoteForOutline=false) const;
     std::vector<Note*>* getNotesOfType(const NoteType& type) const;
     std::vector<Note*>* getNotesOfType(const NoteType& type, const Outline& outline) const;
@@ -538,6 +613,11 @@ public:
      */
     bool outlineForget(std::string outlineKey);
 
+    /**
+     * @brief Mark O as read - reads are counted and O goes up in memory dwell.
+     */
+    void outlineRead(Outline* outline);
+
     /*
      * NOTE MGMT
      */
@@ -590,6 +670,11 @@ public:
      */
     Outline* noteForget(Note* note);
 
+    /**
+     * @brief Mark N as read - reads are counted and N goes up in memory dwell.
+     */
+    void noteRead(Note* note);
+
     /**
      * @brief Move note to the beginning on the current level of depth.
      */
@@ -675,11 +760,34 @@ private:
     bool mindSleep();
     bool mindAmnesia();
 
+    /**
+     * @brief Build Mind indices once all Os are learned.
+     */
+    void mindLearned();
+
+    /**
+     * @brief Mark O body as recently used and evict the coldest bodies over memory budget.
+     */
+    void bodyRead(Outline* outline);
+
     /**
      * @brief Invoked on remembering Outline/Note/... to flush all inferred knowledge, caches, ...
      */
     void onRemembering();
 
+    /**
+     * @brief Collect Ns of outline which link O/N of given key (anchors ~ also its Ns).
+     */
+    void findReferees(
+            const std::string& key,
+            bool anchors,
+            const Note* self,
+            const Outline& outline,
+            std::vector<Note*>& result) const;
+
+    void outlineToLink(const Outline* o, const Outline* currentO, std::string& link) const;
+    void noteToLink(Note* n, const Outline* currentO, std::string& link) const;
+
     void findNoteFts(
             std::vector<Note*>* result,
             const std::string& pattern,
@@ -53,10 +53,10 @@ public:
     MAP_ITERATOR begin() { return entries.begin(); }
     MAP_ITERATOR end() { return entries.end(); }
     void clear() { entries.clear(); }
-    std::vector<const VALUE*>& values() {
-        // IMPROVE cache this via dirty flag
-        static std::vector<const VALUE*> v;
-        v.clear();
+    // returned by value (no shared static buffer) to allow concurrent readers
+    std::vector<const VALUE*> values() {
+        std::vector<const VALUE*> v{};
+        v.reserve(entries.size());
         for(MAP_ITERATOR i = entries.begin(); i!=entries.end(); ++i) {
           v.push_back(i->second);
         }
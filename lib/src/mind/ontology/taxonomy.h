@@ -54,7 +54,7 @@ public:
     MAP_SIZE size() { return classes.size(); }
     const CLAZZ* get(const std::string& name);
     void add(const std::string& key, const CLAZZ* clazz);
-    std::vector<const CLAZZ*>& values() { return classes.values(); }
+    std::vector<const CLAZZ*> values() { return classes.values(); }
     void clear() { classes.clear(); }
 
     OntologyVocabulary<CLAZZ>& getClasses() { return classes; }
@@ -30,11 +30,13 @@ long Thing::sequence = 0;
 
 Thing::Thing()
     : key{std::to_string(++sequence)},
+      id{0},
       name{}
 {
 }
 
 Thing::Thing(const string name)
+    : id{0}
 {
     setName(name);
 }
@@ -19,6 +19,7 @@
 #ifndef M8R_THING_CLASS_REL_TRIPLE_H_
 #define M8R_THING_CLASS_REL_TRIPLE_H_
 
+#include <cstdint>
 #include <string>
 #include <set>
 
@@ -51,6 +52,13 @@ protected:
      */
     std::string key;
 
+    /**
+     * @brief Stable integer identifier (0 ~ none).
+     *
+     * Os and Ns ids are unique within repository and persisted in metadata.
+     */
+    std::uint32_t id;
+
     /**
      * @brief Display name.
      */
@@ -84,6 +92,8 @@ public:
     virtual ~Thing();
 
     virtual const std::string& getKey() { return key; }
+    std::uint32_t getId() const { return id; }
+    void setId(std::uint32_t id) { this->id = id; }
 
     const std::string& getName() const { return name; }
     virtual void setName(const std::string& name) { this->name = name; autolinkName();}
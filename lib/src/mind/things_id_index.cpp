@@ -0,0 +1,303 @@
+/*
+ things_id_index.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "things_id_index.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+namespace m8r {
+
+using namespace std;
+
+constexpr uint32_t ThingsIdIndex::MAX_ID;
+
+constexpr const auto FILE_THINGS_IDS_HWM = "hwm";
+
+ThingsIdIndex::ThingsIdIndex()
+    : things(1, Entry{nullptr, nullptr, false}),
+      outlinesIds{},
+      count{0},
+      idsPath{},
+      keysPrefix{},
+      stored{},
+      highWaterMark{0},
+      dirty{false}
+{
+}
+
+ThingsIdIndex::~ThingsIdIndex()
+{
+}
+
+/*
+ * Ids file is a list of tab separated pairs - the first line is high-water mark,
+ * the other lines are ids of Things w/o id in metadata:
+ *
+ *   hwm<TAB><high-water mark>
+ *   <id><TAB><relative key>
+ */
+void ThingsIdIndex::load(const string& idsPath, const string& keysPrefix)
+{
+    clear();
+    this->idsPath = idsPath;
+    this->keysPrefix = keysPrefix;
+
+    if(idsPath.size()) {
+        ifstream in{idsPath};
+        string line{};
+        while(getline(in, line)) {
+            size_t tab = line.find('\t');
+            if(tab == string::npos) {
+                continue;
+            }
+            if(line.compare(0, tab, FILE_THINGS_IDS_HWM) == 0) {
+                highWaterMark = std::max(
+                    highWaterMark,
+                    static_cast<uint32_t>(std::min<unsigned long>(strtoul(line.c_str()+tab+1, nullptr, 10), MAX_ID)));
+            } else {
+                unsigned long id = strtoul(line.c_str(), nullptr, 10);
+                if(id && id < MAX_ID) {
+                    stored[line.substr(tab+1)].push_back(static_cast<uint32_t>(id));
+                    highWaterMark = std::max(highWaterMark, static_cast<uint32_t>(id));
+                }
+            }
+        }
+    }
+}
+
+bool ThingsIdIndex::save()
+{
+    if(!dirty || idsPath.empty()) {
+        return false;
+    }
+
+    ofstream out{idsPath};
+    if(!out) {
+        MF_DEBUG("Unable to write Things ids to " << idsPath << endl);
+        return false;
+    }
+    out << FILE_THINGS_IDS_HWM << '\t' << highWaterMark << '\n';
+    // ids file reflects indexed Things - forgotten ids are not recalled
+    stored.clear();
+    for(uint32_t id=1; id<things.size(); id++) {
+        if(things[id].thing && !things[id].persisted) {
+            string key = relativeKey(things[id].thing);
+            out << id << '\t' << key << '\n';
+            stored[key].push_back(id);
+        }
+    }
+    out.close();
+
+    dirty = false;
+    return true;
+}
+
+size_t ThingsIdIndex::learn(const vector<Outline*>& outlines)
+{
+    reset();
+
+    // keys order makes reconciliation independent on (parallel) learning order
+    vector<Outline*> sorted{outlines};
+    std::sort(sorted.begin(), sorted.end(), [](Outline* o1, Outline* o2) {
+        return o1->getKey() < o2->getKey();
+    });
+
+    vector<pair<Thing*,const Outline*>> missing{};
+    for(Outline* o:sorted) {
+        bool persisted = o->getFormat() == MarkdownDocument::Format::MINDFORGER;
+        if(!claim(o, o, persisted)) {
+            missing.push_back(make_pair(o, o));
+        }
+        for(Note* n:o->getNotes()) {
+            if(!claim(n, o, persisted)) {
+                missing.push_back(make_pair(n, o));
+            }
+        }
+    }
+    recall(missing);
+    for(auto& m:missing) {
+        assign(m.first, m.second, false);
+    }
+    return missing.size();
+}
+
+size_t ThingsIdIndex::relearn(Outline* outline)
+{
+    return reindex(outline, false);
+}
+
+size_t ThingsIdIndex::remember(Outline* outline)
+{
+    return reindex(outline, true);
+}
+
+void ThingsIdIndex::forget(const Outline* outline)
+{
+    release(outline);
+}
+
+void ThingsIdIndex::clear()
+{
+    reset();
+    idsPath.clear();
+    keysPrefix.clear();
+    stored.clear();
+    highWaterMark = 0;
+    dirty = false;
+}
+
+Outline* ThingsIdIndex::getOutline(uint32_t id) const
+{
+    if(id < things.size() && things[id].thing && things[id].thing == things[id].outline) {
+        return static_cast<Outline*>(things[id].thing);
+    }
+    return nullptr;
+}
+
+Note* ThingsIdIndex::getNote(uint32_t id) const
+{
+    if(id < things.size() && things[id].thing && things[id].thing != things[id].outline) {
+        return static_cast<Note*>(things[id].thing);
+    }
+    return nullptr;
+}
+
+void ThingsIdIndex::reset()
+{
+    things.assign(1, Entry{nullptr, nullptr, false});
+    outlinesIds.clear();
+    count = 0;
+}
+
+size_t ThingsIdIndex::reindex(Outline* outline, bool saved)
+{
+    release(outline);
+
+    // saved O gets ids to metadata (MF format), loaded O has ids in metadata
+    bool persisted = outline->getFormat() == MarkdownDocument::Format::MINDFORGER;
+    vector<pair<Thing*,const Outline*>> missing{};
+    if(!claim(outline, outline, persisted)) {
+        missing.push_back(make_pair(outline, outline));
+    }
+    for(Note* n:outline->getNotes()) {
+        if(!claim(n, outline, persisted)) {
+            missing.push_back(make_pair(n, outline));
+        }
+    }
+    if(!saved) {
+        recall(missing);
+    }
+    for(auto& m:missing) {
+        assign(m.first, m.second, saved && persisted);
+    }
+    return missing.size();
+}
+
+void ThingsIdIndex::recall(vector<pair<Thing*,const Outline*>>& missing)
+{
+    if(stored.empty()) {
+        return;
+    }
+
+    // Ns w/ the same name (key) get stored ids in order
+    unordered_map<string,size_t> occurrences{};
+    vector<pair<Thing*,const Outline*>> unknown{};
+    for(auto& m:missing) {
+        string key = relativeKey(m.first);
+        auto s = stored.find(key);
+        size_t occurrence = occurrences[key]++;
+        if(s != stored.end() && occurrence < s->second.size()) {
+            m.first->setId(s->second[occurrence]);
+            if(claim(m.first, m.second, false)) {
+                continue;
+            }
+        }
+        unknown.push_back(m);
+    }
+    missing.swap(unknown);
+}
+
+string ThingsIdIndex::relativeKey(Thing* thing) const
+{
+    const string& key = thing->getKey();
+    if(keysPrefix.size() && key.compare(0, keysPrefix.size(), keysPrefix) == 0) {
+        return key.substr(keysPrefix.size());
+    }
+    return key;
+}
+
+void ThingsIdIndex::release(const Outline* outline)
+{
+    auto ids = outlinesIds.find(outline);
+    if(ids != outlinesIds.end()) {
+        for(uint32_t id:ids->second) {
+            // N might have been moved to another O which owns its id now
+            if(things[id].outline == outline) {
+                if(!things[id].persisted) {
+                    dirty = true;
+                }
+                things[id] = Entry{nullptr, nullptr, false};
+                count--;
+            }
+        }
+        outlinesIds.erase(ids);
+    }
+}
+
+bool ThingsIdIndex::claim(Thing* thing, const Outline* outline, bool persisted)
+{
+    uint32_t id = thing->getId();
+    if(id && id < MAX_ID) {
+        if(id >= things.size()) {
+            things.resize(id+1, Entry{nullptr, nullptr, false});
+        }
+        if(!things[id].thing || things[id].thing == thing) {
+            if(!things[id].thing) {
+                count++;
+            }
+            things[id] = Entry{thing, outline, persisted};
+            outlinesIds[outline].push_back(id);
+            if(id > highWaterMark) {
+                highWaterMark = id;
+                dirty = true;
+            }
+            if(!persisted) {
+                dirty = true;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThingsIdIndex::assign(Thing* thing, const Outline* outline, bool persisted)
+{
+    // ids up to high-water mark might belong to forgotten Things
+    uint32_t id = highWaterMark+1;
+    things.resize(id, Entry{nullptr, nullptr, false});
+    things.push_back(Entry{thing, outline, persisted});
+    outlinesIds[outline].push_back(id);
+    thing->setId(id);
+    highWaterMark = id;
+    dirty = true;
+    count++;
+}
+
+}
@@ -0,0 +1,148 @@
+/*
+ things_id_index.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_THINGS_ID_INDEX_H_
+#define M8R_THINGS_ID_INDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../model/outline.h"
+#include "../model/note.h"
+
+namespace m8r {
+
+/**
+ * @brief Stable ids of Os and Ns.
+ *
+ * Ids are persisted in Os/Ns metadata, therefore they survive restarts, renames
+ * and N refactoring to another O. Ids which are not (yet) in metadata - Markdown
+ * repositories, Things learned w/o id and not saved since - are persisted in ids
+ * file by Thing key (relative to repository) along with ids high-water mark.
+ *
+ * Ids are reconciled on learn: the first Thing (in Os keys order) keeps its id
+ * from metadata, Things w/o id get id from ids file, the rest (e.g. copied file)
+ * gets new ids above the high-water mark i.e. ids are never reused.
+ *
+ * Ids are dense, therefore id to Thing index is an array and id can be used as
+ * index of any per-Thing array.
+ */
+class ThingsIdIndex
+{
+public:
+    // index is an array - larger ids (e.g. from a corrupted file) are not trusted
+    static constexpr std::uint32_t MAX_ID = 1<<24;
+
+private:
+    struct Entry {
+        Thing* thing;
+        // O which owns the id (the O itself or O of the N)
+        const Outline* outline;
+        // id is in O metadata i.e. it's not written to ids file
+        bool persisted;
+    };
+
+    // id to Thing, 0 ~ no id
+    std::vector<Entry> things;
+    // ids of O and its Ns - removal doesn't touch (possibly deleted) Ns
+    std::unordered_map<const Outline*,std::vector<std::uint32_t>> outlinesIds;
+    size_t count;
+
+    // ids file path ("" ~ ids file is not written) and repository prefix of keys
+    std::string idsPath;
+    std::string keysPrefix;
+    // ids from ids file: relative key to ids (Ns w/ the same name in order)
+    std::unordered_map<std::string,std::vector<std::uint32_t>> stored;
+    // the highest id ever assigned
+    std::uint32_t highWaterMark;
+    bool dirty;
+
+public:
+    explicit ThingsIdIndex();
+    ThingsIdIndex(const ThingsIdIndex&) = delete;
+    ThingsIdIndex(const ThingsIdIndex&&) = delete;
+    ThingsIdIndex &operator=(const ThingsIdIndex&) = delete;
+    ThingsIdIndex &operator=(const ThingsIdIndex&&) = delete;
+    ~ThingsIdIndex();
+
+    /**
+     * @brief Load ids file - stored ids and high-water mark are used by learn.
+     *
+     * @param idsPath   ids file path, empty path ~ ids are not persisted.
+     * @param keysPrefix    repository path prefix stripped from Things keys.
+     */
+    void load(const std::string& idsPath, const std::string& keysPrefix);
+    /**
+     * @brief Write ids file if ids or high-water mark changed.
+     */
+    bool save();
+
+    /**
+     * @brief Index ids of learned Os and Ns, assign missing and duplicate ids.
+     *
+     * @return number of Things which got new id.
+     */
+    size_t learn(const std::vector<Outline*>& outlines);
+    /**
+     * @brief Reindex O (re)loaded from file e.g. O body with new Ns.
+     *
+     * @return number of Things which got new id.
+     */
+    size_t relearn(Outline* outline);
+    /**
+     * @brief Reindex O which is being saved - new Ns get ids.
+     *
+     * @return number of Things which got new id.
+     */
+    size_t remember(Outline* outline);
+    void forget(const Outline* outline);
+    void clear();
+
+    /**
+     * @brief Number of indexed Things.
+     */
+    size_t size() const { return count; }
+    /**
+     * @brief Upper bound of ids (size of arrays indexed by id).
+     */
+    std::uint32_t getIdsBound() const { return static_cast<std::uint32_t>(things.size()); }
+    /**
+     * @brief The highest id ever assigned in the repository.
+     */
+    std::uint32_t getHighWaterMark() const { return highWaterMark; }
+
+    Thing* get(std::uint32_t id) const {
+        return id < things.size() ? things[id].thing : nullptr;
+    }
+    Outline* getOutline(std::uint32_t id) const;
+    Note* getNote(std::uint32_t id) const;
+
+private:
+    void reset();
+    size_t reindex(Outline* outline, bool saved);
+    void recall(std::vector<std::pair<Thing*,const Outline*>>& missing);
+    std::string relativeKey(Thing* thing) const;
+    void release(const Outline* outline);
+    bool claim(Thing* thing, const Outline* outline, bool persisted);
+    void assign(Thing* thing, const Outline* outline, bool persisted);
+};
+
+}
+#endif /* M8R_THINGS_ID_INDEX_H_ */
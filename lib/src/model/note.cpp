@@ -32,7 +32,7 @@ Note::Note(const NoteType* type, Outline* outline)
     reads = revision = 0;
     progress = 0;
     flags = 0;
-    aiAaMatrixIndex = -1;
+    updateKey();
 }
 
 Note::Note(const Note& n)
@@ -42,6 +42,10 @@ Note::Note(const Note& n)
 {
     name = n.name;
     autolinkName();
+    updateMangledName();
+    if(n.outline) {
+        n.outline->loadBody();
+    }
     if(n.description.size()) {
         for(string* s:n.description) {
             description.push_back(new string(*s));
@@ -56,8 +60,6 @@ Note::Note(const Note& n)
     reads = n.reads;
     revision = n.revision;
     progress = n.progress;
-    // share old N's similarity assessment
-    aiAaMatrixIndex = n.aiAaMatrixIndex;
 
     if(n.tags.size()) {
         tags.insert(tags.end(), n.tags.begin(), n.tags.end());
@@ -69,14 +71,41 @@ Note::Note(const Note& n)
 Note::~Note()
 {
     for(string* d:description) {
-        delete d;
+        TextArena::release(d, textArena.get());
     }
     for(Link* l:links) {
         delete l;
     }
 }
 
-string Note::getMangledName() const
+void Note::setName(const string& name)
+{
+    if(name != this->name) {
+        Thing::setName(name);
+        updateMangledName();
+    }
+}
+
+void Note::updateMangledName()
+{
+    mangledName = mangleName(name);
+    updateKey();
+    if(outline) {
+        outline->invalidateNotesNamesIndex();
+    }
+}
+
+void Note::updateKey()
+{
+    key.clear();
+    if(outline) {
+        key.append(outline->getKey());
+    }
+    key.append("#");
+    key.append(mangledName);
+}
+
+string Note::mangleName(const string& name)
 {
     string result = name;
     if(result.size()) {
@@ -132,6 +161,7 @@ u_int16_t Note::getDepth() const
 void Note::setDepth(u_int16_t depth)
 {
     this->depth = depth;
+    if(outline) outline->invalidateNotesIndex();
 }
 
 time_t Note::getModified() const
@@ -142,7 +172,6 @@ time_t Note::getModified() const
 void Note::makeModified()
 {
     setModified();
-    setModifiedPretty();
     incRevision();
 
     if(outline) outline->makeModified();
@@ -158,37 +187,16 @@ void Note::setModified(time_t modified)
     MF_ASSERT_FUTURE_TIMESTAMPS(created, read, modified, outline->getKey() << "# " << name, name);
 
     this->modified = modified;
-    setModifiedPretty();
-}
-
-const string& Note::getModifiedPretty() const
-{
-    return modifiedPretty;
-}
-
-void Note::setModifiedPretty()
-{
-    this->modifiedPretty = datetimeToPrettyHtml(modified);
-}
-
-void Note::setModifiedPretty(const string& modifiedPretty)
-{
-    this->modifiedPretty = modifiedPretty;
 }
 
-const string& Note::getReadPretty() const
+string Note::getModifiedPretty() const
 {
-    return readPretty;
+    return datetimeToPrettyHtml(modified);
 }
 
-void Note::setReadPretty()
+string Note::getReadPretty() const
 {
-    this->readPretty = datetimeToPrettyHtml(read);
-}
-
-void Note::setReadPretty(const string& readPretty)
-{
-    this->readPretty = readPretty;
+    return datetimeToPrettyHtml(read);
 }
 
 u_int8_t Note::getProgress() const
@@ -209,7 +217,6 @@ time_t Note::getRead() const
 void Note::setRead(time_t read)
 {
     this->read = read;
-    setReadPretty();
 }
 
 void Note::makeRead()
@@ -284,6 +291,7 @@ void Note::setTags(const vector<const Tag*>* tags)
 void Note::addName(const string& s) {
     name += s;
     autolinkName();
+    updateMangledName();
 }
 
 const NoteType* Note::getType() const
@@ -298,11 +306,17 @@ void Note::clear()
 
 const vector<string*>& Note::getDescription() const
 {
+    if(outline) {
+        outline->loadBody();
+    }
     return description;
 }
 
 string Note::getDescriptionAsString(const std::string& separator) const
 {    
+    if(outline) {
+        outline->loadBody();
+    }
     // IMPROVE cache narrowed description for performance & return it by reference
     string result{};
     if(description.size()) {
@@ -316,15 +330,25 @@ string Note::getDescriptionAsString(const std::string& separator) const
 
 void Note::setDescription(const vector<string*>& description)
 {
+    if(outline) {
+        outline->loadBody();
+    }
     this->description = description;
 }
 
 void Note::moveDescription(std::vector<std::string*>& target)
 {
+    if(outline) {
+        outline->loadBody();
+    }
     if(description.size()) {
-        // IMPROVE find a more efficient method - perhaps an algorithm function
+        // arena lines are copied on move as the target owns lines
         for(auto& s:description) {
-            target.push_back(s);
+            if(textArena && textArena->owns(s)) {
+                target.push_back(new string{*s});
+            } else {
+                target.push_back(s);
+            }
         }
         description.clear();
     }
@@ -332,11 +356,17 @@ void Note::moveDescription(std::vector<std::string*>& target)
 
 void Note::clearDescription()
 {
+    if(outline) {
+        outline->loadBody();
+    }
     this->description.clear();
 }
 
 void Note::addDescription(const vector<string*>& d)
 {
+    if(outline) {
+        outline->loadBody();
+    }
     // IMPROVE why not description.push_back(d);
     description.insert(description.end(),d.begin(),d.end());
 }
@@ -349,6 +379,7 @@ Outline* Note::getOutline() const
 void Note::setOutline(Outline* outline)
 {
     this->outline = outline;
+    updateKey();
 }
 
 const string& Note::getOutlineKey() const
@@ -362,6 +393,9 @@ const string& Note::getOutlineKey() const
 
 void Note::addDescriptionLine(string *line)
 {
+    if(outline) {
+        outline->loadBody();
+    }
     if(line) {
         description.push_back(line);
     }
@@ -428,7 +462,6 @@ void Note::completeProperties(const time_t outlineModificationTime)
     }
 
     checkAndFixProperties();
-    setModifiedPretty();
 }
 
 void Note::checkAndFixProperties()
@@ -446,21 +479,12 @@ void Note::checkAndFixProperties()
     if(name.empty()) {
         name.assign("Note");
         autolinkName();
+        updateMangledName();
     }
 
     MF_ASSERT_FUTURE_TIMESTAMPS(created, read, modified, outline->getKey() << " # " << name, name);
 }
 
-const string& Note::getKey()
-{
-    key.clear();
-    key.append(outline->getKey());
-    key.append("#");
-    key.append(getMangledName());
-
-    return key;
-}
-
 void Note::addLink(Link* link)
 {
     if(link) {
@@ -471,11 +495,13 @@ void Note::addLink(Link* link)
 void Note::demote()
 {
     depth++;
+    if(outline) outline->invalidateNotesIndex();
 }
 
 void Note::promote()
 {
     if(depth) depth--;
+    if(outline) outline->invalidateNotesIndex();
 }
 
 void Note::makeDirty()
@@ -21,6 +21,7 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <string>
 
 #include "../config/config.h"
@@ -29,6 +30,7 @@
 #include "tag.h"
 #include "link.h"
 #include "../exceptions.h"
+#include "../gear/text_arena.h"
 
 namespace m8r {
 
@@ -46,6 +48,9 @@ class Outline;
  */
 class Note : public Thing
 {
+    // O manages Ns descriptions when its body is (un)loaded
+    friend class Outline;
+
 private:
     static constexpr int FLAG_MASK_POST_DECLARED_SECTION = 1;
     static constexpr int FLAG_MASK_TRAILING_HASHES_SECTION = 1<<1;
@@ -65,13 +70,13 @@ private:
     std::vector<Link*> links;
     const NoteType* type;
     std::vector<std::string*> description;
+    // arena of parsed description lines (shared w/ O) - edited lines are heap allocated
+    std::shared_ptr<TextArena> textArena;
 
     time_t created;
     time_t modified;
-    std::string modifiedPretty;
     u_int32_t revision;
     time_t read;
-    std::string readPretty;
     u_int32_t reads;
 
     u_int8_t progress;
@@ -81,7 +86,8 @@ private:
      * Transient fields
      */
 
-    int aiAaMatrixIndex;
+    // GitHub compatible mangled name - precomputed (w/ key) on name change
+    std::string mangledName;
 
 public:
     Note() = delete;
@@ -96,14 +102,24 @@ public:
     void completeProperties(const time_t outlineModificationTime);
     void checkAndFixProperties();
 
-    virtual const std::string& getKey();
+    /**
+     * @brief Return N key (O key # mangled name) - key is precomputed, not built per call.
+     */
+    virtual const std::string& getKey() override { return key; }
+    /**
+     * @brief Rebuild key - to be called when O key is changed.
+     */
+    void updateKey();
+
+    virtual void setName(const std::string& name) override;
 
     /**
      * @brief Return GitHub compatible mangled name to ensure compatiblity between GitHub and MindForger # links.
      *
      * See also https://github.com/dvorka/trainer/blob/master/markdow/section-links-mangling.md
      */
-    std::string getMangledName() const;
+    const std::string& getMangledName() const { return mangledName; }
+    static std::string mangleName(const std::string& name);
     time_t getCreated() const;
     void setCreated(time_t created);
     time_t getDeadline() const;
@@ -114,18 +130,17 @@ public:
     void makeModified();
     void setModified();
     void setModified(time_t modified);
-    const std::string& getModifiedPretty() const;
-    void setModifiedPretty();
-    void setModifiedPretty(const std::string& modifiedPretty);
+    /**
+     * @brief Pretty modified timestamp - created on demand (pretty dates are memoized per day).
+     */
+    std::string getModifiedPretty() const;
     const std::string& getOutlineKey() const;
     u_int8_t getProgress() const;
     void setProgress(u_int8_t progress);
     time_t getRead() const;
     void setRead(time_t read);
     void makeRead();
-    const std::string& getReadPretty() const;
-    void setReadPretty();
-    void setReadPretty(const std::string& readPretty);
+    std::string getReadPretty() const;
     u_int32_t getReads() const;
     void setReads(u_int32_t reads);
     u_int32_t getRevision() const;
@@ -154,6 +169,8 @@ public:
     void clearDescription();
     void addDescription(const std::vector<std::string*>& d);
     void addDescriptionLine(std::string *line);
+    TextArena* getTextArena() const { return textArena.get(); }
+    void setTextArena(const std::shared_ptr<TextArena>& textArena) { this->textArena = textArena; }
     Outline* getOutline() const;
     void setOutline(Outline* outline);
 
@@ -171,8 +188,8 @@ public:
 
     void makeDirty();
 
-    int getAiAaMatrixIndex() const { return aiAaMatrixIndex; }
-    void setAiAaMatrixIndex(int i) { aiAaMatrixIndex = i; }
+private:
+    void updateMangledName();
 };
 
 } // m8r namespace
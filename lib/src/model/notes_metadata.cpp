@@ -0,0 +1,80 @@
+/*
+ notes_metadata.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "notes_metadata.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "note.h"
+
+namespace m8r {
+
+using namespace std;
+
+NotesMetadata::NotesMetadata()
+    : notes{},
+      read{}
+{
+}
+
+NotesMetadata::~NotesMetadata()
+{
+}
+
+void NotesMetadata::assign(const vector<Note*>& ns)
+{
+    clear();
+
+    notes.reserve(ns.size());
+    read.reserve(ns.size());
+    for(Note* n:ns) {
+        notes.push_back(n);
+        read.push_back(n->getRead());
+    }
+}
+
+void NotesMetadata::clear()
+{
+    notes.clear();
+    read.clear();
+}
+
+void NotesMetadata::sortByRead(vector<Note*>& sorted) const
+{
+    // sort (timestamp, offset) keys which are small and contiguous
+    vector<pair<time_t,size_t>> keys{};
+    keys.reserve(read.size());
+    for(size_t i=0; i<read.size(); i++) {
+        keys.push_back(pair<time_t,size_t>(read[i], i));
+    }
+    std::sort(
+        keys.begin(),
+        keys.end(),
+        [](const pair<time_t,size_t>& k1, const pair<time_t,size_t>& k2) {
+            return k1.first > k2.first || (k1.first == k2.first && k1.second < k2.second);
+        });
+
+    sorted.clear();
+    sorted.reserve(keys.size());
+    for(const auto& k:keys) {
+        sorted.push_back(notes[k.second]);
+    }
+}
+
+} // m8r namespace
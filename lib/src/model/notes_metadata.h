@@ -0,0 +1,66 @@
+/*
+ notes_metadata.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_NOTES_METADATA_H
+#define M8R_NOTES_METADATA_H
+
+#include <ctime>
+#include <vector>
+
+namespace m8r {
+
+class Note;
+
+/**
+ * @brief Compact (column per property) snapshot of hot numeric N metadata.
+ *
+ * Sorting of (all) Ns accesses just one number per N - chasing N pointers
+ * for every comparison thrashes cache. Columns are gathered in one pass
+ * and then scanned linearly.
+ */
+class NotesMetadata
+{
+private:
+    std::vector<Note*> notes;
+
+    std::vector<time_t> read;
+
+public:
+    explicit NotesMetadata();
+    NotesMetadata(const NotesMetadata&) = delete;
+    NotesMetadata(const NotesMetadata&&) = delete;
+    NotesMetadata &operator=(const NotesMetadata&) = delete;
+    NotesMetadata &operator=(const NotesMetadata&&) = delete;
+    ~NotesMetadata();
+
+    /**
+     * @brief Gather metadata of given Ns (previous content is dropped).
+     */
+    void assign(const std::vector<Note*>& ns);
+    void clear();
+
+    size_t size() const { return notes.size(); }
+
+    /**
+     * @brief Ns sorted by read timestamp (most recently read first).
+     */
+    void sortByRead(std::vector<Note*>& sorted) const;
+};
+
+}
+#endif // M8R_NOTES_METADATA_H
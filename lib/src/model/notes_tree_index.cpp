@@ -0,0 +1,135 @@
+/*
+ notes_tree_index.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "notes_tree_index.h"
+
+#include "note.h"
+
+namespace m8r {
+
+using namespace std;
+
+NotesTreeIndex::NotesTreeIndex()
+    : valid{false},
+      offsets{},
+      entries{},
+      rootChildrenCount{0}
+{
+}
+
+NotesTreeIndex::~NotesTreeIndex()
+{
+}
+
+void NotesTreeIndex::ensure(const vector<Note*>& notes)
+{
+    if(!valid) {
+        lock_guard<mutex> criticalSection{buildMutex};
+        if(!valid) {
+            build(notes);
+            valid = true;
+        }
+    }
+}
+
+void NotesTreeIndex::build(const vector<Note*>& notes)
+{
+    offsets.clear();
+    offsets.reserve(notes.size());
+    entries.resize(notes.size());
+
+    int lastRoot;
+    rootChildrenCount = indexRange(notes, 0, notes.size(), NONE, lastRoot);
+}
+
+void NotesTreeIndex::reindex(const vector<Note*>& notes, size_t begin, size_t end)
+{
+    if(!valid || begin >= end || end > notes.size()) {
+        valid = false;
+        return;
+    }
+
+    // roots of reordered subtrees have the same depth and parent, Ns outside of range are not affected
+    int parent = entries[begin].parent;
+    int prevOutside = entries[begin].prevSibling;
+    int nextOutside = NONE;
+    if(end < notes.size() && notes[end]->getDepth() == notes[begin]->getDepth()) {
+        nextOutside = static_cast<int>(end);
+    }
+
+    int lastRoot;
+    indexRange(notes, begin, end, parent, lastRoot);
+
+    entries[begin].prevSibling = prevOutside;
+    if(prevOutside != NONE) {
+        entries[prevOutside].nextSibling = static_cast<int>(begin);
+    }
+    entries[lastRoot].nextSibling = nextOutside;
+    if(nextOutside != NONE) {
+        entries[nextOutside].prevSibling = lastRoot;
+    }
+}
+
+size_t NotesTreeIndex::indexRange(const vector<Note*>& notes, size_t begin, size_t end, int parent, int& lastRoot)
+{
+    size_t roots = 0;
+    lastRoot = NONE;
+
+    // stack of ancestors of the previous N (strictly growing depth)
+    vector<size_t> ancestors{};
+    for(size_t i=begin; i<end; i++) {
+        const auto depth = notes[i]->getDepth();
+
+        // close subtrees of Ns which are not N's ancestors
+        int closed = NONE;
+        while(!ancestors.empty() && notes[ancestors.back()]->getDepth() >= depth) {
+            closed = static_cast<int>(ancestors.back());
+            entries[closed].subtreeSize = i-closed-1;
+            ancestors.pop_back();
+        }
+
+        Entry& e = entries[i];
+        e.childrenCount = 0;
+        e.nextSibling = NONE;
+        // the nearest N above w/ depth lower or equal is either sibling or parent
+        if(closed != NONE && notes[closed]->getDepth() == depth) {
+            e.prevSibling = closed;
+            entries[closed].nextSibling = static_cast<int>(i);
+        } else {
+            e.prevSibling = NONE;
+        }
+        if(ancestors.empty()) {
+            e.parent = parent;
+            lastRoot = static_cast<int>(i);
+            roots++;
+        } else {
+            e.parent = static_cast<int>(ancestors.back());
+            entries[ancestors.back()].childrenCount++;
+        }
+
+        offsets[notes[i]] = i;
+        ancestors.push_back(i);
+    }
+    for(size_t a:ancestors) {
+        entries[a].subtreeSize = end-a-1;
+    }
+
+    return roots;
+}
+
+} // m8r namespace
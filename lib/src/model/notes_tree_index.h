@@ -0,0 +1,108 @@
+/*
+ notes_tree_index.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_NOTES_TREE_INDEX_H
+#define M8R_NOTES_TREE_INDEX_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+namespace m8r {
+
+class Note;
+
+/**
+ * @brief Tree structure index of O's flat (depth first ordered) vector of Ns.
+ *
+ * Parent of N is the nearest N above with lower depth (regardless how big
+ * the gap in depth is), subtree of N are Ns below with higher depth. Siblings
+ * are linked only if they have the same depth (as required by N moves).
+ *
+ * Index is built on demand in O(n) and it must be invalidated on any change
+ * of Ns vector or N depth. Block moves of sibling subtrees can be reindexed
+ * in O(moved subtrees).
+ */
+class NotesTreeIndex
+{
+public:
+    static constexpr int NONE = -1;
+
+private:
+    struct Entry {
+        int parent;
+        // number of all (transitive) children
+        size_t subtreeSize;
+        size_t childrenCount;
+        int prevSibling;
+        int nextSibling;
+    };
+
+    std::atomic<bool> valid;
+    std::mutex buildMutex;
+
+    std::unordered_map<const Note*,size_t> offsets;
+    std::vector<Entry> entries;
+    size_t rootChildrenCount;
+
+public:
+    explicit NotesTreeIndex();
+    NotesTreeIndex(const NotesTreeIndex&) = delete;
+    NotesTreeIndex(const NotesTreeIndex&&) = delete;
+    NotesTreeIndex &operator=(const NotesTreeIndex&) = delete;
+    NotesTreeIndex &operator=(const NotesTreeIndex&&) = delete;
+    ~NotesTreeIndex();
+
+    void invalidate() { valid = false; }
+    bool isValid() const { return valid; }
+
+    /**
+     * @brief Build index if it's not valid.
+     */
+    void ensure(const std::vector<Note*>& notes);
+
+    /**
+     * @brief Reindex [begin,end) range of complete sibling subtrees with the same parent after they were reordered.
+     */
+    void reindex(const std::vector<Note*>& notes, size_t begin, size_t end);
+
+    int getOffset(const Note* note) const {
+        auto o = offsets.find(note);
+        return o==offsets.end()?NONE:static_cast<int>(o->second);
+    }
+    int getParent(size_t offset) const { return entries[offset].parent; }
+    size_t getSubtreeSize(size_t offset) const { return entries[offset].subtreeSize; }
+    size_t getChildrenCount(size_t offset) const { return entries[offset].childrenCount; }
+    size_t getRootChildrenCount() const { return rootChildrenCount; }
+    int getPrevSibling(size_t offset) const { return entries[offset].prevSibling; }
+    int getNextSibling(size_t offset) const { return entries[offset].nextSibling; }
+
+private:
+    void build(const std::vector<Note*>& notes);
+
+    /**
+     * @brief Index range of complete subtrees whose roots have given parent.
+     *
+     * @return number of roots in range.
+     */
+    size_t indexRange(const std::vector<Note*>& notes, size_t begin, size_t end, int parent, int& lastRoot);
+};
+
+}
+#endif // M8R_NOTES_TREE_INDEX_H
@@ -25,6 +25,8 @@ namespace m8r {
 // IMPROVE this type is not bound to any parent Clazz in Ontology
 const NoteType Outline::NOTE_4_OUTLINE_TYPE{"Outline", nullptr, Color::RED()};
 
+std::atomic<unsigned long> Outline::namesRevision{0};
+
 Outline::Outline(const OutlineType* type)
     : Thing{},
       memoryLocation(OutlineMemoryLocation::NORMAL),
@@ -36,18 +38,21 @@ Outline::Outline(const OutlineType* type)
     reads = revision = 0;
     importance = urgency = progress = 0;
     bytesize = 0;
+    bodyLoader = nullptr;
+    bodyLoaded = true;
     flags = 0;
     dirty = false;
+    notesNamesIndexValid = false;
 
     outlineDescriptorAsNote = new Note(&NOTE_4_OUTLINE_TYPE, this);
 }
 
 Outline::~Outline() {
     for(string* d:description) {
-        delete d;
+        TextArena::release(d, textArena.get());
     }
     for(string* d:preamble) {
-        delete d;
+        TextArena::release(d, textArena.get());
     }
     for(Link* l:links) {
         delete l;
@@ -70,7 +75,6 @@ void Outline::resetClonedOutline(Outline* o)
     o->setModified();
     o->setCreated(modified);
     o->setRead(modified);
-    o->setModifiedPretty();
     o->completeProperties(modified);
     o->outlineDescriptorAsNote = nullptr;
 }
@@ -80,6 +84,10 @@ Outline::Outline(const Outline& o)
       memoryLocation(OutlineMemoryLocation::NORMAL), format(o.format), type(o.type)
 {
     key.clear();
+    notesNamesIndexValid = false;
+    o.loadBody();
+    bodyLoader = nullptr;
+    bodyLoaded = true;
 
     // IMPROVE i18n
     name = "Copy of " + o.name;
@@ -175,13 +183,10 @@ void Outline::completeProperties(const time_t fileModificationTime)
     if(notes.size()) {
         for(Note* n:notes) {
             n->completeProperties(modified);
-            n->setModifiedPretty();
-            n->setReadPretty();
         }
     }
 
     checkAndFixProperties();
-    setModifiedPretty();
 }
 
 void Outline::checkAndFixProperties()
@@ -201,7 +206,6 @@ void Outline::checkAndFixProperties()
 
     if(latestNote > modified) {
         modified = latestNote;
-        setModifiedPretty();
     }
     if(revision > reads) {
         reads = revision;
@@ -241,7 +245,6 @@ void Outline::notifyChange(Note* note)
     revision++;
 
     note->setModified(modified);
-    note->setModifiedPretty(datetimeToPrettyHtml(modified));
     note->incRevision();
 }
 
@@ -273,6 +276,19 @@ const string& Outline::getKey() const
 void Outline::setKey(const string key)
 {
     this->key = key;
+    // N keys are precomputed from O key
+    for(Note* n:notes) {
+        n->updateKey();
+    }
+    if(outlineDescriptorAsNote) {
+        outlineDescriptorAsNote->updateKey();
+    }
+}
+
+void Outline::setName(const string& name)
+{
+    Thing::setName(name);
+    namesRevision++;
 }
 
 const Tag* Outline::getPrimaryTag() const
@@ -313,7 +329,6 @@ time_t Outline::getModified() const
 void Outline::makeModified()
 {
     setModified();
-    setModifiedPretty();
     incRevision();
 }
 
@@ -327,19 +342,9 @@ void Outline::setModified(time_t modified)
     this->modified = modified;
 }
 
-const string& Outline::getModifiedPretty() const
+string Outline::getModifiedPretty() const
 {
-    return modifiedPretty;
-}
-
-void Outline::setModifiedPretty()
-{
-    this->modifiedPretty = datetimeToPrettyHtml(modified);
-}
-
-void Outline::setModifiedPretty(const string& modifiedPretty)
-{
-    this->modifiedPretty = modifiedPretty;
+    return datetimeToPrettyHtml(modified);
 }
 
 const vector<Note*>& Outline::getNotes() const
@@ -354,7 +359,10 @@ size_t Outline::getNotesCount() const
 
 void Outline::setNotes(const vector<Note*>& notes)
 {
+    // body is matched to Ns by order
+    loadBody();
     this->notes = notes;
+    invalidateNotesIndices();
 }
 
 int8_t Outline::getProgress() const
@@ -460,12 +468,12 @@ void Outline::resetClonedNote(Note* n)
     n->setModified();
     n->setModified(n->getModified());
     n->setRead(n->getModified());
-    n->setModifiedPretty();
     n->completeProperties(n->getModified());
 }
 
 Note* Outline::cloneNote(const Note* clonedNote)
 {
+    loadBody();
     int offset = getNoteOffset(clonedNote);
     if(offset != -1) {
         Note* newNote;
@@ -487,6 +495,7 @@ Note* Outline::cloneNote(const Note* clonedNote)
                     newNote->setOutline(this);
                     notes.push_back(newNote);
                 }
+                invalidateNotesIndices();
             }
         }
 
@@ -503,22 +512,27 @@ Note* Outline::cloneNote(const Note* clonedNote)
 
 void Outline::addNote(Note* note)
 {
+    loadBody();
     note->setOutline(this);
     notes.push_back(note);
+    invalidateNotesIndices();
 }
 
 void Outline::addNote(Note* note, int offset)
 {
+    loadBody();
     note->setOutline(this);
     if(static_cast<unsigned int>(offset) > notes.size()-1) {
         notes.push_back(note);
     } else {
         notes.insert(notes.begin()+offset, note);
     }
+    invalidateNotesIndices();
 }
 
 void Outline::addNotes(std::vector<Note*>& notesToAdd, int offset)
 {
+    loadBody();
     if(notesToAdd.size()) {
         for(int i=notesToAdd.size()-1; i>=0; i--) {
             notesToAdd[i]->makeModified();
@@ -539,12 +553,20 @@ Note* Outline::getNoteByName(const std::string& noteName) const
 
 Note* Outline::getNoteByMangledName(const std::string& mangledName) const
 {
-    for(Note* n:notes) {
-        if(!n->getMangledName().compare(mangledName)) {
-            return n;
+    if(!notesNamesIndexValid) {
+        lock_guard<mutex> criticalSection{notesNamesIndexMutex};
+        if(!notesNamesIndexValid) {
+            notesNamesIndex.clear();
+            // the first N wins like in case of linear scan
+            for(Note* n:notes) {
+                notesNamesIndex.insert(make_pair(n->getMangledName(), n));
+            }
+            notesNamesIndexValid = true;
         }
     }
-    return nullptr;
+
+    auto n = notesNamesIndex.find(mangledName);
+    return n==notesNamesIndex.end()?nullptr:n->second;
 }
 
 int Outline::getNoteOffset(const Note* note) const
@@ -553,11 +575,7 @@ int Outline::getNoteOffset(const Note* note) const
         if(notes.size()==1) {
             return 0;
         } else {
-            // IMPROVE this is SLOW O(n) - consider keeping order of note within it as a field
-            auto it = std::find(notes.begin(), notes.end(), note);
-            if(it != notes.end()) {
-                return std::distance(notes.begin(), it);
-            }
+            return getNotesIndex().getOffset(note);
         }
     }
     return -1;
@@ -566,34 +584,33 @@ int Outline::getNoteOffset(const Note* note) const
 void Outline::getDirectNoteChildren(vector<Note*>& directChildren)
 {
     if(notes.size()) {
-        // child depth is initialized to a big nuber
-        //  +
-        // any non-monotonous non-growing depth is detected as direct child
-        u_int16_t minDepth = 2^15;
-        for(Note* n:notes) {
-            if(minDepth >= n->getDepth()) {
-                directChildren.push_back(n);
-                minDepth = n->getDepth();
-            }
+        NotesTreeIndex& index = getNotesIndex();
+        // Ns w/o parent are direct children of O - skip subtrees of children
+        for(size_t c=0; c<notes.size(); c+=index.getSubtreeSize(c)+1) {
+            directChildren.push_back(notes[c]);
         }
     }
 }
 
+size_t Outline::getDirectNoteChildrenCount()
+{
+    if(notes.size()) {
+        return getNotesIndex().getRootChildrenCount();
+    }
+    return 0;
+}
+
 void Outline::getDirectNoteChildren(const Note* note, std::vector<Note*>& directChildren)
 {
     if(note) {
         if(notes.size()) {
-            vector<Note*> allNoteChildren{};
-            getAllNoteChildren(note, &allNoteChildren);
-
-            // child depth is initialized to a big nuber
-            //  +
-            // any non-monotonous non-growing depth is detected as direct child
-            u_int16_t minDepth = 2^15;
-            for(Note* n:allNoteChildren) {
-                if(minDepth >= n->getDepth()) {
-                    directChildren.push_back(n);
-                    minDepth = n->getDepth();
+            NotesTreeIndex& index = getNotesIndex();
+            int offset = index.getOffset(note);
+            if(offset != NotesTreeIndex::NONE) {
+                // skip subtrees of children
+                size_t last = offset+index.getSubtreeSize(offset);
+                for(size_t c=offset+1; c<=last; c+=index.getSubtreeSize(c)+1) {
+                    directChildren.push_back(notes[c]);
                 }
             }
         }
@@ -602,45 +619,40 @@ void Outline::getDirectNoteChildren(const Note* note, std::vector<Note*>& direct
     }
 }
 
-// IMPROVE: if gap between Ns level is >1, this method doesn't work (user has freedom to make arbitrary depth)
+size_t Outline::getDirectNoteChildrenCount(const Note* note)
+{
+    if(note) {
+        if(notes.size()) {
+            NotesTreeIndex& index = getNotesIndex();
+            int offset = index.getOffset(note);
+            if(offset != NotesTreeIndex::NONE) {
+                return index.getChildrenCount(offset);
+            }
+        }
+        return 0;
+    } else {
+        return getDirectNoteChildrenCount();
+    }
+}
+
 void Outline::getAllNoteChildren(const Note* note, vector<Note*>* children, Outline::Patch* patch)
 {
     if(note) {
-        if(note == notes[notes.size()-1]) {
+        int offset = notes.size()?getNotesIndex().getOffset(note):NotesTreeIndex::NONE;
+        if(offset != NotesTreeIndex::NONE) {
+            size_t count = notesIndex.getSubtreeSize(offset);
+            if(children && count) {
+                children->insert(children->end(), notes.begin()+offset+1, notes.begin()+offset+1+count);
+            }
             if(patch) {
-                patch->start=notes.size()-1;
-                patch->count=0;
+                // patch includes N which follows the subtree (if any)
+                patch->start=offset;
+                patch->count=offset+count+1<notes.size()?count+1:count;
             }
-            return;
         } else {
-            // IMPROVE this is SLOW o(n) - consider keeping order of N within it as a field
-            auto offset = std::find(notes.begin(), notes.end(), note);
-            if(offset != notes.end()) {
-                auto index = std::distance(notes.begin(), offset);
-                for(size_t i=index+1; i<notes.size(); i++) {
-                    if(notes[i]->getDepth() > note->getDepth()) {
-                        if(children) {
-                            children->push_back(notes[i]);
-                        }
-                    } else {
-                        if(patch) {
-                            patch->start=index;
-                            patch->count=i-index;
-                        }
-                        return;
-                    }
-                }
-                if(patch) {
-                    patch->start=index;
-                    patch->count=notes.size()-1-index;
-                }
-                return;
-            } else {
-                // note not in vector
-                if(patch) {
-                    patch->start=patch->count=0;
-                }
-                return;
+            // note not in vector
+            if(patch) {
+                patch->start=patch->count=0;
             }
         }
     }
@@ -667,50 +679,35 @@ void Outline::getNotePathToRoot(const size_t offset, std::vector<int>& parents)
 
 void Outline::removeNote(Note* note, bool deallocate)
 {
+    // body is matched to Ns by order
+    loadBody();
     if(note && notes.size()) {
-        auto d = note->getDepth();
-        for(size_t i=0; i<notes.size(); i++) {
-            if(notes[i] == note) {
-                auto begin = i++;
-                while(i<notes.size() && notes[i]->getDepth()>d) {
-                    if(deallocate) {
-                        delete notes[i];
-                    }
-                    i++;
-                }
-                // because erase deletes [begin,end)
-                notes.erase(notes.begin()+begin, notes.begin()+i);
-
-                if(deallocate) {
-                    delete note;
+        int offset = getNotesIndex().getOffset(note);
+        if(offset != NotesTreeIndex::NONE) {
+            size_t end = offset+notesIndex.getSubtreeSize(offset)+1;
+            if(deallocate) {
+                for(size_t i=offset+1; i<end; i++) {
+                    delete notes[i];
                 }
+            }
+            // because erase deletes [begin,end)
+            notes.erase(notes.begin()+offset, notes.begin()+end);
+            invalidateNotesIndices();
 
-                return;
+            if(deallocate) {
+                delete note;
             }
         }
-
-        // IMPROVE this iterates ALL Ns, but I know that I need to delete just 1st one
-        notes.erase(std::remove(notes.begin(), notes.end(), note), notes.end());
     }
 }
 
 int Outline::getOffsetOfAboveNoteSibling(Note* note, int& offset)
 {
     offset = getNoteOffset(note);
-    if(offset != Outline::NO_OFFSET) {
-        if(offset) {
-            for(int o=offset-1; o>=0; o--) {
-                if(notes[o]->getDepth() == note->getDepth()) {
-                    if(offset == o) {
-                        return NO_SIBLING;
-                    } else {
-                        return o;
-                    }
-                }
-                if(notes[o]->getDepth() < note->getDepth()) {
-                    return NO_SIBLING;
-                }
-            }
+    if(offset != Outline::NO_OFFSET && offset) {
+        int sibling = getNotesIndex().getPrevSibling(offset);
+        if(sibling != NotesTreeIndex::NONE) {
+            return sibling;
         }
     }
     return NO_SIBLING;
@@ -719,25 +716,25 @@ int Outline::getOffsetOfAboveNoteSibling(Note* note, int& offset)
 int Outline::getOffsetOfBelowNoteSibling(Note* note, int& offset)
 {
     offset = getNoteOffset(note);
-    if(offset != Outline::NO_OFFSET) {
-        if(static_cast<unsigned int>(offset) < notes.size()-1) {
-            for(unsigned int o=offset+1; o<notes.size(); o++) {
-                if(notes[o]->getDepth() == note->getDepth()) {
-                    if(static_cast<unsigned int>(offset) == o) {
-                        return NO_SIBLING;
-                    } else {
-                        return o;
-                    }
-                }
-                if(notes[o]->getDepth() < note->getDepth()) {
-                    return NO_SIBLING;
-                }
-            }
+    if(offset != Outline::NO_OFFSET && static_cast<unsigned int>(offset) < notes.size()-1) {
+        int sibling = getNotesIndex().getNextSibling(offset);
+        if(sibling != NotesTreeIndex::NONE) {
+            return sibling;
         }
     }
     return NO_SIBLING;
 }
 
+void Outline::moveNoteBlock(size_t begin, size_t middle, size_t end)
+{
+    // body is matched to Ns by order
+    loadBody();
+    std::rotate(notes.begin()+begin, notes.begin()+middle, notes.begin()+end);
+    notesIndex.reindex(notes, begin, end);
+    // order of Ns w/ the same name might be changed
+    notesNamesIndexValid = false;
+}
+
 void Outline::promoteNote(Note* note, Outline::Patch* patch)
 {
     if(note) {
@@ -810,17 +807,8 @@ void Outline::moveNoteToFirst(Note* note, Outline::Patch* patch)
                 patch->start = siblingOffset;
                 patch->count = noteOffset+children.size() - siblingOffset;
             }
-            // modify outline: cut & insert
-            if(children.size()) {
-                notes.erase(notes.begin()+noteOffset, notes.begin()+noteOffset+children.size()+1);
-                for(int c=children.size()-1; c>=0; c--) {
-                    // bottom up insert
-                    notes.insert(notes.begin()+siblingOffset, children[c]);
-                }
-            } else {
-                notes.erase(notes.begin()+noteOffset);
-            }
-            notes.insert(notes.begin()+siblingOffset, note);
+            // modify outline: move N w/ children above sibling
+            moveNoteBlock(siblingOffset, noteOffset, noteOffset+children.size()+1);
             note->makeModified();
             return;
         } else {
@@ -850,17 +838,8 @@ void Outline::moveNoteUp(Note* note, Outline::Patch* patch)
                 patch->start = siblingOffset;
                 patch->count = noteOffset+children.size() - siblingOffset;
             }
-            // modify outline: cut & insert
-            if(children.size()) {
-                notes.erase(notes.begin()+noteOffset, notes.begin()+noteOffset+children.size()+1);
-                for(int c=children.size()-1; c>=0; c--) {
-                    // bottom up insert
-                    notes.insert(notes.begin()+siblingOffset, children[c]);
-                }
-            } else {
-                notes.erase(notes.begin()+noteOffset);
-            }
-            notes.insert(notes.begin()+siblingOffset, note);
+            // modify outline: move N w/ children above sibling
+            moveNoteBlock(siblingOffset, noteOffset, noteOffset+children.size()+1);
             makeModified();
             return;
         } else {
@@ -891,18 +870,10 @@ void Outline::moveNoteDown(Note* note, Outline::Patch* patch)
                 patch->start = noteOffset;
                 patch->count = siblingOffset+siblingChildren.size() - noteOffset;
             }
-            // modify outline: cut & insert (COPY moved Note below sibling, DELETE original Note)
+            // modify outline: move N w/ children below sibling's last child
             vector<Note*> children{};
             getAllNoteChildren(note, &children);
-            int belowSiblingIndex = siblingOffset+siblingChildren.size()+1;
-            notes.insert(notes.begin()+belowSiblingIndex, note);
-            if(children.size()) {
-                for(int c=children.size()-1; c>=0; c--) {
-                    // bottom up insert
-                    notes.insert(notes.begin()+belowSiblingIndex+1, children[c]);
-                }
-            }
-            notes.erase(notes.begin()+noteOffset, notes.begin()+noteOffset+children.size()+1);
+            moveNoteBlock(noteOffset, noteOffset+children.size()+1, siblingOffset+siblingChildren.size()+1);
             makeModified();
             return;
         } else {
@@ -942,18 +913,10 @@ void Outline::moveNoteToLast(Note* note, Outline::Patch* patch)
                 patch->start = noteOffset;
                 patch->count = siblingOffset+siblingChildren.size() - noteOffset;
             }
-            // modify outline: cut & insert (COPY moved Note below sibling, DELETE original Note)
+            // modify outline: move N w/ children below sibling's last child
             vector<Note*> children{};
             getAllNoteChildren(note, &children);
-            int belowSiblingIndex = siblingOffset+siblingChildren.size()+1;
-            notes.insert(notes.begin()+belowSiblingIndex, note);
-            if(children.size()) {
-                for(int c=children.size()-1; c>=0; c--) {
-                    // bottom up insert
-                    notes.insert(notes.begin()+belowSiblingIndex+1, children[c]);
-                }
-            }
-            notes.erase(notes.begin()+noteOffset, notes.begin()+noteOffset+children.size()+1);
+            moveNoteBlock(noteOffset, noteOffset+children.size()+1, siblingOffset+siblingChildren.size()+1);
             makeModified();
             return;
         } else {
@@ -971,11 +934,13 @@ void Outline::moveNoteToLast(Note* note, Outline::Patch* patch)
 
 const vector<string*>& Outline::getPreamble() const
 {
+    loadBody();
     return preamble;
 }
 
 string Outline::getPreambleAsString() const
 {
+    loadBody();
     // IMPROVE cache narrowed preamble for performance
     string result{};
     if(preamble.size()) {
@@ -990,6 +955,7 @@ string Outline::getPreambleAsString() const
 
 void Outline::addPreambleLine(string *line)
 {
+    loadBody();
     if(line) {
         preamble.push_back(line);
     }
@@ -997,16 +963,19 @@ void Outline::addPreambleLine(string *line)
 
 void Outline::setPreamble(const vector<string*>& preamble)
 {
+    loadBody();
     this->preamble = preamble;
 }
 
 const vector<string*>& Outline::getDescription() const
 {
+    loadBody();
     return description;
 }
 
 string Outline::getDescriptionAsString(const std::string& separator) const
 {
+    loadBody();
     // IMPROVE cache narrowed description for performance
     string result{};
     if(description.size()) {
@@ -1020,6 +989,7 @@ string Outline::getDescriptionAsString(const std::string& separator) const
 
 void Outline::addDescriptionLine(string *line)
 {
+    loadBody();
     if(line) {
         description.push_back(line);
     }
@@ -1027,11 +997,13 @@ void Outline::addDescriptionLine(string *line)
 
 void Outline::setDescription(const vector<string*>& description)
 {
+    loadBody();
     this->description = description;
 }
 
 void Outline::clearDescription()
 {
+    loadBody();
     this->description.clear();
 }
 
@@ -1052,17 +1024,138 @@ void Outline::setMemoryLocation(OutlineMemoryLocation memoryLocation)
 
 Note* Outline::getOutlineDescriptorAsNote()
 {
+    // descriptor is written only if O changed since its last refresh, therefore
+    // up to date descriptor can be got by concurrent readers (FTS, HTML, ...)
     outlineDescriptorAsNote->setName(name);
-    outlineDescriptorAsNote->setDescription(description);
-    outlineDescriptorAsNote->setCreated(created);
-    outlineDescriptorAsNote->setModified(modified);
-    outlineDescriptorAsNote->setRead(read);
-    outlineDescriptorAsNote->setReads(reads);
-    outlineDescriptorAsNote->setRevision(revision);
+    if(outlineDescriptorAsNote->getId() != id) {
+        outlineDescriptorAsNote->setId(id);
+    }
+    // description is shared w/o loading body
+    if(outlineDescriptorAsNote->description != description) {
+        outlineDescriptorAsNote->description = description;
+    }
+    if(outlineDescriptorAsNote->getCreated() != created) {
+        outlineDescriptorAsNote->setCreated(created);
+    }
+    if(outlineDescriptorAsNote->getModified() != modified) {
+        outlineDescriptorAsNote->setModified(modified);
+    }
+    if(outlineDescriptorAsNote->getRead() != read) {
+        outlineDescriptorAsNote->setRead(read);
+    }
+    if(outlineDescriptorAsNote->getReads() != reads) {
+        outlineDescriptorAsNote->setReads(reads);
+    }
+    if(outlineDescriptorAsNote->getRevision() != revision) {
+        outlineDescriptorAsNote->setRevision(revision);
+    }
 
     return outlineDescriptorAsNote;
 }
 
+void Outline::acquireDescription(Outline* full)
+{
+    for(string* s:preamble) {
+        TextArena::release(s, textArena.get());
+    }
+    preamble = full->preamble;
+    full->preamble.clear();
+
+    for(string* s:description) {
+        TextArena::release(s, textArena.get());
+    }
+    // lines are kept in the arena of the full O
+    textArena = full->textArena;
+    description = full->description;
+    full->description.clear();
+    outlineDescriptorAsNote->description = description;
+    full->outlineDescriptorAsNote->description.clear();
+}
+
+bool Outline::acquireBody(Outline* full)
+{
+    acquireDescription(full);
+
+    // Ns are matched by order - file might have been modified since headers were learned
+    bool matching = notes.size() == full->notes.size();
+    size_t f = 0;
+    for(Note* n:notes) {
+        for(string* s:n->description) {
+            TextArena::release(s, n->textArena.get());
+        }
+        n->description.clear();
+
+        size_t i = f;
+        while(i<full->notes.size()
+                &&
+              (n->getName() != full->notes[i]->getName() || n->getDepth() != full->notes[i]->getDepth()))
+        {
+            i++;
+        }
+        if(i<full->notes.size()) {
+            if(i != f) {
+                matching = false;
+            }
+            n->description = full->notes[i]->description;
+            n->textArena = full->notes[i]->textArena;
+            full->notes[i]->description.clear();
+            f = i+1;
+        } else {
+            matching = false;
+            n->textArena.reset();
+        }
+    }
+    if(!matching) {
+        MF_DEBUG("Outline body of '" << key << "' doesn't match headers (" << full->notes.size() << " Ns instead of " << notes.size() << ")" << endl);
+    }
+
+    bodyLoaded = true;
+    return matching;
+}
+
+void Outline::replaceNotes(Outline* full, vector<Note*>& replaced)
+{
+    acquireDescription(full);
+
+    replaced.insert(replaced.end(), notes.begin(), notes.end());
+    notes = full->notes;
+    full->notes.clear();
+    for(Note* n:notes) {
+        n->setOutline(this);
+    }
+    invalidateNotesIndices();
+
+    bodyLoaded = true;
+}
+
+bool Outline::evictBody()
+{
+    if(bodyLoader && bodyLoaded && !dirty) {
+        bodyLoaded = false;
+
+        for(string* s:preamble) {
+            TextArena::release(s, textArena.get());
+        }
+        preamble.clear();
+        for(string* s:description) {
+            TextArena::release(s, textArena.get());
+        }
+        description.clear();
+        outlineDescriptorAsNote->description.clear();
+        for(Note* n:notes) {
+            for(string* s:n->description) {
+                TextArena::release(s, n->textArena.get());
+            }
+            n->description.clear();
+            n->textArena.reset();
+        }
+        // arena lines are freed at once
+        textArena.reset();
+        return true;
+    }
+    return false;
+}
+
 void Outline::addLink(Link* link)
 {
     if(link) {
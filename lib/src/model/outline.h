@@ -19,12 +19,18 @@
 #ifndef M8R_OUTLINE_H_
 #define M8R_OUTLINE_H_
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
+#include "../gear/text_arena.h"
 #include "../mind/ontology/thing_class_rel_triple.h"
 #include "note.h"
 #include "outline_type.h"
+#include "notes_tree_index.h"
 #include "../representations/markdown/markdown_document.h"
 #include "../gear/datetime_utils.h"
 
@@ -33,6 +39,18 @@
 namespace m8r {
 
 class Note;
+class Outline;
+
+/**
+ * @brief Loader of O body (preamble and descriptions of O and its Ns) for Os learned w/o it.
+ */
+class OutlineBodyLoader
+{
+public:
+    virtual ~OutlineBodyLoader() {}
+
+    virtual void loadBody(Outline* outline) = 0;
+};
 
 enum class OutlineMemoryLocation {
     NORMAL,
@@ -68,6 +86,11 @@ private:
      */
     static const NoteType NOTE_4_OUTLINE_TYPE;
 
+    /**
+     * @brief Incremented on any O rename so that indices of Os by name can detect change.
+     */
+    static std::atomic<unsigned long> namesRevision;
+
 public:
     struct Patch;
 
@@ -91,10 +114,11 @@ private:
     std::vector<Link*> links;
     const OutlineType* type;
     std::vector<std::string*> description;
+    // arena of parsed preamble and description lines of O and its Ns
+    std::shared_ptr<TextArena> textArena;
 
     time_t created;
     time_t modified;
-    std::string modifiedPretty;
     u_int32_t revision;
     time_t read;
     u_int32_t reads;
@@ -103,8 +127,13 @@ private:
     int8_t urgency;
     int8_t progress;
 
-    // IMPROVE introduce own data structure: tree of ordered notes w/ offset i.e. heap
+    // Ns ordered depth first - tree structure is kept by notes index
     std::vector<Note*> notes;
+    mutable NotesTreeIndex notesIndex;
+    // mangled N name to the first N w/ such name - built on demand
+    mutable std::atomic<bool> notesNamesIndexValid;
+    mutable std::mutex notesNamesIndexMutex;
+    mutable std::unordered_map<std::string,Note*> notesNamesIndex;
 
     Note* outlineDescriptorAsNote;
 
@@ -113,6 +142,12 @@ private:
      */
     unsigned int bytesize;
 
+    /**
+     * @brief Loader of O learned w/ headers only - body is loaded on the first access.
+     */
+    OutlineBodyLoader* bodyLoader;
+    std::atomic<bool> bodyLoaded;
+
     /*
      * Transient fields
      */
@@ -162,6 +197,8 @@ public:
 
     const std::string& getKey() const;
     void setKey(const std::string key);
+    virtual void setName(const std::string& name) override;
+    static unsigned long getNamesRevision() { return namesRevision; }
     MarkdownDocument::Format getFormat() const { return format; }
     void setFormat(MarkdownDocument::Format format) { this->format = format; }
     const std::vector<std::string*>& getPreamble() const;
@@ -173,6 +210,11 @@ public:
     void addDescriptionLine(std::string *);
     void setDescription(const std::vector<std::string*>& description);
     void clearDescription();
+    /**
+     * @brief Arena of parsed lines of O and its Ns (may be nullptr).
+     */
+    const std::shared_ptr<TextArena>& getTextArena() const { return textArena; }
+    void setTextArena(const std::shared_ptr<TextArena>& textArena) { this->textArena = textArena; }
     time_t getCreated() const;
     void setCreated(time_t created);
     int8_t getImportance() const;
@@ -194,9 +236,10 @@ public:
     void makeModified();
     void setModified();
     void setModified(time_t modified);
-    const std::string& getModifiedPretty() const;
-    void setModifiedPretty();
-    void setModifiedPretty(const std::string& modifiedPretty);
+    /**
+     * @brief Pretty modified timestamp - created on demand (pretty dates are memoized per day).
+     */
+    std::string getModifiedPretty() const;
     int8_t getProgress() const;
     void setProgress(int8_t progress);
     u_int32_t getRevision() const;
@@ -255,8 +298,7 @@ public:
      * are returned regardless how big depth GAP is between O and N.
      */
     void getDirectNoteChildren(std::vector<Note*>& children);
-    // IMPROVE cache w/ dirty flag
-    size_t getDirectNoteChildrenCount() { std::vector<Note*> c{}; getDirectNoteChildren(c); return c.size(); }
+    size_t getDirectNoteChildrenCount();
     /**
      * @brief Get direct Ns children.
      *
@@ -264,7 +306,7 @@ public:
      * the gap in depth is.
      */
     void getDirectNoteChildren(const Note* note, std::vector<Note*>& children);
-    size_t getDirectNoteChildrenCount(const Note* note) { std::vector<Note*> c{}; getDirectNoteChildren(note, c); return c.size(); }
+    size_t getDirectNoteChildrenCount(const Note* note);
 
     void getAllNoteChildren(const Note* note, std::vector<Note*>* children=nullptr, Outline::Patch* patch=nullptr);
     /**
@@ -287,6 +329,15 @@ public:
     void moveNoteDown(Note* note, Outline::Patch* patch=nullptr);
     void moveNoteToLast(Note* note, Outline::Patch* patch=nullptr);
 
+    /**
+     * @brief Invalidate notes index - must be called when N depth is changed.
+     */
+    void invalidateNotesIndex() { notesIndex.invalidate(); }
+    /**
+     * @brief Invalidate index of Ns by name - must be called when N name or Ns vector is changed.
+     */
+    void invalidateNotesNamesIndex() { notesNamesIndexValid = false; }
+
     Note* getOutlineDescriptorAsNote();
     const NoteType* getOutlineDescriptorNoteType() const { return &NOTE_4_OUTLINE_TYPE; }
 
@@ -294,6 +345,52 @@ public:
     void makeDirty() { dirty = true; }
     void clearDirty() { dirty = false; }
 
+    /*
+     * Lazy body
+     */
+
+    /**
+     * @brief Set loader of body i.e. O was learned w/ headers only (nullptr for O w/ body).
+     */
+    void setBodyLoader(OutlineBodyLoader* loader) {
+        bodyLoader = loader;
+        bodyLoaded = loader==nullptr;
+    }
+    bool isBodyLoaded() const { return bodyLoaded; }
+    /**
+     * @brief Load body if O was learned w/ headers only and body is not loaded (yet).
+     */
+    void loadBody() const {
+        if(!bodyLoaded && bodyLoader) {
+            bodyLoader->loadBody(const_cast<Outline*>(this));
+        }
+    }
+    /**
+     * @brief Take body from fully parsed copy of this O.
+     *
+     * Body is loaded on access to (any) N, therefore Ns are never replaced here
+     * as the caller might iterate them. Descriptions are taken by Ns which match
+     * Ns of full O (name and depth, in order), Ns which are not in the file
+     * (anymore) stay w/o description.
+     *
+     * @return all Ns were matched i.e. O doesn't have to be relearned using replaceNotes().
+     */
+    bool acquireBody(Outline* full);
+    /**
+     * @brief Replace body and Ns by body and Ns of fully parsed copy of this O.
+     *
+     * Call it only when nobody iterates Ns of this O.
+     *
+     * @param replaced  replaced Ns - caller owns them.
+     */
+    void replaceNotes(Outline* full, std::vector<Note*>& replaced);
+    /**
+     * @brief Drop body of O learned w/ headers only - it's loaded again on the next access.
+     *
+     * @return body was dropped.
+     */
+    bool evictBody();
+
     /*
      * Links
      */
@@ -323,6 +420,32 @@ public:
 private:
     void removeNote(Note* note, bool dealocate);
 
+    /**
+     * @brief Get notes index (built if needed).
+     */
+    NotesTreeIndex& getNotesIndex() const {
+        notesIndex.ensure(notes);
+        return notesIndex;
+    }
+
+    /**
+     * @brief Rotate range of sibling subtrees so that N at middle offset becomes first.
+     */
+    void moveNoteBlock(size_t begin, size_t middle, size_t end);
+
+    /**
+     * @brief Take preamble and description of fully parsed copy of this O.
+     */
+    void acquireDescription(Outline* full);
+
+    /**
+     * @brief Invalidate both tree and names index - to be called on any change of Ns vector.
+     */
+    void invalidateNotesIndices() {
+        notesIndex.invalidate();
+        notesNamesIndexValid = false;
+    }
+
     /**
      * @brief Returns offset of the first sibling above on the same level.
      *
@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
 */
 #include "filesystem_persistence.h"
+#include "../gear/tracer.h"
 
 #include <sys/stat.h>
 
@@ -68,11 +69,13 @@ string FilesystemPersistence::createFileName(
 
 void FilesystemPersistence::save(Outline* outline)
 {
+    MF_TRACE_SPAN("persistence", "save");
     string* text = mdRepresentation.to(outline);
     if(text!=nullptr) {
         std::ofstream out(outline->getKey());
         out << *text;
         out.close();
+        MF_TRACE_COUNTER("persistence", "bytes written", static_cast<int64_t>(text->size()));
         delete text;
 
         outline->clearDirty();
@@ -18,6 +18,8 @@
  */
 #include "repository_indexer.h"
 
+#include <algorithm>
+
 using namespace std;
 
 namespace m8r {
@@ -34,13 +36,10 @@ void RepositoryIndexer::clear()
 {
     repository = nullptr;
 
-    for(const string* f:allFiles) {
-        delete f;
-    }
+    // paths are owned by files
     allFiles.clear();
-
-    // markdowns strings were cleared as a part of allFiles strings
     markdowns.clear();
+    files.clear();
 
     for(const string* s:outlineStencils) {
         delete s;
@@ -134,52 +133,37 @@ bool RepositoryIndexer::fileHasMarkdownExtension(const std::string& filename)
 
 void RepositoryIndexer::updateIndexMemory(const string& directory)
 {
+    allFiles.clear();
+    markdowns.clear();
+    files.clear();
+
     if(repository->getMode() == Repository::RepositoryMode::REPOSITORY) {
         MF_DEBUG(endl << "INDEXING memory DIR: " << directory);
-        DIR *dir;
-        if((dir = opendir(directory.c_str()))) {
-            const struct dirent *entry;
-            if((entry = readdir(dir))) {
-                string path;
-                string *ppath;
-                do {
-                    if(entry->d_type == DT_DIR) {
-                        if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) {
-                            continue;
-                        }
-                        //MF_DEBUG(endl << "DIVE> " << directory.c_str() << "//" << entry->d_name);
-                        path.assign(directory);
-                        path += FILE_PATH_SEPARATOR;
-                        path += entry->d_name;
-
-                        updateIndexMemory(path);
-                    } else {
-                        MF_DEBUG(endl << "  FILE: " << directory.c_str() << "//" << entry->d_name);
-                        ppath = new string{directory};
-                        ppath->append(FILE_PATH_SEPARATOR);
-                        ppath->append(entry->d_name);
-
-                        allFiles.insert(ppath);
-                        if(fileHasMarkdownExtension(*ppath)) {
-                            markdowns.insert(ppath);
-                        }
-                    }
-                } while ((entry = readdir(dir)) != 0);
-                closedir(dir);
-            }
-        }
+        DirectoryScanner scanner{};
+        scanner.scan(directory, files);
     } else {
         MF_DEBUG(endl << "INDEXING memory single FILE: " << repository->getFile() << " in " << repository->getDir());
         if(repository->getFile().size()) {
-            string* path = new string{repository->getDir()};
-            path->append(FILE_PATH_SEPARATOR);
-            path->append(repository->getFile());
-            allFiles.insert(path);
-            if(fileHasMarkdownExtension(*path)) {
-                markdowns.insert(path);
+            ScannedFile file{repository->getDir(), 0, 0};
+            file.path.append(FILE_PATH_SEPARATOR);
+            file.path.append(repository->getFile());
+            struct stat status;
+            if(!stat(file.path.c_str(), &status)) {
+                file.size = status.st_size;
+                file.modified = status.st_mtime;
             }
+            files.push_back(file);
         }
     }
+
+    // files are not modified until the next indexing ~ paths can be shared
+    for(const ScannedFile& file:files) {
+        allFiles.insert(allFiles.end(), &file.path);
+        if(fileHasMarkdownExtension(file.path)) {
+            markdowns.insert(markdowns.end(), &file.path);
+        }
+    }
+    MF_DEBUG(endl << "  " << files.size() << " files / " << markdowns.size() << " Markdowns");
 }
 
 void RepositoryIndexer::updateIndexStencils(const string& directory, set<const std::string*>& stencils)
@@ -206,24 +190,43 @@ void RepositoryIndexer::updateIndexStencils(const string& directory, set<const s
     }
 }
 
-const set<const string*> RepositoryIndexer::getMarkdownFiles() const {
+const set<const string*>& RepositoryIndexer::getMarkdownFiles() const {
     return markdowns;
 }
 
-const set<const string*> RepositoryIndexer::getAllOutlineFileNames() const {
+const set<const string*>& RepositoryIndexer::getAllOutlineFileNames() const {
     return allFiles;
 }
 
-const set<const std::string*> RepositoryIndexer::getOutlineStencilsFileNames() const
+const set<const std::string*>& RepositoryIndexer::getOutlineStencilsFileNames() const
 {
     return outlineStencils;
 }
 
-const set<const std::string*> RepositoryIndexer::getNoteStencilsFileNames() const
+const set<const std::string*>& RepositoryIndexer::getNoteStencilsFileNames() const
 {
     return noteStencils;
 }
 
+void RepositoryIndexer::getMarkdownFilesBySize(vector<const string*>& markdownFiles) const
+{
+    vector<const ScannedFile*> bySize{};
+    for(const ScannedFile& file:files) {
+        if(markdowns.count(&file.path)) {
+            bySize.push_back(&file);
+        }
+    }
+    std::stable_sort(
+        bySize.begin(),
+        bySize.end(),
+        [](const ScannedFile* f1, const ScannedFile* f2) { return f1->size > f2->size; });
+
+    markdownFiles.clear();
+    for(const ScannedFile* file:bySize) {
+        markdownFiles.push_back(&file->path);
+    }
+}
+
 char* RepositoryIndexer::getTagsFromPath() {
     return nullptr;
 }
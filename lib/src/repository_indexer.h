@@ -30,9 +30,11 @@
 #include <cstdlib>
 
 #include <iostream>
+#include <set>
 #include <vector>
 
 #include "debug.h"
+#include "gear/directory_scanner.h"
 #include "gear/file_utils.h"
 #include "gear/string_utils.h"
 #include "config/configuration.h"
@@ -81,6 +83,10 @@ private:
     std::string outlineStencilsDirectory;
     std::string noteStencilsDirectory;
 
+    // memory files sorted by path w/ size and modification time
+    std::vector<ScannedFile> files;
+
+    // paths of files (owned by files) - set order is files order
     std::set<const std::string*> allFiles;
     std::set<const std::string*> markdowns;
     std::set<const std::string*> outlineStencils;
@@ -111,10 +117,18 @@ public:
 
     Repository* getRepository() const { return repository; }
 
-    const std::set<const std::string*> getMarkdownFiles() const;
-    const std::set<const std::string*> getAllOutlineFileNames() const;
-    const std::set<const std::string*> getOutlineStencilsFileNames() const;
-    const std::set<const std::string*> getNoteStencilsFileNames() const;
+    const std::set<const std::string*>& getMarkdownFiles() const;
+    const std::set<const std::string*>& getAllOutlineFileNames() const;
+    const std::set<const std::string*>& getOutlineStencilsFileNames() const;
+    const std::set<const std::string*>& getNoteStencilsFileNames() const;
+
+    /**
+     * @brief Get Markdown files ordered by size - the biggest first.
+     *
+     * Parsing the biggest files first balances parallel parsing (workers don't wait
+     * for one long file at the end).
+     */
+    void getMarkdownFilesBySize(std::vector<const std::string*>& markdownFiles) const;
     char* getTagsFromPath();
 
 private:
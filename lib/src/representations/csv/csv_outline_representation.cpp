@@ -18,12 +18,26 @@
 */
 #include "csv_outline_representation.h"
 
+#include <atomic>
+#include <thread>
+
 namespace m8r {
 
 using namespace std;
 
-CsvOutlineRepresentation::CsvOutlineRepresentation()
+constexpr size_t CsvOutlineRepresentation::CHUNK_SIZE;
+constexpr size_t CsvOutlineRepresentation::CHUNKS_PER_THREAD;
+constexpr char CsvOutlineRepresentation::MULTI_VALUE_SEPARATOR;
+
+CsvOutlineRepresentation::CsvOutlineRepresentation(unsigned threads)
+    : threads{threads}
 {
+    if(!this->threads) {
+        this->threads = thread::hardware_concurrency();
+        if(!this->threads) {
+            this->threads = 1;
+        }
+    }
 }
 
 CsvOutlineRepresentation::~CsvOutlineRepresentation()
@@ -36,7 +50,7 @@ CsvOutlineRepresentation::~CsvOutlineRepresentation()
  * O is serialized as N descriptor, only shared fields are serialized to avoid sparse
  * lines
  */
-void CsvOutlineRepresentation::to(const vector<Outline*>& os, const m8r::File& sourceFile)
+void CsvOutlineRepresentation::to(const vector<Outline*>& os, const m8r::File& sourceFile, const BagOfWords* bow)
 {
     MF_DEBUG("Exporting MIND to CSV " << sourceFile.getName() << endl);
 
@@ -46,9 +60,44 @@ void CsvOutlineRepresentation::to(const vector<Outline*>& os, const m8r::File& s
             try {
                 out.open(sourceFile.getName());
 
-                toHeader(out);
-                for(Outline* o:os) {
-                    to(o, out);
+                string csv{};
+                toHeader(csv, bow!=nullptr);
+                out << csv;
+
+                // window of chunks: encode in parallel, write in order
+                const size_t chunks = (os.size()+CHUNK_SIZE-1) / CHUNK_SIZE;
+                const size_t window = threads*CHUNKS_PER_THREAD;
+                vector<string> encoded(std::min(chunks, window));
+                for(size_t windowBegin=0; windowBegin<chunks; windowBegin+=window) {
+                    const size_t windowEnd = std::min(chunks, windowBegin+window);
+                    atomic<size_t> next{windowBegin};
+                    auto worker = [&]() {
+                        size_t c;
+                        while((c = next++) < windowEnd) {
+                            string& chunk = encoded[c-windowBegin];
+                            chunk.clear();
+                            for(size_t o=c*CHUNK_SIZE; o<std::min(os.size(), (c+1)*CHUNK_SIZE); o++) {
+                                to(os[o], chunk, bow);
+                            }
+                        }
+                    };
+
+                    const size_t workersCount = std::min<size_t>(threads, windowEnd-windowBegin);
+                    if(workersCount <= 1) {
+                        worker();
+                    } else {
+                        vector<thread> workers{};
+                        for(size_t t=0; t<workersCount; t++) {
+                            workers.push_back(thread{worker});
+                        }
+                        for(thread& t:workers) {
+                            t.join();
+                        }
+                    }
+
+                    for(size_t c=windowBegin; c<windowEnd; c++) {
+                        out.write(encoded[c-windowBegin].data(), encoded[c-windowBegin].size());
+                    }
                 }
             } catch (const std::ofstream::failure& e) {
                 cerr << "Error: unable to open/write file " << sourceFile.getName() << " " << e.what();
@@ -61,75 +110,147 @@ void CsvOutlineRepresentation::to(const vector<Outline*>& os, const m8r::File& s
     }
 }
 
-void CsvOutlineRepresentation::toHeader(std::ofstream& out)
+void CsvOutlineRepresentation::toHeader(string& csv, bool withBow)
 {
     // O/N CSV line
-    // id,     type, title, offset, depth, reads, writes, created, modified, read, description
-    // string, o/n,  int,   int,    int,   int,   int,    long,    long,     long, string
+    // id,     type, title, offset, depth, reads, writes, created, modified, read, description, tags,       links,      bow
+    // string, o/n,  int,   int,    int,   int,   int,    long,    long,     long, string,      tag|tag..., url|url..., word:frequency|...
 
-    // TODO tags|tags
-    out << "id,type,title,offset,depth,reads,writes,created,modified,read,description\n";
+    csv += "id,type,title,offset,depth,reads,writes,created,modified,read,description,tags,links";
+    if(withBow) {
+        csv += ",bow";
+    }
+    csv += "\n";
 }
 
-void CsvOutlineRepresentation::to(const Outline* o, ofstream& out)
+void CsvOutlineRepresentation::to(const Outline* o, string& csv, const BagOfWords* bow)
 {
-    string s{};
-
     MF_DEBUG("  " << o->getName() << endl);
 
     // O
-    out << o->getKey() << ",";
-    out << "o,";
-    s.clear(); quoteValue(o->getName(), s);
-    out << s << ",";
+    quoteValue(o->getKey(), csv);
+    csv += ",o,";
+    quoteValue(o->getName(), csv);
     // O's offset and depth == 0
-    out << "0,";
-    out << "0,";
-    out << o->getReads() << ",";
-    out << o->getRevision() << ",";
-    out << o->getCreated() << ",";
-    out << o->getModified() << ",";
-    out << o->getRead() << ",";
-    s.clear(); quoteValue(o->getDescriptionAsString(" "), s);
-    out << s;
-    out << "\n";
+    csv += ",0,0,";
+    csv += std::to_string(o->getReads());
+    csv += ",";
+    csv += std::to_string(o->getRevision());
+    csv += ",";
+    csv += std::to_string(o->getCreated());
+    csv += ",";
+    csv += std::to_string(o->getModified());
+    csv += ",";
+    csv += std::to_string(o->getRead());
+    csv += ",";
+    quoteValue(o->getDescriptionAsString(" "), csv);
+    csv += ",";
+    toTags(o->getTags(), csv);
+    csv += ",";
+    toLinks(o->getLinks(), csv);
+    if(bow) {
+        // BoW is built for Ns only
+        csv += ",";
+    }
+    csv += "\n";
 
     // Ns
     const vector<Note*>& ns = o->getNotes();
     int offset = 1;
     for(Note* n:ns) {
-        out << n->getKey() << ",";
-        out << "n,";
-        s.clear(); quoteValue(n->getName(), s);
-        out << s << ",";
         // N's offset: <1,inf>
-        out << offset++ << ",";
-        // N's depth: <1,inf>
-        out << (n->getDepth()+1) << ",";
-        out << n->getReads() << ",";
-        out << n->getRevision() << ",";
-        out << n->getCreated() << ",";
-        out << n->getModified() << ",";
-        out << n->getRead() << ",";
-        s.clear(); quoteValue(n->getDescriptionAsString(" "), s);
-        out << s;
-        out << "\n";
+        toRow(n, offset++, csv, bow);
     }
 }
 
-void CsvOutlineRepresentation::quoteValue(const std::string& is, std::string& os)
+void CsvOutlineRepresentation::toRow(Note* n, int offset, string& csv, const BagOfWords* bow)
 {
-    if(is.size()) {
-        os.append(" ");
-        os.append(is);
+    quoteValue(n->getKey(), csv);
+    csv += ",n,";
+    quoteValue(n->getName(), csv);
+    csv += ",";
+    csv += std::to_string(offset);
+    csv += ",";
+    // N's depth: <1,inf>
+    csv += std::to_string(n->getDepth()+1);
+    csv += ",";
+    csv += std::to_string(n->getReads());
+    csv += ",";
+    csv += std::to_string(n->getRevision());
+    csv += ",";
+    csv += std::to_string(n->getCreated());
+    csv += ",";
+    csv += std::to_string(n->getModified());
+    csv += ",";
+    csv += std::to_string(n->getRead());
+    csv += ",";
+    quoteValue(n->getDescriptionAsString(" "), csv);
+    csv += ",";
+    toTags(n->getTags(), csv);
+    csv += ",";
+    toLinks(n->getLinks(), csv);
+    if(bow) {
+        csv += ",";
+        toTermVector(bow->find(n), csv);
+    }
+    csv += "\n";
+}
+
+void CsvOutlineRepresentation::toTags(const vector<const Tag*>* tags, string& csv)
+{
+    string value{};
+    if(tags) {
+        for(const Tag* t:*tags) {
+            if(value.size()) {
+                value += MULTI_VALUE_SEPARATOR;
+            }
+            value += t->getName();
+        }
+    }
+    quoteValue(value, csv);
+}
 
-        //os.append(is);
-        while(os.find("\"") != std::string::npos) {
-          os.replace(os.find("\""),1,"\"\"");
+void CsvOutlineRepresentation::toLinks(const vector<Link*>& links, string& csv)
+{
+    string value{};
+    for(Link* l:links) {
+        if(value.size()) {
+            value += MULTI_VALUE_SEPARATOR;
         }
+        value += l->getUrl();
+    }
+    quoteValue(value, csv);
+}
 
-        os[0] = '\"';
-        os.append("\"");
+void CsvOutlineRepresentation::toTermVector(const WordFrequencyList* wfl, string& csv)
+{
+    string value{};
+    if(wfl) {
+        for(auto& w:wfl->iterable()) {
+            if(value.size()) {
+                value += MULTI_VALUE_SEPARATOR;
+            }
+            value += *w.first;
+            value += ':';
+            value += std::to_string(w.second);
+        }
+    }
+    quoteValue(value, csv);
+}
+
+void CsvOutlineRepresentation::quoteValue(const std::string& is, std::string& os)
+{
+    if(is.size()) {
+        os.reserve(os.size() + is.size() + 2);
+        os += '\"';
+        for(const char c:is) {
+            if(c == '\"') {
+                os += "\"\"";
+            } else {
+                os += c;
+            }
+        }
+        os += '\"';
     }
 }
 
@@ -20,10 +20,12 @@
 #define M8R_CSV_OUTLINE_REPRESENTATION_H
 
 #include <iostream>
+#include <string>
 #include <vector>
 
 #include "../../model/outline.h"
 #include "../../gear/file_utils.h"
+#include "../../mind/ai/nlp/bag_of_words.h"
 
 namespace m8r {
 
@@ -33,25 +35,56 @@ namespace m8r {
  * CSV format is therefore designed to make loading of CSVs as datasets to ML frameworks.
  * No library is used to make things simple - also parsing is not needed, just serialization.
  *
+ * Os are encoded to CSV in chunks by worker threads, chunks are written
+ * in the original order as soon as the window of chunks being encoded
+ * is finished ~ memory used by the export is bounded.
+ *
  * Spec: https://tools.ietf.org/html/rfc4180
  */
 class CsvOutlineRepresentation
 {
 public:
-    explicit CsvOutlineRepresentation();
+    // Os encoded by a worker at once
+    static constexpr size_t CHUNK_SIZE = 16;
+    // chunks encoded in parallel before they are written
+    static constexpr size_t CHUNKS_PER_THREAD = 4;
+
+    static constexpr char MULTI_VALUE_SEPARATOR = '|';
+
+private:
+    unsigned threads;
+
+public:
+    /**
+     * @param threads   number of worker threads, 0 to use all cores.
+     */
+    explicit CsvOutlineRepresentation(unsigned threads=0);
     CsvOutlineRepresentation(const CsvOutlineRepresentation&) = delete;
     CsvOutlineRepresentation(const CsvOutlineRepresentation&&) = delete;
     CsvOutlineRepresentation &operator=(const CsvOutlineRepresentation&) = delete;
     CsvOutlineRepresentation &operator=(const CsvOutlineRepresentation&&) = delete;
     virtual ~CsvOutlineRepresentation();
 
-    void to(const std::vector<Outline*>&, const m8r::File& sourceFile);
+    /**
+     * @brief Export Os to CSV file.
+     *
+     * @param bow   if BoW is given, then N term vectors are exported as well.
+     */
+    void to(const std::vector<Outline*>& os, const m8r::File& sourceFile, const BagOfWords* bow=nullptr);
 
-    void toHeader(std::ofstream& out);
-    void to(const Outline* o, std::ofstream& out);
-private:
-    void quoteValue(const std::string& is, std::string& os);
+    void toHeader(std::string& csv, bool withBow=false);
+    void to(const Outline* o, std::string& csv, const BagOfWords* bow=nullptr);
 
+    /**
+     * @brief Quote and escape value in a single pass.
+     */
+    static void quoteValue(const std::string& is, std::string& os);
+
+private:
+    void toRow(Note* n, int offset, std::string& csv, const BagOfWords* bow);
+    void toTags(const std::vector<const Tag*>* tags, std::string& csv);
+    void toLinks(const std::vector<Link*>& links, std::string& csv);
+    void toTermVector(const WordFrequencyList* wfl, std::string& csv);
 };
 
 }
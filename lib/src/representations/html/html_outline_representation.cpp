@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "html_outline_representation.h"
+#include "../../gear/tracer.h"
 
 namespace m8r {
 
@@ -261,6 +262,7 @@ void HtmlOutlineRepresentation::footer(string& html)
 
 string* HtmlOutlineRepresentation::to(const string* markdown, string* html, string* basePath, bool standalone, int yScrollTo)
 {
+    MF_TRACE_SPAN("html", "render");
     if(!config.isUiHtmlTheme()) {
         header(*html, basePath, standalone, yScrollTo);
         html->append(*markdown);
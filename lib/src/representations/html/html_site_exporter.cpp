@@ -0,0 +1,482 @@
+/*
+ html_site_exporter.cpp     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "html_site_exporter.h"
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+
+#include "html_outline_representation.h"
+#include "../markdown/markdown_outline_representation.h"
+#ifdef MF_MD_2_HTML_CMARK
+  #include "../markdown/cmark_gfm_markdown_transcoder.h"
+#endif
+#include "../../gear/file_utils.h"
+#include "../../gear/string_utils.h"
+
+namespace m8r {
+
+using namespace std;
+
+constexpr unsigned HtmlSiteExporter::MIN_OUTLINES_PER_THREAD;
+constexpr const char* HtmlSiteExporter::INDEX_FILENAME;
+
+/**
+ * @brief Split path to components while resolving . and .. components.
+ */
+static vector<string> pathToComponents(const string& path)
+{
+    vector<string> components{};
+    size_t begin = 0;
+    while(begin <= path.size()) {
+        size_t end = path.find(FILE_PATH_SEPARATOR_CHAR, begin);
+        if(end == string::npos) {
+            end = path.size();
+        }
+        string component = path.substr(begin, end-begin);
+        if(component == "..") {
+            if(components.size()) {
+                components.pop_back();
+            }
+        } else if(component.size() && component != ".") {
+            components.push_back(component);
+        }
+        begin = end+1;
+    }
+    return components;
+}
+
+static string componentsToPath(const vector<string>& components, size_t begin=0)
+{
+    string path{};
+    for(size_t i=begin; i<components.size(); i++) {
+        if(i>begin) {
+            path += FILE_PATH_SEPARATOR_CHAR;
+        }
+        path += components[i];
+    }
+    return path;
+}
+
+/**
+ * @brief Relative path from the directory of one site path to another site path.
+ */
+static string relativeSitePath(const string& fromSitePath, const string& toSitePath)
+{
+    vector<string> from = pathToComponents(fromSitePath);
+    vector<string> to = pathToComponents(toSitePath);
+    if(from.size()) {
+        // file name
+        from.pop_back();
+    }
+
+    size_t common = 0;
+    while(common < from.size() && common+1 < to.size() && from[common] == to[common]) {
+        common++;
+    }
+
+    string path{};
+    for(size_t i=common; i<from.size(); i++) {
+        path += "..";
+        path += FILE_PATH_SEPARATOR_CHAR;
+    }
+    path += componentsToPath(to, common);
+    return path;
+}
+
+HtmlSiteExporter::HtmlSiteExporter(Ontology& ontology, unsigned threads)
+    : ontology(ontology),
+      threads{threads},
+      manifest{}
+{
+    if(!this->threads) {
+        this->threads = thread::hardware_concurrency();
+        if(!this->threads) {
+            this->threads = 1;
+        }
+    }
+}
+
+HtmlSiteExporter::~HtmlSiteExporter()
+{
+}
+
+string HtmlSiteExporter::toSitePath(const string& outlineKey, const string& memoryPath, bool keepExtension)
+{
+    string sitePath{};
+    if(memoryPath.size() && outlineKey.size() > memoryPath.size() && !outlineKey.compare(0, memoryPath.size(), memoryPath)) {
+        sitePath = outlineKey.substr(memoryPath.size());
+    } else {
+        string directory{};
+        pathToDirectoryAndFile(outlineKey, directory, sitePath);
+    }
+    sitePath = componentsToPath(pathToComponents(sitePath));
+
+    if(!keepExtension) {
+        size_t dot = sitePath.find_last_of('.');
+        size_t separator = sitePath.find_last_of(FILE_PATH_SEPARATOR_CHAR);
+        if(dot != string::npos && (separator == string::npos || dot > separator)) {
+            sitePath.erase(dot);
+        }
+    }
+    sitePath += FILE_EXTENSION_HTML;
+    return sitePath;
+}
+
+void HtmlSiteExporter::rewriteLinks(
+        string& markdown,
+        const string& outlineKey,
+        const string& sitePath,
+        const map<string,string>& sitePaths)
+{
+    string directory{}, file{};
+    pathToDirectoryAndFile(outlineKey, directory, file);
+
+    size_t offset = 0;
+    while((offset = markdown.find("](", offset)) != string::npos) {
+        offset += 2;
+        size_t end = markdown.find_first_of(") \n", offset);
+        if(end == string::npos) {
+            break;
+        }
+        if(end == offset) {
+            continue;
+        }
+
+        string target = markdown.substr(offset, end-offset);
+        if(target[0] == '#' || target.find("://") != string::npos || !target.compare(0, 7, "mailto:")) {
+            offset = end;
+            continue;
+        }
+
+        string anchor{};
+        size_t hash = target.find('#');
+        if(hash != string::npos) {
+            anchor = target.substr(hash);
+            target.erase(hash);
+        }
+
+        string resolved{};
+        if(target[0] != FILE_PATH_SEPARATOR_CHAR) {
+            resolved = directory + FILE_PATH_SEPARATOR + target;
+        } else {
+            resolved = target;
+        }
+        resolved = FILE_PATH_SEPARATOR + componentsToPath(pathToComponents(resolved));
+
+        auto s = sitePaths.find(resolved);
+        if(s != sitePaths.end()) {
+            string link = relativeSitePath(sitePath, s->second) + anchor;
+            markdown.replace(offset, end-offset, link);
+            end = offset + link.size();
+        }
+        offset = end;
+    }
+}
+
+string HtmlSiteExporter::hash(const string& text)
+{
+    u_int64_t h = 14695981039346656037ULL;
+    for(const char c:text) {
+        h ^= static_cast<unsigned char>(c);
+        h *= 1099511628211ULL;
+    }
+
+    static const char* HEX = "0123456789abcdef";
+    string result(16, '0');
+    for(int i=15; i>=0; i--) {
+        result[i] = HEX[h & 0xF];
+        h >>= 4;
+    }
+    return result;
+}
+
+string HtmlSiteExporter::renderingConfiguration(Configuration& config)
+{
+    string configuration{"html-site-1"};
+    configuration += '\n';
+    configuration += config.getUiThemeName();
+    configuration += '\n';
+    configuration += config.getUiHtmlCssPath();
+    configuration += '\n';
+    configuration += std::to_string(config.getMd2HtmlOptions());
+    configuration += ' ';
+    configuration += std::to_string(static_cast<int>(config.getUiEnableDiagramsInMd()));
+    configuration += ' ';
+    configuration += config.isUiEnableMathInMd()?'1':'0';
+    configuration += config.isUiEnableSrcHighlightInMd()?'1':'0';
+    configuration += '\n';
+    return configuration;
+}
+
+void HtmlSiteExporter::loadManifest()
+{
+    manifest.clear();
+
+    ifstream in{siteDirectory + FILE_PATH_SEPARATOR + FILENAME_HTML_EXPORT_MANIFEST};
+    string line{};
+    while(getline(in, line)) {
+        // <hash> <site path>
+        if(line.size() > 17 && line[16] == ' ') {
+            manifest[line.substr(17)] = line.substr(0, 16);
+        }
+    }
+}
+
+void HtmlSiteExporter::saveManifest()
+{
+    ofstream out{siteDirectory + FILE_PATH_SEPARATOR + FILENAME_HTML_EXPORT_MANIFEST};
+    for(auto& m:manifest) {
+        out << m.second << " " << m.first << endl;
+    }
+}
+
+bool HtmlSiteExporter::createDirectories(const string& sitePath)
+{
+    vector<string> components = pathToComponents(sitePath);
+    if(components.size()) {
+        // file name
+        components.pop_back();
+    }
+
+    string directory{siteDirectory};
+    for(string& c:components) {
+        directory += FILE_PATH_SEPARATOR;
+        directory += c;
+        if(!isDirectory(directory.c_str()) && !createDirectory(directory)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void HtmlSiteExporter::writeIndex()
+{
+    vector<size_t> order{};
+    for(size_t i=0; i<sitePaths.size(); i++) {
+        if(sitePaths[i] == INDEX_FILENAME) {
+            MF_DEBUG("[HtmlSiteExporter] O " << names[i] << " is exported as index - skipping index generation" << endl);
+            return;
+        }
+        if(!collisions[i]) {
+            order.push_back(i);
+        }
+    }
+    std::sort(
+        order.begin(),
+        order.end(),
+        [this](size_t i1, size_t i2) {
+            return names[i1].compare(names[i2]) < 0;
+        });
+
+    string html{};
+    html.reserve(100 + order.size()*100);
+    html +=
+        "<!DOCTYPE html>\n"
+        "<html>\n"
+        "<head><meta charset='utf-8'><title>MindForger</title></head>\n"
+        "<body>\n"
+        "<ul>\n";
+    for(size_t i:order) {
+        html += "<li><a href='";
+        stringAppendHtmlEscaped(sitePaths[i], html);
+        html += "'>";
+        stringAppendHtmlEscaped(names[i], html);
+        html += "</a></li>\n";
+    }
+    html +=
+        "</ul>\n"
+        "</body>\n"
+        "</html>\n";
+
+    stringToFile(siteDirectory + FILE_PATH_SEPARATOR + INDEX_FILENAME, html);
+}
+
+HtmlSiteExporter::Stats HtmlSiteExporter::to(
+        const vector<Outline*>& outlines,
+        const string& memoryPath,
+        const string& siteDirectory)
+{
+    prepare(outlines, memoryPath, siteDirectory);
+    return write();
+}
+
+void HtmlSiteExporter::prepare(
+        const vector<Outline*>& outlines,
+        const string& memoryPath,
+        const string& siteDirectory)
+{
+    MF_DEBUG("[HtmlSiteExporter] preparing export of " << outlines.size() << " Os to " << siteDirectory << endl);
+
+    this->siteDirectory = siteDirectory;
+    if(!isDirectory(siteDirectory.c_str()) && !createDirectory(siteDirectory)) {
+        throw MindForgerException{"Unable to create HTML export directory: " + siteDirectory};
+    }
+
+    // site paths - Os mapped to the same page keep their extensions
+    sitePaths.clear();
+    sitePaths.reserve(outlines.size());
+    map<string,size_t> pages{};
+    for(Outline* o:outlines) {
+        sitePaths.push_back(toSitePath(o->getKey(), memoryPath));
+        pages[sitePaths.back()]++;
+    }
+    for(size_t i=0; i<outlines.size(); i++) {
+        if(pages[sitePaths[i]] > 1) {
+            sitePaths[i] = toSitePath(outlines[i]->getKey(), memoryPath, true);
+        }
+    }
+    // pages which still collide are not exported (never overwrite other O's page)
+    collisions.assign(outlines.size(), 0);
+    set<string> unique{};
+    for(size_t i=0; i<outlines.size(); i++) {
+        if(!unique.insert(sitePaths[i]).second) {
+            MF_DEBUG("[HtmlSiteExporter] O " << outlines[i]->getKey() << " collides w/ page " << sitePaths[i] << endl);
+            collisions[i] = 1;
+        }
+    }
+
+    // directories are created upfront (not by workers)
+    map<string,string> keysToSitePaths{};
+    for(size_t i=0; i<outlines.size(); i++) {
+        keysToSitePaths[FILE_PATH_SEPARATOR + componentsToPath(pathToComponents(outlines[i]->getKey()))] = sitePaths[i];
+        createDirectories(sitePaths[i]);
+    }
+
+    // snapshot Os so that pages can be rendered w/o accessing Os
+    MarkdownOutlineRepresentation markdownRepresentation{ontology, nullptr};
+    names.clear();
+    markdowns.clear();
+    names.reserve(outlines.size());
+    markdowns.reserve(outlines.size());
+    for(size_t i=0; i<outlines.size(); i++) {
+        names.push_back(outlines[i]->getName());
+        markdowns.push_back(string{});
+        if(!collisions[i]) {
+            string* markdown = markdownRepresentation.to(outlines[i]);
+            rewriteLinks(*markdown, outlines[i]->getKey(), sitePaths[i], keysToSitePaths);
+            markdowns.back().swap(*markdown);
+            delete markdown;
+        }
+    }
+}
+
+HtmlSiteExporter::Stats HtmlSiteExporter::write()
+{
+    MF_DEBUG("[HtmlSiteExporter] exporting " << markdowns.size() << " Os to " << siteDirectory << endl);
+#ifdef DO_MF_DEBUG
+    auto begin = chrono::high_resolution_clock::now();
+#endif
+
+    Stats stats{0, 0, 0, 0};
+
+    loadManifest();
+    const string configuration = renderingConfiguration(Configuration::getInstance());
+
+#ifdef MF_MD_2_HTML_CMARK
+    // cmark-gfm extensions must be registered before workers create transcoders
+    CmarkGfmMarkdownTranscoder::registerExtensions();
+#endif
+
+    // render Os in parallel - empty hash indicates failed export
+    vector<string> hashes(markdowns.size());
+    vector<char> skipped(markdowns.size(), 0);
+    atomic<size_t> next{0};
+    auto worker = [&]() {
+        HtmlOutlineRepresentation htmlRepresentation{ontology, nullptr};
+        string html{};
+        size_t i;
+        while((i = next++) < markdowns.size()) {
+            if(collisions[i]) {
+                continue;
+            }
+            string h = hash(configuration + markdowns[i]);
+
+            string fileName = siteDirectory + FILE_PATH_SEPARATOR + sitePaths[i];
+            auto m = manifest.find(sitePaths[i]);
+            if(m != manifest.end() && m->second == h && isFile(fileName.c_str())) {
+                skipped[i] = 1;
+            } else {
+                html.clear();
+                htmlRepresentation.to(&markdowns[i], &html, nullptr, true);
+                ofstream out{fileName};
+                out << html;
+                out.close();
+                if(!out.good()) {
+                    h.clear();
+                }
+            }
+            hashes[i] = h;
+        }
+    };
+
+    unsigned workersCount = std::min<size_t>(threads, 1 + markdowns.size()/MIN_OUTLINES_PER_THREAD);
+    if(workersCount <= 1) {
+        worker();
+    } else {
+        vector<thread> workers{};
+        for(unsigned t=0; t<workersCount; t++) {
+            workers.push_back(thread{worker});
+        }
+        for(thread& t:workers) {
+            t.join();
+        }
+    }
+
+    // update manifest and remove pages of forgotten Os
+    map<string,string> previous{};
+    previous.swap(manifest);
+    for(size_t i=0; i<markdowns.size(); i++) {
+        if(hashes[i].empty()) {
+            stats.failed++;
+        } else {
+            manifest[sitePaths[i]] = hashes[i];
+            if(skipped[i]) {
+                stats.skipped++;
+            } else {
+                stats.exported++;
+            }
+        }
+    }
+    for(auto& p:previous) {
+        if(manifest.find(p.first) == manifest.end()
+             &&
+           find(sitePaths.begin(), sitePaths.end(), p.first) == sitePaths.end())
+        {
+            string fileName = siteDirectory + FILE_PATH_SEPARATOR + p.first;
+            if(!remove(fileName.c_str())) {
+                stats.removed++;
+            }
+        }
+    }
+    saveManifest();
+    writeIndex();
+
+#ifdef DO_MF_DEBUG
+    auto end = chrono::high_resolution_clock::now();
+    MF_DEBUG("[HtmlSiteExporter] " << stats.exported << " exported / " << stats.skipped << " skipped / " << stats.removed << " removed / " << stats.failed << " failed in " << chrono::duration_cast<chrono::milliseconds>(end-begin).count() << "ms using " << workersCount << " threads" << endl);
+#endif
+
+    return stats;
+}
+
+} // m8r namespace
@@ -0,0 +1,145 @@
+/*
+ html_site_exporter.h     MindForger thinking notebook
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_HTML_SITE_EXPORTER_H
+#define M8R_HTML_SITE_EXPORTER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+
+#include "../../debug.h"
+#include "../../model/outline.h"
+#include "../../mind/ontology/ontology.h"
+#include "../../config/configuration.h"
+
+namespace m8r {
+
+/**
+ * @brief Export of all Os to a static (HTML) site.
+ *
+ * Site mirrors memory directory structure - O memory/a/b.md is exported
+ * to <site>/a/b.html. If more Os map to the same page (a.md and a.markdown),
+ * then their extensions are kept: a.md.html and a.markdown.html. Links to other
+ * Os are rewritten to link exported HTML pages.
+ *
+ * Export is incremental: hash of (link rewritten) O Markdown and HTML rendering
+ * configuration is stored in the export manifest in site directory and Os whose
+ * hash didn't change since the last export are skipped.
+ *
+ * Export has two phases: prepare() snapshots Os Markdown and must be called
+ * from the thread which owns Os (e.g. GUI), write() renders and writes pages
+ * using worker threads (every worker has its own HTML representation), therefore
+ * it can run in background.
+ */
+class HtmlSiteExporter
+{
+public:
+    static constexpr unsigned MIN_OUTLINES_PER_THREAD = 8;
+    static constexpr const char* INDEX_FILENAME = "index.html";
+
+    struct Stats {
+        size_t exported;
+        size_t skipped;
+        size_t removed;
+        size_t failed;
+    };
+
+private:
+    Ontology& ontology;
+    unsigned threads;
+
+    // site path (relative to the site directory) -> O Markdown hash
+    std::map<std::string,std::string> manifest;
+
+    // prepared export: site path, name and link rewritten Markdown of every O
+    std::string siteDirectory;
+    std::vector<std::string> sitePaths;
+    std::vector<std::string> names;
+    std::vector<std::string> markdowns;
+    std::vector<char> collisions;
+
+public:
+    /**
+     * @param threads   number of worker threads, 0 to use all cores.
+     */
+    explicit HtmlSiteExporter(Ontology& ontology, unsigned threads=0);
+    HtmlSiteExporter(const HtmlSiteExporter&) = delete;
+    HtmlSiteExporter(const HtmlSiteExporter&&) = delete;
+    HtmlSiteExporter &operator=(const HtmlSiteExporter&) = delete;
+    HtmlSiteExporter &operator=(const HtmlSiteExporter&&) = delete;
+    ~HtmlSiteExporter();
+
+    /**
+     * @brief Export Os from memory directory to site directory.
+     */
+    Stats to(
+        const std::vector<Outline*>& outlines,
+        const std::string& memoryPath,
+        const std::string& siteDirectory);
+
+    /**
+     * @brief Snapshot Os Markdown w/ rewritten links and create site directories.
+     */
+    void prepare(
+        const std::vector<Outline*>& outlines,
+        const std::string& memoryPath,
+        const std::string& siteDirectory);
+    /**
+     * @brief Render and write prepared Os, update manifest and index - Os are not accessed.
+     */
+    Stats write();
+
+    /**
+     * @brief Get site path (relative, with .html extension) of O.
+     *
+     * @param keepExtension  keep O file extension i.e. a.md to a.md.html
+     */
+    static std::string toSitePath(const std::string& outlineKey, const std::string& memoryPath, bool keepExtension=false);
+
+    /**
+     * @brief Rewrite Markdown links to Os to relative links to exported HTML pages.
+     *
+     * @param sitePaths     O key -> site path
+     */
+    static void rewriteLinks(
+        std::string& markdown,
+        const std::string& outlineKey,
+        const std::string& sitePath,
+        const std::map<std::string,std::string>& sitePaths);
+
+    /**
+     * @brief 64-bit FNV-1a hash as hex string.
+     */
+    static std::string hash(const std::string& text);
+
+    /**
+     * @brief Configuration which affects rendered HTML (theme, CSS, Markdown options, ...).
+     */
+    static std::string renderingConfiguration(Configuration& config);
+
+private:
+    void loadManifest();
+    void saveManifest();
+    bool createDirectories(const std::string& sitePath);
+    void writeIndex();
+};
+
+}
+#endif // M8R_HTML_SITE_EXPORTER_H
@@ -18,6 +18,10 @@
 */
 
 #include "cmark_gfm_markdown_transcoder.h"
+
+#include <cstdlib>
+#include <mutex>
+
 // cmark-gfm headers must NOT be included in header (Win build fails otherwise)
 #ifdef MF_MD_2_HTML_CMARK
   #include <cmark-gfm.h>
@@ -34,10 +38,18 @@ CmarkGfmMarkdownTranscoder::CmarkGfmMarkdownTranscoder() : config(Configuration:
 {
     cmarkOptions = lastMfOptions = 0;
 
+    registerExtensions();
+}
+
+void CmarkGfmMarkdownTranscoder::registerExtensions()
+{
 #ifdef MF_MD_2_HTML_CMARK
-    cmark_gfm_core_extensions_ensure_registered();
-    // free extensions at application exit (cmark-gfm is not able to register/unregister more than once)
-    std::atexit(cmark_release_plugins);
+    static std::once_flag registered;
+    std::call_once(registered, []() {
+        cmark_gfm_core_extensions_ensure_registered();
+        // free extensions at application exit (cmark-gfm is not able to register/unregister more than once)
+        std::atexit(cmark_release_plugins);
+    });
 #endif
 }
 
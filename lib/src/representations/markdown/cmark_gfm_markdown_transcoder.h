@@ -64,6 +64,14 @@ public:
             RepresentationType format,
             const std::string* markdown,
             std::string* html);
+
+    /**
+     * @brief Register cmark-gfm core extensions (once per process).
+     *
+     * Registration is not thread safe in cmark-gfm - call it before transcoders
+     * are created by worker threads.
+     */
+    static void registerExtensions();
 };
 
 }
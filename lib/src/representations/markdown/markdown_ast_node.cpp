@@ -79,13 +79,14 @@ void MarkdownAstNodeSection::setDepth(u_int16_t depth)
     this->depth = depth;
 }
 
-void MarkdownAstNodeSection::setBody(vector<string*>* body)
+void MarkdownAstNodeSection::setBody(vector<string*>* body, const shared_ptr<TextArena>& textArena)
 {
     if(this->body!=nullptr) {
         delete this->body;
         this->body=nullptr;
     }
     this->body = body;
+    this->textArena = textArena;
 }
 
 MarkdownAstNodeSection::~MarkdownAstNodeSection()
@@ -93,7 +94,7 @@ MarkdownAstNodeSection::~MarkdownAstNodeSection()
     if(body!=nullptr) {
         for(string*& b:*body) {
             if(b!=nullptr) {
-                delete b;
+                TextArena::release(b, textArena.get());
             }
         }
         delete body;
@@ -195,7 +196,7 @@ MarkdownAstSectionMetadata::MarkdownAstSectionMetadata()
 {
     deadline = created = read = modified = 0;
     importance = urgency = progress = 0;
-    revision = reads = 0;
+    revision = reads = id = 0;
     type = nullptr;
 }
 
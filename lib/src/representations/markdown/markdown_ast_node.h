@@ -19,9 +19,11 @@
 #ifndef M8R_MARKDOWN_AST_M8RUI_NAVIGATOR_NODE_H_
 #define M8R_MARKDOWN_AST_M8RUI_NAVIGATOR_NODE_H_
 
+#include <memory>
 #include <string>
 
 #include "../../model/link.h"
+#include "../../gear/text_arena.h"
 #include "markdown_note_metadata.h"
 
 namespace m8r {
@@ -113,6 +115,7 @@ private:
     u_int32_t revision;
     time_t read;
     u_int32_t reads;
+    u_int32_t id;
 
     int8_t importance;
     int8_t urgency;
@@ -148,6 +151,8 @@ public:
     void setReads(u_int32_t reads);
     u_int32_t getRevision() const;
     void setRevision(u_int32_t revision);
+    u_int32_t getId() const { return id; }
+    void setId(u_int32_t id) { this->id = id; }
     const std::string* getType() const;
     void setType(const std::string* type);
     int8_t getUrgency() const;
@@ -179,6 +184,8 @@ protected:
     u_int16_t depth;
     MarkdownAstSectionMetadata metadata;
     std::vector<std::string*>* body;
+    // owner of (some) body lines - shared w/ lexer and all sections of the document
+    std::shared_ptr<TextArena> textArena;
 
     // various flags (bit)
     int flags;
@@ -194,7 +201,8 @@ public:
 
     std::vector<std::string*>* getBody() const { return body; }
     std::vector<std::string*>* moveBody() { std::vector<std::string*>* result=body; body=nullptr; return result; }
-    void setBody(std::vector<std::string*>* body);
+    void setBody(std::vector<std::string*>* body, const std::shared_ptr<TextArena>& textArena);
+    const std::shared_ptr<TextArena>& getTextArena() const { return textArena; }
 
     u_int16_t getDepth() const;
     void setDepth(u_int16_t depth);
@@ -31,6 +31,7 @@ constexpr const auto CONFIG_SETTING_MIND_TIME_SCOPE_LABEL = "* Time scope: ";
 constexpr const auto CONFIG_SETTING_MIND_TAGS_SCOPE_LABEL = "* Tags scope: ";
 constexpr const auto CONFIG_SETTING_MIND_DISTRIBUTOR_INTERVAL = "* Async refresh interval (ms): ";
 constexpr const auto CONFIG_SETTING_MIND_AUTOLINKING = "* Autolinking: ";
+constexpr const auto CONFIG_SETTING_MIND_MEMORY_BUDGET = "* Memory budget (MB): ";
 
 // application
 constexpr const auto CONFIG_SETTING_STARTUP_VIEW_LABEL = "* Startup view: ";
@@ -106,7 +107,7 @@ void MarkdownConfigurationRepresentation::configuration(vector<MarkdownAstNodeSe
                 configuration(ast->at(i)->getText(), sectionBody, c);
 
                 for(string* l:*sectionBody) {
-                    delete l;
+                    TextArena::release(l, ast->at(i)->getTextArena().get());
                 }
                 delete sectionBody;
             }
@@ -345,6 +346,20 @@ void MarkdownConfigurationRepresentation::configuration(string* title, vector<st
                         }
                         i %= 10000;
                         c.setDistributorSleepInterval(i);
+                    } else if(line->find(CONFIG_SETTING_MIND_MEMORY_BUDGET) != std::string::npos) {
+                        string t = line->substr(strlen(CONFIG_SETTING_MIND_MEMORY_BUDGET));
+                        std::string::size_type st;
+                        int i;
+                        try {
+                          i = std::stoi (t,&st);
+                        }
+                        catch(...) {
+                          i = Configuration::DEFAULT_MEMORY_BUDGET;
+                        }
+                        if(i<0) {
+                            i=Configuration::DEFAULT_MEMORY_BUDGET;
+                        }
+                        c.setMemoryBudget(static_cast<unsigned>(i));
                     } else if(line->find(CONFIG_SETTING_MIND_AUTOLINKING) != std::string::npos) {
                         if(line->find("yes") != std::string::npos) {
                             c.setAutolinking(true);
@@ -437,6 +452,9 @@ string& MarkdownConfigurationRepresentation::to(Configuration* c, string& md)
          CONFIG_SETTING_MIND_DISTRIBUTOR_INTERVAL << (c?c->getDistributorSleepInterval():Configuration::DEFAULT_DISTRIBUTOR_SLEEP_INTERVAL+1) << endl <<
          "    * Sleep interval (miliseconds) between asynchronous mind-related evaluations (associations, ...)" << endl <<
          "    * Examples: 500, 1000, 3000, 5000" << endl <<
+         CONFIG_SETTING_MIND_MEMORY_BUDGET << (c?c->getMemoryBudget():Configuration::DEFAULT_MEMORY_BUDGET) << endl <<
+         "    * Memory for Notes text - only headers of Outlines are kept in memory and text is loaded on access (0 for whole repository in memory)" << endl <<
+         "    * Examples: 0, 64, 256" << endl <<
          CONFIG_SETTING_MIND_AUTOLINKING << (c?(c->isAutolinking()?"yes":"no"):(Configuration::DEFAULT_AUTOLINKING?"yes":"no")) << endl <<
          "    * Examples: yes, no" << endl <<
          endl <<
@@ -550,6 +568,10 @@ void MarkdownConfigurationRepresentation::save(const File* file, Configuration*
     to(c,md);
 
     if(c) {
+        if(!c->isPersistent()) {
+            MF_DEBUG("Configuration is not persistent - skipping save to " << c->getConfigFilePath() << endl);
+            return;
+        }
         MF_DEBUG("Saving configuration to file " << c->getConfigFilePath() << endl);
         std::ofstream out(c->getConfigFilePath());
         out << md;
@@ -65,7 +65,7 @@ public:
      */
     bool load(Configuration& c);
     /**
-     * @brief Save configuration to file.
+     * @brief Save configuration to file (unless configuration is not persistent).
      */
     void save(Configuration& c) { save(nullptr, &c); }
     /**
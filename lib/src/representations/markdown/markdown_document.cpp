@@ -49,17 +49,16 @@ void MarkdownDocument::from()
     modified = fileModificationTime(filePath);
     MarkdownLexerSections lexer{filePath};
     lexer.tokenize();
-    // IMPROVE the rest of this section could be shared by file & text
-    if(lexer.getLexems().size()) {
-        fileSize = lexer.getFileSize();
-        // must be pointer (circular header dep)
-        MarkdownParserSections parser{lexer};
-        parser.parse();
-        format = parser.hasMetadata()?Format::MINDFORGER:Format::MARKDOWN;
-        // parser is deleted on return, but AST is kept
-        ast = parser.moveAst();
-        from(ast);
-    } // else: empty file/no lexems
+    from(lexer);
+}
+
+void MarkdownDocument::fromHeaders()
+{
+    clear();
+    modified = fileModificationTime(filePath);
+    MarkdownLexerSections lexer{filePath};
+    lexer.tokenizeHeaders();
+    from(lexer);
 }
 
 void MarkdownDocument::from(const std::string* text)
@@ -68,10 +67,15 @@ void MarkdownDocument::from(const std::string* text)
     modified = datetimeNow();
     MarkdownLexerSections lexer{};
     lexer.tokenize(text);
-    // IMPROVE the rest of this section could be shared by file & text
+    from(lexer);
+}
+
+void MarkdownDocument::from(MarkdownLexerSections& lexer)
+{
     if(lexer.getLexems().size()) {
         fileSize = lexer.getFileSize();
-        MarkdownParserSections parser = MarkdownParserSections(lexer);
+        // must be pointer (circular header dep)
+        MarkdownParserSections parser{lexer};
         parser.parse();
         format = parser.hasMetadata()?Format::MINDFORGER:Format::MARKDOWN;
         // parser is deleted on return, but AST is kept
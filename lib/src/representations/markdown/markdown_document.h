@@ -79,6 +79,10 @@ public:
 
     void from();
     void from(const std::string* text);
+    /**
+     * @brief Parse section headers of the file only i.e. sections have no body.
+     */
+    void fromHeaders();
     bool isParsed() const { return ast==nullptr; }
     void clear();
 
@@ -101,6 +105,7 @@ public:
     }
 
 private:
+    void from(MarkdownLexerSections& lexer);
     void from(const std::vector<MarkdownAstNodeSection*>* ast);
 };
 
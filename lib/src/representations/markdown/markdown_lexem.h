@@ -56,6 +56,7 @@ enum class MarkdownLexemType
     META_PROPERTY_links,
     META_PROPERTY_deadline,
     META_PROPERTY_scope,
+    META_PROPERTY_id,
 
     META_NAMEVALUE_DELIMITER,   // :
     META_PROPERTY_VALUE,
@@ -18,6 +18,8 @@
  */
 #include "markdown_lexer_sections.h"
 
+#include <cstring>
+
 using namespace std;
 
 namespace m8r {
@@ -96,6 +98,8 @@ MarkdownLexemTable::MarkdownLexemTable()
     lexems.insert(META_PROPERTY_deadline);
     META_PROPERTY_scope = new MarkdownLexem{MarkdownLexemType::META_PROPERTY_scope};
     lexems.insert(META_PROPERTY_scope);
+    META_PROPERTY_id = new MarkdownLexem{MarkdownLexemType::META_PROPERTY_id};
+    lexems.insert(META_PROPERTY_id);
     META_NAMEVALUE_DELIMITER = new MarkdownLexem{MarkdownLexemType::META_NAMEVALUE_DELIMITER};
     lexems.insert(META_NAMEVALUE_DELIMITER);
     HTML_COMMENT_BEGIN = new MarkdownLexem{MarkdownLexemType::HTML_COMMENT_BEGIN};
@@ -126,6 +130,7 @@ MarkdownLexemTable::~MarkdownLexemTable()
     delete META_PROPERTY_links;
     delete META_PROPERTY_deadline;
     delete META_PROPERTY_scope;
+    delete META_PROPERTY_id;
     delete META_NAMEVALUE_DELIMITER;
     delete HTML_COMMENT_BEGIN;
     delete HTML_COMMENT_END;
@@ -168,10 +173,32 @@ MarkdownSymbolTable::~MarkdownSymbolTable()
  * MarkdownLexerSections
  */
 
+// rules shared by lexer (lines) and header scanner (file buffer)
+
+static inline bool isCodeBlockSymbol(const char* line, const size_t size)
+{
+    return size>=3 && line[0]=='`' && line[1]=='`' && line[2]=='`';
+}
+
+static inline bool isSameChars(const char* line, const size_t size, const char c)
+{
+    // fail fast
+    if(size && line[0]==c && line[size-1]==c) {
+        for(size_t i=1; i<size-1; i++) {
+            if(line[i]!=c) {
+                return false;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
 MarkdownLexerSections::MarkdownLexerSections(const string* filePath)
 {
     this->filePath = filePath;
     this->fileSize = 0;
+    this->emptyLinesOffset = 0;
     this->inCodeBlock = false;
     this->lastBrTokensOffset = 0;
 }
@@ -181,7 +208,7 @@ MarkdownLexerSections::~MarkdownLexerSections()
     // lines
     for(string*& line:lines) {
         if(line!=nullptr) {
-            delete line;
+            TextArena::release(line, textArena.get());
         }
     }
 
@@ -199,39 +226,128 @@ MarkdownLexerSections::~MarkdownLexerSections()
 void MarkdownLexerSections::tokenize()
 {
     fileSize = 0;
-    if(fileToLines(filePath, lines, fileSize)) {
-        // IMPROVE body of this function can be shared by file & text
-        lexems.push_back(MarkdownSymbolTable::LEXEM.BEGIN_DOC);
+    textArena = make_shared<TextArena>();
+    if(fileToLines(filePath, lines, fileSize, *textArena)) {
+        tokenizeLines();
+    }
+}
 
-        unsigned offset = 0;
-        while(nextToken(offset)) {
-            offset++;
+void MarkdownLexerSections::tokenize(const string* text)
+{
+    size_t size = 0;
+    textArena = make_shared<TextArena>();
+    if(stringToLines(text, lines, size, *textArena)) {
+        tokenizeLines();
+    }
+}
+
+void MarkdownLexerSections::tokenizeHeaders()
+{
+    fileSize = 0;
+    string text{};
+    if(!fileToString(*filePath, text)) {
+        return;
+    }
+
+    // file is scanned w/o lexing section bodies - only lines which declare sections are created
+    // and lexed by the same rules as by tokenize(), other lines are kept as nullptr; skipped lines
+    // just toggle code blocks and might be names of post declared sections
+    lexems.push_back(MarkdownSymbolTable::LEXEM.BEGIN_DOC);
+    bool sections = false;
+    // previous line would be lexed as LINE i.e. it might be name of post declared section
+    bool previousLine = false;
+    const char* previous = nullptr;
+    size_t previousSize = 0;
+
+    const char* begin = text.data();
+    const char* end = begin+text.size();
+    unsigned offset = 0;
+    while(begin<end) {
+        const char* eol = static_cast<const char*>(memchr(begin, '\n', end-begin));
+        if(!eol) {
+            eol = end;
         }
+        const size_t size = eol-begin;
+        fileSize += size+1;
+        lines.push_back(nullptr);
 
-        if(lexems.size()==1) {
-            lexems.clear();
-        } else {
-            lexems.push_back(MarkdownSymbolTable::LEXEM.END_DOC);
+        bool line = size>0;
+        if(size) {
+            switch(*begin) {
+            case '`':
+                if(isCodeBlockSymbol(begin, size)) {
+                    toggleInCodeBlock();
+                }
+                break;
+            case '#':
+                if(!inCodeBlock) {
+                    lines[offset] = new string{begin, size};
+                    nextToken(offset);
+                    sections = true;
+                    line = false;
+                }
+                break;
+            case '=':
+            case '-':
+                if(previousLine && !inCodeBlock && isSameChars(begin, size, *begin)) {
+                    const size_t lexemsSize = lexems.size();
+                    lines[offset-1] = new string{previous, previousSize};
+                    lines[offset] = new string{begin, size};
+                    addLineToLexems(offset-1);
+                    if(lexPostDeclaredSectionHeader(offset, *begin)) {
+                        sections = true;
+                        line = false;
+                    } else {
+                        for(size_t i=lexemsSize; i<lexems.size(); i++) {
+                            if(!MarkdownSymbolTable::LEXEM.contains(lexems[i])) {
+                                delete lexems[i];
+                            }
+                        }
+                        lexems.resize(lexemsSize);
+                        delete lines[offset-1];
+                        lines[offset-1] = nullptr;
+                    }
+                    delete lines[offset];
+                    lines[offset] = nullptr;
+                }
+                break;
+            }
         }
+
+        previousLine = line;
+        previous = begin;
+        previousSize = size;
+        begin = eol+1;
+        offset++;
+    }
+
+    if(sections) {
+        lexems.push_back(MarkdownSymbolTable::LEXEM.END_DOC);
+    } else {
+        // no section: document is tokenized whole
+        lexems.clear();
+        lines.clear();
+        inCodeBlock = false;
+        fileSize = 0;
+        textArena = make_shared<TextArena>();
+        stringToLines(&text, lines, fileSize, *textArena);
+        tokenizeLines();
     }
 }
 
-void MarkdownLexerSections::tokenize(const string* text)
+void MarkdownLexerSections::tokenizeLines()
 {
-    if(stringToLines(text, lines)) {
-        // IMPROVE body of this function can be shared by file & text
-        lexems.push_back(MarkdownSymbolTable::LEXEM.BEGIN_DOC);
+    lexems.push_back(MarkdownSymbolTable::LEXEM.BEGIN_DOC);
 
-        unsigned offset = 0;
-        while(nextToken(offset)) {
-            offset++;
-        }
+    unsigned offset = 0;
+    while(nextToken(offset)) {
+        offset++;
+    }
 
-        if(lexems.size()==1) {
-            lexems.clear();
-        } else {
-            lexems.push_back(MarkdownSymbolTable::LEXEM.END_DOC);
-        }
+    if(lexems.size()==1) {
+        lexems.clear();
+    } else {
+        lexems.push_back(MarkdownSymbolTable::LEXEM.END_DOC);
     }
 }
 
@@ -253,14 +369,7 @@ bool MarkdownLexerSections::lexWhitespaces(const unsigned offset, unsigned short
 
 bool MarkdownLexerSections::startsWithCodeBlockSymbol(const unsigned offset) const
 {
-    if(lines[offset]!=nullptr && lines[offset]->size()>=3
-         &&
-       lines[offset]->at(0)=='`' && lines[offset]->at(1)=='`' && lines[offset]->at(2)=='`'
-    ){
-        return true;
-    } else {
-        return false;
-    }
+    return lines[offset]!=nullptr && isCodeBlockSymbol(lines[offset]->data(), lines[offset]->size());
 }
 
 bool MarkdownLexerSections::startsWithHtmlCommentEndSymbol(const unsigned offset, const unsigned short idx) const
@@ -417,7 +526,12 @@ bool MarkdownLexerSections::lexMetaPropertyName(const unsigned offset, unsigned
             }
             return false;
         case 'i':
-            if(lines[offset]->at(idx+2)=='m' &&
+            if(lines[offset]->at(idx+2)=='d' &&
+               (lines[offset]->at(idx+3)==':' || !isspace(idx+3))) {
+                lexems.push_back(symbolTable.LEXEM.META_PROPERTY_id);
+                idx+=2;
+                return true;
+            } else if(lines[offset]->at(idx+2)=='m' &&
                lines[offset]->at(idx+3)=='p' &&
                lines[offset]->at(idx+4)=='o' &&
                lines[offset]->at(idx+5)=='r' &&
@@ -773,19 +887,7 @@ bool MarkdownLexerSections::nextToken(const unsigned int offset) {
 
 bool MarkdownLexerSections::isSameCharsLine(const unsigned offset, const char c) const
 {
-    // fail fast
-    if(lines[offset]!=nullptr && lines[offset]->size()
-         &&
-       lines[offset]->at(0)==c && lines[offset]->at(lines[offset]->size()-1)==c)
-    {
-        for(unsigned i=1; i<lines[offset]->size()-1; i++) {
-            if(lines[offset]->at(i)!=c) {
-                return false;
-            }
-        }
-        return true;
-    }
-    return false;
+    return lines[offset]!=nullptr && isSameChars(lines[offset]->data(), lines[offset]->size(), c);
 }
 
 bool MarkdownLexerSections::lookahead(const unsigned offset, const unsigned short idx) const
@@ -842,6 +944,10 @@ string* MarkdownLexerSections::getText(const MarkdownLexem* lexem)
         if(lexem->getOff()<lines.size()) {
             if(lexem->getLng()==MarkdownLexem::WHOLE_LINE) {
                 string *result = lines[lexem->getOff()];
+                if(textArena && result) {
+                    // arena lines are kept for body text
+                    return new string{*result};
+                }
                 lines[lexem->getOff()] = nullptr;
                 return result;
             } else {
@@ -856,4 +962,26 @@ string* MarkdownLexerSections::getText(const MarkdownLexem* lexem)
     return nullptr;
 }
 
+string* MarkdownLexerSections::getBodyText(const MarkdownLexem* lexem)
+{
+    if(lexem!=nullptr && lines.size()) {
+        if(lexem->getType()==MarkdownLexemType::BR) {
+            // BR lexem is shared by all empty lines, which are interchangeable - next one is taken
+            while(emptyLinesOffset<lines.size()) {
+                string*& line = lines[emptyLinesOffset++];
+                if(line!=nullptr && line->empty()) {
+                    string *result = line;
+                    line = nullptr;
+                    return result;
+                }
+            }
+        } else if(lexem->getOff()<lines.size() && lexem->getLng()==MarkdownLexem::WHOLE_LINE) {
+            string *result = lines[lexem->getOff()];
+            lines[lexem->getOff()] = nullptr;
+            return result;
+        }
+    }
+    return getText(lexem);
+}
+
 } // m8r namespace
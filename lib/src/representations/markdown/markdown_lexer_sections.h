@@ -19,6 +19,7 @@
 #ifndef M8R_MARKDOWN_LEXER_SECTIONS_H_
 #define M8R_MARKDOWN_LEXER_SECTIONS_H_
 
+#include <memory>
 #include <set>
 #include <string>
 #include <vector>
@@ -26,6 +27,7 @@
 
 #include "../../gear/lang_utils.h"
 #include "../../gear/file_utils.h"
+#include "../../gear/text_arena.h"
 #include "markdown_lexem.h"
 
 namespace m8r {
@@ -55,6 +57,7 @@ public:
     MarkdownLexem* META_PROPERTY_links;
     MarkdownLexem* META_PROPERTY_deadline;
     MarkdownLexem* META_PROPERTY_scope;
+    MarkdownLexem* META_PROPERTY_id;
     MarkdownLexem* META_NAMEVALUE_DELIMITER;
     MarkdownLexem* HTML_COMMENT_BEGIN;
     MarkdownLexem* HTML_COMMENT_END;
@@ -110,7 +113,11 @@ private:
     bool inCodeBlock;
 
     size_t fileSize;
+    // lines of whole document are lexed to the arena, which is shared by AST (and O)
+    std::shared_ptr<TextArena> textArena;
     std::vector<std::string*> lines;
+    // offset where the search for the next empty line of section body starts
+    size_t emptyLinesOffset;
     // IMPROVE prepare a LexemPool: vector + MarkdownLexem[1000] and allocate from there (performance)
     std::vector<MarkdownLexem*> lexems;
     MarkdownSymbolTable symbolTable;
@@ -125,11 +132,28 @@ public:
 
     void tokenize();
     void tokenize(const std::string* text);
+    /**
+     * @brief Tokenize section headers (name and metadata) of the file only.
+     *
+     * File is scanned line by line w/o lexing of section bodies. Lines which declare
+     * sections are lexed by the same rules (code blocks, post declared sections) as by
+     * tokenize(), lines of section bodies are nullptr - file size is kept. If the file
+     * has no section, then it's tokenized whole.
+     */
+    void tokenizeHeaders();
 
     /**
      * Returns text, caller is expected to destroy it.
      */
     std::string* getText(const MarkdownLexem*);
+    /**
+     * @brief Returns text of section body LINE or BR lexem.
+     *
+     * Unlike getText() the line is moved from the lexer w/o copying, therefore it may
+     * be owned by the text arena - caller is expected to destroy it using TextArena::release().
+     */
+    std::string* getBodyText(const MarkdownLexem*);
+    const std::shared_ptr<TextArena>& getTextArena() const { return textArena; }
 
     void setFilePath(const std::string*& filePath) { this->filePath = filePath; }
     size_t getFileSize() const { return fileSize; }
@@ -164,6 +188,7 @@ private:
     inline bool lexPostDeclaredSectionHeader(const unsigned offset, const char delimiter);
 
     inline void addLineToLexems(const unsigned offset);
+    void tokenizeLines();
 
     /**
      * @brief Insert back section lexem if "standalone line section declaration" found.
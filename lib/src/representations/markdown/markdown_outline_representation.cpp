@@ -17,6 +17,7 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "markdown_outline_representation.h"
+#include "../../gear/tracer.h"
 
 #include "../../mind/ontology/ontology.h"
 
@@ -64,6 +65,8 @@ Note* MarkdownOutlineRepresentation::note(vector<MarkdownAstNodeSection*>* ast,
         note->setDepth(ast->at(i)->getDepth());
         body = ast->at(i)->moveBody();
         if(body != nullptr) {
+            // lines lexed to arena are shared w/ O (long lived, freed at once)
+            note->setTextArena(ast->at(i)->getTextArena());
             for(string*& bodyItem : *body) {
                 note->addDescriptionLine(bodyItem);
             }
@@ -74,6 +77,7 @@ Note* MarkdownOutlineRepresentation::note(vector<MarkdownAstNodeSection*>* ast,
         note->setRevision(ast->at(i)->getMetadata().getRevision());
         note->setRead(ast->at(i)->getMetadata().getRead());
         note->setReads(ast->at(i)->getMetadata().getReads());
+        note->setId(ast->at(i)->getMetadata().getId());
         note->setDeadline(ast->at(i)->getMetadata().getDeadline());
         note->setProgress(ast->at(i)->getMetadata().getProgress());
 
@@ -100,8 +104,14 @@ Note* MarkdownOutlineRepresentation::note(vector<MarkdownAstNodeSection*>* ast,
 
 Outline* MarkdownOutlineRepresentation::outline(const File& file)
 {
+    MF_TRACE_SPAN("markdown", "parse");
     MarkdownDocument md{&file.name};
     md.from();
+    return outline(md);
+}
+
+Outline* MarkdownOutlineRepresentation::outline(MarkdownDocument& md)
+{
     vector<MarkdownAstNodeSection*>* ast = md.moveAst();
 
     Outline* o = outline(ast);
@@ -110,7 +120,6 @@ Outline* MarkdownOutlineRepresentation::outline(const File& file)
         o->setKey(*md.getFilePath());
         o->setBytesize(md.getFileSize());
         o->completeProperties(md.getModified());
-        o->setModifiedPretty(datetimeToPrettyHtml(o->getModified()));
     }
     return o;
 }
@@ -123,13 +132,17 @@ Outline* MarkdownOutlineRepresentation::outline(vector<MarkdownAstNodeSection*>*
         if(ast->size()) {
             MarkdownAstNodeSection* astNode = ast->at(off);
 
+            // lines of O and its Ns are lexed to the arena of the document
+            outline->setTextArena(astNode->getTextArena());
+
             // preamble
             if(astNode->isPreambleSection()) {
                 vector<string*>* body = ast->at(off)->moveBody();
                 if(body!=nullptr) {
-                    // IMPROVE use body as is
                     for(string*& bodyItem:*body) {
-                        outline->addPreambleLine(bodyItem);
+                        if(bodyItem) {
+                            outline->addPreambleLine(bodyItem);
+                        }
                     }
                     delete body;
                 }
@@ -164,6 +177,7 @@ Outline* MarkdownOutlineRepresentation::outline(vector<MarkdownAstNodeSection*>*
                 outline->setRevision(astNode->getMetadata().getRevision());
                 outline->setRead(astNode->getMetadata().getRead());
                 outline->setReads(astNode->getMetadata().getReads());
+                outline->setId(astNode->getMetadata().getId());
                 outline->setImportance(astNode->getMetadata().getImportance());
                 outline->setUrgency(astNode->getMetadata().getUrgency());
                 outline->setProgress(astNode->getMetadata().getProgress());
@@ -189,9 +203,10 @@ Outline* MarkdownOutlineRepresentation::outline(vector<MarkdownAstNodeSection*>*
 
                 vector<string*>* body = ast->at(off)->moveBody();
                 if(body!=nullptr) {
-                    // IMPROVE use body as is
                     for(string*& bodyItem:*body) {
-                        outline->addDescriptionLine(bodyItem);
+                        if(bodyItem) {
+                            outline->addDescriptionLine(bodyItem);
+                        }
                     }
                     delete body;
                 }
@@ -314,6 +329,9 @@ void MarkdownOutlineRepresentation::toHeader(const Outline* outline, string* md)
                 outline->getTimeScope().toString(ts);
                 md->append(" scope: "); md->append(ts); md->append(";");
             }
+            if(outline->getId()) {
+                sprintf(buffer," id: %u;",outline->getId()); md->append(buffer);
+            }
             md->append(" -->");
         }
         if(outline->isTrailingHashesSection()) {
@@ -479,6 +497,9 @@ string* MarkdownOutlineRepresentation::to(const Note* note, string* md, bool inc
         if(note->getDeadline()) {
             md->append(" deadline: "); md->append(datetimeToString(note->getDeadline())); md->append(";");
         }
+        if(note->getId()) {
+            sprintf(buffer," id: %u;",note->getId()); md->append(buffer);
+        }
         md->append(" -->");
     }
     if(note->isTrailingHashesSection()) {
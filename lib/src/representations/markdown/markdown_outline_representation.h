@@ -81,6 +81,13 @@ public:
     virtual ~MarkdownOutlineRepresentation();
 
     virtual Outline* outline(const File& file) override;
+    /**
+     * @brief Create O from parsed Markdown document.
+     *
+     * Document can be parsed in any thread, O creation uses ontology and it
+     * therefore must be serialized.
+     */
+    virtual Outline* outline(MarkdownDocument& md);
     virtual Outline* header(const std::string* md);
     virtual Note* note(const File& file);
     virtual Note* note(const std::string* md);
@@ -140,7 +140,7 @@ void MarkdownParserSections::preambleRule(size_t& offset)
     if(lookaheadSection(offset+1) == nullptr) {
         MarkdownAstNodeSection* result = new MarkdownAstNodeSection();
         result->setPreamble();
-        result->setBody(sectionBodyRule(offset));
+        result->setBody(sectionBodyRule(offset), lexer.getTextArena());
         ast->push_back(result);
     }
 }
@@ -175,7 +175,7 @@ MarkdownAstNodeSection* MarkdownParserSections::sectionRule(size_t& offset)
                 }
 
                 result->setDepth(depth);
-                result->setBody(sectionBodyRule(offset));
+                result->setBody(sectionBodyRule(offset), lexer.getTextArena());
                 return result;
             }
             break;
@@ -188,7 +188,7 @@ MarkdownAstNodeSection* MarkdownParserSections::sectionRule(size_t& offset)
             result->setPostDeclaredSection();
             result->setDepth(depth);
             ++offset; // skip BR
-            result->setBody(sectionBodyRule(offset));
+            result->setBody(sectionBodyRule(offset), lexer.getTextArena());
             return result;
         default:
             return nullptr;
@@ -360,6 +360,9 @@ bool MarkdownParserSections::sectionMetadataRule(
                 case MarkdownLexemType::META_PROPERTY_urgency:
                     meta.setUrgency(parsePropertyValueFraction(offset));
                     break;
+                case MarkdownLexemType::META_PROPERTY_id:
+                    meta.setId(static_cast<u_int32_t>(parsePropertyValueInteger(offset)));
+                    break;
                 case MarkdownLexemType::META_PROPERTY_scope:
                     meta.setTimeScope(parsePropertyValueTimeScope(offset));
                     break;
@@ -408,13 +411,9 @@ time_t MarkdownParserSections::parsePropertyValueTimestamp(size_t& offset)
 {
     const MarkdownLexem* valueLexem = parsePropertyValue(offset);
     if(valueLexem != nullptr) {
-        struct tm tm;
-        // C-style initialization as GCC doesn't like {}
-        memset(&tm, 0, sizeof tm);
         string* s = lexer.getText(valueLexem);
-        datetimeFrom(s->c_str(), &tm);
+        time_t result = datetimeSecondsFrom(s->c_str());
         delete s;
-        time_t result = datetimeSeconds(&tm);
         return result;
     }
     return 0;
@@ -602,7 +601,7 @@ vector<string*>* MarkdownParserSections::sectionBodyRule(size_t& offset)
         ++offset;
         switch(l->getType()) {
         case MarkdownLexemType::LINE:
-            if((s=lexer.getText(l))!=nullptr) {
+            if((s=lexer.getBodyText(l))!=nullptr) {
                 result->push_back(s);
             }
             // skip line's BR
@@ -610,7 +609,7 @@ vector<string*>* MarkdownParserSections::sectionBodyRule(size_t& offset)
             break;
         case MarkdownLexemType::BR:
             // empty line
-            if((s=lexer.getText(l))!=nullptr) {
+            if((s=lexer.getBodyText(l))!=nullptr) {
                 result->push_back(s);
             }
             break;
@@ -0,0 +1,530 @@
+/*
+ benchmark_gear.cpp     MindForger benchmark
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "benchmark_gear.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+#include "../../src/config/configuration.h"
+#include "../../src/install/installer.h"
+#include "../../src/gear/file_utils.h"
+
+namespace m8r {
+
+using namespace std;
+
+// fixed timestamp ~ generated repository doesn't depend on generation time
+static const char* TIMESTAMP = "2020-01-01 08:00:00";
+
+static const char* SYLLABLES[] = {
+    "ka", "lo", "mi", "nu", "pe", "ra", "si", "to", "vu", "ze",
+    "bar", "cor", "den", "fil", "gar", "hum", "jet", "kin", "lum", "mor"
+};
+static constexpr unsigned SYLLABLES_COUNT = sizeof(SYLLABLES)/sizeof(SYLLABLES[0]);
+static constexpr unsigned VOCABULARY_SIZE = 5000;
+
+void SyntheticRepositoryProfile::toJson(ostream& out) const
+{
+    out << "{\"notes\":" << notes
+        << ",\"notesPerOutline\":" << notesPerOutline
+        << ",\"tagsPerNote\":" << tagsPerNote
+        << ",\"tags\":" << tags
+        << ",\"linksPerNote\":" << linksPerNote
+        << ",\"wordsPerNote\":" << wordsPerNote
+        << ",\"seed\":" << seed << "}";
+}
+
+/*
+ * Generator
+ */
+
+SyntheticRepositoryGenerator::SyntheticRepositoryGenerator(const SyntheticRepositoryProfile& profile)
+    : profile(profile),
+      state{profile.seed},
+      vocabulary{}
+{
+    // vocabulary of unique pronounceable words
+    vocabulary.reserve(VOCABULARY_SIZE);
+    for(unsigned i=0; i<VOCABULARY_SIZE; i++) {
+        string w{};
+        unsigned v = i;
+        do {
+            w += SYLLABLES[v % SYLLABLES_COUNT];
+            v /= SYLLABLES_COUNT;
+        } while(v);
+        vocabulary.push_back(w);
+    }
+}
+
+uint32_t SyntheticRepositoryGenerator::next()
+{
+    // PCG32 (O'Neill) - the same sequence on all platforms
+    uint64_t old = state;
+    state = old * 6364136223846793005ULL + 1442695040888963407ULL;
+    uint32_t xorshifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = static_cast<uint32_t>(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((32-rot) & 31));
+}
+
+unsigned SyntheticRepositoryGenerator::nextSkewedBelow(unsigned bound)
+{
+    // product of two uniforms is skewed towards 0
+    uint64_t a = nextBelow(bound);
+    uint64_t b = nextBelow(bound);
+    return static_cast<unsigned>(a*b/bound);
+}
+
+unsigned SyntheticRepositoryGenerator::nextCount(float average)
+{
+    unsigned count = static_cast<unsigned>(average);
+    if(nextBelow(1000) < static_cast<unsigned>((average-count)*1000)) {
+        count++;
+    }
+    return count;
+}
+
+string SyntheticRepositoryGenerator::outlineFileName(unsigned o)
+{
+    return "o-" + std::to_string(o) + ".md";
+}
+
+string SyntheticRepositoryGenerator::noteName(unsigned o, unsigned n)
+{
+    return "Note " + std::to_string(o) + "." + std::to_string(n);
+}
+
+string SyntheticRepositoryGenerator::tag(unsigned t)
+{
+    return "tag-" + std::to_string(t);
+}
+
+string SyntheticRepositoryGenerator::outline(unsigned o, unsigned outlines)
+{
+    string md{};
+    md.reserve(profile.notesPerOutline*(profile.wordsPerNote*6+200));
+
+    md += "# Outline ";
+    md += std::to_string(o);
+    md += " <!-- Metadata: type: Outline; created: ";
+    md += TIMESTAMP;
+    md += "; reads: 1; read: ";
+    md += TIMESTAMP;
+    md += "; revision: 1; modified: ";
+    md += TIMESTAMP;
+    md += "; importance: 0/5; urgency: 0/5; progress: 0%; -->\n";
+    md += "Synthetic outline ";
+    md += word(o);
+    md += ".\n\n";
+
+    unsigned notes = std::min(profile.notesPerOutline, profile.notes - o*profile.notesPerOutline);
+    for(unsigned n=0; n<notes; n++) {
+        // depth 2..4 w/ children following parents
+        md.append(2 + (n ? nextBelow(3) : 0), '#');
+        md += ' ';
+        md += noteName(o, n);
+        md += " <!-- Metadata: type: Note; ";
+        unsigned tagsCount = nextCount(profile.tagsPerNote);
+        if(tagsCount && profile.tags) {
+            md += "tags: ";
+            for(unsigned t=0; t<tagsCount; t++) {
+                if(t) md += ',';
+                md += tag(nextSkewedBelow(profile.tags));
+            }
+            md += "; ";
+        }
+        md += "created: ";
+        md += TIMESTAMP;
+        md += "; reads: ";
+        md += std::to_string(1+nextBelow(100));
+        md += "; read: ";
+        md += TIMESTAMP;
+        md += "; revision: 1; modified: ";
+        md += TIMESTAMP;
+        md += "; progress: 0%; -->\n";
+
+        unsigned words = profile.wordsPerNote/2 + nextBelow(profile.wordsPerNote+1);
+        unsigned links = nextCount(profile.linksPerNote);
+        for(unsigned w=0; w<words; w++) {
+            md += word(nextSkewedBelow(VOCABULARY_SIZE));
+            if(links && nextBelow(words) < links) {
+                links--;
+                unsigned target = nextBelow(outlines);
+                md += " [Outline ";
+                md += std::to_string(target);
+                md += "](";
+                md += outlineFileName(target);
+                md += ")";
+            }
+            md += (w%12 == 11) ? ".\n" : " ";
+        }
+        md += "end.\n\n";
+    }
+
+    return md;
+}
+
+unsigned SyntheticRepositoryGenerator::generate(const string& directory)
+{
+    state = profile.seed;
+
+    removeDirectoryRecursively(directory.c_str());
+    Installer installer{};
+    if(!installer.createEmptyMindForgerRepository(directory)) {
+        return 0;
+    }
+
+    unsigned outlines = profile.notesPerOutline
+        ? (profile.notes + profile.notesPerOutline - 1) / profile.notesPerOutline
+        : 0;
+    for(unsigned o=0; o<outlines; o++) {
+        stringToFile(
+            directory + FILE_PATH_SEPARATOR + FILE_PATH_MEMORY + FILE_PATH_SEPARATOR + outlineFileName(o),
+            outline(o, outlines));
+    }
+    return outlines;
+}
+
+/*
+ * Build
+ */
+
+BenchmarkBuild::BenchmarkBuild()
+    :
+#ifdef MF_MD_2_HTML_CMARK
+      md2html{"cmark"},
+#else
+      md2html{"none"},
+#endif
+#ifdef __OPTIMIZE__
+      optimized{true},
+#else
+      optimized{false},
+#endif
+#ifdef DO_MF_DEBUG
+      debug{true},
+#else
+      debug{false},
+#endif
+#ifdef MF_NO_TRACING
+      tracing{false},
+#else
+      tracing{true},
+#endif
+#if defined(__VERSION__)
+      compiler{__VERSION__},
+#elif defined(_MSC_VER)
+      compiler{"MSVC " + std::to_string(_MSC_VER)},
+#else
+      compiler{"unknown"},
+#endif
+      cores{thread::hardware_concurrency()}
+{
+}
+
+string BenchmarkBuild::key() const
+{
+    return "md2html=" + md2html
+        + " optimized=" + (optimized?"1":"0")
+        + " debug=" + (debug?"1":"0")
+        + " tracing=" + (tracing?"1":"0");
+}
+
+void BenchmarkBuild::toJson(ostream& out) const
+{
+    out << "{\"md2html\":\"" << md2html << "\""
+        << ",\"optimized\":" << (optimized?"true":"false")
+        << ",\"debug\":" << (debug?"true":"false")
+        << ",\"tracing\":" << (tracing?"true":"false")
+        << ",\"compiler\":\"" << compiler << "\""
+        << ",\"cores\":" << cores << "}";
+}
+
+/*
+ * Suite
+ */
+
+constexpr const char* BenchmarkSuite::CALIBRATION;
+
+BenchmarkSuite::BenchmarkSuite(const SyntheticRepositoryProfile& profile, const string& filter)
+    : profile(profile),
+      build{},
+      filter{filter},
+      results{}
+{
+}
+
+bool BenchmarkSuite::isEnabled(const string& name) const
+{
+    return filter.empty() || name.find(filter) != string::npos;
+}
+
+void BenchmarkSuite::run(
+        const string& name,
+        unsigned iterations,
+        const function<void()>& benchmark,
+        const function<void()>& setup)
+{
+    if(!isEnabled(name) || !iterations) {
+        return;
+    }
+
+    cout << left << setw(32) << name << flush;
+    vector<double> times{};
+    for(unsigned i=0; i<iterations; i++) {
+        if(setup) {
+            setup();
+        }
+        auto begin = chrono::steady_clock::now();
+        benchmark();
+        auto end = chrono::steady_clock::now();
+        times.push_back(chrono::duration_cast<chrono::microseconds>(end-begin).count()/1000.0);
+    }
+
+    std::sort(times.begin(), times.end());
+    BenchmarkResult r{name, iterations, times.front(), 0., 0., times.back()};
+    r.median = times.size()%2
+        ? times[times.size()/2]
+        : (times[times.size()/2-1]+times[times.size()/2])/2.;
+    for(double t:times) {
+        r.mean += t;
+    }
+    r.mean /= times.size();
+    results.push_back(r);
+
+    cout << right << fixed << setprecision(3)
+         << setw(12) << r.median << "ms (median of " << iterations << ")" << endl;
+    cout.unsetf(ios_base::floatfield);
+}
+
+void BenchmarkSuite::calibrate(unsigned iterations)
+{
+    // string generation, sort and search ~ the kind of work MindForger does, but fixed
+    static volatile size_t checksum = 0;
+    const string savedFilter{filter};
+    filter.clear();
+    run(CALIBRATION, iterations, [&]() {
+        uint32_t state = 2020;
+        vector<string> words{};
+        words.reserve(100000);
+        for(unsigned i=0; i<100000; i++) {
+            string w{};
+            for(unsigned l=0; l<3; l++) {
+                state = state*1664525u + 1013904223u;
+                w += SYLLABLES[(state>>16) % SYLLABLES_COUNT];
+            }
+            words.push_back(w);
+        }
+        std::sort(words.begin(), words.end());
+        size_t matches = 0;
+        for(const string& w:words) {
+            if(w.find("mor") != string::npos) {
+                matches++;
+            }
+        }
+        checksum = checksum + matches;
+    });
+    filter = savedFilter;
+}
+
+void BenchmarkSuite::toJson(ostream& out) const
+{
+    // one result per line ~ easy to diff and to parse
+    out << "{" << endl
+        << "\"build\":";
+    build.toJson(out);
+    out << "," << endl
+        << "\"profile\":";
+    profile.toJson(out);
+    out << "," << endl
+        << "\"results\":[" << endl;
+    out << fixed << setprecision(3);
+    for(size_t i=0; i<results.size(); i++) {
+        const BenchmarkResult& r = results[i];
+        out << "{\"name\":\"" << r.name << "\""
+            << ",\"iterations\":" << r.iterations
+            << ",\"min\":" << r.min
+            << ",\"median\":" << r.median
+            << ",\"mean\":" << r.mean
+            << ",\"max\":" << r.max
+            << "}" << (i+1<results.size()?",":"") << endl;
+    }
+    out.unsetf(ios_base::floatfield);
+    out << "]" << endl
+        << "}" << endl;
+}
+
+static bool jsonNumber(const string& line, const string& key, double& value)
+{
+    size_t i = line.find("\"" + key + "\":");
+    if(i == string::npos) {
+        return false;
+    }
+    value = atof(line.c_str() + i + key.size() + 3);
+    return true;
+}
+
+static string jsonString(const string& line, const string& key)
+{
+    size_t b = line.find("\"" + key + "\":\"");
+    if(b == string::npos) {
+        return string{};
+    }
+    b += key.size() + 4;
+    size_t e = line.find('"', b);
+    return e == string::npos ? string{} : line.substr(b, e-b);
+}
+
+static bool jsonBool(const string& line, const string& key)
+{
+    return line.find("\"" + key + "\":true") != string::npos;
+}
+
+bool BenchmarkSuite::fromJson(const string& fileName, BenchmarkBaseline& baseline)
+{
+    ifstream in{fileName};
+    if(!in.good()) {
+        return false;
+    }
+
+    string line{};
+    while(getline(in, line)) {
+        if(line.compare(0, 9, "\"build\":{") == 0) {
+            BenchmarkBuild build{};
+            build.md2html = jsonString(line, "md2html");
+            build.optimized = jsonBool(line, "optimized");
+            build.debug = jsonBool(line, "debug");
+            build.tracing = jsonBool(line, "tracing");
+            baseline.buildKey = build.key();
+            baseline.compiler = jsonString(line, "compiler");
+            continue;
+        }
+        if(line.compare(0, 10, "\"profile\":") == 0) {
+            baseline.profile = line.substr(10);
+            if(baseline.profile.size() && baseline.profile.back() == ',') {
+                baseline.profile.pop_back();
+            }
+            continue;
+        }
+
+        size_t b = line.find("{\"name\":\"");
+        if(b == string::npos) {
+            continue;
+        }
+        b += 9;
+        size_t e = line.find('"', b);
+        if(e == string::npos) {
+            continue;
+        }
+
+        BenchmarkResult r{line.substr(b, e-b), 0, 0., 0., 0., 0.};
+        double iterations = 0;
+        jsonNumber(line, "iterations", iterations);
+        r.iterations = static_cast<unsigned>(iterations);
+        jsonNumber(line, "min", r.min);
+        jsonNumber(line, "mean", r.mean);
+        jsonNumber(line, "max", r.max);
+        if(jsonNumber(line, "median", r.median)) {
+            baseline.results[r.name] = r;
+        }
+    }
+    return true;
+}
+
+bool BenchmarkSuite::isComparable(const BenchmarkBaseline& baseline, ostream& out) const
+{
+    bool comparable = true;
+    if(baseline.buildKey.empty() || baseline.buildKey != build.key()) {
+        out << "Baseline build configuration differs:" << endl
+            << "  baseline: " << (baseline.buildKey.empty()?"unknown":baseline.buildKey) << endl
+            << "  current : " << build.key() << endl;
+        comparable = false;
+    }
+    if(baseline.compiler != build.compiler) {
+        out << "Baseline compiler differs (compared w/ calibration):" << endl
+            << "  baseline: " << baseline.compiler << endl
+            << "  current : " << build.compiler << endl;
+    }
+    ostringstream currentProfile{};
+    profile.toJson(currentProfile);
+    if(baseline.profile != currentProfile.str()) {
+        out << "Baseline synthetic repository profile differs:" << endl
+            << "  baseline: " << baseline.profile << endl
+            << "  current : " << currentProfile.str() << endl;
+        comparable = false;
+    }
+    if(baseline.results.find(CALIBRATION) == baseline.results.end()) {
+        out << "Baseline has no calibration" << endl;
+        comparable = false;
+    }
+    return comparable;
+}
+
+unsigned BenchmarkSuite::compare(
+        const BenchmarkBaseline& baseline,
+        double tolerance,
+        double minDelta,
+        ostream& out) const
+{
+    // baseline medians are scaled to this machine by the ratio of calibrations
+    double scale = 1.;
+    auto bc = baseline.results.find(CALIBRATION);
+    for(const BenchmarkResult& r:results) {
+        if(r.name == CALIBRATION && bc != baseline.results.end() && bc->second.median > 0) {
+            scale = r.median / bc->second.median;
+        }
+    }
+
+    unsigned regressions = 0;
+    out << "Baseline scaled by calibration ratio " << fixed << setprecision(3) << scale << endl;
+    out << left << setw(32) << "benchmark" << right
+        << setw(14) << "baseline [ms]"
+        << setw(14) << "current [ms]"
+        << setw(10) << "change" << endl;
+    for(const BenchmarkResult& r:results) {
+        if(r.name == CALIBRATION) {
+            continue;
+        }
+        auto b = baseline.results.find(r.name);
+        if(b == baseline.results.end()) {
+            out << left << setw(32) << r.name << right << setw(14) << "-" << setw(14) << r.median << setw(10) << "NEW" << endl;
+            continue;
+        }
+
+        double expected = b->second.median * scale;
+        double change = expected > 0 ? (r.median - expected)/expected : 0.;
+        bool regression = change > tolerance && r.median - expected > minDelta;
+        if(regression) {
+            regressions++;
+        }
+        out << left << setw(32) << r.name << right
+            << setw(14) << expected
+            << setw(14) << r.median
+            << setw(9) << setprecision(1) << change*100 << "%" << setprecision(3)
+            << (regression?"  REGRESSION":"") << endl;
+    }
+    out.unsetf(ios_base::floatfield);
+    return regressions;
+}
+
+} // m8r namespace
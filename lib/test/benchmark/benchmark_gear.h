@@ -0,0 +1,233 @@
+/*
+ benchmark_gear.h     MindForger benchmark
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+#ifndef M8R_BENCHMARK_GEAR_H
+#define M8R_BENCHMARK_GEAR_H
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace m8r {
+
+/**
+ * @brief Shape of generated synthetic repository.
+ */
+struct SyntheticRepositoryProfile
+{
+    unsigned notes;
+    unsigned notesPerOutline;
+    // average number of tags per N and size of tags vocabulary
+    float tagsPerNote;
+    unsigned tags;
+    // average number of links to other Os per N
+    float linksPerNote;
+    // average number of words in N description
+    unsigned wordsPerNote;
+    uint32_t seed;
+
+    explicit SyntheticRepositoryProfile()
+        : notes{1000},
+          notesPerOutline{50},
+          tagsPerNote{.5f},
+          tags{100},
+          linksPerNote{.2f},
+          wordsPerNote{80},
+          seed{2020}
+    {}
+
+    void toJson(std::ostream& out) const;
+};
+
+/**
+ * @brief Deterministic generator of synthetic MindForger repositories.
+ *
+ * The same profile generates byte-to-byte identical repository on any
+ * platform (own PRNG and distributions are used, not std:: ones which
+ * are implementation specific).
+ */
+class SyntheticRepositoryGenerator
+{
+private:
+    const SyntheticRepositoryProfile& profile;
+    uint64_t state;
+
+    std::vector<std::string> vocabulary;
+
+public:
+    explicit SyntheticRepositoryGenerator(const SyntheticRepositoryProfile& profile);
+    SyntheticRepositoryGenerator(const SyntheticRepositoryGenerator&) = delete;
+    SyntheticRepositoryGenerator(const SyntheticRepositoryGenerator&&) = delete;
+    SyntheticRepositoryGenerator &operator=(const SyntheticRepositoryGenerator&) = delete;
+    SyntheticRepositoryGenerator &operator=(const SyntheticRepositoryGenerator&&) = delete;
+    ~SyntheticRepositoryGenerator() {}
+
+    /**
+     * @brief Create MindForger repository w/ synthetic Os in given directory.
+     *
+     * @return Number of generated Os.
+     */
+    unsigned generate(const std::string& directory);
+
+    static std::string outlineFileName(unsigned o);
+    static std::string noteName(unsigned o, unsigned n);
+
+    /**
+     * @brief Word of the vocabulary - it is used to craft FTS queries which match.
+     */
+    const std::string& word(size_t i) const { return vocabulary[i%vocabulary.size()]; }
+    static std::string tag(unsigned t);
+
+private:
+    uint32_t next();
+    unsigned nextBelow(unsigned bound) { return next() % bound; }
+    // Zipf-like skew: low indices are picked much more often (like common words)
+    unsigned nextSkewedBelow(unsigned bound);
+    // round average to integer count w/ probability of the fractional part
+    unsigned nextCount(float average);
+
+    std::string outline(unsigned o, unsigned outlines);
+};
+
+/**
+ * @brief Build configuration of benchmarks - only results of the same configuration are comparable.
+ */
+struct BenchmarkBuild
+{
+    // Markdown to HTML transcoder: cmark or none
+    std::string md2html;
+    bool optimized;
+    bool debug;
+    bool tracing;
+    std::string compiler;
+    unsigned cores;
+
+    explicit BenchmarkBuild();
+
+    /**
+     * @brief Configuration w/o machine specific fields (compiler, cores).
+     *
+     * Calibration compensates for different machines and compiler versions,
+     * therefore baselines committed to the repository stay comparable.
+     */
+    std::string key() const;
+    void toJson(std::ostream& out) const;
+};
+
+/**
+ * @brief Benchmark measurement.
+ */
+struct BenchmarkResult
+{
+    std::string name;
+    unsigned iterations;
+    double min;
+    double median;
+    double mean;
+    double max;
+};
+
+/**
+ * @brief Results loaded from JSON w/ build configuration and profile they were measured with.
+ */
+struct BenchmarkBaseline
+{
+    std::string buildKey;
+    std::string compiler;
+    std::string profile;
+    std::map<std::string,BenchmarkResult> results;
+};
+
+/**
+ * @brief Benchmark runner w/ JSON report and baseline comparison.
+ *
+ * Times are in milliseconds. Median is compared with baseline as it's the
+ * least sensitive statistic to noisy neighbours. Absolute times are machine
+ * specific, therefore every run measures fixed calibration workload and
+ * baseline medians are scaled by the ratio of calibration medians before
+ * they are compared.
+ */
+class BenchmarkSuite
+{
+public:
+    static constexpr const char* CALIBRATION = "calibration";
+
+private:
+    const SyntheticRepositoryProfile& profile;
+    const BenchmarkBuild build;
+    std::string filter;
+    std::vector<BenchmarkResult> results;
+
+public:
+    explicit BenchmarkSuite(const SyntheticRepositoryProfile& profile, const std::string& filter);
+    BenchmarkSuite(const BenchmarkSuite&) = delete;
+    BenchmarkSuite(const BenchmarkSuite&&) = delete;
+    BenchmarkSuite &operator=(const BenchmarkSuite&) = delete;
+    BenchmarkSuite &operator=(const BenchmarkSuite&&) = delete;
+    ~BenchmarkSuite() {}
+
+    bool isEnabled(const std::string& name) const;
+
+    /**
+     * @brief Measure iterations of benchmark - setup is called before each iteration and it's not measured.
+     */
+    void run(
+            const std::string& name,
+            unsigned iterations,
+            const std::function<void()>& benchmark,
+            const std::function<void()>& setup = nullptr);
+
+    /**
+     * @brief Measure fixed CPU and memory bound workload which doesn't depend on MindForger code.
+     */
+    void calibrate(unsigned iterations);
+
+    const std::vector<BenchmarkResult>& getResults() const { return results; }
+    const BenchmarkBuild& getBuild() const { return build; }
+
+    void toJson(std::ostream& out) const;
+
+    /**
+     * @brief Load results from JSON written by toJson().
+     */
+    static bool fromJson(const std::string& fileName, BenchmarkBaseline& baseline);
+
+    /**
+     * @brief Check that baseline was measured by the same build configuration and profile.
+     */
+    bool isComparable(const BenchmarkBaseline& baseline, std::ostream& out) const;
+
+    /**
+     * @brief Compare results w/ baseline (scaled by calibration) and print report.
+     *
+     * @param tolerance Allowed slowdown e.g. 0.2 for 20%.
+     * @param minDelta Slowdown (ms) under which difference is considered as noise.
+     * @return Number of regressions.
+     */
+    unsigned compare(
+            const BenchmarkBaseline& baseline,
+            double tolerance,
+            double minDelta,
+            std::ostream& out) const;
+};
+
+}
+#endif // M8R_BENCHMARK_GEAR_H
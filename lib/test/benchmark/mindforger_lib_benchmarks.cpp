@@ -0,0 +1,335 @@
+/*
+ mindforger_lib_benchmarks.cpp     MindForger benchmark
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+
+#include "benchmark_gear.h"
+
+#include "../../src/version.h"
+#include "../../src/config/configuration.h"
+#include "../../src/mind/mind.h"
+#include "../../src/mind/ai/ai_aa_weighted_fts.h"
+#include "../../src/representations/html/html_outline_representation.h"
+#include "../../src/representations/markdown/markdown_outline_representation.h"
+#ifdef MF_MD_2_HTML_CMARK
+  #include "../../src/mind/ai/autolinking/cmark_aho_corasick_block_autolinking_preprocessor.h"
+#else
+  #include "../../src/mind/ai/autolinking/naive_autolinking_preprocessor.h"
+#endif
+
+using namespace std;
+using namespace m8r;
+
+static void usage()
+{
+    cout << "MindForger library benchmarks " << MINDFORGER_VERSION << endl
+         << endl
+         << "Usage: mindforger-lib-benchmarks [options]" << endl
+         << endl
+         << "Synthetic repository:" << endl
+         << "  --notes <n>              number of Ns (default 1000)" << endl
+         << "  --notes-per-outline <n>  Ns per O (default 50)" << endl
+         << "  --tags-per-note <f>      average tags per N (default 0.5)" << endl
+         << "  --tags <n>               tags vocabulary size (default 100)" << endl
+         << "  --links-per-note <f>     average links per N (default 0.2)" << endl
+         << "  --words-per-note <n>     average words per N (default 80)" << endl
+         << "  --seed <n>               generator seed (default 2020)" << endl
+         << "  --repository <dir>       where to generate repository (default /tmp/mf-benchmark-<notes>)" << endl
+         << endl
+         << "Run:" << endl
+         << "  --iterations <n>         iterations of each benchmark (default 5)" << endl
+         << "  --filter <substring>     run only benchmarks w/ matching name" << endl
+         << "  --output <file>          write results as JSON" << endl
+         << "  --baseline <file>        compare results w/ baseline JSON" << endl
+         << "  --tolerance <f>          allowed slowdown (default 0.2 ~ 20%)" << endl
+         << "  --min-delta <ms>         ignore slowdowns smaller than (default 1ms)" << endl
+         << endl
+         << "Baseline is compared only if it was measured by the same build configuration" << endl
+         << "(Markdown to HTML transcoder, optimization, debug, tracing) and profile, baseline" << endl
+         << "times are scaled to this machine and compiler by the ratio of calibration workload times." << endl
+         << endl
+         << "Exit code is 2 if a regression is detected, 3 if baseline is not comparable." << endl;
+}
+
+int main(int argc, char** argv)
+{
+    SyntheticRepositoryProfile profile{};
+    string repositoryPath{};
+    unsigned iterations = 5;
+    string filter{};
+    string output{};
+    string baselinePath{};
+    double tolerance = .2;
+    double minDelta = 1.;
+
+    for(int i=1; i<argc; i++) {
+        string option{argv[i]};
+        if(option == "-h" || option == "--help") {
+            usage();
+            return 0;
+        }
+        if(i+1 >= argc) {
+            cerr << "Missing value of option: " << option << endl;
+            return 1;
+        }
+        const char* value = argv[++i];
+        if(option == "--notes") {
+            profile.notes = static_cast<unsigned>(atoi(value));
+        } else if(option == "--notes-per-outline") {
+            profile.notesPerOutline = static_cast<unsigned>(atoi(value));
+        } else if(option == "--tags-per-note") {
+            profile.tagsPerNote = static_cast<float>(atof(value));
+        } else if(option == "--tags") {
+            profile.tags = static_cast<unsigned>(atoi(value));
+        } else if(option == "--links-per-note") {
+            profile.linksPerNote = static_cast<float>(atof(value));
+        } else if(option == "--words-per-note") {
+            profile.wordsPerNote = static_cast<unsigned>(atoi(value));
+        } else if(option == "--seed") {
+            profile.seed = static_cast<uint32_t>(atol(value));
+        } else if(option == "--repository") {
+            repositoryPath = value;
+        } else if(option == "--iterations") {
+            iterations = static_cast<unsigned>(atoi(value));
+        } else if(option == "--filter") {
+            filter = value;
+        } else if(option == "--output") {
+            output = value;
+        } else if(option == "--baseline") {
+            baselinePath = value;
+        } else if(option == "--tolerance") {
+            tolerance = atof(value);
+        } else if(option == "--min-delta") {
+            minDelta = atof(value);
+        } else {
+            cerr << "Unknown option: " << option << endl;
+            usage();
+            return 1;
+        }
+    }
+    if(!profile.notes || !profile.notesPerOutline || !iterations) {
+        cerr << "Number of Ns, Ns per O and iterations must be positive" << endl;
+        return 1;
+    }
+    if(repositoryPath.empty()) {
+        repositoryPath = "/tmp/mf-benchmark-" + std::to_string(profile.notes);
+    }
+
+    /*
+     * Repository
+     */
+
+    SyntheticRepositoryGenerator generator{profile};
+    cout << "Generating " << profile.notes << " Ns repository to " << repositoryPath << "..." << endl;
+    unsigned outlines = generator.generate(repositoryPath);
+    if(!outlines) {
+        cerr << "Unable to generate repository: " << repositoryPath << endl;
+        return 1;
+    }
+
+    Configuration& config = Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath(repositoryPath + ".cfg.md");
+    config.setActiveRepository(config.addRepository(RepositoryIndexer::getRepositoryForPath(repositoryPath)));
+    config.setAaAlgorithm(Configuration::AssociationAssessmentAlgorithm::BOW);
+
+    BenchmarkSuite suite{profile, filter};
+    cout << "Build: " << suite.getBuild().key() << endl;
+    suite.calibrate(iterations);
+    unique_ptr<Mind> mind{new Mind{config}};
+
+    /*
+     * Memory
+     */
+
+    suite.run("learn", iterations, [&]() { mind->learn(); });
+    if(!suite.isEnabled("learn")) {
+        mind->learn();
+    }
+    cout << "  " << mind->remind().getOutlinesCount() << " Os / " << mind->remind().getNotesCount() << " Ns" << endl;
+    if(mind->remind().getOutlinesCount() != outlines) {
+        cerr << "Generated repository was not learned: " << mind->remind().getOutlinesCount() << " Os" << endl;
+        return 1;
+    }
+
+    // recent Ns: sort of all Ns vs. memory dwell top K
+    suite.run("recent notes sort", iterations, [&]() {
+        vector<Note*> notes{};
+        mind->getAllNotes(notes, true, true);
+    });
+    suite.run("recent notes dwell", iterations, [&]() {
+        vector<Note*> notes{};
+        mind->getMemoryDwell(notes, static_cast<size_t>(config.getRecentNotesUiLimit()), true);
+    });
+
+    /*
+     * FTS
+     */
+
+    string common{generator.word(1)};
+    string rare{generator.word(3000)};
+    string regexp{generator.word(2) + ".*" + generator.word(3)};
+    auto fts = [&](const string& pattern, FtsSearch mode) {
+        vector<Note*>* result = mind->findNoteFts(pattern, mode);
+        delete result;
+    };
+    suite.run("fts exact", iterations, [&]() { fts(common, FtsSearch::EXACT); fts(rare, FtsSearch::EXACT); });
+    suite.run("fts ignore case", iterations, [&]() { fts(common, FtsSearch::IGNORE_CASE); fts(rare, FtsSearch::IGNORE_CASE); });
+    suite.run("fts regexp", iterations, [&]() { fts(regexp, FtsSearch::REGEXP); });
+
+    /*
+     * Tags
+     */
+
+    vector<const Tag*> frequentTags{};
+    frequentTags.push_back(mind->remind().getOntology().findOrCreateTag(SyntheticRepositoryGenerator::tag(0)));
+    vector<const Tag*> rareTags{};
+    rareTags.push_back(mind->remind().getOntology().findOrCreateTag(SyntheticRepositoryGenerator::tag(profile.tags ? profile.tags-1 : 0)));
+    suite.run("tags notes", iterations, [&]() {
+        vector<Note*> result{};
+        mind->findNotesByTags(frequentTags, result);
+        result.clear();
+        mind->findNotesByTags(rareTags, result);
+    });
+    suite.run("tags outlines", iterations, [&]() {
+        vector<Outline*> result{};
+        mind->findOutlinesByTags(frequentTags, result);
+    });
+    suite.run("tags cardinality", iterations, [&]() {
+        map<const Tag*,int> cardinality{};
+        mind->getTagsCardinality(cardinality);
+    });
+
+    /*
+     * Representations
+     */
+
+    MarkdownOutlineRepresentation markdownRepresentation{mind->remind().getOntology(), nullptr};
+    suite.run("markdown serialize", iterations, [&]() {
+        for(Outline* o:mind->remind().getOutlines()) {
+            delete markdownRepresentation.to(o);
+        }
+    });
+
+    HtmlOutlineRepresentation htmlRepresentation{mind->remind().getOntology(), nullptr};
+    suite.run("markdown to html", iterations, [&]() {
+        string html{};
+        for(Outline* o:mind->remind().getOutlines()) {
+            html.clear();
+            htmlRepresentation.to(o, &html, false, false, true, true);
+        }
+    });
+
+    suite.run("save", iterations, [&]() {
+        for(Outline* o:mind->remind().getOutlines()) {
+            mind->remind().remember(o);
+        }
+    });
+
+    /*
+     * AI
+     */
+
+    // think as you write: cold text cache, warm text cache w/ new words and leaderboards cache
+    AiAaWeightedFts weightedFts{mind->remind(), *mind};
+    const size_t WORDS = 10;
+    size_t round = 0;
+    auto ftsWords = [&](size_t offset) {
+        for(size_t i=0; i<WORDS; i++) {
+            vector<pair<Note*,float>> associations{};
+            weightedFts.getAssociatedNotes(generator.word(7*(offset+i)), associations, static_cast<const Note*>(nullptr)).get();
+        }
+    };
+    suite.run("aa fts words cold", iterations, [&]() { ftsWords(0); }, [&]() { weightedFts.sleep(); });
+    suite.run("aa fts words", iterations, [&]() { ftsWords(WORDS*++round); });
+    suite.run("aa fts words cached", iterations, [&]() { ftsWords(0); });
+
+    if(suite.isEnabled("aa") || suite.isEnabled("autolinking")) {
+        suite.run("aa dream", iterations, [&]() { mind->think().get(); }, [&]() { mind->sleep(); });
+        mind->think().get();
+
+        // leaderboards of Ns from different Os - cache is dropped by re-dreaming
+        vector<Note*> notes{};
+        mind->remind().getAllNotes(notes);
+        const size_t LEADERBOARDS = 20;
+        suite.run(
+            "aa leaderboard",
+            iterations,
+            [&]() {
+                for(size_t i=0; i<LEADERBOARDS && i<notes.size(); i++) {
+                    AssociatedNotes associations{ResourceType::NOTE, notes[(i*notes.size())/LEADERBOARDS]};
+                    mind->getAssociatedNotes(associations).get();
+                }
+            },
+            [&]() { mind->sleep(); mind->think().get(); });
+
+#ifdef MF_MD_2_HTML_CMARK
+        CmarkAhoCorasickBlockAutolinkingPreprocessor autolinker{*mind};
+#else
+        NaiveAutolinkingPreprocessor autolinker{*mind};
+#endif
+        // Ns are autolinked one by one when viewed - sample of Ns keeps benchmark linear in repository size
+        const size_t AUTOLINKED_NOTES = 1000;
+        vector<Note*> autolinked{};
+        for(size_t i=0; i<AUTOLINKED_NOTES && i<notes.size(); i++) {
+            autolinked.push_back(notes[(i*notes.size())/min(AUTOLINKED_NOTES, notes.size())]);
+        }
+        suite.run("autolinking", iterations, [&]() {
+            string amd{};
+            for(Note* n:autolinked) {
+                amd.clear();
+                autolinker.process(n->getDescription(), amd);
+            }
+        });
+    }
+
+    /*
+     * Report
+     */
+
+    if(!output.empty()) {
+        ofstream out{output};
+        suite.toJson(out);
+        cout << "Results written to " << output << endl;
+    }
+
+    if(!baselinePath.empty()) {
+        BenchmarkBaseline baseline{};
+        if(!BenchmarkSuite::fromJson(baselinePath, baseline)) {
+            cerr << "Unable to read baseline: " << baselinePath << endl;
+            return 1;
+        }
+        cout << endl;
+        if(!suite.isComparable(baseline, cout)) {
+            cout << "Baseline " << baselinePath << " NOT compared" << endl;
+            return 3;
+        }
+        unsigned regressions = suite.compare(baseline, tolerance, minDelta, cout);
+        if(regressions) {
+            cout << endl << regressions << " REGRESSION(S) detected" << endl;
+            return 2;
+        }
+    }
+
+    return 0;
+}
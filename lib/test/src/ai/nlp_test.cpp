@@ -22,10 +22,16 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <thread>
+
+#include <sys/stat.h>
+#include <utime.h>
 
 #include "../../../src/config/configuration.h"
 #include "../../../src/mind/mind.h"
 #include "../../../src/mind/ai/ai.h"
+#include "../../../src/mind/ai/ai_aa_weighted_fts.h"
+#include "../../../src/mind/ai/aa_model.h"
 #include "../../../src/mind/ai/nlp/stemmer/stemmer.h"
 #include "../../../src/mind/ai/nlp/string_char_provider.h"
 #include "../../../src/mind/ai/nlp/note_char_provider.h"
@@ -33,6 +39,8 @@
 #include "../../../src/mind/ai/nlp/lexicon.h"
 #include "../../../src/mind/ai/nlp/word_frequency_list.h"
 #include "../../../src/mind/ai/nlp/bag_of_words.h"
+#include "../../../src/install/installer.h"
+#include "../../../src/gear/file_utils.h"
 
 #include <gtest/gtest.h>
 
@@ -200,6 +208,32 @@ TEST(AiNlpTestCase, Tokenizer)
     }
     cout << narrowed << endl << "- END char stream --" << endl;
     ASSERT_EQ(146, narrowed.size());
+
+    // test in place N tokenization gives the same tokens as char stream tokenization
+    m8r::Lexicon lexicon{};
+    m8r::CommonWordsBlacklist blacklist{};
+    m8r::MarkdownTokenizer tokenizer{lexicon, blacklist};
+    m8r::NoteCharProvider chars{n};
+    m8r::WordFrequencyList streamed{&lexicon};
+    tokenizer.tokenize(chars, streamed);
+    m8r::WordFrequencyList inPlace{&lexicon};
+    tokenizer.tokenize(n, inPlace);
+    ASSERT_LT(0, streamed.size());
+    ASSERT_EQ(streamed.size(), inPlace.size());
+    for(auto& e:streamed.iterable()) {
+        ASSERT_TRUE(inPlace.contains(e.first));
+        EXPECT_EQ(e.second, inPlace.iterable().at(e.first));
+    }
+    // 2nd tokenization is served by stem cache
+    EXPECT_LT(0, tokenizer.getStemCache().getHits());
+    EXPECT_EQ(tokenizer.getStemCache().getMisses(), tokenizer.getStemCache().size());
+
+    // last word of a string is tokenized as well
+    m8r::WordFrequencyList title{&lexicon};
+    tokenizer.tokenize(string{"Self-awareness of AI"}, title, false, true, false);
+    EXPECT_EQ(3, title.size());
+    EXPECT_TRUE(title.contains(&lexicon.get("ai")->word));
+    EXPECT_TRUE(title.contains(&lexicon.get("self-awareness")->word));
 }
 
 // IMPROVE disabled as AA API changed - it will be re-enable once BoW becomes main AA algorithm again
@@ -294,6 +328,376 @@ TEST(AiNlpTestCase, DISABLED_AaUniverseBow)
     ASSERT_EQ("Alternative Universe", (*leaderboard)[1].first->getOutline()->getName());
 }
 
+TEST(AiNlpTestCase, AaBowSnapshot)
+{
+    string repositoryPath{"/lib/test/resources/aa-repository"};
+    repositoryPath.insert(0, getMindforgerGitHomePath());
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-antc-abs.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath)));
+    config.setAaAlgorithm(m8r::Configuration::AssociationAssessmentAlgorithm::BOW);
+
+    m8r::Mind mind(config);
+    ASSERT_TRUE(mind.learn());
+    shared_future<bool> readyToThink = mind.think();
+    ASSERT_EQ(true, readyToThink.get()); // blocked
+    ASSERT_EQ(m8r::Configuration::MindState::THINKING, config.getMindState());
+
+    m8r::Note* n=mind.remind().getOutlines()[0]->getNotes()[0];
+    ASSERT_NE(nullptr, n);
+
+    // 1st query calculates leaderboard asynchronously
+    m8r::AssociatedNotes associations{m8r::ResourceType::NOTE, n};
+    ASSERT_TRUE(mind.getAssociatedNotes(associations).get()); // blocked
+
+    // 2nd query is served from published snapshot
+    m8r::AssociatedNotes cached{m8r::ResourceType::NOTE, n};
+    shared_future<bool> cachedFuture = mind.getAssociatedNotes(cached);
+    ASSERT_EQ(future_status::ready, cachedFuture.wait_for(chrono::seconds(0)));
+    ASSERT_TRUE(cachedFuture.get());
+    ASSERT_LT(0, cached.getAssociations()->size());
+    for(auto& a:*cached.getAssociations()) {
+        EXPECT_NE(n, a.first);
+    }
+
+    // snapshot is dropped on sleep
+    ASSERT_TRUE(mind.sleep());
+    m8r::AssociatedNotes asleep{m8r::ResourceType::NOTE, n};
+    ASSERT_FALSE(mind.getAssociatedNotes(asleep).get());
+}
+
+TEST(AiNlpTestCase, AaBowSupersede)
+{
+    // AA matrix rows longer than cancellation stride
+    string repositoryDir{"/tmp/mf-unit-repository-aa-bow-supersede"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    for(int o=0; o<3; o++) {
+        string md{"# Outline "};
+        md += std::to_string(o);
+        md += "\n\n";
+        for(int n=0; n<100; n++) {
+            md += "## Note " + std::to_string(o) + "." + std::to_string(n) + "\n";
+            md += "Lorem ipsum dolor sit amet " + std::to_string(n%7) + " consectetur.\n\n";
+        }
+        m8r::stringToFile(repositoryDir+"/memory/o-"+std::to_string(o)+".md", md);
+    }
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-antc-abss.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    config.setAaAlgorithm(m8r::Configuration::AssociationAssessmentAlgorithm::BOW);
+
+    m8r::Mind mind(config);
+    ASSERT_TRUE(mind.learn());
+    ASSERT_EQ(true, mind.think().get());
+    ASSERT_LT(256, mind.remind().getNotesCount()); // AA_CANCELLATION_STRIDE
+
+    // each query supersedes the previous one - only the latest leaderboard is guaranteed to be published
+    vector<shared_future<bool>> futures{};
+    vector<m8r::AssociatedNotes*> queries{};
+    for(m8r::Note* q:mind.remind().getOutlines()[0]->getNotes()) {
+        queries.push_back(new m8r::AssociatedNotes{m8r::ResourceType::NOTE, q});
+        futures.push_back(mind.getAssociatedNotes(*queries.back()));
+    }
+    ASSERT_TRUE(futures.back().get());
+    for(size_t i=0; i<queries.size(); i++) {
+        bool published = futures[i].get();
+        m8r::AssociatedNotes again{m8r::ResourceType::NOTE, queries[i]->getNote()};
+        shared_future<bool> againFuture = mind.getAssociatedNotes(again);
+        if(published) {
+            // published leaderboard is served from snapshot
+            EXPECT_EQ(future_status::ready, againFuture.wait_for(chrono::seconds(0)));
+        } else {
+            // superseded leaderboard is calculated again when asked for
+            EXPECT_TRUE(againFuture.get());
+        }
+        m8r::AssociatedNotes cached{m8r::ResourceType::NOTE, queries[i]->getNote()};
+        EXPECT_EQ(future_status::ready, mind.getAssociatedNotes(cached).wait_for(chrono::seconds(0)));
+        EXPECT_LT(0, cached.getAssociations()->size());
+        delete queries[i];
+    }
+
+    // concurrent callers don't supersede each other and share leaderboard being calculated
+    const vector<m8r::Note*>& others = mind.remind().getOutlines()[1]->getNotes();
+    vector<thread> callers{};
+    vector<int> published(4, 0);
+    for(int c=0; c<4; c++) {
+        callers.push_back(thread{[&mind, &others, &published, c]() {
+            m8r::AssociatedNotes associated{m8r::ResourceType::NOTE, others[c%2]};
+            published[c] = mind.getAssociatedNotes(associated).get();
+        }});
+    }
+    for(thread& c:callers) {
+        c.join();
+    }
+    for(int c=0; c<4; c++) {
+        EXPECT_TRUE(published[c]) << c;
+    }
+}
+
+TEST(AiNlpTestCase, AaBowInterrupt)
+{
+    // AA matrix rows long enough to be interrupted
+    string repositoryDir{"/tmp/mf-unit-repository-aa-bow-interrupt"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    for(int o=0; o<6; o++) {
+        string md{"# Outline "};
+        md += std::to_string(o);
+        md += "\n\n";
+        for(int n=0; n<100; n++) {
+            md += "## Note " + std::to_string(o) + "." + std::to_string(n) + "\n";
+            md += "Lorem ipsum dolor sit amet " + std::to_string(n%7) + " consectetur.\n\n";
+        }
+        m8r::stringToFile(repositoryDir+"/memory/o-"+std::to_string(o)+".md", md);
+    }
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-antc-abi.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    config.setAaAlgorithm(m8r::Configuration::AssociationAssessmentAlgorithm::BOW);
+
+    m8r::Mind mind(config);
+    ASSERT_TRUE(mind.learn());
+    ASSERT_EQ(true, mind.think().get());
+    ASSERT_EQ(600, mind.remind().getNotesCount());
+
+    // the 1st leaderboard calculation is superseded by the 2nd one
+    const vector<m8r::Note*>& notes = mind.remind().getOutlines()[0]->getNotes();
+    m8r::AssociatedNotes first{m8r::ResourceType::NOTE, notes[0]};
+    shared_future<bool> firstFuture = mind.getAssociatedNotes(first);
+    m8r::AssociatedNotes second{m8r::ResourceType::NOTE, notes[1]};
+    shared_future<bool> secondFuture = mind.getAssociatedNotes(second);
+
+    // sleep interrupts running calculations and waits for them
+    ASSERT_TRUE(mind.sleep());
+    EXPECT_EQ(m8r::Configuration::MindState::SLEEPING, config.getMindState());
+    EXPECT_EQ(future_status::ready, firstFuture.wait_for(chrono::seconds(0)));
+    EXPECT_EQ(future_status::ready, secondFuture.wait_for(chrono::seconds(0)));
+
+    // mind can think again after interruption
+    ASSERT_EQ(true, mind.think().get());
+    m8r::AssociatedNotes calculated{m8r::ResourceType::NOTE, notes[0]};
+    ASSERT_TRUE(mind.getAssociatedNotes(calculated).get());
+    m8r::AssociatedNotes again{m8r::ResourceType::NOTE, notes[0]};
+    ASSERT_TRUE(mind.getAssociatedNotes(again).get());
+    EXPECT_LT(0, again.getAssociations()->size());
+
+    // learning interrupts thinking instead of failing
+    m8r::AssociatedNotes pending{m8r::ResourceType::NOTE, notes[2]};
+    shared_future<bool> pendingFuture = mind.getAssociatedNotes(pending);
+    ASSERT_TRUE(mind.learn());
+    EXPECT_EQ(future_status::ready, pendingFuture.wait_for(chrono::seconds(0)));
+}
+
+TEST(AiNlpTestCase, AaWeightedFtsCache)
+{
+    // repository large enough to be assessed in parallel
+    string repositoryDir{"/tmp/mf-unit-repository-aa-wfts"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    for(int o=0; o<30; o++) {
+        string md{"# Outline "};
+        md += std::to_string(o);
+        md += "\n\n";
+        for(int n=0; n<100; n++) {
+            md += "## Note " + std::to_string(o) + "." + std::to_string(n) + "\n";
+            md += "Lorem ipsum dolor sit amet.\n";
+            if(o%10==3 && n==7) {
+                md += "Needle and NEEDLE.\n";
+            }
+            md += "\n";
+        }
+        m8r::stringToFile(repositoryDir+"/memory/o-"+std::to_string(o)+".md", md);
+    }
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-antc-awfc.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    config.setAaAlgorithm(m8r::Configuration::AssociationAssessmentAlgorithm::WEIGHTED_FTS);
+
+    m8r::Mind mind(config);
+    ASSERT_TRUE(mind.learn());
+    ASSERT_EQ(true, mind.think().get());
+    ASSERT_EQ(3000, mind.remind().getNotesCount());
+
+    m8r::AssociatedNotes associations{m8r::ResourceType::WORD, "needle"};
+    ASSERT_TRUE(mind.getAssociatedNotes(associations).get());
+    ASSERT_EQ(3, associations.getAssociations()->size());
+    // Os order is kept regardless threads
+    vector<m8r::Note*> needles{};
+    for(m8r::Outline* o:mind.remind().getOutlines()) {
+        if(o->getNotes()[7]->getDescriptionAsString().find("Needle") != string::npos) {
+            needles.push_back(o->getNotes()[7]);
+        }
+    }
+    ASSERT_EQ(3, needles.size());
+    for(size_t i=0; i<needles.size(); i++) {
+        EXPECT_EQ(needles[i], associations.getAssociations()->at(i).first);
+    }
+
+    // cached leaderboard
+    m8r::AssociatedNotes cached{m8r::ResourceType::WORD, "needle"};
+    ASSERT_TRUE(mind.getAssociatedNotes(cached).get());
+    ASSERT_EQ(3, cached.getAssociations()->size());
+    EXPECT_EQ(associations.getAssociations()->at(0).first, cached.getAssociations()->at(0).first);
+
+    // N modification invalidates both text cache and leaderboards
+    m8r::Note* n = mind.remind().getOutlines()[0]->getNotes()[11];
+    n->setName("Needle in haystack");
+    n->makeModified();
+    m8r::AssociatedNotes modified{m8r::ResourceType::WORD, "needle"};
+    ASSERT_TRUE(mind.getAssociatedNotes(modified).get());
+    ASSERT_EQ(4, modified.getAssociations()->size());
+    EXPECT_EQ(n, modified.getAssociations()->at(0).first);
+
+    m8r::AssociatedNotes missing{m8r::ResourceType::WORD, "haystacks"};
+    ASSERT_FALSE(mind.getAssociatedNotes(missing).get());
+    ASSERT_FALSE(mind.getAssociatedNotes(missing).get());
+
+    // parallel assessment gives the same leaderboards as sequential one
+    m8r::AiAaWeightedFts sequential{mind.remind(), mind, 1};
+    m8r::AiAaWeightedFts parallel{mind.remind(), mind, 4};
+    for(const string& w:{"needle", "ipsum", "note 2", "lorem needle haystack"}) {
+        vector<pair<m8r::Note*,float>> s{}, p{};
+        sequential.getAssociatedNotes(w, s, static_cast<const m8r::Note*>(nullptr)).get();
+        parallel.getAssociatedNotes(w, p, static_cast<const m8r::Note*>(nullptr)).get();
+        EXPECT_LT(0, s.size());
+        EXPECT_EQ(s, p);
+    }
+}
+
+TEST(AiNlpTestCase, AaModelPersistence)
+{
+    // Ns w/ enough parent/child pairs to train NN
+    string repositoryDir{"/tmp/mf-unit-repository-aa-model"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    for(int o=0; o<8; o++) {
+        string md{"# Outline "};
+        md += std::to_string(o);
+        md += "\n\n";
+        for(int p=0; p<5; p++) {
+            md += "## Parent " + std::to_string(o) + "." + std::to_string(p) + "\n";
+            md += "Lorem ipsum dolor sit amet " + std::to_string(p) + ".\n\n";
+            for(int c=0; c<5; c++) {
+                md += "### Child " + std::to_string(o) + "." + std::to_string(p) + "." + std::to_string(c) + "\n";
+                md += "Lorem ipsum dolor " + std::to_string(p) + " consectetur " + std::to_string(c) + ".\n\n";
+            }
+        }
+        m8r::stringToFile(repositoryDir+"/memory/o-"+std::to_string(o)+".md", md);
+    }
+    string modelPath{repositoryDir+"/mind/"+m8r::FILENAME_MIND_AA_NN_MODEL};
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-antc-aamp.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    config.setAaAlgorithm(m8r::Configuration::AssociationAssessmentAlgorithm::BOW);
+
+    // NN is trained and saved when memory is learned for the first time
+    {
+        m8r::Mind mind(config);
+        ASSERT_TRUE(mind.learn(4));
+        ASSERT_EQ(true, mind.think().get());
+        ASSERT_TRUE(mind.sleep());
+    }
+    ASSERT_TRUE(m8r::isFile(modelPath.c_str()));
+    // backdate model to detect whether it was saved again
+    struct utimbuf backdated{1000, 1000};
+    ASSERT_EQ(0, utime(modelPath.c_str(), &backdated));
+
+    // Ns are learned in different order by parallel workers, but NN is loaded (not trained and saved)
+    for(int i=0; i<3; i++) {
+        m8r::Mind mind(config);
+        ASSERT_TRUE(mind.learn(4));
+        ASSERT_EQ(true, mind.think().get());
+        struct stat modelStat;
+        ASSERT_EQ(0, stat(modelPath.c_str(), &modelStat));
+        EXPECT_EQ(1000, modelStat.st_mtime);
+        ASSERT_TRUE(mind.sleep());
+    }
+
+    // Ns modification doesn't make NN stale
+    string* md = m8r::fileToString(repositoryDir+"/memory/o-0.md");
+    md->replace(md->find("Lorem"), 5, "Dolor");
+    m8r::stringToFile(repositoryDir+"/memory/o-0.md", *md);
+    delete md;
+    {
+        m8r::Mind mind(config);
+        ASSERT_TRUE(mind.learn(4));
+        ASSERT_EQ(true, mind.think().get());
+        struct stat modelStat;
+        ASSERT_EQ(0, stat(modelPath.c_str(), &modelStat));
+        EXPECT_EQ(1000, modelStat.st_mtime);
+        ASSERT_TRUE(mind.sleep());
+    }
+}
+
+TEST(AiNlpTestCase, AaModel)
+{
+    const int F = m8r::AssociationAssessmentModel::INPUTS;
+
+    // synthetic features: Ns are associated if they are similar by description
+    vector<float> features{};
+    vector<float> labels{};
+    for(int i=0; i<4000; i++) {
+        for(int f=0; f<F; f++) {
+            features.push_back(((i*(f+7))%101)/100.f);
+        }
+        labels.push_back(features[i*F+m8r::AssociationAssessmentNotesFeature::IDX_SIMILARITY_BY_DESCRIPTIONS]>.5f?1.f:0.f);
+    }
+
+    m8r::AssociationAssessmentModel model{};
+    EXPECT_FALSE(model.isTrained());
+    model.train(features, labels, 30, .5, 4);
+    ASSERT_TRUE(model.isTrained());
+
+    // batch scoring
+    vector<float> scores(labels.size());
+    model.score(features.data(), labels.size(), scores.data());
+    int correct = 0;
+    for(size_t i=0; i<labels.size(); i++) {
+        if((scores[i]>.5f) == (labels[i]>.5f)) correct++;
+        // batch forward pass == per pair forward pass
+        if(i%97 == 0) {
+            EXPECT_FLOAT_EQ(model.score(features.data()+i*F), scores[i]);
+        }
+    }
+    cout << "AA NN accuracy: " << correct << "/" << labels.size() << endl;
+    EXPECT_LT(labels.size()*9/10, correct);
+
+    // serialization
+    string path{"/tmp/mf-unit-aa-model.genann"};
+    ASSERT_TRUE(model.save(path, 0xCAFE));
+    m8r::AssociationAssessmentModel loaded{};
+    // model trained on different data is stale
+    EXPECT_FALSE(loaded.load(path, 0xBEEF));
+    EXPECT_FALSE(loaded.isTrained());
+    ASSERT_TRUE(loaded.load(path, 0xCAFE));
+    EXPECT_FLOAT_EQ(scores[42], loaded.score(features.data()+42*F));
+    // model w/o format version and fingerprint
+    FILE* f = fopen(path.c_str(), "w");
+    fputs("7 1 8 1 0.1 0.2", f);
+    fclose(f);
+    m8r::AssociationAssessmentModel legacy{};
+    EXPECT_FALSE(legacy.load(path, 0xCAFE));
+    remove(path.c_str());
+
+    model.clear();
+    EXPECT_FALSE(model.isTrained());
+    EXPECT_FALSE(loaded.load(path, 0xCAFE));
+}
+
 /*
  * AA: FTS
  */
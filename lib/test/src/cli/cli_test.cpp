@@ -0,0 +1,346 @@
+/*
+ cli_test.cpp     MindForger command line interface test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+#include "../../../../cli/src/cli_command_processor.h"
+#include "../../../../cli/src/cli_server.h"
+#include "../../../src/install/installer.h"
+#include "../../../src/representations/markdown/markdown_configuration_representation.h"
+#include "../test_gear.h"
+
+using namespace std;
+
+static void createCliRepository(const string& repositoryDir)
+{
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    for(int i=0; i<3; i++) {
+        m8r::stringToFile(
+            repositoryDir+"/memory/o-" + std::to_string(i) + ".md",
+            "# Outline " + std::to_string(i) + "\nText.\n\n## Needle " + std::to_string(i) + "\nHaystack needle.\n\n## Other\nHaystack.\n");
+    }
+}
+
+TEST(CliTestCase, Commands)
+{
+    string repositoryDir{"/tmp/mf-unit-repository-cli"};
+    createCliRepository(repositoryDir);
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-clitc-c.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind{config};
+    mind.learn();
+    m8r::CliCommandProcessor processor{mind};
+
+    string json{};
+    EXPECT_TRUE(processor.execute("stats", json));
+    EXPECT_EQ("{\"command\":\"stats\",\"ok\":true,\"outlines\":3,\"notes\":6}", json);
+
+    // command line is split to command and argument
+    EXPECT_TRUE(processor.execute("  fts   Needle 1 ", json));
+    EXPECT_NE(string::npos, json.find("\"command\":\"fts\",\"ok\":true,\"notes\":[{"));
+    EXPECT_NE(string::npos, json.find("\"name\":\"Needle 1\""));
+    EXPECT_EQ(string::npos, json.find("\"name\":\"Needle 2\""));
+
+    EXPECT_TRUE(processor.execute("", json));
+    EXPECT_TRUE(json.empty());
+
+    EXPECT_FALSE(processor.execute("fts", json));
+    EXPECT_NE(string::npos, json.find("\"ok\":false,\"error\":"));
+    EXPECT_FALSE(processor.execute("unknown argument", json));
+    EXPECT_NE(string::npos, json.find("{\"command\":\"unknown\",\"ok\":false,\"error\":"));
+
+    EXPECT_TRUE(m8r::CliCommandProcessor::isReadOnly("stats"));
+    EXPECT_TRUE(m8r::CliCommandProcessor::isReadOnly("fts"));
+    EXPECT_TRUE(m8r::CliCommandProcessor::isReadOnly("html"));
+    EXPECT_TRUE(m8r::CliCommandProcessor::isReadOnly("associations"));
+    EXPECT_FALSE(m8r::CliCommandProcessor::isReadOnly("learn"));
+    EXPECT_FALSE(m8r::CliCommandProcessor::isReadOnly("import-twiki"));
+}
+
+TEST(CliTestCase, ConfigurationNotPersisted)
+{
+    string repositoryDir{"/tmp/mf-unit-repository-cli-config"};
+    createCliRepository(repositoryDir);
+
+    // GUI configuration
+    string guiRepositoryDir{"/tmp/mf-unit-repository-cli-gui"};
+    createCliRepository(guiRepositoryDir);
+    string configFile{"/tmp/cfg-clitc-cnp.md"};
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath(configFile);
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(guiRepositoryDir)));
+    m8r::MarkdownConfigurationRepresentation mdConfigRepresentation{};
+    mdConfigRepresentation.save(config);
+    string* guiConfig = m8r::fileToString(configFile);
+
+    // headless run as in mindforger-cli
+    config.clear();
+    config.setConfigFilePath(configFile);
+    mdConfigRepresentation.load(config);
+    config.setPersistent(false);
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    {
+        m8r::Mind mind{config};
+        mind.learn();
+        m8r::CliCommandProcessor processor{mind};
+        // thinking persists mind state
+        EXPECT_TRUE(processor.think());
+        string json{};
+        EXPECT_TRUE(processor.execute("stats", json));
+        mind.amnesia();
+    }
+    EXPECT_EQ(m8r::Configuration::MindState::SLEEPING, config.getMindState());
+
+    string* cliConfig = m8r::fileToString(configFile);
+    EXPECT_EQ(*guiConfig, *cliConfig);
+    delete cliConfig;
+
+    // persistent configuration is written
+    config.setPersistent(true);
+    mdConfigRepresentation.save(config);
+    cliConfig = m8r::fileToString(configFile);
+    EXPECT_NE(*guiConfig, *cliConfig);
+    delete cliConfig;
+
+    delete guiConfig;
+}
+
+TEST(CliTestCase, ParseRequest)
+{
+    string id{}, command{}, argument{};
+
+    EXPECT_TRUE(m8r::CliServer::parseRequest("{\"id\":7,\"command\":\"fts\",\"argument\":\"needle\"}", id, command, argument));
+    EXPECT_EQ("7", id);
+    EXPECT_EQ("fts", command);
+    EXPECT_EQ("needle", argument);
+
+    // raw id is echoed, unknown keys are ignored, strings are unescaped
+    id.clear(); command.clear(); argument.clear();
+    EXPECT_TRUE(m8r::CliServer::parseRequest(
+        " { \"id\" : \"a\\\"b\" , \"x\":null, \"command\":\"fts\", \"argument\":\"a\\\\b\\n\\u00e9\\u20ac\" } ",
+        id, command, argument));
+    EXPECT_EQ("\"a\\\"b\"", id);
+    EXPECT_EQ("fts", command);
+    EXPECT_EQ("a\\b\n\xC3\xA9\xE2\x82\xAC", argument);
+
+    // id is JSON number or string (escaped again)
+    for(const char* number:{"0", "-7", "3.14", "1e9", "-2.5E-3"}) {
+        id.clear();
+        EXPECT_TRUE(m8r::CliServer::parseRequest(string{"{\"id\":"}+number+",\"command\":\"stats\"}", id, command, argument));
+        EXPECT_EQ(number, id);
+    }
+    id.clear();
+    EXPECT_TRUE(m8r::CliServer::parseRequest("{\"id\":\"\\x\u0001\",\"command\":\"stats\"}", id, command, argument));
+    EXPECT_EQ("\"x\\u0001\"", id);
+    for(const char* invalid:{"1x", "01", "-", "1.", ".5", "1e", "true", "null"}) {
+        id.clear();
+        EXPECT_FALSE(m8r::CliServer::parseRequest(string{"{\"id\":"}+invalid+",\"command\":\"stats\"}", id, command, argument)) << invalid;
+        EXPECT_TRUE(id.empty()) << invalid;
+    }
+    // id of malformed frame
+    id.clear();
+    EXPECT_FALSE(m8r::CliServer::parseRequest("{\"id\":9,\"command\":}", id, command, argument));
+    EXPECT_EQ("9", id);
+
+    // id and argument are optional
+    id.clear(); command.clear(); argument.clear();
+    EXPECT_TRUE(m8r::CliServer::parseRequest("{\"command\":\"stats\"}", id, command, argument));
+    EXPECT_TRUE(id.empty());
+    EXPECT_EQ("stats", command);
+    EXPECT_TRUE(argument.empty());
+
+    // malformed frames
+    const char* malformed[] = {
+        "",
+        "{}",
+        "[\"command\",\"stats\"]",
+        "{\"id\":1}",
+        "{\"command\":\"stats\"",
+        "{\"command\":\"stats\",}",
+        "{\"command\" \"stats\"}",
+        "{\"command\":\"sta",
+        "{\"command\":\"stats\\",
+        "{\"command\":\"\\u00\"}",
+        "{command:\"stats\"}",
+        "{\"id\":,\"command\":\"stats\"}",
+    };
+    for(const char* frame:malformed) {
+        id.clear(); command.clear(); argument.clear();
+        EXPECT_FALSE(m8r::CliServer::parseRequest(frame, id, command, argument)) << frame;
+    }
+}
+
+static int connectCliServer(const string& socketPath)
+{
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path)-1);
+    // server socket is opened asynchronously
+    for(int attempt=0; attempt<100; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if(!connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address))) {
+            return fd;
+        }
+        close(fd);
+        this_thread::sleep_for(chrono::milliseconds(50));
+    }
+    return -1;
+}
+
+static vector<string> cliServerRequests(int fd, const string& frames, size_t responses)
+{
+    size_t written = 0;
+    while(written < frames.size()) {
+        ssize_t w = send(fd, frames.data()+written, frames.size()-written, MSG_NOSIGNAL);
+        if(w <= 0) {
+            break;
+        }
+        written += static_cast<size_t>(w);
+    }
+
+    vector<string> result{};
+    string buffer{};
+    char chunk[4096];
+    while(result.size() < responses) {
+        ssize_t r = recv(fd, chunk, sizeof(chunk), 0);
+        if(r <= 0) {
+            break;
+        }
+        buffer.append(chunk, static_cast<size_t>(r));
+        size_t e;
+        while((e = buffer.find('\n')) != string::npos) {
+            result.push_back(buffer.substr(0, e));
+            buffer.erase(0, e+1);
+        }
+    }
+    return result;
+}
+
+TEST(CliTestCase, Server)
+{
+    string repositoryDir{"/tmp/mf-unit-repository-cli-server"};
+    createCliRepository(repositoryDir);
+    string socketPath{"/tmp/mf-unit-cli-server.socket"};
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-clitc-s.md");
+    config.setPersistent(false);
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    // server keeps whole memory warm as in mindforger-cli
+    config.setMemoryBudget(0);
+    m8r::Mind mind{config};
+    mind.learn();
+    m8r::CliCommandProcessor processor{mind};
+    ASSERT_TRUE(processor.think());
+    const string noteId = std::to_string(mind.remind().getOutlines()[0]->getNotes()[0]->getId());
+
+    m8r::CliServer server{processor, socketPath, 4};
+    bool served = false;
+    thread serving{[&server, &served]() { served = server.serve(); }};
+
+    // pipelined requests - responses are matched by id
+    int fd = connectCliServer(socketPath);
+    ASSERT_LE(0, fd);
+    vector<string> responses = cliServerRequests(
+        fd,
+        "{\"id\":1,\"command\":\"stats\"}\n"
+        "{\"id\":2,\"command\":\"fts\",\"argument\":\"Needle 1\"}\n"
+        "not JSON\n"
+        "\n"
+        "{\"id\":\"h\",\"command\":\"html\",\"argument\":\"" + noteId + "\"}\n"
+        "{\"id\":4,\"command\":\"associations\",\"argument\":\"" + noteId + "\"}\n"
+        "{\"id\":5,\"command\":\"stats\",}\n"
+        "{\"id\":1x,\"command\":\"stats\"}\n",
+        7);
+    ASSERT_EQ(7, responses.size());
+    map<string,string> byId{};
+    for(const string& r:responses) {
+        size_t e = r.find(',');
+        byId[r.compare(0, 6, "{\"id\":") ? "" : r.substr(6, e-6)] = r;
+    }
+    EXPECT_EQ("{\"id\":1,\"command\":\"stats\",\"ok\":true,\"outlines\":3,\"notes\":6}", byId["1"]);
+    EXPECT_NE(string::npos, byId["2"].find("\"ok\":true,\"notes\":[{"));
+    EXPECT_NE(string::npos, byId["2"].find("\"name\":\"Needle 1\""));
+    EXPECT_EQ("{\"ok\":false,\"error\":\"Malformed request\"}", byId[""]);
+    EXPECT_EQ("{\"id\":5,\"ok\":false,\"error\":\"Malformed request\"}", byId["5"]);
+    EXPECT_NE(string::npos, byId["\"h\""].find("\"command\":\"html\",\"ok\":true,\"html\":"));
+    EXPECT_NE(string::npos, byId["4"].find("\"command\":\"associations\",\"ok\":true"));
+    close(fd);
+
+    // concurrent clients w/ read-only requests (searches, HTML and associations run concurrently)
+    const int CLIENTS = 4;
+    const int REQUESTS = 32;
+    vector<thread> clients{};
+    vector<int> oks(CLIENTS, 0);
+    for(int c=0; c<CLIENTS; c++) {
+        clients.push_back(thread{[&socketPath, &noteId, &oks, c, REQUESTS]() {
+            int client = connectCliServer(socketPath);
+            if(client < 0) {
+                return;
+            }
+            const char* commands[] = {"stats", "fts", "backlinks", "html", "associations", "tags"};
+            string frames{};
+            for(int r=0; r<REQUESTS; r++) {
+                string command{commands[(r+c)%6]};
+                frames += "{\"id\":" + std::to_string(r) + ",\"command\":\"" + command + "\",\"argument\":\"";
+                frames += command=="fts" ? "needle" : noteId;
+                frames += "\"}\n";
+            }
+            for(const string& r:cliServerRequests(client, frames, REQUESTS)) {
+                if(r.find("\"ok\":true") != string::npos) {
+                    oks[c]++;
+                }
+            }
+            close(client);
+        }});
+    }
+    for(thread& c:clients) {
+        c.join();
+    }
+    for(int c=0; c<CLIENTS; c++) {
+        EXPECT_EQ(REQUESTS, oks[c]);
+    }
+
+    // shutdown
+    fd = connectCliServer(socketPath);
+    ASSERT_LE(0, fd);
+    responses = cliServerRequests(fd, "{\"id\":9,\"command\":\"shutdown\"}\n", 1);
+    ASSERT_EQ(1, responses.size());
+    EXPECT_EQ("{\"id\":9,\"command\":\"shutdown\",\"ok\":true}", responses[0]);
+    close(fd);
+    serving.join();
+    EXPECT_TRUE(served);
+    EXPECT_FALSE(m8r::isFile(socketPath.c_str()));
+}
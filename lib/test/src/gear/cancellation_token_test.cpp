@@ -0,0 +1,72 @@
+/*
+ cancellation_token_test.cpp     MindForger application test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "gear/cancellation_token.h"
+
+using namespace std;
+
+TEST(CancellationTokenTestCase, CancelAndDeadline)
+{
+    m8r::CancellationToken token{};
+    EXPECT_FALSE(token.isCancelled());
+    token.cancel();
+    EXPECT_TRUE(token.isCancelled());
+
+    // token is reused
+    token.reset();
+    EXPECT_FALSE(token.isCancelled());
+    token.setDeadline(chrono::milliseconds(10000));
+    EXPECT_FALSE(token.isCancelled());
+    token.setDeadline(chrono::milliseconds(0));
+    EXPECT_TRUE(token.isCancelled());
+    token.reset();
+    EXPECT_FALSE(token.isCancelled());
+
+    // parent cancellation is inherited
+    m8r::CancellationToken child{&token};
+    EXPECT_FALSE(child.isCancelled());
+    token.cancel();
+    EXPECT_TRUE(child.isCancelled());
+}
+
+TEST(CancellationTokenTestCase, CancelFromAnotherThread)
+{
+    m8r::CancellationToken token{};
+    atomic<long> iterations{0};
+
+    thread worker{[&token, &iterations]() {
+        while(!token.isCancelled()) {
+            iterations++;
+        }
+    }};
+    while(!iterations) {
+        this_thread::yield();
+    }
+    token.cancel();
+    worker.join();
+
+    EXPECT_TRUE(token.isCancelled());
+    EXPECT_LT(0, iterations);
+}
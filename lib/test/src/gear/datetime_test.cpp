@@ -175,3 +175,45 @@ TEST(DateTimeGearTestCase, MdDateTimeParsing)
     cout << endl;
     EXPECT_EQ(116, datetime.tm_year);
 }
+
+TEST(DateTimeGearTestCase, FastTimestampParsing)
+{
+    string in[] = {
+            "2016-05-02 21:30:28",
+            "2016-5-2 21:30:28",
+            "2016-5-28 18:45:00",
+            "2018-09-21 23:30:00",
+            "2017-1-1 0:00:00",
+            "2004-03-21 12:45:33",
+            "2016-12-21 12:45:33",
+            "1976-11-12 18:31:01",
+            "2016-12-30 5:31:01",
+            "2020-02-29 23:59:59",
+            // slow path
+            "2016-05-02T21:30:28",
+            "2016/05/02 21:30:28"
+            };
+    struct tm datetime;
+
+    for(size_t i=0; i<sizeof(in)/sizeof(string); i++) {
+        // C-style initialization as GCC doesn't like {}
+        memset(&datetime, 0, sizeof datetime);
+        datetimeFrom(in[i].c_str(), &datetime);
+        time_t expected = datetimeSeconds(&datetime);
+
+        cout << "#" << i << " " << in[i] << " -> " << expected << endl;
+        EXPECT_EQ(expected, datetimeSecondsFrom(in[i].c_str()));
+        // cached UTC offset
+        EXPECT_EQ(expected, datetimeSecondsFrom(in[i].c_str()));
+    }
+
+    // memoized pretty timestamps
+    time_t ts = datetimeSecondsFrom("2004-03-21 12:45:33");
+    string pretty = datetimeToPrettyHtml(ts);
+    EXPECT_NE(string::npos, pretty.find("&nbsp;&nbsp;2004&nbsp;&nbsp;"));
+    EXPECT_NE(string::npos, datetimeToPrettyHtml(ts+60).find("&nbsp;&nbsp;2004&nbsp;&nbsp;"));
+    ts = datetimeNow();
+    pretty = datetimeToPrettyHtml(ts);
+    EXPECT_NE(string::npos, pretty.find("#000000"));
+    EXPECT_EQ(pretty, datetimeToPrettyHtml(&ts));
+}
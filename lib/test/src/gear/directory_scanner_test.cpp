@@ -0,0 +1,88 @@
+/*
+ directory_scanner_test.cpp     MindForger application test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gear/directory_scanner.h"
+#include "gear/file_utils.h"
+
+using namespace std;
+
+TEST(DirectoryScannerTestCase, Scan)
+{
+    string directory{"/tmp/mf-unit-directory-scanner"};
+#ifndef _WIN32
+    // links are not removed recursively
+    unlink((directory + "/cycle").c_str());
+    unlink((directory + "/readme.md").c_str());
+#endif
+    m8r::removeDirectoryRecursively(directory.c_str());
+    m8r::createDirectory(directory);
+    // wide and deep tree ~ more directories than may be opened ahead
+    unsigned count = 0;
+    for(unsigned i=0; i<80; i++) {
+        string d{directory + "/d" + std::to_string(i)};
+        m8r::createDirectory(d);
+        m8r::createDirectory(d + "/empty");
+        m8r::createDirectory(d + "/deep");
+        m8r::stringToFile(d + "/deep/n.md", string(i, 'x'));
+        m8r::stringToFile(d + "/o.md", "# O");
+        count += 2;
+    }
+    m8r::stringToFile(directory + "/README.md", "# README");
+    count++;
+#ifndef _WIN32
+    // link to directory is not followed, link to file is
+    ASSERT_EQ(0, symlink(directory.c_str(), (directory + "/cycle").c_str()));
+    ASSERT_EQ(0, symlink((directory + "/README.md").c_str(), (directory + "/readme.md").c_str()));
+    count++;
+#endif
+
+    vector<m8r::ScannedFile> sequential{}, parallel{};
+    m8r::DirectoryScanner{1}.scan(directory, sequential);
+    m8r::DirectoryScanner{4}.scan(directory, parallel);
+
+    ASSERT_EQ(count, sequential.size());
+    ASSERT_EQ(count, parallel.size());
+    for(size_t i=0; i<count; i++) {
+        EXPECT_EQ(sequential[i].path, parallel[i].path);
+        EXPECT_EQ(sequential[i].size, parallel[i].size);
+        EXPECT_EQ(sequential[i].modified, parallel[i].modified);
+        if(i) {
+            EXPECT_LT(sequential[i-1].path, sequential[i].path);
+        }
+        EXPECT_LT(0, sequential[i].modified);
+    }
+    EXPECT_EQ(directory + "/README.md", sequential[0].path);
+    EXPECT_EQ(8, sequential[0].size);
+    EXPECT_EQ(directory + "/d0/deep/n.md", sequential[1].path);
+    EXPECT_EQ(0, sequential[1].size);
+    EXPECT_EQ(directory + "/d0/o.md", sequential[2].path);
+#ifndef _WIN32
+    EXPECT_EQ(directory + "/readme.md", sequential[count-1].path);
+    EXPECT_EQ(8, sequential[count-1].size);
+#endif
+
+    // nonexistent directory
+    m8r::DirectoryScanner{}.scan(directory + "/missing", parallel);
+    EXPECT_EQ(0, parallel.size());
+}
@@ -0,0 +1,178 @@
+/*
+ fuzzy_finder_test.cpp     MindForger application test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gear/fuzzy_finder.h"
+
+using namespace std;
+
+TEST(FuzzyFinderTestCase, Score)
+{
+    m8r::FuzzyFinder finder{};
+    finder.setCandidates(vector<string>{
+        "MindForger Roadmap",
+        "My Idea Notes and Drafts",
+        "Machine Learning",
+        "mind",
+        "Random Notes (Mind Dump)",
+        "Other"});
+
+    m8r::FuzzyFinderResult result{};
+
+    // subsequence
+    ASSERT_TRUE(finder.find("mfr", true, false, 10, result));
+    ASSERT_EQ(1, result.total);
+    EXPECT_EQ(0, result.matches[0].index);
+
+    // word boundaries and shorter names win
+    ASSERT_TRUE(finder.find("mind", true, false, 10, result));
+    ASSERT_EQ(4, result.total);
+    EXPECT_EQ(3, result.matches[0].index);
+    EXPECT_EQ(0, result.matches[1].index);
+    EXPECT_EQ(4, result.matches[2].index);
+    // "My IdeA Notes anD" ~ scattered match is the last one
+    EXPECT_EQ(1, result.matches[3].index);
+
+    // camel case hump
+    EXPECT_GT(
+        m8r::FuzzyFinder::score("MindForger", "mindforger", "mf", "mf", true),
+        m8r::FuzzyFinder::score("Mindfulness", "mindfulness", "mf", "mf", true));
+    // case match bonus
+    EXPECT_GT(
+        m8r::FuzzyFinder::score("Mind", "mind", "Mind", "mind", true),
+        m8r::FuzzyFinder::score("mind", "mind", "Mind", "mind", true));
+
+    // case sensitive
+    ASSERT_TRUE(finder.find("Mind", false, false, 10, result));
+    ASSERT_EQ(2, result.total);
+    EXPECT_EQ(0, result.matches[0].index);
+    EXPECT_EQ(4, result.matches[1].index);
+
+    // keywords in any order
+    ASSERT_TRUE(finder.find("dump notes", true, true, 10, result));
+    ASSERT_EQ(1, result.total);
+    EXPECT_EQ(4, result.matches[0].index);
+    ASSERT_TRUE(finder.find("dump notes", true, false, 10, result));
+    ASSERT_EQ(0, result.total);
+
+    // empty query
+    ASSERT_TRUE(finder.find("", true, true, 3, result));
+    ASSERT_EQ(6, result.total);
+    ASSERT_EQ(3, result.matches.size());
+    EXPECT_EQ(2, result.matches[2].index);
+
+    // limit
+    ASSERT_TRUE(finder.find("m", true, false, 2, result));
+    EXPECT_EQ(5, result.total);
+    EXPECT_EQ(2, result.matches.size());
+}
+
+TEST(FuzzyFinderTestCase, IncrementalAndParallel)
+{
+    // enough candidates to be scored in parallel chunks
+    vector<string> names{};
+    for(int i=0; i<50000; i++) {
+        names.push_back("Note " + std::to_string(i) + (i%7 ? " lorem" : " ipsum") + (i%3 ? " Dolor" : ""));
+    }
+
+    m8r::FuzzyFinder sequential{1};
+    sequential.setCandidates(names);
+    m8r::FuzzyFinder parallel{4};
+    parallel.setCandidates(names);
+
+    // typing ~ each query extends the previous one
+    m8r::FuzzyFinderResult s{}, p{}, f{};
+    string query{};
+    for(char c:string{"ipsum dol 77"}) {
+        query += c;
+        ASSERT_TRUE(sequential.find(query, true, true, 20, s));
+        ASSERT_TRUE(parallel.find(query, true, true, 20, p));
+        ASSERT_EQ(s.total, p.total);
+        ASSERT_EQ(s.matches.size(), p.matches.size());
+        for(size_t i=0; i<s.matches.size(); i++) {
+            ASSERT_EQ(s.matches[i].index, p.matches[i].index);
+            ASSERT_EQ(s.matches[i].score, p.matches[i].score);
+        }
+
+        // narrowed result is the same as the full one
+        m8r::FuzzyFinder fresh{1};
+        fresh.setCandidates(names);
+        ASSERT_TRUE(fresh.find(query, true, true, 20, f));
+        ASSERT_EQ(f.total, s.total);
+    }
+    cout << "Matches of '" << query << "': " << s.total << endl;
+    EXPECT_LT(0, s.total);
+    for(m8r::FuzzyMatch& m:s.matches) {
+        EXPECT_EQ(0, m.index%7);
+        EXPECT_NE(0, m.index%3);
+    }
+    // consecutive characters win
+    EXPECT_NE(string::npos, names[s.matches[0].index].find("77"));
+
+    // deleted character ~ no narrowing
+    ASSERT_TRUE(sequential.find("ipsum", true, true, 20, s));
+    ASSERT_EQ(50000/7+1, s.total);
+}
+
+TEST(FuzzyFinderTestCase, Async)
+{
+    vector<string> names{};
+    for(int i=0; i<20000; i++) {
+        names.push_back("Outline " + std::to_string(i));
+    }
+    mutex m{};
+    condition_variable cv{};
+    bool done = false;
+    uint64_t calledGeneration = 0;
+    string calledQuery{};
+    size_t calls = 0;
+    auto callback = [&](m8r::FuzzyFinderResult& result) {
+        lock_guard<mutex> lock{m};
+        calls++;
+        calledGeneration = result.generation;
+        calledQuery = result.query;
+        done = result.query == "o 1999";
+        cv.notify_one();
+    };
+
+    // finder (thread) must be destroyed before callback's state
+    m8r::FuzzyFinder finder{};
+    finder.setCandidates(names);
+
+    // only the latest query is guaranteed to be evaluated
+    string query{};
+    uint64_t generation = 0;
+    for(char c:string{"o 1999"}) {
+        query += c;
+        generation = finder.findAsync(query, true, true, 10, callback);
+    }
+
+    unique_lock<mutex> lock{m};
+    ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]{ return done; }));
+    EXPECT_EQ(generation, calledGeneration);
+    EXPECT_EQ("o 1999", calledQuery);
+    EXPECT_GE(6, calls);
+}
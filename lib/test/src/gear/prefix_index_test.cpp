@@ -0,0 +1,149 @@
+/*
+ prefix_index_test.cpp     MindForger application test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gear/prefix_index.h"
+#include "mind/completion_index.h"
+
+using namespace std;
+
+TEST(PrefixIndexTestCase, AddFindRemove)
+{
+    m8r::PrefixIndex<int> index{};
+    index.add("MindForger", 1);
+    index.add("mind", 2);
+    index.add("Mind", 3);
+    index.add("Mindfulness", 4);
+    index.add("Middle", 5);
+    index.add("Other", 6);
+    ASSERT_EQ(6, index.size());
+
+    vector<const m8r::PrefixIndex<int>::Entry*> result{};
+    index.find("Mind", result, 10);
+    ASSERT_EQ(4, result.size());
+    // case sensitive matches first, shorter first
+    EXPECT_EQ("Mind", result[0]->key);
+    EXPECT_EQ("MindForger", result[1]->key);
+    EXPECT_EQ("Mindfulness", result[2]->key);
+    EXPECT_EQ("mind", result[3]->key);
+
+    // top N
+    result.clear();
+    index.find("mi", result, 2);
+    ASSERT_EQ(2, result.size());
+    EXPECT_EQ("mind", result[0]->key);
+
+    // weight
+    index.add("Middle", 5);
+    index.add("Middle", 5);
+    result.clear();
+    index.find("Mi", result, 1);
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ("Middle", result[0]->key);
+    EXPECT_EQ(3, result[0]->weight);
+
+    // remove
+    EXPECT_TRUE(index.remove("Middle", 5, 3));
+    EXPECT_FALSE(index.remove("Middle", 5));
+    EXPECT_FALSE(index.remove("Other", 7));
+    ASSERT_EQ(5, index.size());
+    result.clear();
+    index.find("x", result, 10);
+    EXPECT_EQ(0, result.size());
+}
+
+TEST(PrefixIndexTestCase, BatchAddRemove)
+{
+    m8r::PrefixIndex<int> index{};
+    index.add("Mind", 1);
+    index.add(vector<pair<string,int>>{
+        {"MindForger", 2}, {"Mind", 1}, {"mind", 3}, {"Middle", 4}, {"Mind", 5}, {"", 6}, {"Middle", 4}});
+    ASSERT_EQ(5, index.size());
+
+    vector<const m8r::PrefixIndex<int>::Entry*> result{};
+    index.find("Mi", result, 10);
+    ASSERT_EQ(5, result.size());
+    // batch duplicates and already indexed pairs are coalesced into weights
+    EXPECT_EQ("Mind", result[0]->key);
+    EXPECT_EQ(1, result[0]->value);
+    EXPECT_EQ(2, result[0]->weight);
+    EXPECT_EQ("Middle", result[1]->key);
+    EXPECT_EQ(2, result[1]->weight);
+
+    // single and batch operations work on the same order
+    index.add("Mind", 5);
+    EXPECT_TRUE(index.remove("mind", 3));
+    index.remove(vector<pair<string,int>>{{"Middle", 4}, {"Mind", 1}, {"Mind", 5}, {"Other", 7}});
+    ASSERT_EQ(4, index.size());
+    index.remove(vector<pair<string,int>>{{"Middle", 4}, {"Mind", 1}, {"Mind", 5}, {"MindForger", 2}});
+    EXPECT_EQ(0, index.size());
+}
+
+TEST(PrefixIndexTestCase, DocumentWords)
+{
+    m8r::DocumentWordsIndex index{};
+    vector<string> lines{"Thinking notebook thinks.", "Think as you write.", "Thinking notebook thinks."};
+    std::hash<string> h{};
+
+    index.beginUpdate();
+    for(string& l:lines) {
+        if(!index.touchLine(h(l))) {
+            index.addLine(h(l), l);
+        }
+    }
+    index.endUpdate();
+
+    vector<string> result{};
+    index.complete("thin", result, 10);
+    ASSERT_EQ(3, result.size());
+    // case sensitive match first, then the most frequent words
+    EXPECT_EQ("thinks", result[0]);
+    EXPECT_EQ("Thinking", result[1]);
+    EXPECT_EQ("Think", result[2]);
+    // prefix itself is excluded
+    result.clear();
+    index.complete("Think", result, 10);
+    EXPECT_EQ(2, result.size());
+
+    // incremental update: duplicated line removed, new line added
+    lines.pop_back();
+    lines.push_back("Write notes.");
+    index.beginUpdate();
+    for(string& l:lines) {
+        if(!index.touchLine(h(l))) {
+            index.addLine(h(l), l);
+        }
+    }
+    index.endUpdate();
+
+    result.clear();
+    index.complete("wr", result, 10);
+    ASSERT_EQ(2, result.size());
+    EXPECT_EQ("write", result[0]);
+    EXPECT_EQ("Write", result[1]);
+
+    index.beginUpdate();
+    index.endUpdate();
+    EXPECT_EQ(0, index.size());
+}
@@ -0,0 +1,100 @@
+/*
+ text_arena_test.cpp     MindForger application test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gear/file_utils.h"
+#include "gear/text_arena.h"
+
+using namespace std;
+
+TEST(TextArenaTestCase, AddAndOwn)
+{
+    m8r::TextArena arena{};
+    EXPECT_EQ(0, arena.size());
+
+    // lines span several (growing) chunks
+    const size_t LINES = 3*m8r::TextArena::MAX_CHUNK_LINES;
+    vector<string*> lines{};
+    for(size_t i=0; i<LINES; i++) {
+        string line{"Line " + std::to_string(i) + " which is long enough to be heap allocated by string"};
+        lines.push_back(arena.add(std::move(line)));
+    }
+    EXPECT_EQ(LINES, arena.size());
+    for(size_t i=0; i<LINES; i++) {
+        EXPECT_TRUE(arena.owns(lines[i]));
+        ASSERT_EQ(0, lines[i]->find("Line " + std::to_string(i) + " "));
+    }
+
+    // arena lines are regular strings
+    lines[7]->assign("Edited");
+    EXPECT_EQ("Edited", *lines[7]);
+    EXPECT_EQ("Line 8", lines[8]->substr(0, 6));
+
+    // heap lines are deleted, text of arena lines is freed
+    string* heap = new string{"Heap"};
+    EXPECT_FALSE(arena.owns(heap));
+    m8r::TextArena::release(heap, &arena);
+    m8r::TextArena::release(lines[0], &arena);
+    EXPECT_TRUE(lines[0]->empty());
+    EXPECT_EQ("Line 1", lines[1]->substr(0, 6));
+
+    m8r::TextArena other{};
+    EXPECT_FALSE(other.owns(lines[0]));
+}
+
+TEST(TextArenaTestCase, Reserve)
+{
+    m8r::TextArena arena{};
+
+    // reserved lines are allocated in a chunk of exact size
+    const size_t LINES = m8r::TextArena::MAX_CHUNK_LINES+3;
+    const char* text = "Line which is long enough to be heap allocated by string";
+    arena.reserve(LINES);
+    vector<string*> lines{};
+    for(size_t i=0; i<LINES; i++) {
+        lines.push_back(arena.add(text, 4+(i%10)));
+    }
+    EXPECT_EQ(LINES, arena.size());
+    EXPECT_EQ(lines[0]+LINES-1, lines[LINES-1]);
+    EXPECT_EQ("Line", *lines[0]);
+    EXPECT_EQ("Line whi", *lines[4]);
+
+    // lines beyond the reservation get a new chunk
+    string* line = arena.add(text, 0);
+    EXPECT_TRUE(arena.owns(line));
+    EXPECT_TRUE(line->empty());
+    EXPECT_FALSE(line == lines[LINES-1]+1);
+
+    // text is split to lines like by getline()
+    m8r::TextArena lexed{};
+    vector<string*> lexedLines{};
+    size_t size = 0;
+    string lexedText{"First\n\nThird\r\nLast"};
+    EXPECT_TRUE(m8r::stringToLines(&lexedText, lexedLines, size, lexed));
+    ASSERT_EQ(4, lexedLines.size());
+    EXPECT_EQ(4, lexed.size());
+    EXPECT_EQ("", *lexedLines[1]);
+    EXPECT_EQ("Third\r", *lexedLines[2]);
+    EXPECT_EQ("Last", *lexedLines[3]);
+    EXPECT_EQ(lexedText.size()+1, size);
+}
@@ -0,0 +1,151 @@
+/*
+ tracer_test.cpp     MindForger application test
+
+ Copyright (C) 2016-2020 Martin Dvorak <martin.dvorak@mindforger.com>
+
+ This program is free software; you can redistribute it and/or
+ modify it under the terms of the GNU General Public License
+ as published by the Free Software Foundation; either version 2
+ of the License, or (at your option) any later version.
+
+ This program is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gear/tracer.h"
+#include "gear/file_utils.h"
+
+using namespace std;
+
+static void traceWork(int spans)
+{
+    for(int i=0; i<spans; i++) {
+        MF_TRACE_SPAN("test", "work");
+        MF_TRACE_COUNTER("test", "items", 2);
+    }
+}
+
+TEST(TracerTestCase, DisabledTracer)
+{
+    m8r::Tracer& tracer = m8r::Tracer::getInstance();
+    tracer.setEnabled(false);
+    tracer.clear();
+
+    traceWork(100);
+
+    EXPECT_EQ(0, tracer.getEventsCount());
+}
+
+TEST(TracerTestCase, SpansAndCounters)
+{
+    m8r::Tracer& tracer = m8r::Tracer::getInstance();
+    tracer.clear();
+    tracer.setEnabled(true);
+
+    // GIVEN spans and counters recorded by several threads
+    vector<thread> workers{};
+    for(int t=0; t<4; t++) {
+        workers.push_back(thread{traceWork, 250});
+    }
+    for(thread& t:workers) {
+        t.join();
+    }
+    {
+        MF_TRACE_SPAN("test", "main \"quoted\"");
+    }
+    tracer.setEnabled(false);
+
+    // THEN
+    EXPECT_EQ(4*250*2+1, tracer.getEventsCount());
+
+    ostringstream json{};
+    tracer.toChromeTrace(json);
+    string trace = json.str();
+    cout << trace.substr(0, 300) << endl;
+    EXPECT_EQ(0, trace.find("{\"traceEvents\":["));
+    EXPECT_NE(string::npos, trace.find("\"name\":\"work\",\"cat\":\"test\",\"ph\":\"X\""));
+    EXPECT_NE(string::npos, trace.find("\"ph\":\"C\""));
+    EXPECT_NE(string::npos, trace.find("main \\\"quoted\\\""));
+    EXPECT_NE(string::npos, trace.find("\"displayTimeUnit\":\"ms\"}"));
+
+    ostringstream report{};
+    tracer.toHistogramReport(report);
+    cout << report.str();
+    EXPECT_NE(string::npos, report.str().find("test/work"));
+    EXPECT_NE(string::npos, report.str().find("1000"));
+    // 4 threads x 250 x 2 items
+    EXPECT_NE(string::npos, report.str().find("2000"));
+
+    tracer.clear();
+    EXPECT_EQ(0, tracer.getEventsCount());
+}
+
+TEST(TracerTestCase, RingOverflow)
+{
+    m8r::Tracer& tracer = m8r::Tracer::getInstance();
+    tracer.clear();
+    tracer.setEnabled(true);
+
+    // ring keeps the newest events, statistics are kept for all of them
+    thread worker{traceWork, static_cast<int>(m8r::Tracer::RING_CAPACITY)};
+    worker.join();
+    tracer.setEnabled(false);
+
+    EXPECT_EQ(m8r::Tracer::RING_CAPACITY, tracer.getEventsCount());
+    ostringstream report{};
+    tracer.toHistogramReport(report);
+    EXPECT_NE(string::npos, report.str().find(to_string(m8r::Tracer::RING_CAPACITY)));
+
+    tracer.clear();
+}
+
+TEST(TracerTestCase, ExportToFile)
+{
+    m8r::Tracer& tracer = m8r::Tracer::getInstance();
+    tracer.clear();
+    tracer.setEnabled(true);
+    traceWork(10);
+    tracer.setEnabled(false);
+
+    string fileName{"/tmp/mf-unit-trace.json"};
+    remove(fileName.c_str());
+    EXPECT_TRUE(tracer.exportTo(fileName));
+
+    string* trace = m8r::fileToString(fileName);
+    EXPECT_NE(string::npos, trace->find("\"traceEvents\""));
+    EXPECT_NE(string::npos, trace->find("\"work\""));
+    delete trace;
+    string* report = m8r::fileToString(fileName + m8r::Tracer::REPORT_FILE_EXTENSION);
+    EXPECT_NE(string::npos, report->find("test/work"));
+    delete report;
+
+    tracer.clear();
+}
+
+TEST(TracerTestCase, Histogram)
+{
+    m8r::TraceHistogram h{};
+    for(uint64_t d=1; d<=1000; d++) {
+        h.add(d*1000);
+    }
+
+    EXPECT_EQ(1000, h.count);
+    EXPECT_EQ(1000, h.min);
+    EXPECT_EQ(1000000, h.max);
+    // log2 buckets ~ percentile is bucket upper bound
+    EXPECT_LE(500000, h.percentile(.5));
+    EXPECT_GE(2*500000, h.percentile(.5));
+    EXPECT_EQ(1000000, h.percentile(1.));
+}
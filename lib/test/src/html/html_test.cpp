@@ -31,6 +31,7 @@
 #include "representations/html/html_outline_representation.h"
 #include "mind/mind.h"
 #include "persistence/filesystem_persistence.h"
+#include "representations/html/html_site_exporter.h"
 
 using namespace std;
 
@@ -145,3 +146,104 @@ TEST(HtmlTestCase, TaskList)
     cout << "= BEGIN N HTML =" << endl << html << endl << "= END N HTML =" << endl;
     EXPECT_NE(std::string::npos, html.find("input"));
 }
+
+TEST(HtmlTestCase, SiteExport)
+{
+    string repositoryPath{"/tmp/mf-unit-repository-html-site"};
+    string sitePath{"/tmp/mf-unit-html-site"};
+    map<string,string> pathToContent;
+    pathToContent[repositoryPath+"/memory/first.md"]
+        = "# First Outline\n\nLink to [second](projects/second.md#note-1) and [web](https://www.mindforger.com).\n";
+    m8r::createEmptyRepository(repositoryPath, pathToContent);
+    m8r::createDirectory(repositoryPath+"/memory/projects");
+    m8r::stringToFile(
+        repositoryPath+"/memory/projects/second.md",
+        "# Second Outline\n\nBack to [first](../first.md).\n\n## Note 1\nText.\n");
+    m8r::removeDirectoryRecursively(sitePath.c_str());
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-htc-se.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath)));
+    m8r::Mind mind(config);
+    mind.learn();
+    mind.think().get();
+    ASSERT_EQ(2, mind.remind().getOutlinesCount());
+
+    // full export
+    m8r::HtmlSiteExporter::Stats stats = mind.remind().exportToHtmlSite(sitePath);
+    EXPECT_EQ(2, stats.exported);
+    EXPECT_EQ(0, stats.skipped);
+    EXPECT_EQ(0, stats.failed);
+    EXPECT_TRUE(m8r::isFile((sitePath+"/index.html").c_str()));
+
+    string* html = m8r::fileToString(sitePath+"/first.html");
+    EXPECT_NE(std::string::npos, html->find("projects/second.html#note-1"));
+    EXPECT_NE(std::string::npos, html->find("https://www.mindforger.com"));
+    delete html;
+    html = m8r::fileToString(sitePath+"/projects/second.html");
+    EXPECT_NE(std::string::npos, html->find("../first.html"));
+    delete html;
+
+    // incremental export
+    stats = mind.remind().exportToHtmlSite(sitePath);
+    EXPECT_EQ(0, stats.exported);
+    EXPECT_EQ(2, stats.skipped);
+
+    m8r::Outline* o = mind.remind().getOutlines()[0];
+    o->setName(o->getName() + " Changed");
+    stats = mind.remind().exportToHtmlSite(sitePath);
+    EXPECT_EQ(1, stats.exported);
+    EXPECT_EQ(1, stats.skipped);
+
+    // O names are escaped in index
+    o->setName("First <script>alert('x')</script> & more");
+    mind.remind().exportToHtmlSite(sitePath);
+    html = m8r::fileToString(sitePath+"/index.html");
+    EXPECT_EQ(std::string::npos, html->find("<script>"));
+    EXPECT_NE(std::string::npos, html->find("First &lt;script&gt;alert(&#39;x&#39;)&lt;/script&gt; &amp; more"));
+    delete html;
+
+    // rendering configuration change re-exports all pages
+    config.setUiHtmlCssPath("/tmp/mf-unit-html-site-changed.css");
+    stats = mind.remind().exportToHtmlSite(sitePath);
+    EXPECT_EQ(2, stats.exported);
+    EXPECT_EQ(0, stats.skipped);
+}
+
+TEST(HtmlTestCase, SiteExportCollisions)
+{
+    string repositoryPath{"/tmp/mf-unit-repository-html-site-collisions"};
+    string sitePath{"/tmp/mf-unit-html-site-collisions"};
+    map<string,string> pathToContent;
+    pathToContent[repositoryPath+"/memory/a.md"] = "# A md\n\nText.\n";
+    pathToContent[repositoryPath+"/memory/a.markdown"] = "# A markdown\n\nText.\n";
+    pathToContent[repositoryPath+"/memory/b.md"] = "# B\n\nLink to [a](a.markdown).\n";
+    m8r::createEmptyRepository(repositoryPath, pathToContent);
+    m8r::removeDirectoryRecursively(sitePath.c_str());
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-htc-sec.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath)));
+    m8r::Mind mind(config);
+    mind.learn();
+    mind.think().get();
+    ASSERT_EQ(3, mind.remind().getOutlinesCount());
+
+    // Os mapped to the same page keep their extensions
+    m8r::HtmlSiteExporter::Stats stats = mind.remind().exportToHtmlSite(sitePath);
+    EXPECT_EQ(3, stats.exported);
+    EXPECT_EQ(0, stats.failed);
+    EXPECT_FALSE(m8r::isFile((sitePath+"/a.html").c_str()));
+
+    string* html = m8r::fileToString(sitePath+"/a.md.html");
+    EXPECT_NE(std::string::npos, html->find("A md"));
+    delete html;
+    html = m8r::fileToString(sitePath+"/a.markdown.html");
+    EXPECT_NE(std::string::npos, html->find("A markdown"));
+    delete html;
+    html = m8r::fileToString(sitePath+"/b.html");
+    EXPECT_NE(std::string::npos, html->find("a.markdown.html"));
+    delete html;
+}
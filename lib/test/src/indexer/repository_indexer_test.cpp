@@ -673,3 +673,34 @@ TEST(RepositoryIndexerTestCase, MakePathRelative)
 
     delete repository;
 }
+
+TEST(RepositoryIndexerTestCase, FilesMetadata)
+{
+    string repositoryPath{"/tmp/mf-unit-repository-indexer-metadata"};
+    string memoryPath{repositoryPath + FILE_PATH_SEPARATOR + "memory" + FILE_PATH_SEPARATOR};
+    map<string,string> pathToContent{};
+    pathToContent[memoryPath + "small.md"] = "# Small";
+    pathToContent[memoryPath + "big.md"] = "# Big\n" + string(1000, 'b');
+    pathToContent[memoryPath + "medium.md"] = "# Medium\n" + string(100, 'm');
+    pathToContent[memoryPath + "image.png"] = string(5000, 'i');
+    m8r::createEmptyRepository(repositoryPath, pathToContent);
+
+    m8r::RepositoryIndexer repositoryIndexer{};
+    m8r::Repository* repository = m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath);
+    repositoryIndexer.index(repository);
+
+    EXPECT_EQ(4, repositoryIndexer.getAllOutlineFileNames().size());
+    EXPECT_EQ(3, repositoryIndexer.getMarkdownFiles().size());
+
+    string bigPath{memoryPath + "big.md"};
+
+    // the biggest Markdown first
+    vector<const string*> bySize{};
+    repositoryIndexer.getMarkdownFilesBySize(bySize);
+    ASSERT_EQ(3, bySize.size());
+    EXPECT_EQ(bigPath, *bySize[0]);
+    EXPECT_TRUE(m8r::stringEndsWith(*bySize[1], "medium.md"));
+    EXPECT_TRUE(m8r::stringEndsWith(*bySize[2], "small.md"));
+
+    delete repository;
+}
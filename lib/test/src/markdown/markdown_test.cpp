@@ -17,10 +17,12 @@
  along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <cstdio>
+#include <set>
 #ifndef _WIN32
 #  include <unistd.h>
 #endif
@@ -162,6 +164,106 @@ TEST(MarkdownParserTestCase, MarkdownLexerSectionsPostDeclaredHeaders2)
     EXPECT_EQ(MarkdownLexemType::BR, lexems[5]->getType());
 }
 
+TEST(MarkdownParserTestCase, MarkdownLexerSectionsHeaders)
+{
+    string content;
+    content.assign(
+        "Preamble text.\n"
+        "\n"
+        "# Outline <!-- Metadata: type: Grow; tags: a,b; -->\n"
+        "O text.\n"
+        "- list item\n"
+        "---\n"
+        "\n"
+        "```\n"
+        "# Not a section\n"
+        "Not a post declared section\n"
+        "---\n"
+        "```\n"
+        "---\n"
+        "Text after fence.\n"
+        "\n"
+        "## Section 1\n"
+        "N1 text.\n"
+        "\n"
+        "Section 2\n"
+        "---------\n"
+        "N2 text.\n"
+        "\n"
+        "---\n"
+        "x\n"
+        "==\n"
+        "Section 3\n"
+        "=========\n");
+    string fileName{"/tmp/mf-unit-lexer-headers.md"};
+    stringToFile(fileName, content);
+
+    // headers ~ header lexems of the whole document
+    MarkdownLexerSections lexer(&fileName);
+    lexer.tokenize();
+    MarkdownLexerSections headersLexer(&fileName);
+    headersLexer.tokenizeHeaders();
+    printLexems(headersLexer.getLexems());
+
+    vector<const MarkdownLexem*> expected{};
+    set<unsigned> offsets{};
+    bool inHeader = false;
+    for(const MarkdownLexem* l:lexer.getLexems()) {
+        bool section = l->getType()==MarkdownLexemType::SECTION
+            || l->getType()==MarkdownLexemType::SECTION_equals
+            || l->getType()==MarkdownLexemType::SECTION_hyphens;
+        if(section || inHeader
+             ||
+           l->getType()==MarkdownLexemType::BEGIN_DOC || l->getType()==MarkdownLexemType::END_DOC)
+        {
+            inHeader = (section || inHeader) && l->getType()!=MarkdownLexemType::BR;
+            expected.push_back(l);
+            if(l->getType()==MarkdownLexemType::LINE || l->getType()==MarkdownLexemType::TEXT) {
+                offsets.insert(l->getOff());
+            }
+        }
+    }
+    ASSERT_EQ(expected.size(), headersLexer.getLexems().size());
+    for(size_t i=0; i<expected.size(); i++) {
+        const MarkdownLexem* l = headersLexer.getLexems()[i];
+        EXPECT_EQ(expected[i]->getType(), l->getType());
+        EXPECT_EQ(expected[i]->getOff(), l->getOff());
+        EXPECT_EQ(expected[i]->getIdx(), l->getIdx());
+        EXPECT_EQ(expected[i]->getLng(), l->getLng());
+    }
+    // Outline, - list item (---), ``` (---), Section 1, Section 2 (---), Section 3 (===) - x is too short for ==
+    EXPECT_EQ(6, std::count_if(expected.begin(), expected.end(), [](const MarkdownLexem* l) {
+        return l->getType()==MarkdownLexemType::SECTION
+            || l->getType()==MarkdownLexemType::SECTION_equals
+            || l->getType()==MarkdownLexemType::SECTION_hyphens;
+    }));
+    EXPECT_EQ(lexer.getFileSize(), headersLexer.getFileSize());
+    ASSERT_EQ(lexer.getLines().size(), headersLexer.getLines().size());
+    for(size_t i=0; i<lexer.getLines().size(); i++) {
+        if(offsets.count(i)) {
+            ASSERT_NE(nullptr, headersLexer.getLines()[i]);
+            EXPECT_EQ(*lexer.getLines()[i], *headersLexer.getLines()[i]);
+        } else {
+            EXPECT_EQ(nullptr, headersLexer.getLines()[i]);
+        }
+    }
+
+    // no section ~ whole document
+    content.assign("Text.\n\n```\n# Code\n```\n");
+    stringToFile(fileName, content);
+    MarkdownLexerSections noSectionsLexer(&fileName);
+    noSectionsLexer.tokenizeHeaders();
+    MarkdownLexerSections wholeLexer(&fileName);
+    wholeLexer.tokenize();
+    ASSERT_EQ(wholeLexer.getLexems().size(), noSectionsLexer.getLexems().size());
+    for(size_t i=0; i<wholeLexer.getLexems().size(); i++) {
+        EXPECT_EQ(wholeLexer.getLexems()[i]->getType(), noSectionsLexer.getLexems()[i]->getType());
+    }
+    EXPECT_EQ(wholeLexer.getFileSize(), noSectionsLexer.getFileSize());
+    ASSERT_EQ(5, noSectionsLexer.getLines().size());
+    EXPECT_EQ("# Code", *noSectionsLexer.getLines()[3]);
+}
+
 TEST(MarkdownParserTestCase, MarkdownLexerTimeScope)
 {
     string content;
@@ -938,3 +1040,76 @@ TEST(MarkdownParserTestCase, Bug622Loop64kLinesOverflow)
     cout << endl << "- DONE ----------------------------------------------";
     cout << endl;
 }
+
+TEST(MarkdownParserTestCase, TextArena)
+{
+    string repositoryPath{"/tmp"};
+    string fileName{"md-parser-text-arena.md"};
+    string content;
+    string filePath{repositoryPath+"/"+fileName};
+
+    content.assign(
+                "# Outline Name\n"
+                "O text.\n"
+                "\n"
+                "## First Section\n"
+                "N1 text.\n"
+                "N1 second line which is long enough to be allocated on heap.\n"
+                "\n"
+                "## Second Section\n"
+                "N2 text.\n"
+                "\n");
+    m8r::stringToFile(filePath, content);
+
+    m8r::Repository* repository = m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath);
+    repository->setMode(m8r::Repository::RepositoryMode::FILE);
+    repository->setFile(fileName);
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mptc-ta.md");
+    config.setActiveRepository(config.addRepository(repository));
+    m8r::Ontology ontology{};
+
+    // parse
+    m8r::MarkdownOutlineRepresentation mdr{ontology, nullptr};
+    File file{filePath};
+    m8r::Outline* o = mdr.outline(file);
+
+    // asserts: O and N lines are lexed to O's arena - one line per file line
+    ASSERT_NE(nullptr, o);
+    ASSERT_EQ(2, o->getNotesCount());
+    shared_ptr<m8r::TextArena> arena = o->getTextArena();
+    ASSERT_NE(nullptr, arena.get());
+    EXPECT_EQ(10, arena->size());
+    for(string* s:o->getDescription()) {
+        EXPECT_TRUE(arena->owns(s));
+    }
+    m8r::Note* n = o->getNotes()[0];
+    EXPECT_EQ(arena.get(), n->getTextArena());
+    ASSERT_LE(2, n->getDescription().size());
+    for(string* s:n->getDescription()) {
+        EXPECT_TRUE(arena->owns(s));
+    }
+    EXPECT_EQ("N1 second line which is long enough to be allocated on heap.", *n->getDescription()[1]);
+
+    // moved lines are copied to heap
+    vector<string*> moved{};
+    n->moveDescription(moved);
+    EXPECT_EQ(0, n->getDescription().size());
+    ASSERT_LE(2, moved.size());
+    for(string* s:moved) {
+        EXPECT_FALSE(arena->owns(s));
+    }
+    EXPECT_EQ("N1 text.", *moved[0]);
+
+    // N (re)described w/ heap lines (edit)
+    n->setDescription(moved);
+
+    // N outlives its O (refactoring) - arena is shared
+    m8r::Note* n2 = o->getNotes()[1];
+    o->removeNote(n2);
+    delete o;
+    ASSERT_LE(1, n2->getDescription().size());
+    EXPECT_EQ("N2 text.", *n2->getDescription()[0]);
+    delete n2;
+}
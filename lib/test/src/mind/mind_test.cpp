@@ -20,6 +20,9 @@
 #include <stddef.h>
 #include <iostream>
 #include <iterator>
+#include <map>
+#include <set>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -30,9 +33,11 @@
 #include "../../../src/model/note.h"
 #include "../../../src/model/tag.h"
 #include "../../../src/mind/mind.h"
+#include "../../../src/mind/knowledge_graph.h"
 #include "../../../src/install/installer.h"
 
 #include "../../../src/representations/markdown/markdown_outline_representation.h"
+#include "../test_gear.h"
 
 extern char* getMindforgerGitHomePath();
 
@@ -304,3 +309,666 @@ TEST(MindTestCase, CommonWordsBlacklist) {
     ASSERT_TRUE(blacklist.findWord("you"));
     ASSERT_TRUE(blacklist.findWord("the"));
 }
+
+TEST(MindTestCase, KnowledgeGraph) {
+    // Os are remembered - repository is copied
+    string srcRepositoryPath{"/lib/test/resources/basic-repository"};
+    srcRepositoryPath.insert(0, getMindforgerGitHomePath());
+    string repositoryPath{"/tmp/mf-unit-repository-kg"};
+    m8r::removeDirectoryRecursively(repositoryPath.c_str());
+    m8r::copyDirectoryRecursively(srcRepositoryPath.c_str(), repositoryPath.c_str());
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-kg.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath)));
+    m8r::Mind mind(config);
+    mind.learn();
+    ASSERT_EQ(3, mind.remind().getOutlinesCount());
+
+    m8r::KnowledgeGraph* graph = mind.getKnowledgeGraph();
+    m8r::KnowledgeSubGraph subgraph{graph->getNode(m8r::KnowledgeGraphNodeType::MIND)};
+
+    // Os
+    graph->getRelatedNodes(graph->getNode(m8r::KnowledgeGraphNodeType::OUTLINES), subgraph);
+    ASSERT_EQ(3, subgraph.getChildren().size());
+    ASSERT_EQ(1, subgraph.getParents().size());
+    vector<m8r::KnowledgeGraphNode*> outlineNodes{subgraph.getChildren()};
+
+    // nodes are pooled ~ one node per Thing
+    m8r::KnowledgeGraphNode* outlineNode = outlineNodes[0];
+    m8r::Outline* o = outlineNode->getOutline();
+    EXPECT_EQ(outlineNode, graph->getNode(o));
+    graph->getRelatedNodes(graph->getNode(m8r::KnowledgeGraphNodeType::OUTLINES), subgraph);
+    EXPECT_EQ(outlineNodes, subgraph.getChildren());
+
+    // O subgraph is cached until memory changes
+    graph->getRelatedNodes(outlineNode, subgraph);
+    size_t size = subgraph.size();
+    EXPECT_EQ(outlineNode, subgraph.getCentralNode());
+    string name{"Knowledge graph N"};
+    mind.noteNew(o->getKey(), o->getNotesCount(), &name);
+    graph->getRelatedNodes(outlineNode, subgraph);
+    EXPECT_EQ(size+1, subgraph.size());
+    EXPECT_EQ(o->getNotesCount(), outlineNode->getCardinality());
+
+    // nodes of forgotten Ns are dropped from the pool
+    m8r::Note* n = o->getNotes()[o->getNotesCount()-1];
+    graph->getRelatedNodes(graph->getNode(n), subgraph);
+    size_t nodes = graph->getNodesCount();
+    mind.noteForget(n);
+    EXPECT_EQ(nodes-1, graph->getNodesCount());
+    graph->getRelatedNodes(outlineNode, subgraph);
+    EXPECT_EQ(size, subgraph.size());
+
+    // O remembered directly by memory (e.g. tag toggled in UI) evicts cached subgraph
+    const m8r::Tag* tag = mind.remind().getOntology().findOrCreateTag("knowledge-graph-tag");
+    o->addTag(tag);
+    mind.remind().remember(o->getKey());
+    graph->getRelatedNodes(outlineNode, subgraph);
+    EXPECT_EQ(size+1, subgraph.size());
+    o->removeTag(tag);
+    mind.remind().remember(o->getKey());
+    graph->getRelatedNodes(outlineNode, subgraph);
+    EXPECT_EQ(size, subgraph.size());
+
+    // limit
+    m8r::KnowledgeSubGraph limited{graph->getNode(m8r::KnowledgeGraphNodeType::MIND), 2};
+    graph->getRelatedNodes(graph->getNode(m8r::KnowledgeGraphNodeType::OUTLINES), limited);
+    EXPECT_EQ(2, limited.size());
+}
+
+TEST(MindTestCase, CsvExport) {
+    string repositoryPath{"/tmp/mf-unit-repository-csv"};
+    map<string,string> pathToContent;
+    for(int i=0; i<50; i++) {
+        string name = "outline-" + (i<10?string{"0"}:string{""}) + std::to_string(i);
+        pathToContent[repositoryPath+"/memory/"+name+".md"]
+            = "# " + name + " \"quoted\" name <!-- Metadata: type: Outline; tags: important,cool; -->"
+              "\nOutline description with comma, \"quote\" and \"\"double quote\"\"."
+              "\n"
+              "\n## Note 1"
+              "\nNote 1 text about bananas."
+              "\n"
+              "\n## Note 2"
+              "\nNote 2 text about apples."
+              "\n";
+    }
+    m8r::createEmptyRepository(repositoryPath, pathToContent);
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-csv.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryPath)));
+    config.setAaAlgorithm(m8r::Configuration::AssociationAssessmentAlgorithm::BOW);
+    m8r::Mind mind(config);
+    mind.learn();
+    mind.think().get();
+    ASSERT_EQ(50, mind.remind().getOutlinesCount());
+
+    // single pass escaping
+    string quoted{};
+    m8r::CsvOutlineRepresentation::quoteValue("a \"b\" \"\"c", quoted);
+    EXPECT_EQ("\"a \"\"b\"\" \"\"\"\"c\"", quoted);
+
+    string csvPath{"/tmp/mf-unit-mind.csv"};
+    mind.exportToCsv(csvPath, true);
+
+    std::ifstream in{csvPath};
+    vector<string> lines{};
+    string line{};
+    while(getline(in, line)) {
+        lines.push_back(line);
+    }
+    ASSERT_EQ(1+50*3, lines.size());
+    EXPECT_EQ("id,type,title,offset,depth,reads,writes,created,modified,read,description,tags,links,bow", lines[0]);
+
+    // rows are written in Os order
+    const vector<m8r::Outline*>& os = mind.remind().getOutlines();
+    for(size_t i=0; i<os.size(); i++) {
+        EXPECT_EQ(0, lines[1+i*3].find("\""+os[i]->getKey()+"\",o,"));
+        EXPECT_NE(string::npos, lines[1+i*3].find("\"\"quoted\"\" name"));
+        EXPECT_NE(string::npos, lines[1+i*3].find("\"\"\"\"double quote\"\"\"\""));
+        EXPECT_NE(string::npos, lines[2+i*3].find(",n,\"Note 1\",1,"));
+        EXPECT_NE(string::npos, lines[3+i*3].find(",n,\"Note 2\",2,"));
+    }
+    EXPECT_NE(string::npos, lines[1].find("important|cool"));
+    // N term vectors
+    EXPECT_NE(string::npos, lines[2].find("banana"));
+    EXPECT_NE(string::npos, lines[3].find("appl"));
+}
+
+TEST(MindTestCase, MemoryDwell) {
+    string repositoryDir{"/tmp/mf-unit-repository-dwell"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    string content{
+        "# Dwell <!-- Metadata: type: Outline; created: 2015-01-01 08:00:00; reads: 1; read: 2015-01-01 08:00:00; revision: 1; modified: 2015-01-01 08:00:00; importance: 0/5; urgency: 0/5; progress: 0%; -->\n"
+        "O.\n\n"
+        "## Old <!-- Metadata: type: Note; created: 2010-01-01 08:00:00; reads: 100; read: 2010-01-01 08:00:00; revision: 1; modified: 2010-01-01 08:00:00; progress: 0%; -->\n"
+        "Old.\n\n"
+        "## Recent <!-- Metadata: type: Note; created: 2020-01-01 08:00:00; reads: 1; read: 2020-01-01 08:00:00; revision: 1; modified: 2020-01-01 08:00:00; progress: 0%; -->\n"
+        "Recent.\n\n"
+        "### Child <!-- Metadata: type: Note; created: 2018-01-01 08:00:00; reads: 1; read: 2018-01-01 08:00:00; revision: 1; modified: 2018-01-01 08:00:00; progress: 0%; -->\n"
+        "Child.\n\n"
+        "## Middle <!-- Metadata: type: Note; created: 2019-06-01 08:00:00; reads: 5; read: 2019-06-01 08:00:00; revision: 1; modified: 2019-06-01 08:00:00; progress: 0%; -->\n"
+        "Middle.\n\n"
+        "## Frequent <!-- Metadata: type: Note; created: 2019-12-25 08:00:00; reads: 1000; read: 2019-12-25 08:00:00; revision: 1; modified: 2019-12-25 08:00:00; progress: 0%; -->\n"
+        "Frequent.\n\n"
+    };
+    m8r::stringToFile(repositoryDir+"/memory/dwell.md", content);
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-md.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind(config);
+    mind.learn();
+    ASSERT_EQ(1, mind.remind().getOutlinesCount());
+    ASSERT_EQ(6, mind.getMemoryDwellDepth());
+
+    // frequency outweighs a week of recency, recency outweighs frequency in years
+    vector<m8r::Note*> dwell{};
+    mind.getMemoryDwell(dwell, 3);
+    ASSERT_EQ(3, dwell.size());
+    EXPECT_EQ("Frequent", dwell[0]->getName());
+    EXPECT_EQ("Recent", dwell[1]->getName());
+    EXPECT_EQ("Middle", dwell[2]->getName());
+    dwell.clear();
+    mind.getMemoryDwell(dwell, 0);
+    ASSERT_EQ(5, dwell.size());
+    EXPECT_EQ("Old", dwell[4]->getName());
+    dwell.clear();
+    mind.getMemoryDwell(dwell, 0, true);
+    ASSERT_EQ(6, dwell.size());
+    EXPECT_EQ(1, std::count_if(dwell.begin(), dwell.end(), [](m8r::Note* n){ return n->getName() == "Dwell"; }));
+    EXPECT_EQ("Old", dwell[5]->getName());
+
+    // read N goes to the top
+    m8r::Note* old = dwell[5];
+    m8r::Outline* o = old->getOutline();
+    mind.noteRead(old);
+    dwell.clear();
+    mind.getMemoryDwell(dwell, 1);
+    ASSERT_EQ(1, dwell.size());
+    EXPECT_EQ(old, dwell[0]);
+    EXPECT_EQ(101, old->getReads());
+
+    // forgotten N leaves dwell w/ its children
+    mind.noteForget(o->getNotes()[1]);
+    EXPECT_EQ(4, mind.getMemoryDwellDepth());
+    dwell.clear();
+    mind.getMemoryDwell(dwell, 0);
+    ASSERT_EQ(3, dwell.size());
+    for(m8r::Note* n:dwell) {
+        EXPECT_NE("Recent", n->getName());
+        EXPECT_NE("Child", n->getName());
+    }
+
+    // new N, save and forget O
+    string name{"New"};
+    mind.noteNew(o->getKey(), 0, &name, nullptr, 1, nullptr, 0, nullptr);
+    EXPECT_EQ(5, mind.getMemoryDwellDepth());
+    mind.remember(o);
+    EXPECT_EQ(5, mind.getMemoryDwellDepth());
+    mind.outlineForget(o->getKey());
+    EXPECT_EQ(0, mind.getMemoryDwellDepth());
+}
+
+TEST(MindTestCase, LearnAsync) {
+    string repositoryDir{"/tmp/mf-unit-repository-learn-async"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    const unsigned OUTLINES = 150;
+    for(unsigned i=0; i<OUTLINES; i++) {
+        string content{"# Outline " + std::to_string(i) + "\nDescription.\n\n"};
+        for(unsigned j=0; j<=i%5; j++) {
+            content += "## Note " + std::to_string(j) + "\nText " + std::to_string(i) + ".\n\n";
+        }
+        m8r::stringToFile(repositoryDir+"/memory/o-" + std::to_string(i) + ".md", content);
+    }
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-la.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind(config);
+
+    mind.learn();
+    unsigned notes = mind.remind().getNotesCount();
+    size_t stencils = mind.remind().getStencils(m8r::ResourceType::OUTLINE).size();
+    ASSERT_EQ(OUTLINES, mind.remind().getOutlinesCount());
+    ASSERT_EQ(3*OUTLINES, notes);
+
+    // progressive learning: Os are available batch by batch, thinking must wait
+    shared_future<bool> learned = mind.learnAsync();
+    EXPECT_TRUE(mind.isLearning());
+    EXPECT_EQ(0, mind.remind().getOutlinesCount());
+    EXPECT_EQ(stencils, mind.remind().getStencils(m8r::ResourceType::OUTLINE).size());
+    EXPECT_FALSE(mind.think().get());
+    unsigned batches = 0;
+    while(mind.isLearning()) {
+        if(mind.learnBatch()) {
+            batches++;
+            EXPECT_GE(batches*m8r::Memory::LEARN_BATCH_SIZE, mind.remind().getOutlinesCount());
+        }
+    }
+    EXPECT_TRUE(learned.get());
+    EXPECT_LE(3, batches);
+    EXPECT_EQ(OUTLINES, mind.remind().getOutlinesCount());
+    EXPECT_EQ(notes, mind.remind().getNotesCount());
+    EXPECT_EQ(notes+OUTLINES, mind.getMemoryDwellDepth());
+    vector<m8r::Outline*> named{};
+    mind.remind().findOutlinesByName("Outline 149", named);
+    EXPECT_EQ(1, named.size());
+    size_t done, total;
+    mind.remind().getLearningProgress(done, total);
+    EXPECT_EQ(OUTLINES, done);
+    EXPECT_EQ(OUTLINES, total);
+
+    // parallel parsing
+    m8r::Memory& memory = mind.remind();
+    mind.amnesia();
+    memory.learn(4);
+    EXPECT_EQ(OUTLINES, memory.getOutlinesCount());
+    EXPECT_EQ(notes, memory.getNotesCount());
+
+    // interrupted learning
+    mind.amnesia();
+    learned = memory.learnAsync(2);
+    memory.learnBatch(1, true);
+    mind.amnesia();
+    EXPECT_FALSE(memory.isLearning());
+    EXPECT_FALSE(learned.get());
+    EXPECT_EQ(0, memory.getOutlinesCount());
+}
+
+TEST(MindTestCase, LazyBodies) {
+    string repositoryDir{"/tmp/mf-unit-repository-lazy-bodies"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    const unsigned OUTLINES = 20;
+    const unsigned BIG_OUTLINES = 3;
+    for(unsigned i=0; i<OUTLINES; i++) {
+        string content{"# Outline " + std::to_string(i) + "\nDescription " + std::to_string(i) + ".\n"};
+        if(i<BIG_OUTLINES) {
+            // ~600kB body - any two big bodies exceed 1MB budget
+            content += string(600*1024, 'm');
+            content += "\n";
+        }
+        content += "\n```\n# Code " + std::to_string(i) + "\n```\n\n";
+        for(unsigned j=0; j<3; j++) {
+            content += "## Note " + std::to_string(j) + "\nText " + std::to_string(i) + "." + std::to_string(j) + "\n\n";
+        }
+        // closing code fence followed by --- declares section named ```
+        content += "```\nfenced " + std::to_string(i) + "\n```\n---\nAfter fence " + std::to_string(i) + ".\n\n";
+        content += "Setext " + std::to_string(i) + "\n---\nSetext text " + std::to_string(i) + ".\n\n";
+        m8r::stringToFile(repositoryDir+"/memory/o-" + std::to_string(i) + ".md", content);
+    }
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-lb.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind(config);
+    m8r::Memory& memory = mind.remind();
+
+    // whole repository in memory
+    mind.learn();
+    EXPECT_FALSE(memory.isLazyBodies());
+    ASSERT_EQ(OUTLINES, memory.getOutlinesCount());
+    map<string,vector<string>> bodies{};
+    for(m8r::Outline* o:memory.getOutlines()) {
+        EXPECT_TRUE(o->isBodyLoaded());
+        vector<string>& body = bodies[o->getKey()];
+        body.push_back(o->getName());
+        body.push_back(o->getDescriptionAsString());
+        for(m8r::Note* n:o->getNotes()) {
+            body.push_back(n->getName());
+            body.push_back(n->getDescriptionAsString());
+        }
+    }
+    unsigned notes = memory.getNotesCount();
+    EXPECT_EQ(5*OUTLINES, notes);
+    EXPECT_EQ("```", memory.getOutlines()[0]->getNotes()[3]->getName());
+
+    // headers only ~ the same Os and Ns, bodies loaded on access
+    mind.amnesia();
+    config.setMemoryBudget(1);
+    mind.learn();
+    EXPECT_TRUE(memory.isLazyBodies());
+    ASSERT_EQ(OUTLINES, memory.getOutlinesCount());
+    EXPECT_EQ(notes, memory.getNotesCount());
+    for(m8r::Outline* o:memory.getOutlines()) {
+        EXPECT_FALSE(o->isBodyLoaded());
+        ASSERT_EQ(bodies[o->getKey()].size(), 2+2*o->getNotesCount());
+    }
+    EXPECT_EQ(0, memory.getLoadedBodiesBytes());
+    for(m8r::Outline* o:memory.getOutlines()) {
+        vector<string>& body = bodies[o->getKey()];
+        EXPECT_EQ(body[0], o->getName());
+        for(size_t i=0; i<o->getNotesCount(); i++) {
+            EXPECT_EQ(body[2+2*i], o->getNotes()[i]->getName());
+            EXPECT_EQ(body[3+2*i], o->getNotes()[i]->getDescriptionAsString());
+        }
+        EXPECT_TRUE(o->isBodyLoaded());
+        EXPECT_EQ(body[1], o->getDescriptionAsString());
+    }
+    EXPECT_LT(BIG_OUTLINES*600*1024, memory.getLoadedBodiesBytes());
+
+    // the coldest bodies are evicted once read is over budget - the read O is kept,
+    // therefore all other big bodies must be evicted regardless of the learning order
+    config.setMindState(m8r::Configuration::MindState::SLEEPING);
+    vector<m8r::Outline*> named{};
+    memory.findOutlinesByName("Outline 0", named);
+    ASSERT_EQ(1, named.size());
+    m8r::Outline* o = named[0];
+    mind.noteRead(o->getNotes()[0]);
+    EXPECT_GE(1024*1024, memory.getLoadedBodiesBytes());
+    unsigned evicted = 0;
+    for(m8r::Outline* outline:memory.getOutlines()) {
+        if(!outline->isBodyLoaded()) {
+            evicted++;
+        }
+    }
+    EXPECT_LE(BIG_OUTLINES-1, evicted);
+    EXPECT_TRUE(o->isBodyLoaded());
+    EXPECT_TRUE(o->evictBody());
+    EXPECT_FALSE(o->isBodyLoaded());
+    EXPECT_EQ(bodies[o->getKey()][1], o->getDescriptionAsString());
+    EXPECT_EQ(bodies[o->getKey()][3], o->getNotes()[0]->getDescriptionAsString());
+
+    // saved O w/o loaded body keeps its body
+    named.clear();
+    memory.findOutlinesByName("Outline 7", named);
+    ASSERT_EQ(1, named.size());
+    o = named[0];
+    if(o->isBodyLoaded()) {
+        ASSERT_TRUE(o->evictBody());
+    }
+    mind.remember(o);
+    string* saved = m8r::fileToString(o->getKey());
+    ASSERT_NE(nullptr, saved);
+    EXPECT_NE(string::npos, saved->find("Text 7.1"));
+    EXPECT_NE(string::npos, saved->find("# Code 7"));
+    delete saved;
+
+    // O modified on disk after its headers were learned ~ body is loaded by N accessor
+    // while Ns are iterated, matching Ns get descriptions and O is relearned later
+    named.clear();
+    memory.findOutlinesByName("Outline 8", named);
+    ASSERT_EQ(1, named.size());
+    o = named[0];
+    if(o->isBodyLoaded()) {
+        ASSERT_TRUE(o->evictBody());
+    }
+    ASSERT_EQ(5, o->getNotesCount());
+    m8r::stringToFile(o->getKey(), "# Outline 8\nChanged.\n\n## Note A\nText A.\n\n## Note 1\nText 1 changed.\n\n## Note B\nText B.\n");
+    vector<string> descriptions{};
+    for(m8r::Note* n:o->getNotes()) {
+        descriptions.push_back(n->getDescriptionAsString());
+        EXPECT_EQ(o, n->getOutline());
+    }
+    ASSERT_EQ(5, descriptions.size());
+    EXPECT_EQ("", descriptions[0]);
+    EXPECT_EQ("Text 1 changed.\n\n", descriptions[1]);
+    EXPECT_EQ("", descriptions[2]);
+    EXPECT_EQ(5, o->getNotesCount());
+    EXPECT_EQ("Changed.\n\n", o->getDescriptionAsString());
+    // Ns are replaced only at safe point
+    int watermark = mind.getMemoryWatermark();
+    mind.noteRead(o->getNotes()[1]);
+    EXPECT_LT(watermark, mind.getMemoryWatermark());
+    ASSERT_EQ(3, o->getNotesCount());
+    EXPECT_EQ("Note A", o->getNotes()[0]->getName());
+    EXPECT_EQ("Text A.\n\n", o->getNotes()[0]->getDescriptionAsString());
+    EXPECT_EQ(o, o->getNotes()[2]->getOutline());
+    EXPECT_EQ("Text B.\n", o->getNotes()[2]->getDescriptionAsString());
+    EXPECT_FALSE(memory.reindexReplacedBodies());
+
+    config.setMemoryBudget(m8r::Configuration::DEFAULT_MEMORY_BUDGET);
+}
+
+TEST(MindTestCase, ThingsIds) {
+    string repositoryDir{"/tmp/mf-unit-repository-things-ids"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    const unsigned OUTLINES = 5;
+    for(unsigned i=0; i<OUTLINES; i++) {
+        m8r::stringToFile(
+            repositoryDir+"/memory/o-" + std::to_string(i) + ".md",
+            "# Outline " + std::to_string(i) + "\nText.\n\n## Note A\nA.\n\n## Note B\nB.\n");
+    }
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-ti.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind(config);
+    m8r::Memory& memory = mind.remind();
+
+    // ids assigned on learn survive restart w/o save
+    mind.learn();
+    const m8r::ThingsIdIndex& ids = memory.getThingsIds();
+    ASSERT_EQ(3*OUTLINES, ids.size());
+    map<string,uint32_t> learnedIds{};
+    for(m8r::Outline* o:memory.getOutlines()) {
+        learnedIds[o->getKey()] = o->getId();
+    }
+    mind.amnesia();
+    mind.learn();
+    ASSERT_EQ(3*OUTLINES, ids.size());
+    for(m8r::Outline* o:memory.getOutlines()) {
+        EXPECT_EQ(learnedIds[o->getKey()], o->getId());
+    }
+
+    // ids persisted on save
+    map<string,uint32_t> keyToId{};
+    for(m8r::Outline* o:memory.getOutlines()) {
+        EXPECT_NE(0, o->getId());
+        EXPECT_EQ(o, ids.getOutline(o->getId()));
+        EXPECT_EQ(nullptr, ids.getNote(o->getId()));
+        keyToId[o->getKey()] = o->getId();
+        for(m8r::Note* n:o->getNotes()) {
+            EXPECT_EQ(n, ids.getNote(n->getId()));
+            keyToId[n->getKey()] = n->getId();
+        }
+        mind.remember(o);
+    }
+    EXPECT_EQ(3*OUTLINES+1, ids.getIdsBound());
+
+    // ids survive restart, copy of O gets new ids
+    mind.amnesia();
+    string* content = m8r::fileToString(repositoryDir+"/memory/o-0.md");
+    m8r::stringToFile(repositoryDir+"/memory/o-copy.md", *content);
+    delete content;
+    mind.learn();
+    ASSERT_EQ(OUTLINES+1, memory.getOutlinesCount());
+    EXPECT_EQ(3*(OUTLINES+1), ids.size());
+    set<uint32_t> unique{};
+    for(m8r::Outline* o:memory.getOutlines()) {
+        unique.insert(o->getId());
+        if(keyToId.count(o->getKey())) {
+            EXPECT_EQ(keyToId[o->getKey()], o->getId());
+        } else {
+            EXPECT_LT(3*OUTLINES, o->getId());
+        }
+        for(m8r::Note* n:o->getNotes()) {
+            unique.insert(n->getId());
+            if(keyToId.count(n->getKey())) {
+                EXPECT_EQ(keyToId[n->getKey()], n->getId());
+            }
+        }
+    }
+    EXPECT_EQ(3*(OUTLINES+1), unique.size());
+
+    // N refactored to another O keeps its id, new N gets a new id
+    vector<m8r::Outline*> named{};
+    memory.findOutlinesByName("Outline 1", named);
+    ASSERT_EQ(1, named.size());
+    m8r::Outline* source = named[0];
+    named.clear();
+    memory.findOutlinesByName("Outline 2", named);
+    ASSERT_EQ(1, named.size());
+    m8r::Note* n = source->getNotes()[1];
+    uint32_t id = n->getId();
+    mind.noteRefactor(n, named[0]->getKey());
+    EXPECT_EQ(id, n->getId());
+    EXPECT_EQ(n, ids.getNote(id));
+    EXPECT_EQ(named[0], ids.getNote(id)->getOutline());
+    string name{"New"};
+    m8r::Note* created = mind.noteNew(source->getKey(), 0, &name);
+    ASSERT_NE(nullptr, created);
+    EXPECT_EQ(0, created->getId());
+    mind.remember(source);
+    EXPECT_LT(3*(OUTLINES+1), created->getId());
+    EXPECT_EQ(created, ids.getNote(created->getId()));
+
+    // forgotten O ids are not reused
+    uint32_t bound = ids.getIdsBound();
+    mind.outlineForget(source->getKey());
+    EXPECT_EQ(nullptr, ids.getOutline(keyToId[repositoryDir+"/memory/o-1.md"]));
+    EXPECT_EQ(bound, ids.getIdsBound());
+}
+
+TEST(MindTestCase, ThingsIdsMarkdownRepository) {
+    // Markdown repository ~ ids are never written to Os
+    string repositoryDir{"/tmp/mf-unit-repository-things-ids-md"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::createDirectory(repositoryDir);
+    const unsigned OUTLINES = 5;
+    string content{"# Outline\nText.\n\n## Note\nA.\n\n## Note\nB.\n"};
+    for(unsigned i=0; i<OUTLINES; i++) {
+        m8r::stringToFile(repositoryDir+"/o-" + std::to_string(i) + ".md", content);
+    }
+
+    // ids file is kept in configuration directory
+    string configDir{"/tmp/mf-unit-cfg-things-ids-md"};
+    m8r::removeDirectoryRecursively(configDir.c_str());
+    m8r::createDirectory(configDir);
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath(configDir+"/cfg-mtc-timr.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind(config);
+    m8r::Memory& memory = mind.remind();
+    const m8r::ThingsIdIndex& ids = memory.getThingsIds();
+
+    mind.learn();
+    ASSERT_EQ(3*OUTLINES, ids.size());
+    EXPECT_FALSE(m8r::isFile((repositoryDir+"/"+m8r::FILENAME_THINGS_IDS).c_str()));
+    EXPECT_TRUE(m8r::isDirectory((configDir+"/"+m8r::DIRNAME_THINGS_IDS).c_str()));
+    EXPECT_EQ(3*OUTLINES, ids.getHighWaterMark());
+    map<string,vector<uint32_t>> keyToIds{};
+    for(m8r::Outline* o:memory.getOutlines()) {
+        keyToIds[o->getKey()].push_back(o->getId());
+        for(m8r::Note* n:o->getNotes()) {
+            // Ns w/ the same name have the same key
+            keyToIds[n->getKey()].push_back(n->getId());
+        }
+    }
+
+    // ids survive restarts w/o save and Os are not modified
+    for(int restart=0; restart<2; restart++) {
+        mind.amnesia();
+        mind.learn();
+        ASSERT_EQ(3*OUTLINES, ids.size());
+        for(m8r::Outline* o:memory.getOutlines()) {
+            EXPECT_EQ(keyToIds[o->getKey()][0], o->getId());
+            ASSERT_EQ(2, o->getNotesCount());
+            EXPECT_EQ(keyToIds[o->getNotes()[0]->getKey()][0], o->getNotes()[0]->getId());
+            EXPECT_EQ(keyToIds[o->getNotes()[1]->getKey()][1], o->getNotes()[1]->getId());
+        }
+    }
+    string* stored = m8r::fileToString(repositoryDir+"/o-0.md");
+    EXPECT_EQ(content, *stored);
+    delete stored;
+
+    // ids of deleted O w/ the highest id are not reused after restart
+    uint32_t highWaterMark = ids.getHighWaterMark();
+    m8r::Note* last = ids.getNote(highWaterMark);
+    ASSERT_NE(nullptr, last);
+    string lastKey = last->getOutline()->getKey();
+    mind.amnesia();
+    remove(lastKey.c_str());
+    mind.learn();
+    EXPECT_EQ(3*(OUTLINES-1), ids.size());
+    mind.amnesia();
+    m8r::stringToFile(repositoryDir+"/o-new.md", content);
+    mind.learn();
+    EXPECT_EQ(3*OUTLINES, ids.size());
+    m8r::Outline* created = memory.getOutline(repositoryDir+"/o-new.md");
+    ASSERT_NE(nullptr, created);
+    EXPECT_LT(highWaterMark, created->getId());
+    for(m8r::Note* n:created->getNotes()) {
+        EXPECT_LT(highWaterMark, n->getId());
+    }
+    EXPECT_EQ(highWaterMark+3, ids.getHighWaterMark());
+
+    // single file repository ~ ids are not written next to the file
+    mind.amnesia();
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir+"/o-new.md")));
+    mind.learn();
+    EXPECT_EQ(3, ids.size());
+    EXPECT_FALSE(m8r::isFile((repositoryDir+"/.o-new.md"+m8r::FILENAME_THINGS_IDS).c_str()));
+}
+
+TEST(MindTestCase, Backlinks) {
+    string repositoryDir{"/tmp/mf-unit-repository-backlinks"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    m8r::createDirectory(repositoryDir+"/memory/sub");
+    m8r::stringToFile(
+        repositoryDir+"/memory/a.md",
+        "# Outline A\nText.\n\n## Target\nT.\n\n## Self\nSee [target](#target).\n");
+    m8r::stringToFile(
+        repositoryDir+"/memory/sub/b.md",
+        "# Outline B\nText.\n\n## Link N\nSee [target](../a.md#target).\n\n## Link O\nSee [A](../a.md) and [A](../a.md).\n");
+    m8r::stringToFile(
+        repositoryDir+"/memory/c.md",
+        "# Outline C\nText.\n\n## Link O\nSee [A](a.md \"title\").\n\n## No link\nSee [backup](a.md.bak) and a.md.\n");
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-mtc-bl.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind(config);
+    mind.learn();
+    m8r::Outline* a = mind.remind().getOutline(repositoryDir+"/memory/a.md");
+    ASSERT_NE(nullptr, a);
+    m8r::Note* target = a->getNotes()[0];
+    ASSERT_EQ("Target", target->getName());
+
+    // N backlinks: relative link from other directory and anchor in the same O
+    vector<m8r::Note*>* referees = mind.getRefereeNotes(*target);
+    ASSERT_EQ(2, referees->size());
+    set<string> names{};
+    for(m8r::Note* n:*referees) {
+        names.insert(n->getOutline()->getName() + "/" + n->getName());
+    }
+    EXPECT_EQ(1, names.count("Outline A/Self"));
+    EXPECT_EQ(1, names.count("Outline B/Link N"));
+    delete referees;
+
+    referees = mind.getRefereeNotes(*target, *a);
+    ASSERT_EQ(1, referees->size());
+    EXPECT_EQ("Self", referees->at(0)->getName());
+    delete referees;
+
+    // O backlinks: links to O and its Ns from other Os, each N reported once
+    referees = mind.getRefereeNotes(*a);
+    ASSERT_EQ(3, referees->size());
+    names.clear();
+    for(m8r::Note* n:*referees) {
+        names.insert(n->getOutline()->getName() + "/" + n->getName());
+    }
+    EXPECT_EQ(1, names.count("Outline B/Link N"));
+    EXPECT_EQ(1, names.count("Outline B/Link O"));
+    EXPECT_EQ(1, names.count("Outline C/Link O"));
+    delete referees;
+}
@@ -844,6 +844,94 @@ TEST(NoteTestCase, MangleNoteName) {
     EXPECT_EQ("", o->getNotes()[5]->getMangledName());
 }
 
+TEST(NoteTestCase, KeysAndNameIndices) {
+    string repositoryDir{"/tmp/mf-unit-repository-keys"};
+    m8r::removeDirectoryRecursively(repositoryDir.c_str());
+    m8r::Installer installer{};
+    installer.createEmptyMindForgerRepository(repositoryDir);
+    string sFile{repositoryDir+"/memory/source.md"};
+    m8r::stringToFile(sFile,
+        "# Source"
+        "\n"
+        "\n# First Note"
+        "\nT1."
+        "\n"
+        "\n# Same"
+        "\nT2."
+        "\n"
+        "\n# Same"
+        "\nT3."
+        "\n");
+    string tFile{repositoryDir+"/memory/target.md"};
+    m8r::stringToFile(tFile,
+        "# Target"
+        "\n"
+        "\n# Other Note"
+        "\nT."
+        "\n");
+
+    m8r::Configuration& config = m8r::Configuration::getInstance();
+    config.clear();
+    config.setConfigFilePath("/tmp/cfg-ntc-kni.md");
+    config.setActiveRepository(config.addRepository(m8r::RepositoryIndexer::getRepositoryForPath(repositoryDir)));
+    m8r::Mind mind{config};
+    m8r::Memory& memory = mind.remind();
+    mind.learn();
+    mind.think().get();
+
+    m8r::Outline* s = memory.getOutline(sFile);
+    m8r::Outline* t = memory.getOutline(tFile);
+    ASSERT_TRUE(s != nullptr);
+    ASSERT_TRUE(t != nullptr);
+
+    // precomputed N keys
+    m8r::Note* n = s->getNotes()[0];
+    EXPECT_EQ(sFile+"#first-note", n->getKey());
+    EXPECT_EQ(n, memory.getNote(sFile+"#first-note"));
+    EXPECT_EQ(n, s->getNoteByMangledName("first-note"));
+    // the first N of the same name wins
+    EXPECT_EQ(s->getNotes()[1], s->getNoteByMangledName("same"));
+    EXPECT_EQ(nullptr, memory.getNote(sFile+"#missing"));
+    EXPECT_EQ(nullptr, memory.getNote(repositoryDir+"/memory/missing.md#first-note"));
+
+    // N rename
+    n->setName("Renamed Note");
+    EXPECT_EQ("renamed-note", n->getMangledName());
+    EXPECT_EQ(sFile+"#renamed-note", n->getKey());
+    EXPECT_EQ(nullptr, s->getNoteByMangledName("first-note"));
+    EXPECT_EQ(n, memory.getNote(sFile+"#renamed-note"));
+
+    // N move
+    s->moveNoteDown(s->getNotes()[1]);
+    EXPECT_EQ(s->getNotes()[1], s->getNoteByMangledName("same"));
+    s->moveNoteToFirst(s->getNotes()[2]);
+    EXPECT_EQ(s->getNotes()[0], s->getNoteByMangledName("same"));
+
+    // N refactoring to another O
+    mind.noteRefactor(n, t->getKey());
+    EXPECT_EQ(tFile+"#renamed-note", n->getKey());
+    EXPECT_EQ(nullptr, s->getNoteByMangledName("renamed-note"));
+    EXPECT_EQ(n, t->getNoteByMangledName("renamed-note"));
+
+    // O key change
+    string k{repositoryDir+"/memory/moved.md"};
+    t->setKey(k);
+    EXPECT_EQ(k+"#other-note", t->getNoteByMangledName("other-note")->getKey());
+    EXPECT_EQ(k+"#renamed-note", n->getKey());
+
+    // O by name
+    unique_ptr<vector<m8r::Outline*>> os = mind.findOutlineByNameFts("Source");
+    ASSERT_EQ(1, os->size());
+    EXPECT_EQ(s, os->at(0));
+    s->setName("Renamed Source");
+    EXPECT_EQ(0, mind.findOutlineByNameFts("Source")->size());
+    EXPECT_EQ(1, mind.findOutlineByNameFts("Renamed Source")->size());
+    t->setName("Renamed Source");
+    os = mind.findOutlineByNameFts("Renamed Source");
+    ASSERT_EQ(2, os->size());
+    EXPECT_EQ(memory.getOutlines()[0]->getName(), os->at(0)->getName());
+}
+
 TEST(NoteTestCase, DirectNoteChildren) {
     // prepare M8R repository and let the mind think...
     string repositoryDir{"/tmp/mf-unit-repository-n-child-n"};
@@ -257,3 +257,78 @@ TEST(OutlineTestCase, DirectOutlineNoteChildren) {
     EXPECT_EQ("4", directChildren[2]->getName());
     EXPECT_EQ("6", directChildren[3]->getName());
 }
+
+TEST(OutlineTestCase, NotesTreeIndex) {
+    m8r::OutlineType oType{"Outline", nullptr, m8r::Color::RED()};
+    m8r::NoteType nType{"Note", nullptr, m8r::Color::RED()};
+    m8r::Outline o{&oType};
+    /*
+     * O . . .
+     * a . . .
+     * . b . .
+     * . . . c
+     * . d . .
+     * . . e .
+     * . f . .
+     * g . . .
+     */
+    vector<pair<string,int>> skeleton{{"a",0},{"b",1},{"c",3},{"d",1},{"e",2},{"f",1},{"g",0}};
+    for(auto& s:skeleton) {
+        m8r::Note* n = new m8r::Note{&nType, &o};
+        n->setName(s.first);
+        n->setDepth(s.second);
+        o.addNote(n);
+    }
+    m8r::Note* a = o.getNotes()[0];
+    m8r::Note* d = o.getNotes()[3];
+
+    // structure queries
+    EXPECT_EQ(2, o.getDirectNoteChildrenCount());
+    EXPECT_EQ(3, o.getDirectNoteChildrenCount(a));
+    EXPECT_EQ(1, o.getDirectNoteChildrenCount(d));
+    EXPECT_EQ(3, o.getNoteOffset(d));
+    vector<m8r::Note*> children{};
+    m8r::Outline::Patch patch{};
+    o.getAllNoteChildren(a, &children, &patch);
+    EXPECT_EQ(5, children.size());
+    EXPECT_EQ(0, patch.start);
+    // patch includes N which follows children
+    EXPECT_EQ(6, patch.count);
+    vector<int> parents{};
+    // path to root doesn't include N at offset 0
+    o.getNotePathToRoot(4, parents);
+    ASSERT_EQ(1, parents.size());
+    EXPECT_EQ(3, parents[0]);
+
+    // block moves keep index consistent w/ Ns vector
+    o.moveNoteUp(d, &patch);
+    EXPECT_EQ(m8r::Outline::Patch::Diff::MOVE, patch.diff);
+    EXPECT_EQ(1, patch.start);
+    EXPECT_EQ(3, patch.count);
+    string order{};
+    for(m8r::Note* n:o.getNotes()) order += n->getName();
+    EXPECT_EQ("adebcfg", order);
+    EXPECT_EQ(1, o.getNoteOffset(d));
+    EXPECT_EQ(1, o.getDirectNoteChildrenCount(d));
+    o.moveNoteToLast(d, &patch);
+    order.clear();
+    for(m8r::Note* n:o.getNotes()) order += n->getName();
+    EXPECT_EQ("abcfdeg", order);
+    EXPECT_EQ(4, o.getNoteOffset(d));
+    children.clear();
+    o.getDirectNoteChildren(a, children);
+    ASSERT_EQ(3, children.size());
+    EXPECT_EQ("d", children[2]->getName());
+
+    // depth change re-parents Ns, patch spans N, its children and N which follows them
+    o.demoteNote(d, &patch);
+    EXPECT_EQ(m8r::Outline::Patch::Diff::CHANGE, patch.diff);
+    EXPECT_EQ(4, patch.start);
+    EXPECT_EQ(2, patch.count);
+    EXPECT_EQ(2, o.getDirectNoteChildrenCount(a));
+    o.forgetNote(d);
+    order.clear();
+    for(m8r::Note* n:o.getNotes()) order += n->getName();
+    EXPECT_EQ("abcfg", order);
+    EXPECT_EQ(2, o.getDirectNoteChildrenCount(a));
+}
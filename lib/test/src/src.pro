@@ -107,6 +107,7 @@ win32{
 SOURCES += \
     ./gear/datetime_test.cpp \
     ./gear/string_utils_test.cpp \
+    ./gear/tracer_test.cpp \
     ./indexer/repository_indexer_test.cpp \
     ./markdown/markdown_test.cpp \
     ./mind/fts_test.cpp \
@@ -125,10 +126,20 @@ SOURCES += \
     ../benchmark/ai_benchmark.cpp \
     ./gear/file_utils_test.cpp \
     ./gear/trie_test.cpp \
+    ./gear/prefix_index_test.cpp \
+    ./gear/fuzzy_finder_test.cpp \
+    ./gear/directory_scanner_test.cpp \
+    ./gear/cancellation_token_test.cpp \
+    ./gear/text_arena_test.cpp \
     ./ai/autolinking_test.cpp \
-    ./ai/autolinking_cmark_test.cpp
+    ./ai/autolinking_cmark_test.cpp \
+    ./cli/cli_test.cpp \
+    ../../../cli/src/cli_command_processor.cpp \
+    ../../../cli/src/cli_server.cpp
 
 HEADERS += \
-    ./test_gear.h
+    ./test_gear.h \
+    ../../../cli/src/cli_command_processor.h \
+    ../../../cli/src/cli_server.h
 
 # eof
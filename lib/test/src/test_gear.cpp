@@ -134,6 +134,9 @@ void printLexemType(MarkdownLexemType type)
     case MarkdownLexemType::META_PROPERTY_links:
         cout << "META links       #";
         break;
+    case MarkdownLexemType::META_PROPERTY_id:
+        cout << "META id          #";
+        break;
     case MarkdownLexemType::META_PROPERTY_scope:
         cout << "META timeScope   #";
         break;
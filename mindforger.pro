@@ -30,10 +30,11 @@
 
 TEMPLATE = subdirs
 
-SUBDIRS = lib app
+SUBDIRS = lib app cli
 
 # build dependencies
 app.depends = lib
+cli.depends = lib
 
 # ########################################
 # Linux installation: make install